@@ -0,0 +1,252 @@
+/**
+ * This is the harness of the benchmarks. Each benchmark case is run a few times without being measured, so that the
+ * caches and the page tables are warm, and then it is run repeatedly and each run is timed with the monotonic clock.
+ * The median and the percentiles of the run times are reported, as they are not skewed by the occasional slow run the
+ * way the mean is.
+ *
+ * The results are written as a JSON document, so that they can be compared between releases, and as a table to the
+ * standard error.
+ */
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <getopt.h>
+
+#include "bench.h"
+#include "compare.h"
+
+// The default number of warmup runs
+#define BENCH_DEFAULT_WARMUP 2
+// The default number of measured runs
+#define BENCH_DEFAULT_RUNS 10
+
+volatile uint64_t bench_sink = 0;
+
+/**
+ * Parse the common command line arguments of a benchmark program. The remaining arguments start at optind.
+ *
+ * @param argc The number of command line arguments.
+ * @param argv The command line arguments.
+ * @param options Pointer to where the options will be written to.
+ * @return true if the parsing was successful, false otherwise.
+ */
+bool bench_parse_arguments(int argc, char *argv[], BenchOptions *options) {
+    static struct option long_options[] = {
+        {"filter", required_argument, 0, 'f'},
+        {"output", required_argument, 0, 'o'},
+        {"quick", no_argument, 0, 'q'},
+        {"runs", required_argument, 0, 'r'},
+        {"warmup", required_argument, 0, 'w'},
+        {"help", no_argument, 0, 'h'},
+        {0, 0, 0, 0}
+    };
+    memset(options, 0, sizeof(BenchOptions));
+    options->warmup = BENCH_DEFAULT_WARMUP;
+    options->runs = BENCH_DEFAULT_RUNS;
+
+    // Parse options
+    int c;
+    char *end_ptr = NULL;
+    int option_index = 0;
+    while (true) {
+        c = getopt_long(argc, argv, "hqf:o:r:w:", long_options, &option_index);
+        if (c == -1) {
+            break;
+        }
+        switch (c) {
+            case 'f':
+                options->filter = optarg;
+                break;
+            case 'o':
+                options->output = optarg;
+                break;
+            case 'q':
+                options->quick = true;
+                break;
+            case 'r':
+                errno = 0;
+                options->runs = strtoul(optarg, &end_ptr, 10);
+                if (end_ptr == optarg || errno != 0 || options->runs == 0) {
+                    fprintf(stderr, "Invalid value for the runs argument: %s.\n", optarg);
+                    return false;
+                }
+                break;
+            case 'w':
+                errno = 0;
+                options->warmup = strtoul(optarg, &end_ptr, 10);
+                if (end_ptr == optarg || errno != 0) {
+                    fprintf(stderr, "Invalid value for the warmup argument: %s.\n", optarg);
+                    return false;
+                }
+                break;
+            case 'h':
+                options->help = true;
+                return false;
+            default:
+                return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * Print the usage instructions of the common options.
+ */
+void bench_print_options() {
+    printf("Mandatory arguments to long options are mandatory for short options too.\n"
+           "    -f, --filter=TEXT       Only run the benchmarks whose name contains TEXT.\n"
+           "    -o, --output=FILE       Write the JSON results to FILE instead of the standard output.\n"
+           "    -q, --quick             Only use the smallest input sizes.\n"
+           "    -r, --runs=RUNS         The number of measured runs of each benchmark, default is %d.\n"
+           "    -w, --warmup=RUNS       The number of warmup runs of each benchmark, default is %d.\n"
+           "    -h, --help              Display this help and exit.\n", BENCH_DEFAULT_RUNS, BENCH_DEFAULT_WARMUP);
+}
+
+/**
+ * Get the current time of the monotonic clock.
+ *
+ * @return The time in nanoseconds.
+ */
+uint64_t bench_now() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (uint64_t) ts.tv_sec * 1000000000u + ts.tv_nsec;
+}
+
+/**
+ * Get the next pseudorandom number of a SplitMix64 generator. The benchmark inputs are generated from a fixed seed, so
+ * they are the same in every release.
+ *
+ * @param state Pointer to the state of the generator.
+ * @return The pseudorandom number.
+ */
+uint64_t bench_random(uint64_t *state) {
+    uint64_t x = (*state += 0x9e3779b97f4a7c15ULL);
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+
+    return x ^ (x >> 31);
+}
+
+/**
+ * Start a benchmark suite, and open its JSON output.
+ *
+ * @param suite Pointer to the suite data structure.
+ * @param name The name of the suite.
+ * @param options The options.
+ * @return true if the suite was started successfully, false otherwise.
+ */
+bool bench_begin(BenchSuite *suite, const char *name, const BenchOptions *options) {
+    memset(suite, 0, sizeof(BenchSuite));
+    suite->options = *options;
+    suite->times = malloc(options->runs * sizeof(uint64_t));
+    suite->json = options->output ? fopen(options->output, "w") : stdout;
+    if (!suite->times || !suite->json) {
+        free(suite->times);
+        if (suite->json && suite->json != stdout) {
+            fclose(suite->json);
+        }
+        return false;
+    }
+    suite->ok = true;
+    fprintf(suite->json, "{\n  \"suite\": \"%s\",\n  \"warmup\": %zu,\n  \"runs\": %zu,\n  \"results\": [",
+            name, options->warmup, options->runs);
+    fprintf(stderr, "%-40s %12s %14s %14s %14s %12s\n", name, "size", "median_ns", "p90_ns", "min_ns", "ns_per_op");
+
+    return true;
+}
+
+/**
+ * Get a percentile of sorted run times.
+ *
+ * @param times The sorted run times.
+ * @param count The number of run times.
+ * @param percentile The percentile, between 0 and 100.
+ * @return The run time.
+ */
+static uint64_t percentile(const uint64_t *times, size_t count, double percentile) {
+    return times[(size_t) (percentile / 100.0 * (double) (count - 1) + 0.5)];
+}
+
+/**
+ * Run a benchmark case, unless it is filtered out. The warmup runs are performed first, and then the measured runs,
+ * whose minimum, median, percentiles and maximum are reported.
+ *
+ * @param suite Pointer to the suite data structure.
+ * @param bench_case The benchmark case.
+ * @return true if the case was successful or filtered out, false otherwise.
+ */
+bool bench_run(BenchSuite *suite, const BenchCase *bench_case) {
+    if (suite->options.filter && !strstr(bench_case->name, suite->options.filter)) {
+        return true;
+    }
+
+    // Run the case
+    size_t runs = suite->options.runs;
+    for (size_t i = 0; i < suite->options.warmup + runs; i++) {
+        if (bench_case->setup && !bench_case->setup(bench_case->context)) {
+            goto failed;
+        }
+        uint64_t start = bench_now();
+        if (!bench_case->run(bench_case->context)) {
+            goto failed;
+        }
+        uint64_t elapsed = bench_now() - start;
+        if (i >= suite->options.warmup) {
+            suite->times[i - suite->options.warmup] = elapsed;
+        }
+    }
+
+    // Report the results
+    qsort(suite->times, runs, sizeof(uint64_t), compare_u_int64_t);
+    uint64_t total = 0;
+    for (size_t i = 0; i < runs; i++) {
+        total += suite->times[i];
+    }
+    uint64_t median = percentile(suite->times, runs, 50);
+    double ns_per_op = bench_case->operations > 0 ? (double) median / (double) bench_case->operations : 0;
+    fprintf(suite->json, "%s\n    {\"name\": \"%s\", \"size\": %zu, \"operations\": %zu, \"min_ns\": %llu, "
+                         "\"median_ns\": %llu, \"p90_ns\": %llu, \"p99_ns\": %llu, \"max_ns\": %llu, "
+                         "\"mean_ns\": %llu, \"ns_per_op\": %.3f}",
+            suite->result_count > 0 ? "," : "", bench_case->name, bench_case->size, bench_case->operations,
+            (unsigned long long) suite->times[0], (unsigned long long) median,
+            (unsigned long long) percentile(suite->times, runs, 90),
+            (unsigned long long) percentile(suite->times, runs, 99), (unsigned long long) suite->times[runs - 1],
+            (unsigned long long) (total / runs), ns_per_op);
+    fprintf(stderr, "%-40s %12zu %14llu %14llu %14llu %12.3f\n", bench_case->name, bench_case->size,
+            (unsigned long long) median, (unsigned long long) percentile(suite->times, runs, 90),
+            (unsigned long long) suite->times[0], ns_per_op);
+    suite->result_count++;
+
+    return true;
+
+failed:
+    fprintf(stderr, "%-40s %12zu failed\n", bench_case->name, bench_case->size);
+    suite->ok = false;
+
+    return false;
+}
+
+/**
+ * Finish a benchmark suite, and close its JSON output.
+ *
+ * @param suite Pointer to the suite data structure.
+ * @return true if all the cases were successful and the output was written successfully, false otherwise.
+ */
+bool bench_end(BenchSuite *suite) {
+    fprintf(suite->json, "\n  ]\n}\n");
+    bool ok = suite->ok && !ferror(suite->json);
+    if (suite->json != stdout) {
+        ok = fclose(suite->json) == 0 && ok;
+    } else {
+        ok = fflush(stdout) == 0 && ok;
+    }
+    free(suite->times);
+    memset(suite, 0, sizeof(BenchSuite));
+
+    return ok;
+}
@@ -0,0 +1,123 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+/**
+ * The options of a benchmark program, which are common to all the benchmark programs.
+ */
+typedef struct {
+    /** The number of runs that are not measured, before the measured runs. */
+    size_t warmup;
+    /** The number of measured runs. */
+    size_t runs;
+    /** Only the benchmarks whose name contains the filter are run, or all of them if it is NULL. */
+    const char *filter;
+    /** The path of the JSON output file, or NULL for the standard output. */
+    const char *output;
+    /** true if only the smallest input sizes are used. */
+    bool quick;
+    /** The help flag. */
+    bool help;
+} BenchOptions;
+
+/**
+ * A benchmark case.
+ */
+typedef struct {
+    /** The name of the benchmark. */
+    const char *name;
+    /** The size of the input, which is reported with the results. */
+    size_t size;
+    /** The number of operations of each run, which the time per operation is calculated from. */
+    size_t operations;
+    /** A function that prepares each run, or NULL. Its time is not measured. */
+    bool (*setup)(void *context);
+    /** The function that is measured. It returns false if the run failed. */
+    bool (*run)(void *context);
+    /** The context that is passed to the functions. */
+    void *context;
+} BenchCase;
+
+/**
+ * A benchmark suite, which runs benchmark cases and writes their results as a JSON document.
+ */
+typedef struct {
+    /** The options. */
+    BenchOptions options;
+    /** The JSON output file. */
+    FILE *json;
+    /** The number of results that were written. */
+    size_t result_count;
+    /** The run times of a case in nanoseconds. */
+    uint64_t *times;
+    /** false if a case has failed. */
+    bool ok;
+} BenchSuite;
+
+// A value that the benchmarks write their results to, so that the compiler does not remove the measured code
+extern volatile uint64_t bench_sink;
+
+/**
+ * Parse the common command line arguments of a benchmark program. The remaining arguments start at optind.
+ *
+ * @param argc The number of command line arguments.
+ * @param argv The command line arguments.
+ * @param options Pointer to where the options will be written to.
+ * @return true if the parsing was successful, false otherwise.
+ */
+bool bench_parse_arguments(int argc, char *argv[], BenchOptions *options);
+
+/**
+ * Print the usage instructions of the common options.
+ */
+void bench_print_options();
+
+/**
+ * Get the current time of the monotonic clock.
+ *
+ * @return The time in nanoseconds.
+ */
+uint64_t bench_now();
+
+/**
+ * Get the next pseudorandom number of a SplitMix64 generator. The benchmark inputs are generated from a fixed seed, so
+ * they are the same in every release.
+ *
+ * @param state Pointer to the state of the generator.
+ * @return The pseudorandom number.
+ */
+uint64_t bench_random(uint64_t *state);
+
+/**
+ * Start a benchmark suite, and open its JSON output.
+ *
+ * @param suite Pointer to the suite data structure.
+ * @param name The name of the suite.
+ * @param options The options.
+ * @return true if the suite was started successfully, false otherwise.
+ */
+bool bench_begin(BenchSuite *suite, const char *name, const BenchOptions *options);
+
+/**
+ * Run a benchmark case, unless it is filtered out. The warmup runs are performed first, and then the measured runs,
+ * whose minimum, median, percentiles and maximum are reported.
+ *
+ * @param suite Pointer to the suite data structure.
+ * @param bench_case The benchmark case.
+ * @return true if the case was successful or filtered out, false otherwise.
+ */
+bool bench_run(BenchSuite *suite, const BenchCase *bench_case);
+
+/**
+ * Finish a benchmark suite, and close its JSON output.
+ *
+ * @param suite Pointer to the suite data structure.
+ * @return true if all the cases were successful and the output was written successfully, false otherwise.
+ */
+bool bench_end(BenchSuite *suite);
+
+#endif // BENCH_H
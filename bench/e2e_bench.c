@@ -0,0 +1,552 @@
+/**
+ * This program runs the end-to-end benchmarks of the executables: each run starts the executable on a generated input
+ * and waits for it to exit, so the time includes the process startup, the input parsing and the output formatting.
+ *
+ * The inputs are generated from a fixed seed in a temporary directory, at sizes that increase by a factor of 10: lists
+ * of unique numbers for the sort and missing number programs, and dictionaries with anagram classes for the anagram
+ * programs. The standard output of the executables is discarded.
+ *
+ * The programs that read their input line by line are also measured with each backend of the input reader, on inputs
+ * that are evicted from the page cache before each run, so that the reads hit the disk.
+ */
+#define _GNU_SOURCE
+
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <signal.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <getopt.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "bench.h"
+#include "reader.h"
+
+// The seed of the input generator
+#define SEED 1
+// The maximum number of arguments of a command
+#define MAX_ARGUMENTS 8
+// The maximum length of a generated word
+#define MAX_WORD_LENGTH 12
+// The number of queries that the client sends
+#define CLIENT_QUERIES 10000
+// The number of milliseconds to wait for the server to start
+#define SERVER_TIMEOUT 5000
+// A word that is not in the generated dictionaries, which only have the letters 'a' to 'z'
+#define ABSENT_WORD "absent0word"
+// The false positive rate of the Bloom filter of the database
+#define BLOOM_RATE "0.01"
+
+/**
+ * The executables.
+ */
+typedef enum {
+    UNIQUE_RANDOM,
+    LIBRARY_SORT,
+    BITSET_SORT,
+    SET_OPS,
+    MISSING_NUMBER_BITSET,
+    MISSING_NUMBER_FILE,
+    FIND_DUPLICATE,
+    ANAGRAM,
+    BUILD_ANAGRAM_DB,
+    SEARCH_ANAGRAM_DB,
+    COMPACT_ANAGRAM_DB,
+    ANAGRAM_STATS,
+    ANAGRAM_SERVER,
+    ANAGRAM_CLIENT,
+    PROGRAM_COUNT
+} Program;
+
+// The reader backends that the cold cache benchmarks compare, as values of the PP_READER_BACKEND variable
+static const char *reader_backends[] = {"sync", "thread", "io_uring"};
+
+// The names of the executables
+static const char *program_names[PROGRAM_COUNT] = {
+    "unique_random", "library_sort", "bitset_sort", "set_ops", "missing_number_bitset", "missing_number_file",
+    "find_duplicate", "anagram", "build_anagram_db", "search_anagram_db", "compact_anagram_db", "anagram_stats",
+    "anagram_server", "anagram_client"
+};
+// The paths of the executables
+static char programs[PROGRAM_COUNT][PATH_MAX];
+
+/**
+ * The generated inputs of a size.
+ */
+typedef struct {
+    /** The number of elements of the inputs. */
+    size_t size;
+    /** The file of unique numbers, one per line. */
+    char numbers[PATH_MAX];
+    /** The file of the same numbers, with the first one repeated at the end. */
+    char duplicates[PATH_MAX];
+    /** The dictionary file, one word per line. */
+    char dictionary[PATH_MAX];
+    /** The dictionary of a delta segment. */
+    char delta[PATH_MAX];
+    /** The file of query words of the client. */
+    char queries[PATH_MAX];
+    /** The anagram database file. */
+    char db[PATH_MAX];
+    /** The compact anagram database file. */
+    char compact_db[PATH_MAX];
+    /** The anagram database file with a Bloom filter file. */
+    char bloom_db[PATH_MAX];
+    /** The anagram database file that delta segments are merged into. */
+    char merged_db[PATH_MAX];
+    /** The checkpoint directory of the multi-pass programs, which their successful runs remove. */
+    char checkpoint[PATH_MAX];
+    /** The socket of the server. */
+    char socket[PATH_MAX];
+    /** A word of the dictionary. */
+    char word[MAX_WORD_LENGTH + 1];
+    /** The size as a string. */
+    char size_text[32];
+    /** The maximum value of the numbers, exclusive, as a string. */
+    char max_text[32];
+} Workload;
+
+/**
+ * A command that is benchmarked.
+ */
+typedef struct {
+    /** The arguments of the command, the first one is the path of the executable. */
+    char *argv[MAX_ARGUMENTS];
+    /** The file that the standard input is read from, or NULL. */
+    const char *input;
+    /** The arguments of a command that prepares each run, or NULL. */
+    char *setup_argv[MAX_ARGUMENTS];
+    /** The reader backend of the command, or NULL for the default one. */
+    const char *backend;
+    /** The file that is evicted from the page cache before each run, or NULL. */
+    const char *cold;
+} Command;
+
+/**
+ * Run a command, and wait for it to exit. Its standard output is discarded.
+ *
+ * @param argv The arguments of the command.
+ * @param input The file that the standard input is read from, or NULL.
+ * @param backend The reader backend of the command, or NULL for the default one.
+ * @return true if the command exited successfully, false otherwise.
+ */
+static bool execute(char *const argv[], const char *input, const char *backend) {
+    pid_t pid = fork();
+    if (pid == -1) {
+        return false;
+    }
+    if (pid == 0) {
+        int in = input ? open(input, O_RDONLY) : -1;
+        int out = open("/dev/null", O_WRONLY);
+        if ((input && (in == -1 || dup2(in, STDIN_FILENO) == -1)) || out == -1 || dup2(out, STDOUT_FILENO) == -1) {
+            _exit(127);
+        }
+        if (backend && setenv(PP_READER_BACKEND_ENV, backend, 1) != 0) {
+            _exit(127);
+        }
+        execv(argv[0], argv);
+        _exit(127);
+    }
+    int status;
+    while (waitpid(pid, &status, 0) == -1) {
+        if (errno != EINTR) {
+            return false;
+        }
+    }
+
+    return WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+/**
+ * Evict a file from the page cache. Only the clean pages are evicted, so the file is written back first.
+ *
+ * @param path The path of the file.
+ * @return true if the file was evicted successfully, false otherwise.
+ */
+static bool evict_file(const char *path) {
+    int fd = open(path, O_RDONLY);
+    if (fd == -1) {
+        return false;
+    }
+    bool ok = fdatasync(fd) == 0 && posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED) == 0;
+    close(fd);
+
+    return ok;
+}
+
+static bool setup_command(void *context) {
+    Command *command = context;
+    return (command->setup_argv[0] == NULL || execute(command->setup_argv, NULL, NULL)) &&
+           (command->cold == NULL || evict_file(command->cold));
+}
+
+static bool run_command(void *context) {
+    Command *command = context;
+    return execute(command->argv, command->input, command->backend);
+}
+
+/**
+ * Write unique random numbers, one per line. The numbers are the first size numbers of a shuffle of the range between
+ * 0 and 2 * size - 1.
+ *
+ * @param path The path of the file.
+ * @param size The number of numbers.
+ * @param duplicate true to repeat the first number at the end.
+ * @return true if the file was written successfully, false otherwise.
+ */
+static bool write_numbers(const char *path, size_t size, bool duplicate) {
+    uint32_t *numbers = malloc(2 * size * sizeof(uint32_t));
+    FILE *file = fopen(path, "w");
+    if (!numbers || !file) {
+        free(numbers);
+        if (file) {
+            fclose(file);
+        }
+        return false;
+    }
+    for (size_t i = 0; i < 2 * size; i++) {
+        numbers[i] = (uint32_t) i;
+    }
+    uint64_t state = SEED;
+    for (size_t i = 0; i < size; i++) {
+        size_t j = i + bench_random(&state) % (2 * size - i);
+        uint32_t number = numbers[i];
+        numbers[i] = numbers[j];
+        numbers[j] = number;
+        fprintf(file, "%u\n", numbers[i]);
+    }
+    if (duplicate && size > 0) {
+        fprintf(file, "%u\n", numbers[0]);
+    }
+    free(numbers);
+
+    return fclose(file) == 0;
+}
+
+/**
+ * Write a dictionary of random words. The words are generated in anagram classes of 1 to 4 words, which are
+ * permutations of a random word of 3 to MAX_WORD_LENGTH letters. One class in 16 repeats a single letter, so its words
+ * are copies of the same word, which the compact format packs to no bits.
+ *
+ * @param path The path of the file.
+ * @param size The number of words.
+ * @param seed The seed of the generator.
+ * @param word Pointer to where the first word will be written to, or NULL.
+ * @return true if the file was written successfully, false otherwise.
+ */
+static bool write_dictionary(const char *path, size_t size, uint64_t seed, char *word) {
+    FILE *file = fopen(path, "w");
+    if (!file) {
+        return false;
+    }
+    uint64_t state = seed;
+    char letters[MAX_WORD_LENGTH + 1];
+    size_t count = 0;
+    while (count < size) {
+        size_t length = 3 + bench_random(&state) % (MAX_WORD_LENGTH - 2);
+        for (size_t i = 0; i < length; i++) {
+            letters[i] = (char) ('a' + bench_random(&state) % 26);
+        }
+        if (bench_random(&state) % 16 == 0) {
+            memset(letters, letters[0], length);
+        }
+        letters[length] = '\0';
+        if (word && count == 0) {
+            strcpy(word, letters);
+        }
+        size_t class_size = 1 + bench_random(&state) % 4;
+        for (size_t i = 0; i < class_size && count < size; i++, count++) {
+            fprintf(file, "%s\n", letters);
+            for (size_t j = length - 1; j > 0; j--) {
+                size_t k = bench_random(&state) % (j + 1);
+                char letter = letters[j];
+                letters[j] = letters[k];
+                letters[k] = letter;
+            }
+        }
+    }
+
+    return fclose(file) == 0;
+}
+
+/**
+ * Generate the inputs of a size in a directory.
+ *
+ * @param workload Pointer to the workload data structure.
+ * @param dir The directory.
+ * @param size The number of elements of the inputs.
+ * @return true if the inputs were generated successfully, false otherwise.
+ */
+static bool generate_workload(Workload *workload, const char *dir, size_t size) {
+    memset(workload, 0, sizeof(Workload));
+    workload->size = size;
+    snprintf(workload->numbers, PATH_MAX, "%s/numbers.%zu.txt", dir, size);
+    snprintf(workload->duplicates, PATH_MAX, "%s/duplicates.%zu.txt", dir, size);
+    snprintf(workload->dictionary, PATH_MAX, "%s/dictionary.%zu.txt", dir, size);
+    snprintf(workload->delta, PATH_MAX, "%s/delta.%zu.txt", dir, size);
+    snprintf(workload->queries, PATH_MAX, "%s/queries.%zu.txt", dir, size);
+    snprintf(workload->db, PATH_MAX, "%s/dictionary.%zu.adb", dir, size);
+    snprintf(workload->compact_db, PATH_MAX, "%s/compact.%zu.adb", dir, size);
+    snprintf(workload->bloom_db, PATH_MAX, "%s/bloom.%zu.adb", dir, size);
+    snprintf(workload->merged_db, PATH_MAX, "%s/merged.%zu.adb", dir, size);
+    snprintf(workload->checkpoint, PATH_MAX, "%s/checkpoint.%zu", dir, size);
+    snprintf(workload->socket, PATH_MAX, "%s/server.%zu.sock", dir, size);
+    snprintf(workload->size_text, sizeof(workload->size_text), "%zu", size);
+    snprintf(workload->max_text, sizeof(workload->max_text), "%zu", 2 * size);
+
+    char *build_argv[] = {programs[BUILD_ANAGRAM_DB], workload->dictionary, workload->merged_db, NULL};
+    return write_numbers(workload->numbers, size, false) &&
+           write_numbers(workload->duplicates, size, true) &&
+           write_dictionary(workload->dictionary, size, SEED, workload->word) &&
+           write_dictionary(workload->delta, size / 100 + 1, SEED + 1, NULL) &&
+           write_dictionary(workload->queries, CLIENT_QUERIES, SEED, NULL) &&
+           execute(build_argv, NULL, NULL);
+}
+
+/**
+ * Start the anagram server, and wait until it accepts connections.
+ *
+ * @param workload The workload.
+ * @return The process id of the server, or -1 if it could not be started or the socket path is too long.
+ */
+static pid_t start_server(const Workload *workload) {
+    struct sockaddr_un address = {.sun_family = AF_UNIX};
+    if (strlen(workload->socket) >= sizeof(address.sun_path)) {
+        return -1;
+    }
+    strcpy(address.sun_path, workload->socket);
+    char *argv[] = {programs[ANAGRAM_SERVER], (char *) workload->db, (char *) workload->socket, NULL};
+    pid_t pid = fork();
+    if (pid == 0) {
+        int out = open("/dev/null", O_WRONLY);
+        if (out == -1 || dup2(out, STDOUT_FILENO) == -1) {
+            _exit(127);
+        }
+        execv(argv[0], argv);
+        _exit(127);
+    }
+    if (pid == -1) {
+        return -1;
+    }
+
+    for (int i = 0; i < SERVER_TIMEOUT; i++) {
+        int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fd != -1 && connect(fd, (struct sockaddr *) &address, sizeof(address)) == 0) {
+            close(fd);
+            return pid;
+        }
+        if (fd != -1) {
+            close(fd);
+        }
+        if (waitpid(pid, NULL, WNOHANG) == pid) {
+            return -1;
+        }
+        usleep(1000);
+    }
+    kill(pid, SIGTERM);
+    waitpid(pid, NULL, 0);
+
+    return -1;
+}
+
+/**
+ * Run the end-to-end benchmarks of a size.
+ *
+ * @param suite The benchmark suite.
+ * @param workload The workload.
+ * @return true if the benchmarks were successful, false otherwise.
+ */
+static bool bench_workload(BenchSuite *suite, Workload *workload) {
+    size_t size = workload->size;
+    Command unique_random = {.argv = {programs[UNIQUE_RANDOM], workload->size_text, workload->max_text}};
+    Command library_sort = {.argv = {programs[LIBRARY_SORT]}, .input = workload->numbers};
+    Command library_sort_top = {.argv = {programs[LIBRARY_SORT], "--top", "100"}, .input = workload->numbers};
+    Command bitset_sort = {.argv = {programs[BITSET_SORT], "-m", workload->max_text, workload->numbers}};
+    Command bitset_sort_checkpoint = {.argv = {programs[BITSET_SORT], "-m", workload->max_text, "-k",
+                                               workload->checkpoint, workload->numbers}};
+    Command set_ops_union = {.argv = {programs[SET_OPS], "union", workload->numbers, workload->duplicates}};
+    Command set_ops_diff_count = {.argv = {programs[SET_OPS], "-c", "diff", workload->duplicates, workload->numbers}};
+    Command missing_number_bitset = {.argv = {programs[MISSING_NUMBER_BITSET], workload->numbers}};
+    Command missing_number_file = {.argv = {programs[MISSING_NUMBER_FILE], workload->numbers}};
+    Command missing_number_file_checkpoint = {.argv = {programs[MISSING_NUMBER_FILE], "-k", workload->checkpoint,
+                                                       workload->numbers}};
+    Command find_duplicate = {.argv = {programs[FIND_DUPLICATE], workload->duplicates}};
+    Command find_duplicate_search = {.argv = {programs[FIND_DUPLICATE], "-m", "search", workload->duplicates}};
+    Command anagram = {.argv = {programs[ANAGRAM], workload->dictionary, workload->word}};
+    Command anagram_stream = {.argv = {programs[ANAGRAM], "--stream", workload->dictionary, workload->word}};
+    Command build_anagram_db = {.argv = {programs[BUILD_ANAGRAM_DB], workload->dictionary, workload->db}};
+    Command build_compact_db = {.argv = {programs[BUILD_ANAGRAM_DB], "-f", "3", workload->dictionary,
+                                         workload->compact_db}};
+    Command build_external_db = {.argv = {programs[BUILD_ANAGRAM_DB], "-l", "1", workload->dictionary,
+                                          workload->db}};
+    Command build_bloom_db = {.argv = {programs[BUILD_ANAGRAM_DB], "-b", BLOOM_RATE, workload->dictionary,
+                                       workload->bloom_db}};
+    Command search_anagram_db = {.argv = {programs[SEARCH_ANAGRAM_DB], workload->db, workload->word}};
+    Command search_absent = {.argv = {programs[SEARCH_ANAGRAM_DB], workload->db, ABSENT_WORD}};
+    Command search_bloom_absent = {.argv = {programs[SEARCH_ANAGRAM_DB], workload->bloom_db, ABSENT_WORD}};
+    Command search_compact_db = {.argv = {programs[SEARCH_ANAGRAM_DB], workload->compact_db, workload->word}};
+    Command compact_anagram_db = {.argv = {programs[COMPACT_ANAGRAM_DB], workload->merged_db},
+                                  .setup_argv = {programs[BUILD_ANAGRAM_DB], "-a", workload->delta,
+                                                 workload->merged_db}};
+    Command anagram_stats = {.argv = {programs[ANAGRAM_STATS], "-t", "10", workload->db}};
+    Command anagram_stats_compact = {.argv = {programs[ANAGRAM_STATS], "-L", workload->compact_db}};
+    char queries_text[32];
+    snprintf(queries_text, sizeof(queries_text), "%d", CLIENT_QUERIES);
+    Command anagram_client = {.argv = {programs[ANAGRAM_CLIENT], "-n", queries_text, workload->socket,
+                                       workload->queries}};
+
+    BenchCase cases[] = {
+        {"unique_random", size, size, NULL, run_command, &unique_random},
+        {"library_sort", size, size, NULL, run_command, &library_sort},
+        {"library_sort_top", size, size, NULL, run_command, &library_sort_top},
+        {"bitset_sort", size, size, NULL, run_command, &bitset_sort},
+        {"bitset_sort_checkpoint", size, size, NULL, run_command, &bitset_sort_checkpoint},
+        {"set_ops_union", size, 2 * size, NULL, run_command, &set_ops_union},
+        {"set_ops_diff_count", size, 2 * size, NULL, run_command, &set_ops_diff_count},
+        {"missing_number_bitset", size, size, NULL, run_command, &missing_number_bitset},
+        {"missing_number_file", size, size, NULL, run_command, &missing_number_file},
+        {"missing_number_file_checkpoint", size, size, NULL, run_command, &missing_number_file_checkpoint},
+        {"find_duplicate", size, size, NULL, run_command, &find_duplicate},
+        {"find_duplicate_search", size, size, NULL, run_command, &find_duplicate_search},
+        {"anagram", size, size, NULL, run_command, &anagram},
+        {"anagram_stream", size, size, NULL, run_command, &anagram_stream},
+        {"build_anagram_db", size, size, NULL, run_command, &build_anagram_db},
+        {"build_anagram_db_compact", size, size, NULL, run_command, &build_compact_db},
+        {"build_anagram_db_external", size, size, NULL, run_command, &build_external_db},
+        {"build_anagram_db_bloom", size, size, NULL, run_command, &build_bloom_db},
+        {"search_anagram_db", size, 1, NULL, run_command, &search_anagram_db},
+        {"search_anagram_db_compact", size, 1, NULL, run_command, &search_compact_db},
+        {"search_anagram_db_absent", size, 1, NULL, run_command, &search_absent},
+        {"search_anagram_db_bloom_absent", size, 1, NULL, run_command, &search_bloom_absent},
+        {"compact_anagram_db", size, size, setup_command, run_command, &compact_anagram_db},
+        {"anagram_stats", size, 1, NULL, run_command, &anagram_stats},
+        {"anagram_stats_compact", size, size, NULL, run_command, &anagram_stats_compact},
+    };
+    bool ok = true;
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+        ok = bench_run(suite, &cases[i]) && ok;
+    }
+
+    // The line oriented programs are measured with each reader backend on a cold page cache
+    struct {
+        const char *name;
+        const Command *command;
+        const char *input;
+    } cold_cases[] = {
+        {"library_sort", &library_sort, workload->numbers},
+        {"bitset_sort", &bitset_sort, workload->numbers},
+        {"missing_number_file", &missing_number_file, workload->numbers},
+        {"anagram_stream", &anagram_stream, workload->dictionary},
+        {"build_anagram_db", &build_anagram_db, workload->dictionary},
+    };
+    for (size_t i = 0; i < sizeof(cold_cases) / sizeof(cold_cases[0]); i++) {
+        for (size_t j = 0; j < sizeof(reader_backends) / sizeof(reader_backends[0]); j++) {
+            char name[64];
+            snprintf(name, sizeof(name), "%s_cold_%s", cold_cases[i].name, reader_backends[j]);
+            Command command = *cold_cases[i].command;
+            command.backend = reader_backends[j];
+            command.cold = cold_cases[i].input;
+            BenchCase cold_case = {name, size, size, setup_command, run_command, &command};
+            ok = bench_run(suite, &cold_case) && ok;
+        }
+    }
+    // The memory mapped search of a single word does not use the reader
+    Command anagram_cold = anagram;
+    anagram_cold.cold = workload->dictionary;
+    BenchCase anagram_cold_case = {"anagram_cold_mmap", size, size, setup_command, run_command, &anagram_cold};
+    ok = bench_run(suite, &anagram_cold_case) && ok;
+
+    // The client is measured against a running server
+    BenchCase client_case = {"anagram_client", size, CLIENT_QUERIES, NULL, run_command, &anagram_client};
+    if (!suite->options.filter || strstr(client_case.name, suite->options.filter)) {
+        pid_t server = start_server(workload);
+        if (server == -1) {
+            fprintf(stderr, "Unable to start the anagram server.\n");
+            return false;
+        }
+        ok = bench_run(suite, &client_case) && ok;
+        kill(server, SIGTERM);
+        waitpid(server, NULL, 0);
+    }
+
+    return ok;
+}
+
+/**
+ * Remove the files of the temporary directory, and the directory.
+ *
+ * @param dir The directory.
+ */
+static void remove_dir(const char *dir) {
+    char *argv[] = {"/bin/rm", "-rf", (char *) dir, NULL};
+    execute(argv, NULL, NULL);
+}
+
+/**
+ * The main entry point of the program. It takes 1 required command line argument: The directory of the executables.
+ *
+ * @param argc The number of command line arguments.
+ * @param argv The command line arguments.
+ * @return The program exit status.
+ */
+int main(int argc, char *argv[]) {
+    // Parse the command line arguments
+    BenchOptions options;
+    if (!bench_parse_arguments(argc, argv, &options) || optind >= argc) {
+        if (options.help) {
+            printf("Usage: e2e_bench [OPTION]... [BIN_DIR]\n\n"
+                   "Run the end-to-end benchmarks of the executables in the directory [BIN_DIR] on generated\n"
+                   "inputs.\n\n");
+            bench_print_options();
+            return EXIT_SUCCESS;
+        }
+        if (optind >= argc) {
+            fprintf(stderr, "The directory of the executables must be provided.\n");
+        }
+        return EXIT_FAILURE;
+    }
+    for (size_t i = 0; i < PROGRAM_COUNT; i++) {
+        snprintf(programs[i], PATH_MAX, "%s/%s", argv[optind], program_names[i]);
+        if (access(programs[i], X_OK) != 0) {
+            fprintf(stderr, "Unable to find the executable %s.\n", programs[i]);
+            return EXIT_FAILURE;
+        }
+    }
+    char dir[] = "/tmp/e2e_bench.XXXXXX";
+    if (!mkdtemp(dir)) {
+        fprintf(stderr, "Unable to create a temporary directory.\n");
+        return EXIT_FAILURE;
+    }
+    BenchSuite suite;
+    if (!bench_begin(&suite, "e2e", &options)) {
+        fprintf(stderr, "Unable to start the benchmarks.\n");
+        remove_dir(dir);
+        return EXIT_FAILURE;
+    }
+
+    // The library_sort executable reads at most 10^6 numbers, so that is the largest size
+    static const size_t sizes[] = {10000, 100000, 1000000};
+    size_t size_steps = options.quick ? 1 : sizeof(sizes) / sizeof(sizes[0]);
+    bool ok = true;
+    for (size_t i = 0; i < size_steps; i++) {
+        Workload workload;
+        if (!generate_workload(&workload, dir, sizes[i])) {
+            fprintf(stderr, "Unable to generate the inputs of size %zu.\n", sizes[i]);
+            ok = false;
+            break;
+        }
+        ok = bench_workload(&suite, &workload) && ok;
+    }
+    ok = bench_end(&suite) && ok;
+    remove_dir(dir);
+
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
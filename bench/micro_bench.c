@@ -0,0 +1,624 @@
+/**
+ * This program runs the microbenchmarks of the common library: each bit set function, the Bloom filter functions, the
+ * string signature functions, and the comparison functions through qsort, on inputs of increasing size. The scaling of
+ * the thread pool is measured by calculating the same signatures with an increasing number of workers, which is the
+ * size of those benchmarks.
+ *
+ * The rotation methods are measured for each element size and shift, on arrays from the size of the L1 cache to much
+ * larger than the last level cache, next to the method that pp_rotate chooses automatically.
+ *
+ * The inputs are generated from a fixed seed, and the bit positions are random, so that the bit set benchmarks measure
+ * the memory access pattern of the sort programs rather than a sequential scan.
+ */
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bench.h"
+#include "bitset.h"
+#include "bloom.h"
+#include "compare.h"
+#include "pool.h"
+#include "rotate.h"
+#include "stringsig.h"
+
+// The seed of the input generator
+#define SEED 1
+// The number of bit positions that each bit set run visits
+#define BITSET_OPERATIONS (1 << 20)
+// The false positive rate of the Bloom filter benchmarks
+#define BLOOM_RATE 0.01
+// The number of words that each string signature run processes
+#define SIGNATURE_WORDS 100000
+// The length of the words of the thread pool benchmarks
+#define POOL_WORD_LENGTH 16
+// The number of words that each thread pool run processes
+#define POOL_WORDS 1000000
+// The number of words of the chunks of the thread pool benchmarks
+#define POOL_GRAIN 1024
+// The maximum length of the name of a rotation benchmark
+#define ROTATE_NAME_LENGTH 40
+
+/**
+ * The context of the bit set benchmarks.
+ */
+typedef struct {
+    /** The bit set. */
+    BitSet bs;
+    /** The number of bits of the bit set. */
+    size_t bits;
+    /** The bit positions to visit. */
+    size_t *positions;
+    /** The number of bit positions. */
+    size_t count;
+} BitsetContext;
+
+/**
+ * The context of the Bloom filter benchmarks.
+ */
+typedef struct {
+    /** The Bloom filter. */
+    BloomFilter bf;
+    /** The keys that are added to the filter. */
+    uint64_t *keys;
+    /** The keys that are not added to the filter. */
+    uint64_t *absent_keys;
+    /** The number of keys of each kind. */
+    size_t count;
+} BloomContext;
+
+/**
+ * The context of the string signature benchmarks.
+ */
+typedef struct {
+    /** The words, stored length characters apart. */
+    char *words;
+    /** The length of each word. */
+    size_t length;
+    /** The number of words. */
+    size_t count;
+    /** The buffer of a signature. */
+    char *signature;
+} SignatureContext;
+
+/**
+ * The context of the thread pool benchmarks.
+ */
+typedef struct {
+    /** The pool. */
+    PpPool pool;
+    /** The words, stored POOL_WORD_LENGTH characters apart. */
+    char *words;
+    /** The signatures, stored POOL_WORD_LENGTH + 1 characters apart. */
+    char *signatures;
+    /** The number of words. */
+    size_t count;
+} PoolContext;
+
+/**
+ * A range of the words of a thread pool benchmark, which is split by the fork-join benchmark.
+ */
+typedef struct {
+    /** The context of the benchmark. */
+    PoolContext *context;
+    /** The index of the first word. */
+    size_t first;
+    /** The index after the last word. */
+    size_t last;
+} PoolRange;
+
+/**
+ * The context of the rotation benchmarks.
+ */
+typedef struct {
+    /** The array, which each run rotates further. */
+    unsigned char *data;
+    /** The number of elements. */
+    size_t count;
+    /** The size of each element. */
+    size_t size;
+    /** The number of positions of each rotation. */
+    size_t shift;
+    /** The way to rotate the array. */
+    PpRotateMethod method;
+} RotateContext;
+
+/**
+ * The context of the comparison function benchmarks.
+ */
+typedef struct {
+    /** The unsorted input. */
+    void *input;
+    /** The array that is sorted by each run. */
+    void *work;
+    /** The number of elements. */
+    size_t count;
+    /** The size of each element. */
+    size_t element_size;
+    /** The comparison function. */
+    int (*compare)(const void *, const void *);
+} SortContext;
+
+static bool run_bs_init(void *context) {
+    BitsetContext *c = context;
+    BitSet bs;
+    if (!bs_init(&bs, c->bits)) {
+        return false;
+    }
+    bench_sink += bs.bits[0];
+    bs_destroy(&bs);
+
+    return true;
+}
+
+static bool setup_bs_reset(void *context) {
+    return bs_reset(&((BitsetContext *) context)->bs);
+}
+
+static bool run_bs_set(void *context) {
+    BitsetContext *c = context;
+    for (size_t i = 0; i < c->count; i++) {
+        bs_set(&c->bs, c->positions[i]);
+    }
+
+    return true;
+}
+
+static bool run_bs_is_set(void *context) {
+    BitsetContext *c = context;
+    uint64_t set = 0;
+    for (size_t i = 0; i < c->count; i++) {
+        set += bs_is_set(&c->bs, c->positions[i]);
+    }
+    bench_sink += set;
+
+    return true;
+}
+
+static bool run_bs_clear(void *context) {
+    BitsetContext *c = context;
+    for (size_t i = 0; i < c->count; i++) {
+        bs_clear(&c->bs, c->positions[i]);
+    }
+
+    return true;
+}
+
+static bool run_bs_toggle(void *context) {
+    BitsetContext *c = context;
+    for (size_t i = 0; i < c->count; i++) {
+        bs_toggle(&c->bs, c->positions[i]);
+    }
+
+    return true;
+}
+
+static bool run_bs_reset(void *context) {
+    return bs_reset(&((BitsetContext *) context)->bs);
+}
+
+static bool setup_bf_add(void *context) {
+    return bs_reset(&((BloomContext *) context)->bf.bits);
+}
+
+static bool run_bf_add(void *context) {
+    BloomContext *c = context;
+    for (size_t i = 0; i < c->count; i++) {
+        bf_add(&c->bf, c->keys[i]);
+    }
+
+    return true;
+}
+
+static bool run_bf_may_contain(void *context) {
+    BloomContext *c = context;
+    uint64_t found = 0;
+    for (size_t i = 0; i < c->count; i++) {
+        found += bf_may_contain(&c->bf, c->keys[i]);
+    }
+    bench_sink += found;
+
+    return true;
+}
+
+static bool run_bf_may_contain_absent(void *context) {
+    BloomContext *c = context;
+    uint64_t found = 0;
+    for (size_t i = 0; i < c->count; i++) {
+        found += bf_may_contain(&c->bf, c->absent_keys[i]);
+    }
+    bench_sink += found;
+
+    return true;
+}
+
+static bool run_ss_calculate(void *context) {
+    SignatureContext *c = context;
+    for (size_t i = 0; i < c->count; i++) {
+        ss_calculate(c->words + i * c->length, c->length, c->signature);
+        bench_sink += (unsigned char) c->signature[0];
+    }
+
+    return true;
+}
+
+static bool run_ss_histogram(void *context) {
+    SignatureContext *c = context;
+    SsHistogram histogram;
+    for (size_t i = 0; i < c->count; i++) {
+        bench_sink += ss_histogram(c->words + i * c->length, c->length, &histogram) ? histogram.counts[0] : 0;
+    }
+
+    return true;
+}
+
+static bool run_ss_hash(void *context) {
+    SignatureContext *c = context;
+    for (size_t i = 0; i < c->count; i++) {
+        bench_sink += ss_hash(c->words + i * c->length, c->length);
+    }
+
+    return true;
+}
+
+static void calculate_pool_signatures(void *context, size_t first, size_t last) {
+    PoolContext *c = context;
+    for (size_t i = first; i < last; i++) {
+        ss_calculate(c->words + i * POOL_WORD_LENGTH, POOL_WORD_LENGTH, c->signatures + i * (POOL_WORD_LENGTH + 1));
+    }
+}
+
+static bool run_pool_parallel_for(void *context) {
+    PoolContext *c = context;
+    pp_parallel_for(&c->pool, 0, c->count, POOL_GRAIN, calculate_pool_signatures, c);
+    bench_sink += (unsigned char) c->signatures[0];
+
+    return true;
+}
+
+static void invoke_pool_range(void *context) {
+    PoolRange *range = context;
+    if (range->last - range->first <= POOL_GRAIN) {
+        calculate_pool_signatures(range->context, range->first, range->last);
+        return;
+    }
+    size_t middle = range->first + (range->last - range->first) / 2;
+    PoolRange halves[] = {{range->context, range->first, middle}, {range->context, middle, range->last}};
+    PpInvoke calls[] = {{invoke_pool_range, &halves[0]}, {invoke_pool_range, &halves[1]}};
+    pp_parallel_invoke(&range->context->pool, calls, 2);
+}
+
+static bool run_pool_parallel_invoke(void *context) {
+    PoolContext *c = context;
+    PoolRange range = {c, 0, c->count};
+    invoke_pool_range(&range);
+    bench_sink += (unsigned char) c->signatures[0];
+
+    return true;
+}
+
+static bool run_rotate(void *context) {
+    RotateContext *c = context;
+    if (pp_rotate(c->data, c->count, c->size, c->shift, c->method) != PP_OK) {
+        return false;
+    }
+    bench_sink += c->data[0];
+
+    return true;
+}
+
+static bool run_reverse(void *context) {
+    RotateContext *c = context;
+    pp_reverse(c->data, c->count, c->size);
+    bench_sink += c->data[0];
+
+    return true;
+}
+
+static bool setup_sort(void *context) {
+    SortContext *c = context;
+    memcpy(c->work, c->input, c->count * c->element_size);
+
+    return true;
+}
+
+static bool run_sort(void *context) {
+    SortContext *c = context;
+    qsort(c->work, c->count, c->element_size, c->compare);
+    bench_sink += *(unsigned char *) c->work;
+
+    return true;
+}
+
+/**
+ * Run the bit set benchmarks for a bit set size.
+ *
+ * @param suite The benchmark suite.
+ * @param bits The number of bits of the bit set.
+ * @param count The number of bit positions that each run visits.
+ * @return true if the benchmarks were successful, false otherwise.
+ */
+static bool bench_bitset(BenchSuite *suite, size_t bits, size_t count) {
+    BitsetContext context = {.bits = bits, .count = count};
+    context.positions = malloc(count * sizeof(size_t));
+    if (!context.positions || !bs_init(&context.bs, bits)) {
+        free(context.positions);
+        return false;
+    }
+    uint64_t state = SEED;
+    for (size_t i = 0; i < count; i++) {
+        context.positions[i] = bench_random(&state) % bits;
+    }
+
+    BenchCase cases[] = {
+        {"bs_init", bits, 1, NULL, run_bs_init, &context},
+        {"bs_set", bits, count, setup_bs_reset, run_bs_set, &context},
+        {"bs_is_set", bits, count, NULL, run_bs_is_set, &context},
+        {"bs_clear", bits, count, NULL, run_bs_clear, &context},
+        {"bs_toggle", bits, count, NULL, run_bs_toggle, &context},
+        {"bs_reset", bits, 1, NULL, run_bs_reset, &context},
+    };
+    bool ok = true;
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+        ok = bench_run(suite, &cases[i]) && ok;
+    }
+    bs_destroy(&context.bs);
+    free(context.positions);
+
+    return ok;
+}
+
+/**
+ * Run the Bloom filter benchmarks for a number of keys. The absent keys are mostly rejected by the first bit that they
+ * test, which is the common case of the lookups of words without anagrams.
+ *
+ * @param suite The benchmark suite.
+ * @param count The number of keys of the filter, which each run adds or tests.
+ * @return true if the benchmarks were successful, false otherwise.
+ */
+static bool bench_bloom(BenchSuite *suite, size_t count) {
+    BloomContext context = {.count = count};
+    context.keys = malloc(count * sizeof(uint64_t));
+    context.absent_keys = malloc(count * sizeof(uint64_t));
+    if (!context.keys || !context.absent_keys || !bf_init(&context.bf, count, BLOOM_RATE)) {
+        free(context.keys);
+        free(context.absent_keys);
+        return false;
+    }
+    uint64_t state = SEED;
+    for (size_t i = 0; i < count; i++) {
+        context.keys[i] = bench_random(&state);
+        context.absent_keys[i] = bench_random(&state);
+    }
+
+    BenchCase cases[] = {
+        {"bf_add", count, count, setup_bf_add, run_bf_add, &context},
+        {"bf_may_contain", count, count, NULL, run_bf_may_contain, &context},
+        {"bf_may_contain_absent", count, count, NULL, run_bf_may_contain_absent, &context},
+    };
+    bool ok = true;
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+        ok = bench_run(suite, &cases[i]) && ok;
+    }
+    bf_destroy(&context.bf);
+    free(context.keys);
+    free(context.absent_keys);
+
+    return ok;
+}
+
+/**
+ * Run the string signature benchmarks for a word length.
+ *
+ * @param suite The benchmark suite.
+ * @param length The length of the words.
+ * @param count The number of words that each run processes.
+ * @return true if the benchmarks were successful, false otherwise.
+ */
+static bool bench_signature(BenchSuite *suite, size_t length, size_t count) {
+    SignatureContext context = {.length = length, .count = count};
+    context.words = malloc(length * count);
+    context.signature = malloc(length + 1);
+    if (!context.words || !context.signature) {
+        free(context.words);
+        free(context.signature);
+        return false;
+    }
+    uint64_t state = SEED;
+    for (size_t i = 0; i < length * count; i++) {
+        context.words[i] = (char) ('a' + bench_random(&state) % 26);
+    }
+
+    BenchCase cases[] = {
+        {"ss_calculate", length, count, NULL, run_ss_calculate, &context},
+        {"ss_histogram", length, count, NULL, run_ss_histogram, &context},
+        {"ss_hash", length, count, NULL, run_ss_hash, &context},
+    };
+    bool ok = true;
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+        ok = bench_run(suite, &cases[i]) && ok;
+    }
+    free(context.words);
+    free(context.signature);
+
+    return ok;
+}
+
+/**
+ * Run the thread pool benchmarks for a number of workers.
+ *
+ * @param suite The benchmark suite.
+ * @param workers The number of workers of the pool.
+ * @param count The number of words that each run processes.
+ * @return true if the benchmarks were successful, false otherwise.
+ */
+static bool bench_pool(BenchSuite *suite, size_t workers, size_t count) {
+    PoolContext context = {.count = count};
+    context.words = malloc(POOL_WORD_LENGTH * count);
+    context.signatures = malloc((POOL_WORD_LENGTH + 1) * count);
+    if (!context.words || !context.signatures || pp_pool_init(&context.pool, workers) != PP_OK) {
+        free(context.words);
+        free(context.signatures);
+        return false;
+    }
+    uint64_t state = SEED;
+    for (size_t i = 0; i < POOL_WORD_LENGTH * count; i++) {
+        context.words[i] = (char) ('a' + bench_random(&state) % 26);
+    }
+
+    BenchCase cases[] = {
+        {"pool_parallel_for", workers, count, NULL, run_pool_parallel_for, &context},
+        {"pool_parallel_invoke", workers, count, NULL, run_pool_parallel_invoke, &context},
+    };
+    bool ok = true;
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+        ok = bench_run(suite, &cases[i]) && ok;
+    }
+    pp_pool_destroy(&context.pool);
+    free(context.words);
+    free(context.signatures);
+
+    return ok;
+}
+
+/**
+ * Run the rotation benchmarks for a working set size and an element size: the reversal, and each rotation method with
+ * a shift of one element, a third and a half of the array. The names of the rotations are rotate_METHOD_SIZE_SHIFT,
+ * and the size of the results is the working set size, in bytes.
+ *
+ * @param suite The benchmark suite.
+ * @param bytes The size of the array, in bytes.
+ * @param size The size of each element.
+ * @return true if the benchmarks were successful, false otherwise.
+ */
+static bool bench_rotate(BenchSuite *suite, size_t bytes, size_t size) {
+    static const char *method_names[] = {"auto", "juggling", "block_swap", "reversal", "scratch"};
+    static const char *shift_names[] = {"one", "third", "half"};
+    RotateContext context = {.count = bytes / size, .size = size};
+    context.data = malloc(context.count * size);
+    if (!context.data) {
+        return false;
+    }
+    uint64_t state = SEED;
+    for (size_t i = 0; i < context.count * size; i++) {
+        context.data[i] = (unsigned char) bench_random(&state);
+    }
+
+    char name[ROTATE_NAME_LENGTH];
+    snprintf(name, sizeof(name), "reverse_%zu", size);
+    BenchCase bench_case = {name, bytes, context.count, NULL, run_reverse, &context};
+    bool ok = bench_run(suite, &bench_case);
+    size_t shifts[] = {1, context.count / 3, context.count / 2};
+    for (size_t i = 0; i < sizeof(shifts) / sizeof(shifts[0]); i++) {
+        context.shift = shifts[i];
+        for (size_t method = 0; method < sizeof(method_names) / sizeof(method_names[0]); method++) {
+            context.method = (PpRotateMethod) method;
+            snprintf(name, sizeof(name), "rotate_%s_%zu_%s", method_names[method], size, shift_names[i]);
+            bench_case = (BenchCase) {name, bytes, context.count, NULL, run_rotate, &context};
+            ok = bench_run(suite, &bench_case) && ok;
+        }
+    }
+    free(context.data);
+
+    return ok;
+}
+
+/**
+ * Run a comparison function benchmark, which sorts random elements with qsort.
+ *
+ * @param suite The benchmark suite.
+ * @param name The name of the benchmark.
+ * @param count The number of elements.
+ * @param element_size The size of each element.
+ * @param compare The comparison function.
+ * @return true if the benchmark was successful, false otherwise.
+ */
+static bool bench_compare(BenchSuite *suite, const char *name, size_t count, size_t element_size,
+                          int (*compare)(const void *, const void *)) {
+    SortContext context = {.count = count, .element_size = element_size, .compare = compare};
+    context.input = malloc(count * element_size);
+    context.work = malloc(count * element_size);
+    if (!context.input || !context.work) {
+        free(context.input);
+        free(context.work);
+        return false;
+    }
+    uint64_t state = SEED;
+    unsigned char *input = context.input;
+    for (size_t i = 0; i < count * element_size; i++) {
+        input[i] = (unsigned char) bench_random(&state);
+    }
+
+    BenchCase bench_case = {name, count, count, setup_sort, run_sort, &context};
+    bool ok = bench_run(suite, &bench_case);
+    free(context.input);
+    free(context.work);
+
+    return ok;
+}
+
+/**
+ * The main entry point of the program.
+ *
+ * @param argc The number of command line arguments.
+ * @param argv The command line arguments.
+ * @return The program exit status.
+ */
+int main(int argc, char *argv[]) {
+    // Parse the command line arguments
+    BenchOptions options;
+    if (!bench_parse_arguments(argc, argv, &options)) {
+        if (options.help) {
+            printf("Usage: micro_bench [OPTION]...\n\n"
+                   "Run the microbenchmarks of the bit set, Bloom filter, string signature, rotation and\n"
+                   "comparison functions, and the scaling of the thread pool.\n\n");
+            bench_print_options();
+            return EXIT_SUCCESS;
+        }
+        return EXIT_FAILURE;
+    }
+    BenchSuite suite;
+    if (!bench_begin(&suite, "micro", &options)) {
+        fprintf(stderr, "Unable to start the benchmarks.\n");
+        return EXIT_FAILURE;
+    }
+
+    // The sizes are increased by a factor that moves the data from the L1 cache to the main memory
+    static const size_t bitset_sizes[] = {1 << 16, 1 << 20, 1 << 24, 1 << 28};
+    static const size_t bloom_sizes[] = {1 << 12, 1 << 16, 1 << 20, 1 << 24};
+    static const size_t word_lengths[] = {4, 8, 16, 32, 64, 256};
+    static const size_t sort_sizes[] = {10000, 100000, 1000000};
+    static const size_t pool_workers[] = {1, 2, 4, 8};
+    static const size_t rotate_sizes[] = {1 << 14, 1 << 18, 1 << 23, 1 << 27};
+    static const size_t element_sizes[] = {1, 4, 8, 16, 24};
+    size_t size_steps = options.quick ? 1 : sizeof(bitset_sizes) / sizeof(bitset_sizes[0]);
+    for (size_t i = 0; i < size_steps; i++) {
+        bench_bitset(&suite, bitset_sizes[i], options.quick ? BITSET_OPERATIONS / 16 : BITSET_OPERATIONS);
+    }
+    for (size_t i = 0; i < size_steps; i++) {
+        bench_bloom(&suite, bloom_sizes[i]);
+    }
+    for (size_t i = 0; i < sizeof(word_lengths) / sizeof(word_lengths[0]); i++) {
+        bench_signature(&suite, word_lengths[i], options.quick ? SIGNATURE_WORDS / 16 : SIGNATURE_WORDS);
+    }
+    size_steps = options.quick ? 1 : sizeof(sort_sizes) / sizeof(sort_sizes[0]);
+    for (size_t i = 0; i < size_steps; i++) {
+        bench_compare(&suite, "compare_char", sort_sizes[i], sizeof(char), compare_char);
+        bench_compare(&suite, "compare_u_int32_t", sort_sizes[i], sizeof(uint32_t), compare_u_int32_t);
+        bench_compare(&suite, "compare_u_int64_t", sort_sizes[i], sizeof(uint64_t), compare_u_int64_t);
+    }
+    size_steps = options.quick ? 1 : sizeof(rotate_sizes) / sizeof(rotate_sizes[0]);
+    for (size_t i = 0; i < size_steps; i++) {
+        for (size_t j = 0; j < sizeof(element_sizes) / sizeof(element_sizes[0]); j++) {
+            bench_rotate(&suite, rotate_sizes[i], element_sizes[j]);
+        }
+    }
+    size_steps = options.quick ? 2 : sizeof(pool_workers) / sizeof(pool_workers[0]);
+    for (size_t i = 0; i < size_steps; i++) {
+        bench_pool(&suite, pool_workers[i], options.quick ? POOL_WORDS / 16 : POOL_WORDS);
+    }
+
+    return bench_end(&suite) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
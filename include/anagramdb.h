@@ -0,0 +1,693 @@
+#ifndef ANAGRAMDB_H
+#define ANAGRAMDB_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "arena.h"
+#include "bloom.h"
+#include "ppstatus.h"
+#include "stringsig.h"
+
+// The magic number at the start of an anagram database file
+#define ADB_MAGIC "PPANAGDB"
+// The size of the magic number
+#define ADB_MAGIC_SIZE 8
+// The current version of the database format
+#define ADB_VERSION 2
+// The version of the legacy database format, which has no header
+#define ADB_VERSION_LEGACY 1
+// The version of the compact database format, which is front coded
+#define ADB_VERSION_COMPACT 3
+
+/**
+ * The header of an anagram database file. All the integers are stored in the native byte order.
+ *
+ * The header is followed by the entry records, and then by the offset table. The offset table holds the file offset of
+ * each entry record, sorted by signature. Each record holds the word length and the number of words as 32-bit
+ * integers, followed by the null terminated signature and the null terminated words, so the words are stored length + 1
+ * characters apart. Records are aligned to 8 bytes.
+ *
+ * Optional sections follow the offset table. Their offsets are stored in fields that were appended to the header, so
+ * readers treat the fields that lie beyond header_size as zero, which means that the section is absent.
+ *
+ * Compact databases have the same header, but their records are not aligned and have no fixed part. The lengths and
+ * counts are stored as LEB128 varints, so there are no size limits. Each record holds the length of the prefix that its
+ * signature shares with the signature of the previous record, the length of the rest of the signature and its
+ * characters, the number of words, and the size in bytes of the words, which follow. Each word is stored as the
+ * permutation of the signature that builds it: For each character of the word, the index of the character among the
+ * distinct characters of the signature that are still unused is stored in as few bits as the number of those
+ * characters requires. The bits of all the words of a record are packed together.
+ *
+ * Every restart_interval records, a record starts a new block, and its signature is stored in full. The offset table
+ * holds the file offset of each block instead of each record, so a lookup binary searches the blocks and then decodes
+ * at most restart_interval records. Compact databases only have the summary section.
+ */
+typedef struct {
+    /** The magic number, ADB_MAGIC without the terminating null character. */
+    char magic[ADB_MAGIC_SIZE];
+    /** The version of the format. */
+    uint32_t version;
+    /** The size of the header in bytes. */
+    uint32_t header_size;
+    /** The number of entries. */
+    uint64_t entry_count;
+    /** The file offset of the offset table. */
+    uint64_t index_offset;
+    /** The file offset of the hash table, or zero if there is no hash table. */
+    uint64_t hash_offset;
+    /** The number of slots of the hash table. It is a power of two. */
+    uint64_t hash_slot_count;
+    /** The file offset of the rack index, or zero if there is no rack index. */
+    uint64_t rack_offset;
+    /** The number of groups of the rack index. */
+    uint64_t rack_group_count;
+    /** The number of records of each block of a compact database, or zero for other versions. */
+    uint64_t restart_interval;
+    /** The file offset of the summary, or zero if there is no summary. */
+    uint64_t summary_offset;
+} AdbHeader;
+
+/**
+ * A slot of the hash table section. The hash table maps the signature hash, as calculated by ss_hash, to the entry
+ * record with open addressing and linear probing, so a lookup usually reads a single slot and a single record.
+ */
+typedef struct {
+    /** The signature hash. */
+    uint64_t hash;
+    /** The file offset of the entry record, or zero if the slot is empty. */
+    uint64_t offset;
+} AdbHashSlot;
+
+/**
+ * A group of the rack index section. The rack index finds the entries whose words can be built from a set of letters.
+ * It holds the letter histogram of each entry signature, grouped by the length and the letter presence mask of the
+ * signature. A group is skipped with a single mask test if it uses a letter that is not available, so the histograms
+ * are only compared for the groups that can match.
+ *
+ * The groups are sorted by length and then by mask, and they are followed by the rack entries of all the groups. Only
+ * the signatures that consist of the letters 'a' to 'z' are indexed.
+ */
+typedef struct {
+    /** The length of the signatures of the group. */
+    uint32_t length;
+    /** The letter presence mask of the signatures of the group, as calculated by ss_histogram_mask. */
+    uint32_t mask;
+    /** The index of the first rack entry of the group. */
+    uint64_t first;
+    /** The number of rack entries of the group. */
+    uint64_t count;
+} AdbRackGroup;
+
+/**
+ * A rack entry of the rack index section.
+ */
+typedef struct {
+    /** The letter histogram of the signature. */
+    SsHistogram histogram;
+    /** The file offset of the entry record. */
+    uint64_t offset;
+} AdbRackEntry;
+
+/**
+ * A rack entry that is being written, with the key by which the rack entries are grouped.
+ */
+typedef struct {
+    /** The length of the signature. */
+    uint32_t length;
+    /** The letter presence mask of the signature. */
+    uint32_t mask;
+    /** The rack entry. */
+    AdbRackEntry entry;
+} AdbRackItem;
+
+/**
+ * The header of the summary section. The summary holds the largest anagram classes and the number of classes of each
+ * size and of each word length, so that these statistics are known without reading every entry.
+ *
+ * The header is followed by the largest classes, sorted by size in descending order, then by the class size buckets,
+ * and then by the word length buckets, both sorted by their key in ascending order.
+ */
+typedef struct {
+    /** The total number of words. */
+    uint64_t word_count;
+    /** The total number of classes, which is the number of entries. */
+    uint64_t class_count;
+    /** The number of the largest classes that are stored. */
+    uint64_t top_count;
+    /** The number of class size buckets. */
+    uint64_t size_count;
+    /** The number of word length buckets. */
+    uint64_t length_count;
+} AdbSummaryHeader;
+
+/**
+ * An anagram class of the summary section.
+ */
+typedef struct {
+    /** The number of words of the class. */
+    uint64_t word_count;
+    /** The length of the words. */
+    uint64_t length;
+    /** The index of the entry of the class. */
+    uint64_t index;
+} AdbSummaryClass;
+
+/**
+ * A bucket of the summary section, which counts the classes with the same size or the same word length.
+ */
+typedef struct {
+    /** The class size or the word length. */
+    uint64_t key;
+    /** The number of classes. */
+    uint64_t class_count;
+    /** The number of words of the classes. */
+    uint64_t word_count;
+} AdbSummaryBucket;
+
+/**
+ * The summary of a database, as stored in its summary section or as calculated from its entries.
+ */
+typedef struct {
+    /** The summary header. */
+    AdbSummaryHeader header;
+    /** The largest classes, sorted by size in descending order. */
+    const AdbSummaryClass *classes;
+    /** The class size buckets, sorted by size. */
+    const AdbSummaryBucket *sizes;
+    /** The word length buckets, sorted by length. */
+    const AdbSummaryBucket *lengths;
+    /** The memory of a calculated summary, or NULL if the summary is stored in the database. */
+    void *memory;
+} AdbSummary;
+
+// The number of the largest classes that the summary section holds
+#define ADB_SUMMARY_TOP 1024
+
+// Writer flag to add a hash table section
+#define ADB_WRITER_HASH 0x1
+// Writer flag to add a rack index section
+#define ADB_WRITER_RACK 0x2
+// Writer flag to write the compact format. Only the summary section is written in the compact format.
+#define ADB_WRITER_COMPACT 0x4
+// Writer flag to add a summary section
+#define ADB_WRITER_SUMMARY 0x8
+// The number of records of each block of the compact format
+#define ADB_RESTART_INTERVAL 16
+
+// The infix of the file names of the delta segments, which are named after the base database as PATH.delta.N
+#define ADB_DELTA_INFIX ".delta."
+// The maximum number of delta segments
+#define ADB_MAX_DELTAS 1024
+// The suffix of the lock file of the segments
+#define ADB_LOCK_SUFFIX ".lock"
+// The suffix of the Bloom filter file of a segment, which is named after the segment as PATH.bloom
+#define ADB_BLOOM_SUFFIX ".bloom"
+// The magic number at the start of a Bloom filter file
+#define ADB_BLOOM_MAGIC "PPADBBLM"
+
+/**
+ * The identity of a database file, by which a Bloom filter file is matched with the file that it was built for. Files
+ * are replaced by renaming a new file over them, so a replaced file has a new inode.
+ */
+typedef struct {
+    /** The size of the file. */
+    uint64_t size;
+    /** The inode of the file. */
+    uint64_t inode;
+    /** The modification time of the file, in nanoseconds since the epoch. */
+    int64_t mtime;
+} AdbFileId;
+
+/**
+ * The header of the Bloom filter file of a database segment. All the integers are stored in the native byte order.
+ *
+ * The filter holds the signature hashes of the entries of the segment, as calculated by ss_hash, so most lookups of a
+ * signature that is not in the segment are rejected by a single block of the filter, without reading the segment. The
+ * header is followed by the blocks, at header_size, which is a multiple of the block size, so the blocks are aligned to
+ * cache lines when the file is memory mapped. A filter whose segment file does not match the identity in its header is
+ * stale, and it is ignored.
+ */
+typedef struct {
+    /** The magic number, ADB_BLOOM_MAGIC without the terminating null character. */
+    char magic[ADB_MAGIC_SIZE];
+    /** The size of the header in bytes. */
+    uint32_t header_size;
+    /** The number of bits that are set for each signature. */
+    uint32_t hash_count;
+    /** The number of blocks. */
+    uint64_t block_count;
+    /** The false positive rate that the filter was sized for. */
+    double false_positive_rate;
+    /** The identity of the segment file. */
+    AdbFileId segment;
+} AdbBloomHeader;
+
+/**
+ * An anagram database entry. It holds the words that have the same signature.
+ *
+ * An entry must be zero initialized before it is read for the first time, and freed with adb_entry_free after it is
+ * read for the last time, because the entries of compact databases are decoded to a buffer that the entry owns.
+ */
+typedef struct {
+    /** The length of the signature and of each word. */
+    size_t length;
+    /** The signature. */
+    const char *signature;
+    /** The number of words. */
+    size_t word_count;
+    /** The words. Each word is null terminated, and the words are stored length + 1 characters apart. */
+    const char *words;
+    /** The buffer where the entries of compact databases are decoded to. It is reused by the next read of the entry. */
+    char *buffer;
+    /** The size of the buffer. */
+    size_t buffer_size;
+} AdbEntry;
+
+/**
+ * An open anagram database. Databases of the current version are memory mapped and are searched in place, legacy
+ * databases are loaded in memory.
+ */
+typedef struct {
+    /** The version of the database format. */
+    uint32_t version;
+    /** The number of entries. */
+    size_t entry_count;
+    /** The memory mapped file, or NULL for a legacy database. */
+    const char *map;
+    /** The size of the memory mapped file. */
+    size_t map_size;
+    /** The offset table of the memory mapped file. */
+    const uint64_t *index;
+    /** The hash table of the memory mapped file, or NULL if it has no hash table. */
+    const AdbHashSlot *hash_slots;
+    /** The number of slots of the hash table. */
+    size_t hash_slot_count;
+    /** The groups of the rack index of the memory mapped file, or NULL if it has no rack index. */
+    const AdbRackGroup *rack_groups;
+    /** The number of groups of the rack index. */
+    size_t rack_group_count;
+    /** The rack entries of the rack index. */
+    const AdbRackEntry *rack_entries;
+    /** The number of rack entries that fit in the file, which bounds the rack entries of the groups. */
+    size_t rack_entry_count;
+    /** The number of records of each block of a compact database. */
+    size_t restart_interval;
+    /** The number of blocks of a compact database. */
+    size_t block_count;
+    /** The summary of the memory mapped file, or NULL if it has no summary. */
+    const AdbSummaryHeader *summary;
+    /** The entries of a legacy database, sorted by signature. */
+    AdbEntry *entries;
+    /** The arena that holds the data of a legacy database. */
+    Arena arena;
+    /** The identity of the database file. */
+    AdbFileId file_id;
+    /** The Bloom filter of the memory mapped filter file, whose blocks are NULL if there is no valid filter file. */
+    BloomFilter bloom;
+    /** The false positive rate of the Bloom filter. */
+    double bloom_rate;
+    /** The memory mapped filter file, or NULL if there is no valid filter file. */
+    const char *bloom_map;
+    /** The size of the memory mapped filter file. */
+    size_t bloom_map_size;
+} AnagramDb;
+
+/**
+ * A set of database segments: a base database, and the delta segments that were appended to it. The entries of all the
+ * segments are merged when they are searched.
+ */
+typedef struct {
+    /** The segments. The first one is the base database, if it exists, followed by the delta segments in order. */
+    AnagramDb *segments;
+    /** The number of segments. */
+    size_t segment_count;
+    /** The number of delta segments. */
+    size_t delta_count;
+    /** true if the base database exists. */
+    bool has_base;
+} AdbSegmentSet;
+
+/**
+ * A callback that receives the words of an entry.
+ *
+ * @param word The word. It is null terminated.
+ * @param length The length of the word.
+ * @param context The context that was passed with the callback.
+ * @return true to continue with the next word, false to stop.
+ */
+typedef bool (*AdbWordCallback)(const char *word, size_t length, void *context);
+
+/**
+ * A callback that receives database entries.
+ *
+ * @param entry The entry.
+ * @param context The context that was passed with the callback.
+ * @return true to continue with the next entry, false to stop.
+ */
+typedef bool (*AdbEntryCallback)(const AdbEntry *entry, void *context);
+
+/**
+ * A writer of anagram database files. The entries are written to a temporary file, which replaces the output file
+ * atomically when the writer is closed.
+ */
+typedef struct {
+    /** The temporary file. */
+    FILE *file;
+    /** The path of the output file. */
+    char *path;
+    /** The path of the temporary file. */
+    char *temp_path;
+    /** The current position in the file. */
+    uint64_t position;
+    /** The writer flags. */
+    uint32_t flags;
+    /** The file offsets of the entries. */
+    uint64_t *offsets;
+    /** The signature hashes of the entries, if a hash table is written. */
+    uint64_t *hashes;
+    /** The rack entries, if a rack index is written. */
+    AdbRackItem *rack_items;
+    /** The number of rack entries. */
+    size_t rack_item_count;
+    /** The capacity of the rack entries array. */
+    size_t rack_capacity;
+    /** The signature of the current entry, which the signature of the next entry is front coded against. */
+    char *signature;
+    /** The capacity of the signature buffer. */
+    size_t signature_capacity;
+    /** The packed words of the current entry of a compact database. */
+    uint8_t *word_bits;
+    /** The number of bits of the packed words. */
+    size_t word_bit_count;
+    /** The capacity of the packed words buffer in bytes. */
+    size_t word_bits_capacity;
+    /** The classes of the entries, if a summary is written. */
+    AdbSummaryClass *classes;
+    /** The number of entries. */
+    size_t entry_count;
+    /** The capacity of the offsets array. */
+    size_t capacity;
+    /** The number of words that remain to be written for the current entry. */
+    size_t pending_words;
+    /** The length of the words of the current entry. */
+    size_t length;
+    /** false if a write has failed. */
+    bool ok;
+} AdbWriter;
+
+/**
+ * Open an anagram database. Its Bloom filter file is mapped as well if it exists and matches the database, so that the
+ * lookups of the signatures that are not in the database are rejected without searching it.
+ *
+ * @param db Pointer to the database data structure.
+ * @param path The path of the database file.
+ * @return true if the database was opened successfully, false otherwise.
+ */
+bool adb_open(AnagramDb *db, const char *path);
+
+/**
+ * Close an anagram database, and free the resources associated with it.
+ *
+ * @param db Pointer to the database data structure.
+ */
+void adb_close(AnagramDb *db);
+
+/**
+ * Get an entry of the database.
+ *
+ * @param db Pointer to the database data structure.
+ * @param index The index of the entry. The entries are sorted by signature.
+ * @param entry Pointer to where the entry will be written to.
+ * @return true if the entry was read successfully, false if the index is out of range or the entry is corrupt.
+ */
+bool adb_entry(const AnagramDb *db, size_t index, AdbEntry *entry);
+
+/**
+ * Free the buffer of an entry.
+ *
+ * @param entry Pointer to the entry.
+ */
+void adb_entry_free(AdbEntry *entry);
+
+/**
+ * Search the database for a signature. The Bloom filter is tested first if the database has one, then the hash table
+ * is used if the database has one, otherwise the offset table is binary searched.
+ *
+ * @param db Pointer to the database data structure.
+ * @param signature The signature to search for.
+ * @param length The length of the signature.
+ * @param entry Pointer to where the matching entry will be written to.
+ * @return true if the signature was found, false otherwise.
+ */
+bool adb_lookup(const AnagramDb *db, const char *signature, size_t length, AdbEntry *entry);
+
+/**
+ * Search the database for the entries whose words can be built from a set of letters, and pass them to a callback. The
+ * rack index is used if the database has one, otherwise the histogram of each entry is calculated and compared.
+ *
+ * @param db Pointer to the database data structure.
+ * @param rack The letter histogram of the set of letters.
+ * @param length The number of letters.
+ * @param callback The callback that receives the entries.
+ * @param context The context that is passed to the callback.
+ * @return false if the callback stopped the search or the database is corrupt, true otherwise.
+ */
+bool adb_rack_search(const AnagramDb *db, const SsHistogram *rack, size_t length, AdbEntryCallback callback,
+                     void *context);
+
+/**
+ * Get the summary of the database. It is read from the summary section if the database has one that holds at least
+ * the requested number of largest classes, otherwise it is calculated from all the entries.
+ *
+ * @param db Pointer to the database data structure.
+ * @param top The number of largest classes that are needed.
+ * @param summary Pointer to where the summary will be written to. It must be freed with adb_summary_free.
+ * @return true if the summary was read successfully, false otherwise.
+ */
+bool adb_summary(const AnagramDb *db, size_t top, AdbSummary *summary);
+
+/**
+ * Free the memory of a summary.
+ *
+ * @param summary Pointer to the summary.
+ */
+void adb_summary_free(AdbSummary *summary);
+
+/**
+ * Get a word of a database entry.
+ *
+ * @param entry Pointer to the database entry.
+ * @param index The index of the word.
+ * @return The word.
+ */
+const char *adb_word(const AdbEntry *entry, size_t index);
+
+/**
+ * Compare a signature with the signature of a database entry, in the order in which the entries are sorted.
+ *
+ * @param signature The signature.
+ * @param length The length of the signature.
+ * @param entry The database entry.
+ * @return A negative value if the signature is less than the entry signature, a positive value if it is greater, or 0
+ * if the two signatures are equal.
+ */
+int adb_compare(const char *signature, size_t length, const AdbEntry *entry);
+
+/**
+ * Open a writer for an anagram database file.
+ *
+ * @param writer Pointer to the writer data structure.
+ * @param path The path of the database file.
+ * @param flags The optional sections to write, as a combination of the ADB_WRITER flags.
+ * @return true if the writer was opened successfully, false otherwise.
+ */
+bool adb_writer_open(AdbWriter *writer, const char *path, uint32_t flags);
+
+/**
+ * Start a new entry. The entries must be added in ascending signature order, as defined by adb_compare, and the words
+ * of the entry must be added with adb_writer_add_word before the next entry is added.
+ *
+ * @param writer Pointer to the writer data structure.
+ * @param signature The signature of the entry.
+ * @param length The length of the signature.
+ * @param word_count The number of words of the entry.
+ * @return true if the entry was written successfully, false otherwise.
+ */
+bool adb_writer_add_entry(AdbWriter *writer, const char *signature, size_t length, size_t word_count);
+
+/**
+ * Add a word to the current entry.
+ *
+ * @param writer Pointer to the writer data structure.
+ * @param word The word. Its length must be the length of the entry signature.
+ * @return true if the word was written successfully, false otherwise.
+ */
+bool adb_writer_add_word(AdbWriter *writer, const char *word);
+
+/**
+ * Finish the database file and close the writer. The output file is only replaced if all the writes were successful.
+ *
+ * @param writer Pointer to the writer data structure.
+ * @return true if the database was written successfully, false otherwise.
+ */
+bool adb_writer_close(AdbWriter *writer);
+
+/**
+ * Write the Bloom filter file of a database segment, from the signatures of its entries. The filter file is replaced
+ * atomically, and it is matched with the current segment file, so it must be written after the segment.
+ *
+ * @param path The path of the segment file.
+ * @param false_positive_rate The false positive rate of the filter, between 0 and 1 exclusive.
+ * @return true if the filter file was written successfully, false otherwise.
+ */
+bool adb_write_bloom(const char *path, double false_positive_rate);
+
+/**
+ * Get the path of the Bloom filter file of a segment.
+ *
+ * @param path The path of the segment file.
+ * @return The path of the filter file, which the caller must free, or NULL if the memory could not be allocated.
+ */
+char *adb_bloom_path(const char *path);
+
+/**
+ * Check the Bloom filter files of a base database and its delta segments for the signature of a word, without opening
+ * the segments. A single block of each filter is read.
+ *
+ * @param path The path of the base database.
+ * @param word The word, or its signature, as the signature hash does not depend on the order of the characters.
+ * @param length The length of the word.
+ * @return false if every segment has a filter that rejects the signature, so no segment has it, true otherwise.
+ */
+bool adb_bloom_may_contain(const char *path, const char *word, size_t length);
+
+/**
+ * Get the path of a database segment.
+ *
+ * @param path The path of the base database.
+ * @param delta The number of the delta segment, starting from 1, or 0 for the base database.
+ * @return The path of the segment, which the caller must free, or NULL if the memory could not be allocated.
+ */
+char *adb_segment_path(const char *path, size_t delta);
+
+/**
+ * Open a base database and all its delta segments. The base database does not need to exist if there are delta
+ * segments.
+ *
+ * @param set Pointer to the segment set data structure.
+ * @param path The path of the base database.
+ * @return true if the segments were opened successfully, false otherwise.
+ */
+bool adb_set_open(AdbSegmentSet *set, const char *path);
+
+/**
+ * Close all the segments of a segment set.
+ *
+ * @param set Pointer to the segment set data structure.
+ */
+void adb_set_close(AdbSegmentSet *set);
+
+/**
+ * Search all the segments for a signature, and pass the words of the matching entries to a callback. The words are
+ * merged in ascending order and each distinct word is passed once.
+ *
+ * @param set Pointer to the segment set data structure.
+ * @param signature The signature to search for.
+ * @param length The length of the signature.
+ * @param callback The callback that receives the words.
+ * @param context The context that is passed to the callback.
+ * @return true if the signature was found in any segment, false otherwise.
+ */
+bool adb_set_lookup(const AdbSegmentSet *set, const char *signature, size_t length, AdbWordCallback callback,
+                    void *context);
+
+/**
+ * Search all the segments for the words that can be built from a set of letters, and pass them to a callback. The
+ * words are passed from the longest to the shortest, the words with the same signature are merged in ascending order,
+ * and each distinct word is passed once.
+ *
+ * @param set Pointer to the segment set data structure.
+ * @param letters The set of letters. It must consist of the letters 'a' to 'z'.
+ * @param length The number of letters.
+ * @param callback The callback that receives the words.
+ * @param context The context that is passed to the callback.
+ * @return true if the search was successful, false if the letters are invalid or the memory could not be allocated.
+ */
+bool adb_set_rack_search(const AdbSegmentSet *set, const char *letters, size_t length, AdbWordCallback callback,
+                         void *context);
+
+/**
+ * Merge entries with the same signature, and pass each distinct word to a callback in ascending order. The words of
+ * each entry must be sorted.
+ *
+ * @param entries The entries.
+ * @param entry_count The number of entries.
+ * @param callback The callback that receives the words.
+ * @param context The context that is passed to the callback.
+ * @return false if the callback stopped the merge, true otherwise.
+ */
+bool adb_merge_words(const AdbEntry *entries, size_t entry_count, AdbWordCallback callback, void *context);
+
+/**
+ * Take an exclusive lock on the segments of a database, so that delta segments are not appended while the segments are
+ * compacted. The lock is held on the file PATH.lock, and it is released when the process exits.
+ *
+ * @param path The path of the base database.
+ * @return The file descriptor of the lock file, or -1 if the lock could not be taken.
+ */
+int adb_lock_segments(const char *path);
+
+/**
+ * Release the lock on the segments of a database.
+ *
+ * @param lock_fd The file descriptor of the lock file.
+ */
+void adb_unlock_segments(int lock_fd);
+
+/**
+ * An anagram database handle of the embeddable API: a database with its delta segments. Lookups do not modify the
+ * handle, so an open handle can be shared by threads.
+ */
+typedef struct {
+    /** The database segments. */
+    AdbSegmentSet set;
+} PpAnagramDb;
+
+/**
+ * Open an anagram database and its delta segments.
+ *
+ * @param db Pointer to the handle data structure.
+ * @param path The path of the database.
+ * @return PP_OK if the database was opened successfully, an error otherwise.
+ */
+PpStatus pp_anagram_db_open(PpAnagramDb *db, const char *path);
+
+/**
+ * Look up the anagrams of a word, other than the word itself. The anagrams are written to a caller provided buffer in
+ * ascending order, each one null terminated.
+ *
+ * @param db The handle.
+ * @param word The word.
+ * @param length The length of the word.
+ * @param buffer The buffer.
+ * @param capacity The size of the buffer.
+ * @param count Pointer to where the number of anagrams will be written to, or NULL.
+ * @param size Pointer to where the size of the anagrams will be written to, or NULL. If the buffer is too small, it is
+ * the size that the buffer must have.
+ * @return PP_OK if the anagrams were written to the buffer, PP_ERROR_BUFFER if the buffer is too small or
+ * PP_ERROR_MEMORY if the memory could not be allocated.
+ */
+PpStatus pp_anagram_db_lookup(const PpAnagramDb *db, const char *word, size_t length, char *buffer, size_t capacity,
+                              size_t *count, size_t *size);
+
+/**
+ * Close an anagram database and its delta segments.
+ *
+ * @param db Pointer to the handle data structure.
+ */
+void pp_anagram_db_close(PpAnagramDb *db);
+
+#endif // ANAGRAMDB_H
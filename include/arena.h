@@ -0,0 +1,80 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * A chunk of memory from which the arena allocates.
+ */
+typedef struct ArenaChunk {
+    /** The previously allocated chunk. */
+    struct ArenaChunk *next;
+    /** The number of bytes that the chunk can hold. */
+    size_t size;
+    /** The number of bytes of the chunk that are allocated. */
+    size_t used;
+    /** The chunk storage. */
+    max_align_t data[];
+} ArenaChunk;
+
+/**
+ * The arena structure. Memory is allocated by bumping a pointer in the current chunk, and it is only freed all at once,
+ * when the arena is destroyed.
+ */
+typedef struct {
+    /** The current chunk, or NULL if no memory has been allocated yet. */
+    ArenaChunk *head;
+    /** The size of the next chunk to allocate. */
+    size_t chunk_size;
+    /** The number of chunks that have been allocated. */
+    size_t chunk_count;
+    /** The total number of bytes that have been allocated from the chunks. */
+    size_t allocated;
+} Arena;
+
+/**
+ * Initialize the arena.
+ *
+ * @param arena Pointer to the arena data structure.
+ * @param chunk_size The size of the first chunk. Each subsequent chunk is double the size of the previous one, up to a
+ * limit. If it is zero, a default size is used.
+ */
+void arena_init(Arena *arena, size_t chunk_size);
+
+/**
+ * Free all the memory allocated from the arena.
+ *
+ * @param arena Pointer to the arena data structure.
+ */
+void arena_destroy(Arena *arena);
+
+/**
+ * Allocate memory from the arena. The memory is suitably aligned for any type.
+ *
+ * @param arena Pointer to the arena data structure.
+ * @param size The number of bytes to allocate.
+ * @return Pointer to the allocated memory, or NULL if the memory could not be allocated.
+ */
+void *arena_alloc(Arena *arena, size_t size);
+
+/**
+ * Allocate memory from the arena without any alignment. It is meant for character data.
+ *
+ * @param arena Pointer to the arena data structure.
+ * @param size The number of bytes to allocate.
+ * @return Pointer to the allocated memory, or NULL if the memory could not be allocated.
+ */
+char *arena_alloc_chars(Arena *arena, size_t size);
+
+/**
+ * Copy at most length characters of a string to memory allocated from the arena. The copy is always null terminated.
+ *
+ * @param arena Pointer to the arena data structure.
+ * @param string The string to copy.
+ * @param length The maximum number of characters to copy.
+ * @return Pointer to the copy, or NULL if the memory could not be allocated.
+ */
+char *arena_strndup(Arena *arena, const char *string, size_t length);
+
+#endif // ARENA_H
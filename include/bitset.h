@@ -78,4 +78,58 @@ bool bs_toggle(BitSet *bs, size_t n);
 */
 bool bs_reset(BitSet *bs);
 
+/**
+* Keep only the bits that are also set in another bit set, a whole unit at a time.
+*
+* @param bs Pointer to the bit set data structure.
+* @param other Pointer to the other bit set, which must hold the same number of bits.
+* @return true if the bit sets were combined successfully, false otherwise.
+*/
+bool bs_and(BitSet *bs, const BitSet *other);
+
+/**
+* Set the bits that are set in another bit set, a whole unit at a time.
+*
+* @param bs Pointer to the bit set data structure.
+* @param other Pointer to the other bit set, which must hold the same number of bits.
+* @return true if the bit sets were combined successfully, false otherwise.
+*/
+bool bs_or(BitSet *bs, const BitSet *other);
+
+/**
+* Clear the bits that are set in another bit set, a whole unit at a time.
+*
+* @param bs Pointer to the bit set data structure.
+* @param other Pointer to the other bit set, which must hold the same number of bits.
+* @return true if the bit sets were combined successfully, false otherwise.
+*/
+bool bs_andnot(BitSet *bs, const BitSet *other);
+
+/**
+* Count the bits that are set.
+*
+* @param bs Pointer to the bit set data structure.
+* @return The number of bits that are set.
+*/
+size_t bs_count(const BitSet *bs);
+
+/**
+* Write a snapshot of the bit set to a file. The snapshot is copied to a shared memory mapping of a temporary file,
+* which is synced to the disk before it replaces the file, so the file always holds a complete snapshot.
+*
+* @param bs Pointer to the bit set data structure.
+* @param path The path of the snapshot file.
+* @return true if the snapshot was written successfully, false otherwise.
+*/
+bool bs_save(const BitSet *bs, const char *path);
+
+/**
+* Read a snapshot of a bit set, which must hold the same number of bits, from a memory mapping of its file.
+*
+* @param bs Pointer to the bit set data structure.
+* @param path The path of the snapshot file.
+* @return true if the snapshot was read successfully, false if it cannot be read or holds a different number of bits.
+*/
+bool bs_load(BitSet *bs, const char *path);
+
 #endif //BITSET_H
@@ -0,0 +1,96 @@
+#ifndef BITSORT_H
+#define BITSORT_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "bitset.h"
+#include "ppstatus.h"
+
+/**
+ * A bit set sorter of unique 32-bit integers. It holds the integers of a range, and returns them in ascending order.
+ * The range can be moved with pp_bitsort_reset, so that large ranges are sorted in several passes with less memory.
+ * Each sorter is independent, so different sorters can be used by different threads.
+ */
+typedef struct {
+    /** The bit set, with one bit for each integer of the range. */
+    BitSet bs;
+    /** The first integer of the range. */
+    uint32_t min_value;
+    /** The integer after the last one of the range. */
+    uint64_t max_value;
+    /** The number of integers that were added. */
+    size_t count;
+} PpBitsort;
+
+/**
+ * Initialize a sorter.
+ *
+ * @param sorter Pointer to the sorter data structure.
+ * @param min_value The first integer of the range.
+ * @param max_value The integer after the last one of the range. It may be up to 2^32.
+ * @return PP_OK if the sorter was initialized successfully, an error otherwise.
+ */
+PpStatus pp_bitsort_init(PpBitsort *sorter, uint32_t min_value, uint64_t max_value);
+
+/**
+ * Remove all the integers of a sorter, and move it to a new range, which must not be larger than the initial one.
+ *
+ * @param sorter Pointer to the sorter data structure.
+ * @param min_value The first integer of the range.
+ * @param max_value The integer after the last one of the range.
+ * @return PP_OK if the sorter was reset successfully, an error otherwise.
+ */
+PpStatus pp_bitsort_reset(PpBitsort *sorter, uint32_t min_value, uint64_t max_value);
+
+/**
+ * Add an integer to a sorter.
+ *
+ * @param sorter Pointer to the sorter data structure.
+ * @param value The integer.
+ * @return PP_OK if the integer was added, PP_ERROR_RANGE if it is out of the range of the sorter or PP_ERROR_DUPLICATE
+ * if it was already added.
+ */
+PpStatus pp_bitsort_add(PpBitsort *sorter, uint32_t value);
+
+/**
+ * Add integers to a sorter. Adding stops at the first integer that cannot be added.
+ *
+ * @param sorter Pointer to the sorter data structure.
+ * @param values The integers.
+ * @param count The number of integers.
+ * @param added Pointer to where the number of added integers will be written to, or NULL.
+ * @return PP_OK if all the integers were added, otherwise the error of the first integer that could not be added.
+ */
+PpStatus pp_bitsort_add_many(PpBitsort *sorter, const uint32_t *values, size_t count, size_t *added);
+
+/**
+ * Read the integers of a sorter in ascending order into a buffer. Reading continues from a position, so the integers
+ * can be read in chunks of the buffer size.
+ *
+ * @param sorter Pointer to the sorter data structure.
+ * @param position Pointer to the reading position, which must be zero for the first call. It is updated.
+ * @param buffer The buffer.
+ * @param capacity The number of integers that the buffer can hold.
+ * @return The number of integers written to the buffer, or zero when all the integers have been read.
+ */
+size_t pp_bitsort_read(const PpBitsort *sorter, uint64_t *position, uint32_t *buffer, size_t capacity);
+
+/**
+ * Free resources associated with a sorter.
+ *
+ * @param sorter Pointer to the sorter data structure.
+ */
+void pp_bitsort_destroy(PpBitsort *sorter);
+
+/**
+ * Sort an array of unique integers in place with a bit set.
+ *
+ * @param values The integers.
+ * @param count The number of integers.
+ * @param max_value The integer after the largest one.
+ * @return PP_OK if the integers were sorted successfully, an error otherwise. The array is unchanged on error.
+ */
+PpStatus pp_bitsort(uint32_t *values, size_t count, uint64_t max_value);
+
+#endif // BITSORT_H
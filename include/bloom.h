@@ -0,0 +1,78 @@
+#ifndef BLOOM_H
+#define BLOOM_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "bitset.h"
+
+// The number of bits of a block of a Bloom filter, which is the size of a cache line
+#define BF_BLOCK_BITS 512
+// The number of bytes of a block of a Bloom filter
+#define BF_BLOCK_SIZE (BF_BLOCK_BITS / 8)
+// The maximum number of bits that are set for each key
+#define BF_MAX_HASHES 16
+
+/**
+ * A blocked Bloom filter over a bit set. The bit set is split into blocks of the size of a cache line, and all the bits
+ * of a key are set in a single block, which is chosen by the key. A test of a key touches a single cache line, at the
+ * cost of a slightly higher false positive rate than a classic Bloom filter of the same size. The keys are 64-bit
+ * hashes: the high half chooses the block and the low half the bits in it.
+ */
+typedef struct {
+    /** The bits of the blocks. */
+    BitSet bits;
+    /** The number of blocks. */
+    size_t block_count;
+    /** The number of bits that are set for each key. */
+    uint32_t hash_count;
+} BloomFilter;
+
+/**
+ * Initialize a Bloom filter that is sized for a number of keys and a false positive rate.
+ *
+ * @param bf Pointer to the Bloom filter data structure.
+ * @param key_count The number of keys that will be added.
+ * @param false_positive_rate The rate of the tests of absent keys that find them, between 0 and 1 exclusive.
+ * @return true if the filter was initialized successfully, false if the rate is invalid or the memory could not be
+ * allocated.
+ */
+bool bf_init(BloomFilter *bf, size_t key_count, double false_positive_rate);
+
+/**
+ * Free resources associated with a Bloom filter. Filters whose bits are owned by someone else, like the views of
+ * memory mapped files, must not be destroyed.
+ *
+ * @param bf Pointer to the Bloom filter data structure.
+ */
+void bf_destroy(BloomFilter *bf);
+
+/**
+ * Get the block of a Bloom filter that holds the bits of a key. The bits inside the block only depend on the key, so a
+ * single block can be tested as a filter of one block.
+ *
+ * @param block_count The number of blocks of the filter.
+ * @param hash The key.
+ * @return The index of the block.
+ */
+size_t bf_block_index(size_t block_count, uint64_t hash);
+
+/**
+ * Add a key to a Bloom filter.
+ *
+ * @param bf Pointer to the Bloom filter data structure.
+ * @param hash The key.
+ */
+void bf_add(BloomFilter *bf, uint64_t hash);
+
+/**
+ * Test if a key may have been added to a Bloom filter.
+ *
+ * @param bf Pointer to the Bloom filter data structure.
+ * @param hash The key.
+ * @return false if the key was definitely not added, true if it may have been.
+ */
+bool bf_may_contain(const BloomFilter *bf, uint64_t hash);
+
+#endif // BLOOM_H
@@ -0,0 +1,129 @@
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "ppstatus.h"
+
+// The magic number of the state files
+#define PP_CHECKPOINT_MAGIC "PPCKPT01"
+// The size of the magic number
+#define PP_CHECKPOINT_MAGIC_SIZE 8
+// The maximum length of the name of the program of a checkpoint, including the null character
+#define PP_CHECKPOINT_PROGRAM_SIZE 24
+// The number of options and the number of values of the state of a checkpoint
+#define PP_CHECKPOINT_OPTIONS 4
+#define PP_CHECKPOINT_VALUES 4
+// The number of input bytes that are processed between two checkpoints inside a pass
+#define PP_CHECKPOINT_INTERVAL ((uint64_t) 1 << 30)
+
+/**
+ * The identity of an input file, which tells if it was changed since a checkpoint was saved.
+ */
+typedef struct {
+    /** The size of the file. */
+    uint64_t size;
+    /** The inode number of the file. */
+    uint64_t inode;
+    /** The modification time of the file, in nanoseconds. */
+    int64_t mtime;
+} PpFileId;
+
+/**
+ * The state of a multi-pass run, as it is stored in the state file of its checkpoint directory. A pass that was
+ * interrupted is resumed from the input offset, with the output truncated to the output offset.
+ */
+typedef struct {
+    /** The magic number, which is PP_CHECKPOINT_MAGIC. */
+    char magic[PP_CHECKPOINT_MAGIC_SIZE];
+    /** The name of the program, which only resumes its own checkpoints. */
+    char program[PP_CHECKPOINT_PROGRAM_SIZE];
+    /** The identity of the input file. */
+    PpFileId input;
+    /** The options of the run that decide its passes, which must not change between the runs. */
+    uint64_t options[PP_CHECKPOINT_OPTIONS];
+    /** The index of the first unfinished pass. */
+    uint64_t pass;
+    /** The number of bytes of the input of the pass that were processed. */
+    uint64_t input_offset;
+    /** The number of bytes of the output that were written. */
+    uint64_t output_offset;
+    /** The values of the state that are specific to the program. */
+    uint64_t values[PP_CHECKPOINT_VALUES];
+} PpCheckpointState;
+
+/**
+ * A checkpoint directory, which holds the state file of a run and the files that the state refers to.
+ */
+typedef struct {
+    /** The path of the directory. */
+    char *directory;
+    /** The state of the run, which is written by pp_checkpoint_save. */
+    PpCheckpointState state;
+    /** true if the state was loaded from an earlier run. */
+    bool resumed;
+} PpCheckpoint;
+
+/**
+ * Open a checkpoint directory, which is created if it does not exist. If it holds the state of an earlier run, the
+ * state is loaded, so the run can be resumed. Otherwise the state is that of a run that has not started.
+ *
+ * @param checkpoint Pointer to the checkpoint data structure.
+ * @param directory The path of the directory.
+ * @param program The name of the program.
+ * @param input_fd The file descriptor of the input file.
+ * @param options The options of the run that decide its passes.
+ * @param option_count The number of options, up to PP_CHECKPOINT_OPTIONS.
+ * @return PP_OK if the directory was opened successfully, PP_ERROR_CHECKPOINT if its state belongs to another program,
+ * input or options, an error otherwise.
+ */
+PpStatus pp_checkpoint_open(PpCheckpoint *checkpoint, const char *directory, const char *program, int input_fd,
+                            const uint64_t *options, size_t option_count);
+
+/**
+ * Get the path of a file of a checkpoint directory.
+ *
+ * @param checkpoint Pointer to the checkpoint data structure.
+ * @param name The name of the file.
+ * @return The path, which must be freed, or NULL if memory could not be allocated.
+ */
+char *pp_checkpoint_path(const PpCheckpoint *checkpoint, const char *name);
+
+/**
+ * Flush a file and make sure that its data is on the disk, before a state that refers to it is saved. Files that
+ * cannot be synced, like pipes and terminals, are only flushed.
+ *
+ * @param file The file.
+ * @return PP_OK if the file was synced successfully, PP_ERROR_IO otherwise.
+ */
+PpStatus pp_checkpoint_sync(FILE *file);
+
+/**
+ * Save the state of a checkpoint. It is written to a temporary file, which replaces the state file once it is on the
+ * disk, and the directory is synced, so the state and the files that were renamed into the directory before it survive
+ * a crash together.
+ *
+ * @param checkpoint Pointer to the checkpoint data structure.
+ * @return PP_OK if the state was saved successfully, PP_ERROR_IO otherwise.
+ */
+PpStatus pp_checkpoint_save(PpCheckpoint *checkpoint);
+
+/**
+ * Remove the state of a finished run and the directory, if it is empty, and free the resources of a checkpoint. The
+ * files of the program must have been removed.
+ *
+ * @param checkpoint Pointer to the checkpoint data structure.
+ */
+void pp_checkpoint_finish(PpCheckpoint *checkpoint);
+
+/**
+ * Free the resources of a checkpoint, keeping its directory for a later run.
+ *
+ * @param checkpoint Pointer to the checkpoint data structure.
+ */
+void pp_checkpoint_close(PpCheckpoint *checkpoint);
+
+#endif // CHECKPOINT_H
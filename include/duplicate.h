@@ -0,0 +1,65 @@
+#ifndef DUPLICATE_H
+#define DUPLICATE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "ppstatus.h"
+
+// The default memory limit of the bit sets of the histogram method, in bytes
+#define PP_DUPLICATE_MEMORY_LIMIT (64u << 20)
+
+/**
+ * The ways to find a duplicate integer of a file.
+ */
+typedef enum {
+    /**
+     * Count the integers by their high 16 bits in a first pass. If a bucket has more integers than values, a second
+     * pass counts its integers by their low 16 bits. Otherwise the buckets with at least two integers are checked with
+     * a bit set each, as many buckets per pass as the memory limit allows. It uses 512 KiB for the counters.
+     */
+    PP_DUPLICATE_HISTOGRAM,
+    /**
+     * Halve the range of values in each pass, keeping the half that has more integers than values, which must contain
+     * a duplicate. It uses constant memory and up to 32 passes, and falls back to the histogram method if neither half
+     * has more integers than values.
+     */
+    PP_DUPLICATE_SEARCH,
+    /**
+     * Mark the integers in a bit set of the whole 32-bit range in a single pass, which needs 512 MiB. It falls back to
+     * the histogram method if the bit set cannot be allocated.
+     */
+    PP_DUPLICATE_BITSET
+} PpDuplicateMethod;
+
+/**
+ * The work of a search for a duplicate integer, over all its passes.
+ */
+typedef struct {
+    /** The number of passes over the file. */
+    size_t passes;
+    /** The number of bytes that were read. */
+    uint64_t bytes;
+    /** The number of integers that were read. */
+    uint64_t records;
+} PpDuplicateCounts;
+
+/**
+ * Find a duplicate 32-bit integer of a file of integers, one per line. The file is read sequentially, once per pass, so
+ * it must be a regular file if more than one pass is needed. If the file has more integers than the 32-bit range has
+ * values, a duplicate always exists.
+ *
+ * @param input The input file, which is read through its file descriptor, so nothing must have been read from it.
+ * @param method The method to use.
+ * @param memory_limit The memory that the bit sets of the histogram method can use, in bytes.
+ * @param duplicate Pointer to where the duplicate integer will be written to.
+ * @param line Pointer to where the number of the invalid line will be written to on a parse or range error, or NULL.
+ * @param counts Pointer to where the number of passes and the bytes and integers that they read will be written to, or
+ * NULL.
+ * @return PP_OK if a duplicate integer was found, PP_ERROR_NO_DUPLICATE if there is none, or another error.
+ */
+PpStatus pp_duplicate_file(FILE *input, PpDuplicateMethod method, size_t memory_limit, uint32_t *duplicate,
+                           size_t *line, PpDuplicateCounts *counts);
+
+#endif // DUPLICATE_H
@@ -0,0 +1,115 @@
+#ifndef MISSING_H
+#define MISSING_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "bitset.h"
+#include "checkpoint.h"
+#include "ppstatus.h"
+#include "reader.h"
+
+/**
+ * A finder of a missing 32-bit integer, which marks the added integers in a bit set. It uses up to 512 MiB of memory
+ * for the full 32-bit range. Each finder is independent, so different finders can be used by different threads.
+ */
+typedef struct {
+    /** The bit set, with one bit for each integer of the range. */
+    BitSet bs;
+    /** The largest integer of the range, which starts at zero. */
+    uint32_t max_value;
+    /** The number of integers that were added. */
+    uint64_t count;
+} PpMissing;
+
+/**
+ * Initialize a finder.
+ *
+ * @param finder Pointer to the finder data structure.
+ * @param max_value The largest integer of the range, which starts at zero.
+ * @return PP_OK if the finder was initialized successfully, an error otherwise.
+ */
+PpStatus pp_missing_init(PpMissing *finder, uint32_t max_value);
+
+/**
+ * Add an integer to a finder. An integer may be added more than once.
+ *
+ * @param finder Pointer to the finder data structure.
+ * @param value The integer.
+ * @return PP_OK if the integer was added, PP_ERROR_RANGE if it is larger than the largest integer of the range.
+ */
+PpStatus pp_missing_add(PpMissing *finder, uint32_t value);
+
+/**
+ * Add integers to a finder. Adding stops at the first integer that is out of the range.
+ *
+ * @param finder Pointer to the finder data structure.
+ * @param values The integers.
+ * @param count The number of integers.
+ * @return PP_OK if all the integers were added, PP_ERROR_RANGE otherwise.
+ */
+PpStatus pp_missing_add_many(PpMissing *finder, const uint32_t *values, size_t count);
+
+/**
+ * Find the smallest integer of the range that was not added to a finder.
+ *
+ * @param finder Pointer to the finder data structure.
+ * @param missing Pointer to where the missing integer will be written to.
+ * @return PP_OK if a missing integer was found, PP_ERROR_NOT_FOUND if all the integers of the range were added.
+ */
+PpStatus pp_missing_find(const PpMissing *finder, uint32_t *missing);
+
+/**
+ * Free resources associated with a finder.
+ *
+ * @param finder Pointer to the finder data structure.
+ */
+void pp_missing_destroy(PpMissing *finder);
+
+/**
+ * Find a missing 32-bit integer of an array without extra memory. The array is split by each bit in turn, from the
+ * least significant one, and the search continues in the smaller part, which must miss an integer. The array is
+ * reordered.
+ *
+ * @param values The integers.
+ * @param count The number of integers.
+ * @param missing Pointer to where the missing integer will be written to.
+ * @return PP_OK if a missing integer was found, PP_ERROR_NOT_FOUND if there is none because of duplicate integers.
+ */
+PpStatus pp_missing_partition(uint32_t *values, size_t count, uint32_t *missing);
+
+/**
+ * Read the next integer of a file, for the finders that read files. The input files have an integer in each line, and
+ * the temporary files hold the integers in binary.
+ *
+ * @param reader The reader of the file.
+ * @param text true if the file is an input file.
+ * @param line Pointer to the line buffer.
+ * @param line_size Pointer to the size of the line buffer.
+ * @param number Pointer to where the integer will be written to.
+ * @param end Pointer to where true will be written to at the end of the file.
+ * @return PP_OK if an integer was read or the end of the file was reached, PP_ERROR_PARSE if a binary file ends with a
+ * partial integer, an error otherwise.
+ */
+PpStatus pp_read_number(PpReader *reader, bool text, char **line, size_t *line_size, uint32_t *number, bool *end);
+
+/**
+ * Find a missing 32-bit integer of a file of integers, one per line, with little memory. The integers are split by
+ * each bit in turn into temporary files, as pp_missing_partition does in memory. The files are read with asynchronous
+ * readers, so the next part of a file is read while the current one is split.
+ *
+ * With a checkpoint, the files of the splits are kept in its directory instead, and a checkpoint is saved at the end of
+ * each split and every PP_CHECKPOINT_INTERVAL bytes of the file that is split. A resumed search continues with the
+ * split of its checkpoint, from the offset that it had read, and the files that were written since are truncated.
+ *
+ * @param input The input file, which is read through its file descriptor, so nothing must have been read from it.
+ * @param checkpoint Pointer to the checkpoint data structure, or NULL.
+ * @param missing Pointer to where the missing integer will be written to.
+ * @param line Pointer to where the number of the invalid line will be written to on a parse or range error, or NULL.
+ * @return PP_OK if a missing integer was found, an error otherwise.
+ */
+PpStatus pp_missing_file(FILE *input, PpCheckpoint *checkpoint, uint32_t *missing, size_t *line);
+
+#endif // MISSING_H
@@ -0,0 +1,161 @@
+#ifndef POOL_H
+#define POOL_H
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "ppstatus.h"
+
+// The maximum number of workers of a pool
+#define PP_POOL_MAX_WORKERS 256
+
+/**
+ * A task of a pool. Tasks are allocated by the code that spawns them, usually on its stack, and they must stay valid
+ * until the join that they belong to is complete.
+ */
+typedef struct PpTask {
+    /** The function that runs the task. */
+    void (*run)(struct PpTask *task);
+    /** The number of unfinished tasks of the join that the task belongs to, which is decremented when it is done. */
+    atomic_size_t *pending;
+} PpTask;
+
+/**
+ * The double-ended queue of the tasks of a worker. The worker pushes and pops its own tasks at the bottom, so it runs
+ * the most recently spawned, smallest and cache warm ones first, and other workers steal from the top, where the
+ * oldest and largest tasks are.
+ */
+typedef struct {
+    /** The lock of the queue. */
+    pthread_mutex_t lock;
+    /** The tasks, in a ring buffer. */
+    PpTask **tasks;
+    /** The number of tasks that the ring buffer can hold. */
+    size_t capacity;
+    /** The index of the top task. */
+    size_t top;
+    /** The number of tasks. */
+    size_t count;
+} PpDeque;
+
+struct PpPool;
+
+/**
+ * A worker of a pool. Worker 0 is not a thread of the pool, but the threads that call the pool functions.
+ */
+typedef struct {
+    /** The pool of the worker. */
+    struct PpPool *pool;
+    /** The index of the worker. */
+    size_t index;
+    /** The thread of the worker. */
+    pthread_t thread;
+    /** The queue of the tasks that the worker spawned. */
+    PpDeque deque;
+    /** The state of the generator of the victims to steal from. */
+    size_t victim_state;
+} PpWorker;
+
+/**
+ * A pool of worker threads that run fork-join tasks with work stealing. Each worker pushes the tasks that it spawns on
+ * its own queue, and an idle worker steals from the queues of the others, so the load is balanced without a central
+ * queue. A thread that waits for a join keeps running tasks instead of blocking, so joins can be nested. The pool
+ * functions can be called from any thread, and they run their own share of the work in that thread.
+ */
+typedef struct PpPool {
+    /** The workers, with worker 0 for the calling threads. */
+    PpWorker *workers;
+    /** The number of workers, including worker 0. */
+    size_t worker_count;
+    /** The number of worker threads that were started. */
+    size_t started;
+    /** The number of tasks in all the queues. */
+    atomic_size_t queued;
+    /** The number of worker threads that are waiting for tasks. */
+    atomic_size_t sleeping;
+    /** true when the worker threads must exit. */
+    atomic_bool stop;
+    /** The lock of the sleeping workers. */
+    pthread_mutex_t lock;
+    /** The condition that the sleeping workers wait on. */
+    pthread_cond_t wake;
+} PpPool;
+
+/**
+ * A function that processes the range of indexes [first, last) of a parallel loop.
+ *
+ * @param context The context that was passed to pp_parallel_for.
+ * @param first The first index of the range.
+ * @param last The index after the last one of the range.
+ */
+typedef void (*PpRangeFunction)(void *context, size_t first, size_t last);
+
+/**
+ * A function call of a parallel invoke.
+ */
+typedef struct {
+    /** The function. */
+    void (*function)(void *context);
+    /** The context that is passed to the function. */
+    void *context;
+} PpInvoke;
+
+/**
+ * Initialize a pool.
+ *
+ * @param pool Pointer to the pool data structure.
+ * @param workers The number of workers, including the calling thread, so workers - 1 threads are started. It must be
+ * between 1 and PP_POOL_MAX_WORKERS.
+ * @return PP_OK if the pool was initialized successfully, an error otherwise.
+ */
+PpStatus pp_pool_init(PpPool *pool, size_t workers);
+
+/**
+ * Spawn a task, which may be run by any worker. The number of pending tasks of its join must have been incremented.
+ *
+ * @param pool Pointer to the pool data structure.
+ * @param task The task.
+ */
+void pp_pool_spawn(PpPool *pool, PpTask *task);
+
+/**
+ * Wait until the pending tasks of a join are done, running tasks in the meantime.
+ *
+ * @param pool Pointer to the pool data structure.
+ * @param pending Pointer to the number of pending tasks of the join.
+ */
+void pp_pool_join(PpPool *pool, atomic_size_t *pending);
+
+/**
+ * Run a function over the range of indexes [first, last) in parallel. The range is halved recursively, and one half is
+ * spawned while the other is processed, until the ranges have at most grain indexes, so idle workers steal the largest
+ * ranges first. The function returns when the whole range has been processed.
+ *
+ * @param pool Pointer to the pool data structure.
+ * @param first The first index of the range.
+ * @param last The index after the last one of the range.
+ * @param grain The largest number of indexes that a single call of the function processes, or zero for 1.
+ * @param function The function.
+ * @param context The context that is passed to the function.
+ */
+void pp_parallel_for(PpPool *pool, size_t first, size_t last, size_t grain, PpRangeFunction function, void *context);
+
+/**
+ * Call functions in parallel, and wait for all of them to return. The first function is called in the calling thread.
+ *
+ * @param pool Pointer to the pool data structure.
+ * @param calls The function calls.
+ * @param count The number of function calls, which may be zero.
+ */
+void pp_parallel_invoke(PpPool *pool, const PpInvoke *calls, size_t count);
+
+/**
+ * Stop the worker threads of a pool, and free its resources. No task may be pending.
+ *
+ * @param pool Pointer to the pool data structure.
+ */
+void pp_pool_destroy(PpPool *pool);
+
+#endif // POOL_H
@@ -0,0 +1,42 @@
+#ifndef PPSTATUS_H
+#define PPSTATUS_H
+
+/**
+ * The status codes that the pp_* library functions return, instead of printing their errors.
+ */
+typedef enum {
+    /** The operation was successful. */
+    PP_OK = 0,
+    /** Memory could not be allocated. */
+    PP_ERROR_MEMORY,
+    /** A file could not be opened, read or written. */
+    PP_ERROR_IO,
+    /** An input line is not a number. */
+    PP_ERROR_PARSE,
+    /** A number is out of the accepted range. */
+    PP_ERROR_RANGE,
+    /** A number was added more than once. */
+    PP_ERROR_DUPLICATE,
+    /** The input has more numbers than the range can hold. */
+    PP_ERROR_TOO_MANY,
+    /** No missing number exists, as all the numbers of the range are present. */
+    PP_ERROR_NOT_FOUND,
+    /** No number is repeated. */
+    PP_ERROR_NO_DUPLICATE,
+    /** The caller provided buffer is too small. */
+    PP_ERROR_BUFFER,
+    /** An argument is invalid. */
+    PP_ERROR_ARGUMENT,
+    /** A checkpoint belongs to another program, input file or options. */
+    PP_ERROR_CHECKPOINT
+} PpStatus;
+
+/**
+ * Get a description of a status code.
+ *
+ * @param status The status code.
+ * @return The description, which must not be freed.
+ */
+const char *pp_status_message(PpStatus status);
+
+#endif // PPSTATUS_H
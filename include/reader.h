@@ -0,0 +1,175 @@
+#ifndef READER_H
+#define READER_H
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/types.h>
+#include <sys/uio.h>
+
+#include "ppstatus.h"
+
+// The size of each buffer of a reader
+#define PP_READER_BUFFER_SIZE (1 << 20)
+// The number of buffers of a reader, which are filled while the program parses the current one
+#define PP_READER_BUFFER_COUNT 4
+// The alignment of the buffers, which is the page size of most systems
+#define PP_READER_BUFFER_ALIGNMENT 4096
+// The environment variable that selects the backend of the readers that are opened with PP_READER_AUTO
+#define PP_READER_BACKEND_ENV "PP_READER_BACKEND"
+
+/**
+ * The ways a reader fills its buffers.
+ */
+typedef enum {
+    /** Use io_uring for regular files if the kernel supports it, and the read thread otherwise. */
+    PP_READER_AUTO = 0,
+    /** Submit the reads of all the free buffers to an io_uring instance. Only regular files are supported. */
+    PP_READER_IO_URING,
+    /** Fill the buffers one after the other with blocking reads in a background thread. */
+    PP_READER_THREAD,
+    /** Fill the buffers with blocking reads in the calling thread, when they are needed. */
+    PP_READER_SYNC
+} PpReaderBackend;
+
+/**
+ * A buffer of a reader.
+ */
+typedef struct {
+    /** The data, aligned to PP_READER_BUFFER_ALIGNMENT. */
+    char *data;
+    /** The number of bytes of the data that were read. */
+    size_t length;
+    /** The file offset of the data, for the io_uring reads. */
+    uint64_t offset;
+    /** The part of the data that the io_uring read fills. */
+    struct iovec iov;
+    /** true if the buffer is being filled. */
+    bool pending;
+    /** true if the buffer was filled and its data has not been consumed yet. */
+    bool full;
+    /** true if the end of the file was reached while filling the buffer. */
+    bool end;
+    /** The error number of a failed read, or zero. */
+    int error;
+} PpReaderBuffer;
+
+/**
+ * The memory mapped rings of an io_uring instance, which are set up with raw system calls.
+ */
+typedef struct {
+    /** The file descriptor of the instance. */
+    int fd;
+    /** The submission queue ring and its size. */
+    void *sq_ring;
+    size_t sq_ring_size;
+    /** The completion queue ring and its size, which may be the same mapping as the submission queue ring. */
+    void *cq_ring;
+    size_t cq_ring_size;
+    /** The submission queue entries and their size. */
+    void *sqes;
+    size_t sqes_size;
+    /** Pointers to the fields of the submission queue ring. */
+    unsigned *sq_tail;
+    unsigned *sq_mask;
+    unsigned *sq_array;
+    /** Pointers to the fields of the completion queue ring. */
+    unsigned *cq_head;
+    unsigned *cq_tail;
+    unsigned *cq_mask;
+    void *cqes;
+} PpReaderRing;
+
+/**
+ * An asynchronous reader of a file descriptor. It keeps several large buffers in flight, so that the program parses one
+ * buffer while the next ones are read, instead of waiting for each read. The data is consumed in order, by lines with
+ * pp_reader_getline, or by bytes with pp_reader_read. A reader must only be used by one thread.
+ */
+typedef struct {
+    /** The file descriptor, which is not closed by the reader. */
+    int fd;
+    /** The backend that fills the buffers. */
+    PpReaderBackend backend;
+    /** true if the file is a regular file. The buffers of other files are handed over after a single read. */
+    bool regular;
+    /** The buffers, which are consumed in a circular order. */
+    PpReaderBuffer buffers[PP_READER_BUFFER_COUNT];
+    /** The index of the buffer that is being consumed. */
+    size_t current;
+    /** The position in the buffer that is being consumed. */
+    size_t position;
+    /** The file offset of the next read that will be submitted, for the io_uring reads. */
+    uint64_t offset;
+    /** true if a buffer reached the end of the file, so no more reads are submitted. */
+    bool end;
+    /** The status of the reader, which is PP_ERROR_IO after a read failed. */
+    PpStatus status;
+    /** The io_uring instance. */
+    PpReaderRing ring;
+    /** The read thread and its synchronization. */
+    pthread_t thread;
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    /** true if the read thread must stop. */
+    bool stop;
+} PpReader;
+
+/**
+ * Open a reader of a file descriptor. Reading starts at the current offset of the file descriptor, so the file must not
+ * have been read through a stdio stream.
+ *
+ * @param reader Pointer to the reader data structure.
+ * @param fd The file descriptor.
+ * @param backend The backend that fills the buffers. PP_READER_AUTO picks io_uring if it is available and the read
+ * thread otherwise, unless the PP_READER_BACKEND environment variable is set to thread or sync.
+ * @return PP_OK if the reader was opened successfully, an error otherwise, in which case it must not be closed.
+ */
+PpStatus pp_reader_open(PpReader *reader, int fd, PpReaderBackend backend);
+
+/**
+ * Read a line, as getline does. The line contains the new line character, if there is one, and it is terminated by a
+ * null character, so a missing new line character can be added in place of it.
+ *
+ * @param reader Pointer to the reader data structure.
+ * @param line Pointer to the line buffer, which is allocated or extended as needed, and must be freed by the caller.
+ * @param size Pointer to the size of the line buffer.
+ * @return The length of the line, or -1 at the end of the file, on error, or if memory could not be allocated. The
+ * status of the reader tells them apart.
+ */
+ssize_t pp_reader_getline(PpReader *reader, char **line, size_t *size);
+
+/**
+ * Read bytes, as fread does.
+ *
+ * @param reader Pointer to the reader data structure.
+ * @param data Pointer to where the bytes will be written to.
+ * @param size The number of bytes to read.
+ * @return The number of bytes that were read, which is less than the size only at the end of the file or on error.
+ */
+size_t pp_reader_read(PpReader *reader, void *data, size_t size);
+
+/**
+ * Start reading again from the start of the file. The file must be seekable.
+ *
+ * @param reader Pointer to the reader data structure.
+ * @return PP_OK if the reader was rewound successfully, an error otherwise.
+ */
+PpStatus pp_reader_rewind(PpReader *reader);
+
+/**
+ * Stop the reads in flight, and free the resources associated with a reader. The file descriptor is not closed.
+ *
+ * @param reader Pointer to the reader data structure.
+ */
+void pp_reader_close(PpReader *reader);
+
+/**
+ * Get the name of a backend, for the reports of the programs.
+ *
+ * @param backend The backend.
+ * @return The name, which must not be freed.
+ */
+const char *pp_reader_backend_name(PpReaderBackend backend);
+
+#endif // READER_H
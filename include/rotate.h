@@ -0,0 +1,79 @@
+#ifndef ROTATE_H
+#define ROTATE_H
+
+#include <stddef.h>
+
+#include "ppstatus.h"
+
+// The size of the stack buffer of the scratch method, in bytes
+#define PP_ROTATE_SCRATCH_SIZE 4096
+
+/**
+ * The ways to rotate an array. All of them work in place, on elements of any size.
+ */
+typedef enum {
+    /** Choose the method from the sizes of the array, its elements and the shift. */
+    PP_ROTATE_AUTO,
+    /**
+     * Move each element directly to its final position, following the gcd(count, shift) cycles of the rotation. It
+     * moves each element once, but the cycles visit the array with a stride of shift elements, so it stops using the
+     * caches when the array does not fit in them.
+     */
+    PP_ROTATE_JUGGLING,
+    /**
+     * Swap the shorter side with the end of the longer one, which puts it in its final position, and rotate the rest
+     * of the longer side in the same way. The swaps are sequential, and each element is moved about twice.
+     */
+    PP_ROTATE_BLOCK_SWAP,
+    /**
+     * Reverse both sides, and then the whole array. Each element is moved twice in three sequential passes, and the
+     * reversals of elements of 1, 2, 4, 8 and 16 bytes use the widest vector shuffles that the processor supports.
+     */
+    PP_ROTATE_REVERSAL,
+    /**
+     * Copy the shorter side to a stack buffer, move the longer side with memmove, and copy the shorter side back. Each
+     * element is moved once, by the fastest copy of the C library. It falls back to the block-swap method if the
+     * shorter side does not fit in PP_ROTATE_SCRATCH_SIZE bytes.
+     */
+    PP_ROTATE_SCRATCH
+} PpRotateMethod;
+
+/**
+ * Reverse the order of the elements of an array.
+ *
+ * @param base The array.
+ * @param count The number of elements.
+ * @param size The size of each element, in bytes.
+ */
+void pp_reverse(void *base, size_t count, size_t size);
+
+/**
+ * Choose the method that rotates an array the fastest, which is the one that pp_rotate uses for PP_ROTATE_AUTO. The
+ * choice follows the rotation benchmarks, from the L1 cache to the main memory: the scratch method moves each element
+ * once, so it is the fastest whenever the shorter side fits in its buffer. Otherwise the vector reversals are the
+ * fastest, except for sides of the same length, which the block-swap method swaps in a single pass. The elements
+ * without vector reversals are rotated with the block-swap method, whose long swaps are copied with memcpy, as the
+ * juggling method misses the caches.
+ *
+ * @param count The number of elements.
+ * @param size The size of each element, in bytes.
+ * @param shift The number of positions that the elements are rotated left by.
+ * @return The method, which is never PP_ROTATE_AUTO.
+ */
+PpRotateMethod pp_rotate_method(size_t count, size_t size, size_t shift);
+
+/**
+ * Rotate an array left by a number of positions, so that the element at index shift becomes the first one and the
+ * first shift elements are moved to the end, in their order.
+ *
+ * @param base The array.
+ * @param count The number of elements.
+ * @param size The size of each element, in bytes.
+ * @param shift The number of positions that the elements are rotated left by, up to count.
+ * @param method The way to rotate the array.
+ * @return PP_OK if the array was rotated, PP_ERROR_RANGE if the shift is larger than the number of elements,
+ * PP_ERROR_ARGUMENT if the element size is zero or the method is unknown.
+ */
+PpStatus pp_rotate(void *base, size_t count, size_t size, size_t shift, PpRotateMethod method);
+
+#endif // ROTATE_H
@@ -0,0 +1,69 @@
+#ifndef SETOPS_H
+#define SETOPS_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "ppstatus.h"
+
+// The default memory limit of the bit sets, in bytes
+#define PP_SETOPS_MEMORY_LIMIT (256u << 20)
+
+/**
+ * The set operations that combine the integers of files.
+ */
+typedef enum {
+    /** The integers of any of the files. */
+    PP_SET_UNION,
+    /** The integers of all the files. */
+    PP_SET_INTERSECTION,
+    /** The integers of the first file that are in none of the other files. */
+    PP_SET_DIFFERENCE
+} PpSetOperation;
+
+/**
+ * The function that receives the integers of the result of a set operation, in ascending order and in chunks.
+ *
+ * @param context The context that was passed to pp_setops_files.
+ * @param values The integers of the chunk.
+ * @param count The number of integers of the chunk.
+ * @return true to continue, false to stop with PP_ERROR_IO.
+ */
+typedef bool (*PpSetOutput)(void *context, const uint32_t *values, size_t count);
+
+/**
+ * Where a set operation failed, for the errors of an input file.
+ */
+typedef struct {
+    /** The index of the input file. */
+    size_t input;
+    /** The number of the invalid line, or of the integer of a binary file, on a parse or range error. */
+    size_t line;
+} PpSetError;
+
+/**
+ * Combine the 32-bit integers of files with a set operation. The integers of each file are marked in a bit set, and the
+ * bit sets are combined a whole unit at a time. If the bit sets of the whole range do not fit in the memory limit, the
+ * range is split into parts that do, and all the files are read again for each part. The files that cannot be read
+ * again, like pipes, are copied to temporary files in the first pass, which the later passes read instead. The parts
+ * past the largest integer that the result can have are skipped, so small integers need a single pass whatever the
+ * limit is.
+ *
+ * @param inputs The input files, which are read through their file descriptors, so nothing must have been read from
+ * them.
+ * @param input_count The number of input files, which must be positive.
+ * @param binary true if the files hold native 32-bit integers, false if they hold an integer in each line.
+ * @param operation The set operation.
+ * @param memory_limit The memory that the bit sets can use, in bytes.
+ * @param output The function that receives the integers of the result, or NULL to only count them.
+ * @param context The context that is passed to the function.
+ * @param count Pointer to where the number of integers of the result will be written to, or NULL.
+ * @param error Pointer to where the failed input will be written to on an error of an input file, or NULL.
+ * @return PP_OK if the files were combined successfully, an error otherwise.
+ */
+PpStatus pp_setops_files(FILE *const *inputs, size_t input_count, bool binary, PpSetOperation operation,
+                         size_t memory_limit, PpSetOutput output, void *context, uint64_t *count, PpSetError *error);
+
+#endif // SETOPS_H
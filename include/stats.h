@@ -0,0 +1,119 @@
+#ifndef STATS_H
+#define STATS_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// The maximum number of distinct phases of a program
+#define STATS_MAX_PHASES 16
+// The value of the --stats long option, which has no short option
+#define STATS_OPTION 0x100
+// The entry of the --stats option in the long options of getopt_long
+#define STATS_LONG_OPTION {"stats", optional_argument, 0, STATS_OPTION}
+// The usage instructions of the --stats option
+#define STATS_USAGE \
+    "        --stats[=json]      Print the time, the counters and the peak memory of each phase to the\n" \
+    "                                standard error when done, as a table or as JSON.\n"
+
+/**
+ * The hardware counters that are recorded, if the perf_event_open system call is available.
+ */
+typedef enum {
+    STATS_CYCLES,
+    STATS_INSTRUCTIONS,
+    STATS_CACHE_MISSES,
+    STATS_TLB_MISSES,
+    STATS_HW_COUNTER_COUNT
+} StatsHwCounter;
+
+/**
+ * A phase of a program. A phase that is entered more than once accumulates its measurements.
+ */
+typedef struct {
+    /** The name of the phase. */
+    const char *name;
+    /** The time spent in the phase in nanoseconds. */
+    uint64_t elapsed;
+    /** The number of bytes processed in the phase. */
+    uint64_t bytes;
+    /** The number of records processed in the phase. */
+    uint64_t records;
+    /** The hardware counter values of the phase. */
+    uint64_t hw[STATS_HW_COUNTER_COUNT];
+} StatsPhase;
+
+/**
+ * The statistics of the program.
+ */
+typedef struct {
+    /** true if the statistics are enabled. */
+    bool enabled;
+    /** true if the report is written as JSON. */
+    bool json;
+    /** The phases, in the order they were first entered. */
+    StatsPhase phases[STATS_MAX_PHASES];
+    /** The number of phases. */
+    size_t phase_count;
+    /** The current phase, or NULL if no phase has been entered. */
+    StatsPhase *current;
+    /** The time the current phase was entered. */
+    uint64_t phase_start;
+    /** The hardware counter values when the current phase was entered. */
+    uint64_t hw_start[STATS_HW_COUNTER_COUNT];
+    /** The file descriptors of the hardware counters, or -1 for the counters that are not available. */
+    int hw_fds[STATS_HW_COUNTER_COUNT];
+    /** The time the statistics were enabled. */
+    uint64_t start;
+    /** The number of bytes processed since the current phase was entered. */
+    uint64_t bytes;
+    /** The number of records processed since the current phase was entered. */
+    uint64_t records;
+} Stats;
+
+// The statistics of the program
+extern Stats stats;
+
+/**
+ * Enable the statistics from the value of the --stats option, and open the hardware counters.
+ *
+ * @param format The format of the report: NULL for a table, or "json".
+ * @return true if the format is valid, false otherwise.
+ */
+bool stats_enable(const char *format);
+
+/**
+ * Enter a phase, and leave the current one. The name must be a string constant, as it is not copied. Nothing is
+ * recorded if the statistics are disabled.
+ *
+ * @param name The name of the phase.
+ */
+void stats_phase(const char *name);
+
+/**
+ * Write the report of the phases, the total time and the peak resident set size to the standard error, and close the
+ * hardware counters. Nothing is written if the statistics are disabled.
+ */
+void stats_report();
+
+/**
+ * Count bytes processed in the current phase. The counter is updated even if the statistics are disabled, as a single
+ * addition is cheaper than checking the flag. It must only be called from the main thread.
+ *
+ * @param count The number of bytes.
+ */
+static inline void stats_add_bytes(uint64_t count) {
+    stats.bytes += count;
+}
+
+/**
+ * Count records processed in the current phase. The counter is updated even if the statistics are disabled, as a
+ * single addition is cheaper than checking the flag. It must only be called from the main thread.
+ *
+ * @param count The number of records.
+ */
+static inline void stats_add_records(uint64_t count) {
+    stats.records += count;
+}
+
+#endif // STATS_H
@@ -1,7 +1,23 @@
 #ifndef STRINGSIG_H
 #define STRINGSIG_H
 
+#include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
+
+// The number of letters that a letter histogram counts
+#define SS_HISTOGRAM_LETTERS 26
+// The size of the letter histogram, padded so that it can be compared in whole words
+#define SS_HISTOGRAM_SIZE 32
+
+/**
+ * The letter histogram of a string. It counts the occurrences of each of the lowercase letters 'a' to 'z'. Two strings
+ * with equal histograms are anagrams of each other.
+ */
+typedef struct {
+    /** The number of occurrences of each letter. The padding bytes are always zero. */
+    uint8_t counts[SS_HISTOGRAM_SIZE];
+} SsHistogram;
 
 /**
  * Calculate the signature for a string.
@@ -13,4 +29,69 @@
  */
 void ss_calculate(const char *string, size_t length, char *signature);
 
+/**
+ * Calculate the signatures for many strings that are stored in the same buffer.
+ *
+ * @param buffer The buffer that holds the strings.
+ * @param offsets The offset of each string in the buffer.
+ * @param lengths The length of each string.
+ * @param count The number of strings.
+ * @param signatures Pointer to where the signatures will be written to. The signature of each string is written at the
+ * same offset as the string itself in the input buffer, and it is null terminated. The caller is responsible to
+ * allocate a buffer that can hold offsets[i] + lengths[i] + 1 characters for every string i, so when the strings are
+ * separated by a single character, a buffer of the same size as the input buffer is sufficient.
+ */
+void ss_calculate_many(const char *buffer, const size_t *offsets, const size_t *lengths, size_t count,
+                       char *signatures);
+
+/**
+ * Calculate the letter histogram for a string.
+ *
+ * @param string The string to calculate the histogram for.
+ * @param length The length of the input string.
+ * @param histogram Pointer to where the histogram will be written to.
+ * @return true if the histogram was calculated, false if the string contains characters other than 'a' to 'z' or a
+ * letter occurs more than 255 times. In that case the signature must be used instead.
+ */
+bool ss_histogram(const char *string, size_t length, SsHistogram *histogram);
+
+/**
+ * Check if two letter histograms are equal.
+ *
+ * @param p The first histogram.
+ * @param q The second histogram.
+ * @return true if the histograms are equal, false otherwise.
+ */
+bool ss_histogram_equal(const SsHistogram *p, const SsHistogram *q);
+
+/**
+ * Check if a string can be built from the letters of another string, that is if each letter occurs in the second
+ * histogram at most as many times as in the first one.
+ *
+ * @param p The histogram of the available letters.
+ * @param q The histogram of the string to build.
+ * @return true if the letters of q are contained in the letters of p, false otherwise.
+ */
+bool ss_histogram_contains(const SsHistogram *p, const SsHistogram *q);
+
+/**
+ * Calculate the letter presence mask of a letter histogram. Bit i of the mask is set if the letter 'a' + i occurs in
+ * the string. A string can only be built from the letters of another string if its mask is a subset of the other mask.
+ *
+ * @param histogram The letter histogram.
+ * @return The letter presence mask.
+ */
+uint32_t ss_histogram_mask(const SsHistogram *histogram);
+
+/**
+ * Calculate a 64-bit hash of the signature of a string. The hash does not depend on the order of the characters, so it
+ * is the same for a word, its signature and all of its anagrams. Different signatures can have the same hash, so it can
+ * only be used to rule out that two strings are anagrams.
+ *
+ * @param string The string to calculate the hash for.
+ * @param length The length of the input string.
+ * @return The signature hash.
+ */
+uint64_t ss_hash(const char *string, size_t length);
+
 #endif // STRINGSIG_H
@@ -0,0 +1,66 @@
+#ifndef TOPK_H
+#define TOPK_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "ppstatus.h"
+
+/**
+ * A selector of the K smallest or largest 32-bit integers of a stream. It keeps the selected integers in a binary heap
+ * of K elements, whose root is the threshold that a new integer must beat, so the memory is O(K) however long the
+ * stream is, and most integers of a long stream are rejected with a single comparison. Each selector is independent, so
+ * different selectors can be used by different threads.
+ */
+typedef struct {
+    /**
+     * The heap of the selected integers. The root is the largest one when the smallest are selected, and vice versa.
+     */
+    uint32_t *heap;
+    /** The number of integers to select. */
+    size_t k;
+    /** The number of integers in the heap. */
+    size_t count;
+    /** true if the largest integers are selected, false if the smallest are. */
+    bool largest;
+    /** The number of integers that were added. */
+    uint64_t added;
+} PpTopK;
+
+/**
+ * Initialize a selector.
+ *
+ * @param selector Pointer to the selector data structure.
+ * @param k The number of integers to select, which must be positive.
+ * @param largest true to select the largest integers, false to select the smallest.
+ * @return PP_OK if the selector was initialized successfully, an error otherwise.
+ */
+PpStatus pp_topk_init(PpTopK *selector, size_t k, bool largest);
+
+/**
+ * Add an integer to a selector. It is kept if it is one of the K smallest or largest integers that were added so far.
+ *
+ * @param selector Pointer to the selector data structure.
+ * @param value The integer.
+ */
+void pp_topk_add(PpTopK *selector, uint32_t value);
+
+/**
+ * Sort the selected integers in ascending order, and get them. The selector must not be added to afterwards.
+ *
+ * @param selector Pointer to the selector data structure.
+ * @param count Pointer to where the number of selected integers will be written to, which is less than K if fewer
+ * integers were added.
+ * @return The selected integers, which are owned by the selector.
+ */
+const uint32_t *pp_topk_sorted(PpTopK *selector, size_t *count);
+
+/**
+ * Free resources associated with a selector.
+ *
+ * @param selector Pointer to the selector data structure.
+ */
+void pp_topk_destroy(PpTopK *selector);
+
+#endif // TOPK_H
@@ -4,6 +4,13 @@
  * minimize the memory usage, n number of passes of the input file can be performed. As the program needs to read the
  * input multiple times, the standard input cannot be used. An input file must be provided as a command line argument.
  *
+ * The sorting is done by the pp_bitsort functions of the library, and this program only parses and prints the text.
+ *
+ * With --checkpoint, the progress is recorded in a directory: at the end of each pass, after the input of each pass is
+ * read, and every PP_CHECKPOINT_INTERVAL bytes of input, with a snapshot of the bit set. An interrupted run that is
+ * started again with the same directory resumes at the first unfinished pass, from the input offset of its last
+ * checkpoint, and truncates the output file to the output of the finished passes.
+ *
  * This program is a solution for problems 3 and 5.
  */
 #include <math.h>
@@ -12,8 +19,13 @@
 #include <stdlib.h>
 
 #include <getopt.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
-#include "bitset.h"
+#include "bitsort.h"
+#include "checkpoint.h"
+#include "reader.h"
+#include "stats.h"
 
 // The maximum number of elements that the program can handle.
 static uint32_t max_elements = UINT32_MAX;
@@ -25,6 +37,22 @@ static size_t passes = 1;
 static bool help_flag = false;
 // The file to open
 static char *input = NULL;
+// The checkpoint directory, or NULL if the run is not checkpointed
+static char *checkpoint_directory = NULL;
+
+// The number of sorted integers that are printed at once
+#define OUTPUT_CHUNK_SIZE 4096
+// The names of the two snapshots of the bit set in the checkpoint directory, which are written in turns, so the one
+// that the saved state refers to is never replaced
+static const char *checkpoint_bits[] = {"bits.0", "bits.1"};
+// The phases of a pass, which the checkpoints record: reading the input, and writing the integers of the pass
+#define PHASE_READ 0
+#define PHASE_WRITE 1
+// The indexes of the phase, of the number of integers of the pass and of the snapshot of the bit set in the values of
+// a checkpoint
+#define VALUE_PHASE 0
+#define VALUE_COUNT 1
+#define VALUE_BITS 2
 
 /**
  * Parse the command line arguments.
@@ -38,7 +66,9 @@ bool parse_arguments(int argc, char *argv[]) {
         {"count", optional_argument, 0, 'c'},
         {"max-value", optional_argument, 0, 'm'},
         {"passes", optional_argument, 0, 'p'},
+        {"checkpoint", required_argument, 0, 'k'},
         {"help", no_argument, 0, 'h'},
+        STATS_LONG_OPTION,
         {0, 0, 0, 0}
     };
 
@@ -47,7 +77,7 @@ bool parse_arguments(int argc, char *argv[]) {
     char *end_ptr = NULL;
     int option_index = 0;
     while (true) {
-        c = getopt_long(argc, argv, "hc:m:p:", long_options, &option_index);
+        c = getopt_long(argc, argv, "hc:m:p:k:", long_options, &option_index);
         if (c == -1) {
             break;
         }
@@ -73,6 +103,14 @@ bool parse_arguments(int argc, char *argv[]) {
                     return false;
                 }
                 break;
+            case 'k':
+                checkpoint_directory = optarg;
+                break;
+            case STATS_OPTION:
+                if (!stats_enable(optarg)) {
+                    return false;
+                }
+                break;
             case 'h':
                 help_flag = true;
                 return false;
@@ -94,6 +132,10 @@ bool parse_arguments(int argc, char *argv[]) {
         fprintf(stderr, "When performing multiple passes an input file must be provided.\n");
         return false;
     }
+    if (checkpoint_directory && !input) {
+        fprintf(stderr, "When using a checkpoint an input file must be provided.\n");
+        return false;
+    }
 
     return true;
 }
@@ -109,10 +151,68 @@ void print_usage() {
            "    -m, --max-value=VALUE   The maximum value of the elements, default is %u exclusive.\n"
            "    -p, --passes=PASSES     The number of passes to perform for the input, default is 1.\n"
            "                                If the number of passes is more than one, an input file must be provided.\n"
+           "    -k, --checkpoint=DIR    Record the progress in the directory DIR, and resume an interrupted run\n"
+           "                                that used it. An input file must be provided, and the output must be\n"
+           "                                appended to the output file of the interrupted run (>>).\n"
+           STATS_USAGE
            "    -h, --help              Display this help and exit.\n"
            "", UINT32_MAX, UINT32_MAX);
 }
 
+/**
+ * Move the output to the output offset of a resumed run. An output file is truncated to the output of the finished
+ * passes, which drops the integers of an unfinished pass. Other outputs, like pipes, continue after whatever the
+ * interrupted run wrote.
+ *
+ * @param offset The output offset of the checkpoint.
+ * @return true if the output was moved successfully, false if it is a file that is shorter than the offset.
+ */
+static bool resume_output(uint64_t offset) {
+    struct stat st;
+    if (fstat(STDOUT_FILENO, &st) != 0) {
+        return false;
+    }
+    if (!S_ISREG(st.st_mode)) {
+        return true;
+    }
+
+    return (uint64_t) st.st_size >= offset && ftruncate(STDOUT_FILENO, (off_t) offset) == 0 &&
+           lseek(STDOUT_FILENO, (off_t) offset, SEEK_SET) == (off_t) offset;
+}
+
+/**
+ * Save a checkpoint of the run. The bit set is saved too when the pass is resumed from it, which is after some of the
+ * input of the pass was read, to the snapshot that the previous state does not refer to.
+ *
+ * @param checkpoint Pointer to the checkpoint data structure.
+ * @param sorter The sorter of the pass.
+ * @param pass The index of the pass.
+ * @param phase The phase of the pass.
+ * @param input_offset The number of bytes of the input of the pass that were read.
+ * @param output_offset The number of bytes of the output that were written, which must be on the disk.
+ * @return true if the checkpoint was saved successfully, false otherwise.
+ */
+static bool save_checkpoint(PpCheckpoint *checkpoint, const PpBitsort *sorter, uint64_t pass, uint64_t phase,
+                            uint64_t input_offset, uint64_t output_offset) {
+    if (phase == PHASE_WRITE || input_offset > 0) {
+        uint64_t bits = !checkpoint->state.values[VALUE_BITS];
+        char *path = pp_checkpoint_path(checkpoint, checkpoint_bits[bits]);
+        bool saved = path && bs_save(&sorter->bs, path);
+        free(path);
+        if (!saved) {
+            return false;
+        }
+        checkpoint->state.values[VALUE_BITS] = bits;
+    }
+    checkpoint->state.pass = pass;
+    checkpoint->state.input_offset = input_offset;
+    checkpoint->state.output_offset = output_offset;
+    checkpoint->state.values[VALUE_PHASE] = phase;
+    checkpoint->state.values[VALUE_COUNT] = sorter->count;
+
+    return pp_checkpoint_save(checkpoint) == PP_OK;
+}
+
 /**
  * The main entry point of the program. It takes 2 required command line arguments: The input file and the number of
  * passes that we want to perform.
@@ -138,19 +238,92 @@ int main(int argc, char *argv[]) {
         return EXIT_FAILURE;
     }
 
-    // Initialize the bitset
-    u_int32_t step = ceil((double) (max_value + 1) / (double) passes);
-    BitSet *bs = malloc(sizeof(BitSet));
-    bs_init(bs, step);
+    // Open the checkpoint, and move the input and the output to the offsets of the interrupted run
+    PpCheckpoint checkpoint = {0};
+    if (checkpoint_directory) {
+        uint64_t options[] = {max_value, passes};
+        PpStatus status = pp_checkpoint_open(&checkpoint, checkpoint_directory, "bitset_sort", fileno(file), options,
+                                             sizeof(options) / sizeof(options[0]));
+        if (status != PP_OK) {
+            fprintf(stderr, "Unable to open the checkpoint %s: %s.\n", checkpoint_directory, pp_status_message(status));
+            fclose(file);
+            return EXIT_FAILURE;
+        }
+        if (checkpoint.resumed && (!resume_output(checkpoint.state.output_offset) ||
+                                   lseek(fileno(file), (off_t) checkpoint.state.input_offset, SEEK_SET) < 0)) {
+            fprintf(stderr, "Unable to resume the checkpoint, the output must be appended to the output file of the "
+                            "interrupted run.\n");
+            pp_checkpoint_close(&checkpoint);
+            fclose(file);
+            return EXIT_FAILURE;
+        }
+    }
 
-    // Perform multiple passes for the input
+    // Initialize the sorter with the range of the first pass, and the reader of the input
+    stats_phase("init");
+    uint64_t step = ceil((double) max_value / (double) passes);
+    PpBitsort sorter;
+    PpStatus status = pp_bitsort_init(&sorter, 0, step);
+    if (status != PP_OK) {
+        fprintf(stderr, "Unable to initialize the bit set: %s.\n", pp_status_message(status));
+        pp_checkpoint_close(&checkpoint);
+        fclose(file);
+        return EXIT_FAILURE;
+    }
+    PpReader reader;
+    status = pp_reader_open(&reader, fileno(file), PP_READER_AUTO);
+    if (status != PP_OK) {
+        fprintf(stderr, "Unable to read the input file: %s.\n", pp_status_message(status));
+        pp_bitsort_destroy(&sorter);
+        pp_checkpoint_close(&checkpoint);
+        fclose(file);
+        return EXIT_FAILURE;
+    }
+
+    // Perform multiple passes for the input, starting at the first unfinished one
     int exit_status = EXIT_SUCCESS;
     char *line = NULL;
+    size_t len = 0;
     char *end_ptr = NULL;
-    for (size_t i = 0; i < passes; i++) {
-        // Read the input line by line
-        size_t len = 0;
-        while (getline(&line, &len, file) != -1) {
+    uint32_t output[OUTPUT_CHUNK_SIZE];
+    size_t first_pass = checkpoint.state.pass;
+    uint64_t output_offset = checkpoint.state.output_offset;
+    for (size_t i = first_pass; i < passes && i * step < max_value; i++) {
+        uint64_t pass_min = i * step;
+        uint64_t pass_max = (i + 1) * step < max_value ? (i + 1) * step : max_value;
+        // Go to the start of the input and move the sorter to the range of the pass
+        if (i > first_pass && pp_reader_rewind(&reader) != PP_OK) {
+            fprintf(stderr, "Unable to read the input again, it must be a regular file for multiple passes.\n");
+            exit_status = EXIT_FAILURE;
+            goto cleanup;
+        }
+        if (i > 0) {
+            pp_bitsort_reset(&sorter, pass_min, pass_max);
+        }
+
+        // Load the bit set of an interrupted pass, which was saved after some of its input was read
+        bool resumed = checkpoint.resumed && i == first_pass;
+        uint64_t input_offset = resumed ? checkpoint.state.input_offset : 0;
+        uint64_t phase = resumed ? checkpoint.state.values[VALUE_PHASE] : PHASE_READ;
+        if (resumed && (phase == PHASE_WRITE || input_offset > 0)) {
+            char *path = pp_checkpoint_path(&checkpoint, checkpoint_bits[checkpoint.state.values[VALUE_BITS] & 1]);
+            bool loaded = path && bs_load(&sorter.bs, path);
+            free(path);
+            if (!loaded) {
+                fprintf(stderr, "Unable to load the bit set of the checkpoint.\n");
+                exit_status = EXIT_FAILURE;
+                goto cleanup;
+            }
+            sorter.count = checkpoint.state.values[VALUE_COUNT];
+        }
+
+        // Read the input line by line, unless the interrupted pass had read all of it
+        ssize_t line_length;
+        uint64_t checkpoint_offset = input_offset;
+        stats_phase("read");
+        while (phase == PHASE_READ && (line_length = pp_reader_getline(&reader, &line, &len)) != -1) {
+            stats_add_bytes(line_length);
+            stats_add_records(1);
             // Parse line as an integer
             errno = 0;
             u_int32_t number = strtoul(line, &end_ptr, 10);
@@ -161,41 +334,78 @@ int main(int argc, char *argv[]) {
                 goto cleanup;
             }
             if (number >= max_value) {
-                fprintf(stderr, "Input number %d is not less than the maximum value of %d.\n", number, max_value);
+                fprintf(stderr, "Input number %u is not less than the maximum value of %u.\n", number, max_value);
+                exit_status = EXIT_FAILURE;
+                goto cleanup;
+            }
+            // Number read successfully, add it if it is in the range of the pass
+            if (number >= pass_min && number < pass_max && pp_bitsort_add(&sorter, number) == PP_ERROR_DUPLICATE) {
+                fprintf(stderr, "Number %u is duplicated.\n", number);
                 exit_status = EXIT_FAILURE;
                 goto cleanup;
             }
-            // Number read successfully
-            if (i * step <= number <= (i + 1) * step) {
-                size_t bit_to_set = number - step * i;
-                if (bs_is_set(bs, bit_to_set)) {
-                    fprintf(stderr, "Number %u is duplicated.\n", number);
+            // Save a checkpoint inside long passes
+            input_offset += line_length;
+            if (checkpoint_directory && input_offset - checkpoint_offset >= PP_CHECKPOINT_INTERVAL) {
+                if (!save_checkpoint(&checkpoint, &sorter, i, PHASE_READ, input_offset, output_offset)) {
+                    fprintf(stderr, "Unable to save the checkpoint.\n");
                     exit_status = EXIT_FAILURE;
                     goto cleanup;
                 }
-                bs_set(bs, bit_to_set);
+                checkpoint_offset = input_offset;
             }
         }
+        if (reader.status != PP_OK) {
+            fprintf(stderr, "Unable to read the input file: %s.\n", pp_status_message(reader.status));
+            exit_status = EXIT_FAILURE;
+            goto cleanup;
+        }
+        if (checkpoint_directory && phase == PHASE_READ &&
+            !save_checkpoint(&checkpoint, &sorter, i, PHASE_WRITE, input_offset, output_offset)) {
+            fprintf(stderr, "Unable to save the checkpoint.\n");
+            exit_status = EXIT_FAILURE;
+            goto cleanup;
+        }
 
-        // Output the numbers that are contained in the bit set
-        for (size_t j = 0; j < bs->n; j++) {
-            if (bs_is_set(bs, j)) {
-                printf("%zu\n", i * step + j);
+        // Output the numbers of the pass in ascending order
+        stats_phase("write");
+        uint64_t position = 0;
+        size_t count;
+        while ((count = pp_bitsort_read(&sorter, &position, output, OUTPUT_CHUNK_SIZE)) > 0) {
+            for (size_t j = 0; j < count; j++) {
+                output_offset += printf("%u\n", output[j]);
             }
+            stats_add_records(count);
+        }
+
+        // Record the end of the pass, once its output is on the disk
+        if (checkpoint_directory && (pp_checkpoint_sync(stdout) != PP_OK ||
+                                     !save_checkpoint(&checkpoint, &sorter, i + 1, PHASE_READ, 0, output_offset))) {
+            fprintf(stderr, "Unable to save the checkpoint.\n");
+            exit_status = EXIT_FAILURE;
+            goto cleanup;
         }
+    }
 
-        if (i != passes - 1) {
-            // Go to the start of the input and reset the bitset for the next pass
-            fseek(file, 0, SEEK_SET);
-            bs_reset(bs);
+    // Remove the checkpoint of a finished run
+    if (checkpoint_directory) {
+        for (size_t i = 0; i < sizeof(checkpoint_bits) / sizeof(checkpoint_bits[0]); i++) {
+            char *path = pp_checkpoint_path(&checkpoint, checkpoint_bits[i]);
+            if (path) {
+                unlink(path);
+            }
+            free(path);
         }
+        pp_checkpoint_finish(&checkpoint);
     }
 
     // Cleanup
     cleanup:
     free(line);
-    bs_destroy(bs);
-    free(bs);
+    pp_reader_close(&reader);
+    pp_bitsort_destroy(&sorter);
+    pp_checkpoint_close(&checkpoint);
     fclose(file);
+    stats_report();
     exit(exit_status);
 }
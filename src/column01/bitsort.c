@@ -0,0 +1,166 @@
+/**
+ * This library sorts unique integers with a bit set, as bitset_sort does, without reading or writing any text. The bit
+ * of each added integer is set, and the integers are read back by scanning the set a whole unit at a time, so the empty
+ * parts of the range are skipped quickly.
+ */
+#include <limits.h>
+#include <string.h>
+
+#include "bitsort.h"
+
+// The number of bits of a bit set unit
+#define UNIT_BITS (sizeof(BS_UNIT) * CHAR_BIT)
+
+/**
+ * Initialize a sorter.
+ *
+ * @param sorter Pointer to the sorter data structure.
+ * @param min_value The first integer of the range.
+ * @param max_value The integer after the last one of the range. It may be up to 2^32.
+ * @return PP_OK if the sorter was initialized successfully, an error otherwise.
+ */
+PpStatus pp_bitsort_init(PpBitsort *sorter, uint32_t min_value, uint64_t max_value) {
+    memset(sorter, 0, sizeof(PpBitsort));
+    if (max_value <= min_value || max_value > (uint64_t) UINT32_MAX + 1) {
+        return PP_ERROR_ARGUMENT;
+    }
+    if (!bs_init(&sorter->bs, max_value - min_value)) {
+        return PP_ERROR_MEMORY;
+    }
+    sorter->min_value = min_value;
+    sorter->max_value = max_value;
+
+    return PP_OK;
+}
+
+/**
+ * Remove all the integers of a sorter, and move it to a new range, which must not be larger than the initial one.
+ *
+ * @param sorter Pointer to the sorter data structure.
+ * @param min_value The first integer of the range.
+ * @param max_value The integer after the last one of the range.
+ * @return PP_OK if the sorter was reset successfully, an error otherwise.
+ */
+PpStatus pp_bitsort_reset(PpBitsort *sorter, uint32_t min_value, uint64_t max_value) {
+    if (max_value <= min_value || max_value - min_value > sorter->bs.n) {
+        return PP_ERROR_ARGUMENT;
+    }
+    bs_reset(&sorter->bs);
+    sorter->min_value = min_value;
+    sorter->max_value = max_value;
+    sorter->count = 0;
+
+    return PP_OK;
+}
+
+/**
+ * Add an integer to a sorter.
+ *
+ * @param sorter Pointer to the sorter data structure.
+ * @param value The integer.
+ * @return PP_OK if the integer was added, PP_ERROR_RANGE if it is out of the range of the sorter or PP_ERROR_DUPLICATE
+ * if it was already added.
+ */
+PpStatus pp_bitsort_add(PpBitsort *sorter, uint32_t value) {
+    if (value < sorter->min_value || value >= sorter->max_value) {
+        return PP_ERROR_RANGE;
+    }
+    size_t bit = value - sorter->min_value;
+    BS_UNIT mask = (BS_UNIT) 1 << (bit % UNIT_BITS);
+    BS_UNIT *unit = &sorter->bs.bits[bit / UNIT_BITS];
+    if (*unit & mask) {
+        return PP_ERROR_DUPLICATE;
+    }
+    *unit |= mask;
+    sorter->count++;
+
+    return PP_OK;
+}
+
+/**
+ * Add integers to a sorter. Adding stops at the first integer that cannot be added.
+ *
+ * @param sorter Pointer to the sorter data structure.
+ * @param values The integers.
+ * @param count The number of integers.
+ * @param added Pointer to where the number of added integers will be written to, or NULL.
+ * @return PP_OK if all the integers were added, otherwise the error of the first integer that could not be added.
+ */
+PpStatus pp_bitsort_add_many(PpBitsort *sorter, const uint32_t *values, size_t count, size_t *added) {
+    PpStatus status = PP_OK;
+    size_t i = 0;
+    for (; i < count && status == PP_OK; i++) {
+        status = pp_bitsort_add(sorter, values[i]);
+    }
+    if (added) {
+        *added = status == PP_OK ? i : i - 1;
+    }
+
+    return status;
+}
+
+/**
+ * Read the integers of a sorter in ascending order into a buffer. Reading continues from a position, so the integers
+ * can be read in chunks of the buffer size.
+ *
+ * @param sorter Pointer to the sorter data structure.
+ * @param position Pointer to the reading position, which must be zero for the first call. It is updated.
+ * @param buffer The buffer.
+ * @param capacity The number of integers that the buffer can hold.
+ * @return The number of integers written to the buffer, or zero when all the integers have been read.
+ */
+size_t pp_bitsort_read(const PpBitsort *sorter, uint64_t *position, uint32_t *buffer, size_t capacity) {
+    uint64_t bit_count = sorter->max_value - sorter->min_value;
+    uint64_t bit = *position;
+    size_t count = 0;
+    while (bit < bit_count && count < capacity) {
+        // Skip the bits before the position in the current unit, and find the next set bit
+        BS_UNIT unit = sorter->bs.bits[bit / UNIT_BITS] >> (bit % UNIT_BITS);
+        if (unit == 0) {
+            bit = (bit / UNIT_BITS + 1) * UNIT_BITS;
+            continue;
+        }
+        bit += __builtin_ctz(unit);
+        if (bit >= bit_count) {
+            break;
+        }
+        buffer[count++] = (uint32_t) (sorter->min_value + bit);
+        bit++;
+    }
+    *position = bit < bit_count ? bit : bit_count;
+
+    return count;
+}
+
+/**
+ * Free resources associated with a sorter.
+ *
+ * @param sorter Pointer to the sorter data structure.
+ */
+void pp_bitsort_destroy(PpBitsort *sorter) {
+    bs_destroy(&sorter->bs);
+    memset(sorter, 0, sizeof(PpBitsort));
+}
+
+/**
+ * Sort an array of unique integers in place with a bit set.
+ *
+ * @param values The integers.
+ * @param count The number of integers.
+ * @param max_value The integer after the largest one.
+ * @return PP_OK if the integers were sorted successfully, an error otherwise. The array is unchanged on error.
+ */
+PpStatus pp_bitsort(uint32_t *values, size_t count, uint64_t max_value) {
+    PpBitsort sorter;
+    PpStatus status = pp_bitsort_init(&sorter, 0, max_value);
+    if (status == PP_OK) {
+        status = pp_bitsort_add_many(&sorter, values, count, NULL);
+    }
+    if (status == PP_OK) {
+        uint64_t position = 0;
+        pp_bitsort_read(&sorter, &position, values, count);
+    }
+    pp_bitsort_destroy(&sorter);
+
+    return status;
+}
@@ -3,53 +3,250 @@
  * standard output. Each integer must be in its own line. It uses the qsort library function in order to perform the
  * sort, so all integers are loaded in memory.
  *
+ * With --top or --bottom, only the K largest or smallest integers are written, in ascending order, as the end or the
+ * start of the full output would be. The input is streamed through a heap of K integers, so the memory is O(K) and the
+ * input may be of any length.
+ *
  * This is a solution for problem 1.
  */
 
 #include "compare.h"
+#include "reader.h"
+#include "stats.h"
+#include "topk.h"
 
 #include <errno.h>
 #include <stdio.h>
 #include <stdlib.h>
 
+#include <getopt.h>
+
 // The maximum number of elements that the program can handle.
 #define MAX_ELEMENTS 1000000
 
+// The help flag
+static bool help_flag = false;
+// The number of integers to select, or 0 to sort all of them
+static size_t select_count = 0;
+// true if the largest integers are selected, false if the smallest are
+static bool select_largest = false;
+
 /**
- * The main entry point of the program.
+ * Parse the command line arguments.
+ *
+ * @param argc The number of command line arguments.
+ * @param argv The command line arguments.
+ * @return true if the parsing was successful, false otherwise.
  */
-int main() {
+bool parse_arguments(int argc, char *argv[]) {
+    static struct option long_options[] = {
+        {"top", required_argument, 0, 't'},
+        {"bottom", required_argument, 0, 'b'},
+        {"help", no_argument, 0, 'h'},
+        STATS_LONG_OPTION,
+        {0, 0, 0, 0}
+    };
+
+    // Parse options
+    int c;
+    char *end_ptr = NULL;
+    int option_index = 0;
+    while ((c = getopt_long(argc, argv, "ht:b:", long_options, &option_index)) != -1) {
+        switch (c) {
+            case 't':
+            case 'b':
+                if (select_count > 0) {
+                    fprintf(stderr, "Only one of the top and bottom arguments can be provided.\n");
+                    return false;
+                }
+                errno = 0;
+                select_count = strtoul(optarg, &end_ptr, 10);
+                if (end_ptr == optarg || *end_ptr != '\0' || errno != 0 || select_count == 0) {
+                    fprintf(stderr, "Invalid value for the %s argument: %s.\n", c == 't' ? "top" : "bottom", optarg);
+                    return false;
+                }
+                select_largest = c == 't';
+                break;
+            case STATS_OPTION:
+                if (!stats_enable(optarg)) {
+                    return false;
+                }
+                break;
+            case 'h':
+                help_flag = true;
+                return false;
+            default:
+                return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * Prints usage instructions for the program.
+ */
+void print_usage() {
+    printf("Usage: library_sort [OPTION]...\n\n"
+           "Read a list of positive 32-bit integers from the standard input, sort them and write them to the standard\n"
+           "output. At most %d integers can be sorted, unless only some of them are selected.\n\n"
+           "Mandatory arguments to long options are mandatory for short options too.\n"
+           "    -t, --top=K             Only write the K largest integers, in ascending order.\n"
+           "    -b, --bottom=K          Only write the K smallest integers, in ascending order.\n"
+           STATS_USAGE
+           "    -h, --help              Display this help and exit.\n", MAX_ELEMENTS);
+}
+
+/**
+ * Parse a line as an integer.
+ *
+ * @param line The line.
+ * @param number Pointer to where the integer will be written to.
+ * @return true if the line is an integer, false otherwise.
+ */
+static bool parse_number(const char *line, u_int32_t *number) {
+    char *end_ptr = NULL;
+    errno = 0;
+    *number = strtoul(line, &end_ptr, 10);
+
+    return end_ptr != line && errno == 0;
+}
+
+/**
+ * Select the K smallest or largest integers of the standard input, and write them in ascending order.
+ *
+ * @param reader The reader of the standard input.
+ * @return The program exit status.
+ */
+static int select_numbers(PpReader *reader) {
+    PpTopK selector;
+    PpStatus status = pp_topk_init(&selector, select_count, select_largest);
+    if (status != PP_OK) {
+        fprintf(stderr, "Unable to select %zu integers: %s.\n", select_count, pp_status_message(status));
+        return EXIT_FAILURE;
+    }
+
+    // Stream the input through the selector
+    int exit_status = EXIT_SUCCESS;
+    char *line = NULL;
+    size_t len = 0;
+    ssize_t line_length;
+    stats_phase("read");
+    while ((line_length = pp_reader_getline(reader, &line, &len)) != -1) {
+        stats_add_bytes(line_length);
+        u_int32_t number;
+        if (!parse_number(line, &number)) {
+            fprintf(stderr, "Could not parse line %llu as an number\n", (unsigned long long) selector.added);
+            exit_status = EXIT_FAILURE;
+            goto cleanup;
+        }
+        pp_topk_add(&selector, number);
+    }
+    stats_add_records(selector.added);
+    if (reader->status != PP_OK) {
+        fprintf(stderr, "Unable to read the standard input: %s.\n", pp_status_message(reader->status));
+        exit_status = EXIT_FAILURE;
+        goto cleanup;
+    }
+
+    // Print the selected integers
+    stats_phase("write");
+    size_t count;
+    const uint32_t *selected = pp_topk_sorted(&selector, &count);
+    stats_add_records(count);
+    for (size_t i = 0; i < count; i++) {
+        printf("%u\n", selected[i]);
+    }
+
+cleanup:
+    free(line);
+    pp_topk_destroy(&selector);
+
+    return exit_status;
+}
+
+/**
+ * The main entry point of the program. It takes the optional --top or --bottom arguments, which only write some of the
+ * integers, and the --stats[=json] argument, which prints the time and the counters of each phase to the standard
+ * error.
+ *
+ * @param argc The number of command line arguments.
+ * @param argv The command line arguments.
+ * @return The program exit status.
+ */
+int main(int argc, char *argv[]) {
+    // Parse the command line arguments
+    if (!parse_arguments(argc, argv)) {
+        if (help_flag) {
+            print_usage();
+            return EXIT_SUCCESS;
+        } else {
+            return EXIT_FAILURE;
+        }
+    }
+
+    PpReader reader;
+    PpStatus status = pp_reader_open(&reader, fileno(stdin), PP_READER_AUTO);
+    if (status != PP_OK) {
+        fprintf(stderr, "Unable to read the standard input: %s.\n", pp_status_message(status));
+        return EXIT_FAILURE;
+    }
+    if (select_count > 0) {
+        int exit_status = select_numbers(&reader);
+        pp_reader_close(&reader);
+        stats_report();
+        exit(exit_status);
+    }
+
     char *line = NULL;
     size_t len = 0;
-    char *end_ptr = NULL;
     size_t current_index = 0;
     int exit_status = EXIT_SUCCESS; // The exit status.
     u_int32_t input[MAX_ELEMENTS] = {0};
 
     // Read the input line by line
-    while (getline(&line, &len, stdin) != -1) {
-        errno = 0;
+    stats_phase("read");
+    ssize_t line_length;
+    while ((line_length = pp_reader_getline(&reader, &line, &len)) != -1) {
+        stats_add_bytes(line_length);
         // Parse line as an integer
-        u_int32_t number = strtoul(line, &end_ptr, 10);
-        // Perform error checking
-        if (end_ptr == line || errno != 0) {
+        u_int32_t number;
+        if (!parse_number(line, &number)) {
             fprintf(stderr, "Could not parse line %zu as an number\n", current_index);
             exit_status = EXIT_FAILURE;
             goto cleanup;
         }
         // Number read successfully, store it to the input array.
+        if (current_index == MAX_ELEMENTS) {
+            fprintf(stderr, "Too many input lines, use --top or --bottom for more than %d integers\n", MAX_ELEMENTS);
+            exit_status = EXIT_FAILURE;
+            goto cleanup;
+        }
         input[current_index++] = number;
     }
+    if (reader.status != PP_OK) {
+        fprintf(stderr, "Unable to read the standard input: %s.\n", pp_status_message(reader.status));
+        exit_status = EXIT_FAILURE;
+        goto cleanup;
+    }
+
+    stats_add_records(current_index);
 
     // Sort the input number array
+    stats_phase("sort");
+    stats_add_records(current_index);
     qsort(input, current_index, sizeof(u_int32_t), compare_u_int32_t);
     // Print the sorted array
+    stats_phase("write");
+    stats_add_records(current_index);
     for (size_t i = 0; i < current_index; i++) {
-        printf("%d\n", input[i]);
+        printf("%u\n", input[i]);
     }
 
     // Cleanup
 cleanup:
     free(line);
+    pp_reader_close(&reader);
+    stats_report();
     exit(exit_status);
 }
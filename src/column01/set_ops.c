@@ -0,0 +1,253 @@
+/**
+ * This program combines files of 32-bit unsigned integers with a set operation, and writes the integers of the result
+ * to the standard output in ascending order, once each, as `sort | comm` would. The union has the integers of any of
+ * the files, the intersection the integers of all of them, and the difference the integers of the first file that are
+ * in none of the others. The files have an integer in each line, or native 32-bit integers with --binary, which also
+ * writes the result in binary. With --count, only the number of integers of the result is written.
+ *
+ * The integers of each file are marked in bit sets of the range, which are combined a whole unit at a time, by
+ * pp_setops_files of the library, so no sorting is needed. If the bit sets do not fit in the memory limit, the range is
+ * split into parts, and the files are read again for each part, from temporary copies for the files that are not
+ * regular files.
+ */
+#include <errno.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <getopt.h>
+
+#include "setops.h"
+#include "stats.h"
+
+// The maximum number of characters of an integer and its newline
+#define NUMBER_MAX_LENGTH 11
+// The size of the buffer of the formatted integers
+#define OUTPUT_BUFFER_SIZE 65536
+
+// The help flag
+static bool help_flag = false;
+// true if only the number of integers of the result is written
+static bool count_flag = false;
+// true if the files and the result hold native 32-bit integers
+static bool binary_flag = false;
+// The memory that the bit sets can use, in bytes
+static size_t memory_limit = PP_SETOPS_MEMORY_LIMIT;
+// The set operation
+static PpSetOperation operation = PP_SET_UNION;
+// The files to open
+static char **inputs = NULL;
+// The number of files to open
+static size_t input_count = 0;
+
+/**
+ * Parse the command line arguments.
+ *
+ * @param argc The number of command line arguments.
+ * @param argv The command line arguments.
+ * @return true if the parsing was successful, false otherwise.
+ */
+bool parse_arguments(int argc, char *argv[]) {
+    static struct option long_options[] = {
+        {"count", no_argument, 0, 'c'},
+        {"binary", no_argument, 0, 'b'},
+        {"memory-limit", required_argument, 0, 'l'},
+        {"help", no_argument, 0, 'h'},
+        STATS_LONG_OPTION,
+        {0, 0, 0, 0}
+    };
+
+    // Parse options
+    int c;
+    char *end_ptr = NULL;
+    int option_index = 0;
+    while ((c = getopt_long(argc, argv, "hcbl:", long_options, &option_index)) != -1) {
+        switch (c) {
+            case 'c':
+                count_flag = true;
+                break;
+            case 'b':
+                binary_flag = true;
+                break;
+            case 'l':
+                errno = 0;
+                memory_limit = strtoul(optarg, &end_ptr, 10);
+                if (end_ptr == optarg || *end_ptr != '\0' || errno != 0 || memory_limit == 0 ||
+                    memory_limit > SIZE_MAX >> 20) {
+                    fprintf(stderr, "Invalid value for the memory limit argument: %s.\n", optarg);
+                    return false;
+                }
+                memory_limit <<= 20;
+                break;
+            case STATS_OPTION:
+                if (!stats_enable(optarg)) {
+                    return false;
+                }
+                break;
+            case 'h':
+                help_flag = true;
+                return false;
+            default:
+                return false;
+        }
+    }
+
+    // Parse the remaining arguments
+    if (optind >= argc) {
+        fprintf(stderr, "The operation must be provided.\n");
+        return false;
+    }
+    if (strcmp(argv[optind], "union") == 0) {
+        operation = PP_SET_UNION;
+    } else if (strcmp(argv[optind], "intersect") == 0) {
+        operation = PP_SET_INTERSECTION;
+    } else if (strcmp(argv[optind], "diff") == 0) {
+        operation = PP_SET_DIFFERENCE;
+    } else {
+        fprintf(stderr, "Invalid operation: %s.\n", argv[optind]);
+        return false;
+    }
+    inputs = &argv[optind + 1];
+    input_count = argc - optind - 1;
+    if (input_count == 0) {
+        fprintf(stderr, "At least one input file must be provided.\n");
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * Prints usage instructions for the program.
+ */
+void print_usage() {
+    printf("Usage: set_ops [OPTION]... OPERATION FILE...\n\n"
+           "Combine the input files [FILE] of 32-bit unsigned integers, one per line, with the set operation\n"
+           "[OPERATION], and write the integers of the result in ascending order, once each. The operation is one of:\n"
+           "    union                   The integers of any of the files.\n"
+           "    intersect               The integers of all the files.\n"
+           "    diff                    The integers of the first file that are in none of the other files.\n"
+           "A file of - is the standard input.\n\n"
+           "Mandatory arguments to long options are mandatory for short options too.\n"
+           "    -c, --count             Only write the number of integers of the result.\n"
+           "    -b, --binary            The files hold native 32-bit integers instead of lines, and the result is\n"
+           "                                written in the same way.\n"
+           "    -l, --memory-limit=MIB  The memory of the bit sets, default is %u MiB. If the integers of the\n"
+           "                                result can be larger than the bit sets hold, the files are read again\n"
+           "                                for each part of the range. The files that are not regular files,\n"
+           "                                like the standard input, are copied to temporary files to be read\n"
+           "                                again.\n"
+           STATS_USAGE
+           "    -h, --help              Display this help and exit.\n", PP_SETOPS_MEMORY_LIMIT >> 20);
+}
+
+/**
+ * Write a chunk of integers of the result to the standard output.
+ *
+ * @param context Unused.
+ * @param values The integers of the chunk.
+ * @param count The number of integers of the chunk.
+ * @return true if the integers were written, false otherwise.
+ */
+static bool write_numbers(void *context, const uint32_t *values, size_t count) {
+    (void) context;
+    stats_add_records(count);
+    if (binary_flag) {
+        return fwrite(values, sizeof(uint32_t), count, stdout) == count;
+    }
+
+    // Format the integers backwards from the end of each one, which is faster than printf for this many integers
+    char text[OUTPUT_BUFFER_SIZE];
+    size_t length = 0;
+    for (size_t i = 0; i < count; i++) {
+        if (length + NUMBER_MAX_LENGTH > sizeof(text)) {
+            if (fwrite(text, 1, length, stdout) != length) {
+                return false;
+            }
+            length = 0;
+        }
+        char digits[NUMBER_MAX_LENGTH];
+        size_t digit_count = 0;
+        uint32_t value = values[i];
+        do {
+            digits[NUMBER_MAX_LENGTH - 1 - digit_count++] = (char) ('0' + value % 10);
+            value /= 10;
+        } while (value > 0);
+        memcpy(text + length, digits + NUMBER_MAX_LENGTH - digit_count, digit_count);
+        length += digit_count;
+        text[length++] = '\n';
+    }
+
+    return fwrite(text, 1, length, stdout) == length;
+}
+
+/**
+ * The main entry point of the program. It takes the operation and at least 1 input file, which contains the integers.
+ *
+ * @param argc The number of command line arguments.
+ * @param argv The command line arguments.
+ * @return The program exit status.
+ */
+int main(int argc, char *argv[]) {
+    // Parse the command line arguments
+    if (!parse_arguments(argc, argv)) {
+        if (help_flag) {
+            print_usage();
+            return EXIT_SUCCESS;
+        } else {
+            return EXIT_FAILURE;
+        }
+    }
+
+    // Open the input files
+    int exit_status = EXIT_SUCCESS;
+    FILE **files = calloc(input_count, sizeof(FILE *));
+    if (!files) {
+        fprintf(stderr, "Unable to allocate memory for the input files.\n");
+        return EXIT_FAILURE;
+    }
+    for (size_t i = 0; i < input_count; i++) {
+        files[i] = strcmp(inputs[i], "-") == 0 ? stdin : fopen(inputs[i], binary_flag ? "rb" : "r");
+        if (files[i] == NULL) {
+            fprintf(stderr, "Unable to open the input file %s.\n", inputs[i]);
+            exit_status = EXIT_FAILURE;
+            goto cleanup;
+        }
+    }
+
+    // Combine the files
+    stats_phase("combine");
+    uint64_t count = 0;
+    PpSetError error = {0};
+    PpStatus status = pp_setops_files(files, input_count, binary_flag, operation, memory_limit,
+                                      count_flag ? NULL : write_numbers, NULL, &count, &error);
+    if (status == PP_ERROR_PARSE || status == PP_ERROR_RANGE) {
+        fprintf(stderr, "%s at line %zu of %s\n", pp_status_message(status), error.line, inputs[error.input]);
+        exit_status = EXIT_FAILURE;
+    } else if (status == PP_ERROR_IO && !count_flag && ferror(stdout)) {
+        fprintf(stderr, "Unable to write the result.\n");
+        exit_status = EXIT_FAILURE;
+    } else if (status == PP_ERROR_IO) {
+        fprintf(stderr, "Unable to read the input file %s.\n", inputs[error.input]);
+        exit_status = EXIT_FAILURE;
+    } else if (status != PP_OK) {
+        fprintf(stderr, "%s\n", pp_status_message(status));
+        exit_status = EXIT_FAILURE;
+    } else if (count_flag) {
+        stats_add_records(count);
+        printf("%llu\n", (unsigned long long) count);
+    }
+
+    // Cleanup
+    cleanup:
+    for (size_t i = 0; i < input_count; i++) {
+        if (files[i] && files[i] != stdin) {
+            fclose(files[i]);
+        }
+    }
+    free(files);
+    stats_report();
+    return exit_status;
+}
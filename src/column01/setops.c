@@ -0,0 +1,313 @@
+/**
+ * This library combines the integers of files with set operations, as set_ops does, without printing anything. The
+ * integers of each file are marked in a bit set of the range, and the bit sets are combined with bs_and and bs_andnot,
+ * a whole unit at a time, so the result is sorted and free of duplicates by construction.
+ *
+ * The union marks every file in the same bit set. The intersection marks each file in a second bit set, which is then
+ * combined with the first one, and the difference marks all the files after the first one in the second bit set, which
+ * is removed from the first one at the end. When the bit sets of the whole range do not fit in the memory limit, the
+ * range is split into parts, and every file is read again for each part. The files that cannot be read again, like
+ * pipes, are copied to temporary files of native integers in the first pass, which the later passes read. The first
+ * pass records the largest integer of
+ * each file, which bounds the largest integer of the result, so the parts after it are never read, and the later
+ * passes skip the files whose integers are all before the part. The bit sets are only combined, counted and cleared up
+ * to the largest integer that was marked, so small integers do not pay for the whole range.
+ */
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "bitset.h"
+#include "missing.h"
+#include "reader.h"
+#include "setops.h"
+
+// The number of values of the 32-bit range
+#define RANGE_SIZE ((uint64_t) 1 << 32)
+// The number of bits of a bit set unit
+#define UNIT_BITS (sizeof(BS_UNIT) * CHAR_BIT)
+// The number of integers of the result that are passed to the output at once
+#define OUTPUT_CHUNK_SIZE 4096
+
+/**
+ * An input file of a set operation, which is read once per pass.
+ */
+typedef struct {
+    /** The file. */
+    FILE *file;
+    /** The temporary file of the integers of a file that cannot be read again, in binary, or NULL. */
+    FILE *spool;
+    /** true if the file has at least one integer. */
+    bool nonempty;
+    /** The largest integer of the file, which is known after the first pass. */
+    uint32_t max_value;
+} Input;
+
+/**
+ * The state that is shared by the passes of a set operation.
+ */
+typedef struct {
+    /** true if the files hold native 32-bit integers. */
+    bool binary;
+    /** The line buffer. */
+    char *line;
+    /** The size of the line buffer. */
+    size_t line_size;
+    /** The number of passes that were started. */
+    size_t passes;
+    /** The number of bits at the start of the bit sets that were touched in the current pass. */
+    uint64_t touched;
+    /** Pointer to where the failed input will be written to, or NULL. */
+    PpSetError *error;
+} Pass;
+
+/**
+ * Read all the integers of an input, and mark the ones of a part of the range in a bit set. The largest integer of the
+ * input is recorded in the first pass, and the integers of an input with a temporary file are copied to it, so the
+ * later passes read them from there.
+ *
+ * @param pass Pointer to the pass data structure.
+ * @param input Pointer to the input data structure.
+ * @param index The index of the input.
+ * @param set Pointer to the bit set, whose first bit is the first integer of the part.
+ * @param low The first integer of the part.
+ * @param high The integer after the last one of the part.
+ * @return PP_OK if the input was read successfully, an error otherwise.
+ */
+static PpStatus mark(Pass *pass, Input *input, size_t index, BitSet *set, uint64_t low, uint64_t high) {
+    bool spooled = input->spool && pass->passes > 1;
+    int fd = fileno(spooled ? input->spool : input->file);
+    if (pass->passes > 1 && lseek(fd, 0, SEEK_SET) != 0) {
+        if (pass->error) {
+            pass->error->input = index;
+        }
+        return PP_ERROR_IO;
+    }
+    PpReader reader;
+    PpStatus status = pp_reader_open(&reader, fd, PP_READER_AUTO);
+    bool reader_open = status == PP_OK;
+    size_t count = 0;
+    while (status == PP_OK) {
+        uint32_t number;
+        bool end;
+        status = pp_read_number(&reader, !pass->binary && !spooled, &pass->line, &pass->line_size, &number, &end);
+        if (status != PP_OK || end) {
+            break;
+        }
+        if (input->spool && !spooled && fwrite(&number, sizeof(uint32_t), 1, input->spool) != 1) {
+            status = PP_ERROR_IO;
+            break;
+        }
+        count++;
+        if (pass->passes == 1 && (!input->nonempty || number > input->max_value)) {
+            input->nonempty = true;
+            input->max_value = number;
+        }
+        if (number >= low && number < high) {
+            set->bits[(number - low) / UNIT_BITS] |= (BS_UNIT) 1 << ((number - low) % UNIT_BITS);
+            pass->touched = number - low + 1 > pass->touched ? number - low + 1 : pass->touched;
+        }
+    }
+    if (reader_open) {
+        pp_reader_close(&reader);
+    }
+    if (status == PP_OK && input->spool && !spooled && fflush(input->spool) != 0) {
+        status = PP_ERROR_IO;
+    }
+    if (status != PP_OK && pass->error) {
+        pass->error->input = index;
+        pass->error->line = count + 1;
+    }
+
+    return status;
+}
+
+/**
+ * Get the integer after the largest one that the result of a set operation can have, once the first pass is done.
+ *
+ * @param inputs The inputs.
+ * @param input_count The number of inputs.
+ * @param operation The set operation.
+ * @return The integer after the largest one of the result, or zero if the result is empty.
+ */
+static uint64_t result_end(const Input *inputs, size_t input_count, PpSetOperation operation) {
+    if (operation == PP_SET_DIFFERENCE) {
+        return inputs[0].nonempty ? (uint64_t) inputs[0].max_value + 1 : 0;
+    }
+    uint64_t end = operation == PP_SET_UNION ? 0 : RANGE_SIZE;
+    for (size_t i = 0; i < input_count; i++) {
+        uint64_t input_end = inputs[i].nonempty ? (uint64_t) inputs[i].max_value + 1 : 0;
+        if (operation == PP_SET_UNION ? input_end > end : input_end < end) {
+            end = input_end;
+        }
+    }
+
+    return end;
+}
+
+/**
+ * Pass the integers of a part of the range that are marked in a bit set to the output, in chunks.
+ *
+ * @param set Pointer to the bit set, whose first bit is the first integer of the part.
+ * @param low The first integer of the part.
+ * @param high The integer after the last one of the part.
+ * @param output The output function.
+ * @param context The context that is passed to the function.
+ * @return true if all the integers were passed to the output, false if it stopped.
+ */
+static bool emit(const BitSet *set, uint64_t low, uint64_t high, PpSetOutput output, void *context) {
+    uint32_t chunk[OUTPUT_CHUNK_SIZE];
+    size_t count = 0;
+    size_t unit_count = (high - low + UNIT_BITS - 1) / UNIT_BITS;
+    for (size_t i = 0; i < unit_count; i++) {
+        // Only the bits of the integers of the part are ever set, so the set bits need no range check
+        BS_UNIT unit = set->bits[i];
+        while (unit != 0) {
+            chunk[count++] = (uint32_t) (low + i * UNIT_BITS + __builtin_ctz(unit));
+            unit &= unit - 1;
+            if (count == OUTPUT_CHUNK_SIZE) {
+                if (!output(context, chunk, count)) {
+                    return false;
+                }
+                count = 0;
+            }
+        }
+    }
+
+    return count == 0 || output(context, chunk, count);
+}
+
+/**
+ * Combine the 32-bit integers of files with a set operation. The integers of each file are marked in a bit set, and the
+ * bit sets are combined a whole unit at a time. If the bit sets of the whole range do not fit in the memory limit, the
+ * range is split into parts that do, and all the files are read again for each part. The files that cannot be read
+ * again, like pipes, are copied to temporary files in the first pass, which the later passes read instead. The parts
+ * past the largest integer that the result can have are skipped, so small integers need a single pass whatever the
+ * limit is.
+ *
+ * @param inputs The input files, which are read through their file descriptors, so nothing must have been read from
+ * them.
+ * @param input_count The number of input files, which must be positive.
+ * @param binary true if the files hold native 32-bit integers, false if they hold an integer in each line.
+ * @param operation The set operation.
+ * @param memory_limit The memory that the bit sets can use, in bytes.
+ * @param output The function that receives the integers of the result, or NULL to only count them.
+ * @param context The context that is passed to the function.
+ * @param count Pointer to where the number of integers of the result will be written to, or NULL.
+ * @param error Pointer to where the failed input will be written to on an error of an input file, or NULL.
+ * @return PP_OK if the files were combined successfully, an error otherwise.
+ */
+PpStatus pp_setops_files(FILE *const *inputs, size_t input_count, bool binary, PpSetOperation operation,
+                         size_t memory_limit, PpSetOutput output, void *context, uint64_t *count, PpSetError *error) {
+    // The union needs a single bit set, the other operations need a second one for the files after the first one
+    size_t set_count = operation == PP_SET_UNION ? 1 : 2;
+    uint64_t part_size = (uint64_t) (memory_limit / set_count / sizeof(BS_UNIT)) * UNIT_BITS;
+    if (input_count == 0 || part_size == 0) {
+        return PP_ERROR_ARGUMENT;
+    }
+    part_size = part_size < RANGE_SIZE ? part_size : RANGE_SIZE;
+
+    Input *in = calloc(input_count, sizeof(Input));
+    BitSet result = {0};
+    BitSet other = {0};
+    if (!in || !bs_init(&result, part_size) || (set_count == 2 && !bs_init(&other, part_size))) {
+        free(in);
+        bs_destroy(&result);
+        return PP_ERROR_MEMORY;
+    }
+    for (size_t i = 0; i < input_count; i++) {
+        in[i].file = inputs[i];
+    }
+
+    // The files that cannot be read again get a temporary file, if the range needs more than one part
+    PpStatus status = PP_OK;
+    for (size_t i = 0; i < input_count && part_size < RANGE_SIZE && status == PP_OK; i++) {
+        struct stat st;
+        if (fstat(fileno(inputs[i]), &st) != 0 || (!S_ISREG(st.st_mode) && (in[i].spool = tmpfile()) == NULL)) {
+            status = PP_ERROR_IO;
+            if (error) {
+                error->input = i;
+            }
+        }
+    }
+
+    // Combine the files in each part of the range, until the end of the result is reached
+    Pass pass = {.binary = binary, .error = error};
+    uint64_t end = RANGE_SIZE;
+    uint64_t result_count = 0;
+    for (uint64_t low = 0; low < end && status == PP_OK; low += part_size) {
+        uint64_t high = low + part_size < RANGE_SIZE ? low + part_size : RANGE_SIZE;
+        pass.passes++;
+        if (pass.touched > 0) {
+            // Views of the touched bits of the previous pass
+            BitSet touched_result = {result.bits, pass.touched};
+            BitSet touched_other = {other.bits, pass.touched};
+            bs_reset(&touched_result);
+            if (set_count == 2) {
+                bs_reset(&touched_other);
+            }
+            pass.touched = 0;
+        }
+        status = mark(&pass, &in[0], 0, &result, low, high);
+        for (size_t i = 1; i < input_count && status == PP_OK; i++) {
+            // The files whose integers are all before the part cannot change it after the first pass
+            if (pass.passes > 1 && operation != PP_SET_INTERSECTION && (!in[i].nonempty || in[i].max_value < low)) {
+                continue;
+            }
+            if (operation == PP_SET_UNION) {
+                status = mark(&pass, &in[i], i, &result, low, high);
+            } else if (operation == PP_SET_INTERSECTION) {
+                BitSet touched_other = {other.bits, pass.touched};
+                if (i > 1 && pass.touched > 0) {
+                    bs_reset(&touched_other);
+                }
+                status = mark(&pass, &in[i], i, &other, low, high);
+                touched_other.n = pass.touched;
+                BitSet touched_result = {result.bits, pass.touched};
+                if (pass.touched > 0) {
+                    bs_and(&touched_result, &touched_other);
+                }
+            } else {
+                status = mark(&pass, &in[i], i, &other, low, high);
+            }
+        }
+        if (status != PP_OK) {
+            break;
+        }
+        if (pass.passes == 1) {
+            end = result_end(in, input_count, operation);
+        }
+        if (pass.touched == 0) {
+            continue;
+        }
+        BitSet touched_result = {result.bits, pass.touched};
+        BitSet touched_other = {other.bits, pass.touched};
+        if (operation == PP_SET_DIFFERENCE) {
+            bs_andnot(&touched_result, &touched_other);
+        }
+
+        // Pass the integers of the part to the output, or only count them
+        result_count += bs_count(&touched_result);
+        if (output && !emit(&touched_result, low, low + pass.touched, output, context)) {
+            status = PP_ERROR_IO;
+        }
+    }
+    if (count) {
+        *count = result_count;
+    }
+
+    for (size_t i = 0; i < input_count; i++) {
+        if (in[i].spool) {
+            fclose(in[i].spool);
+        }
+    }
+    free(pass.line);
+    free(in);
+    bs_destroy(&result);
+    bs_destroy(&other);
+
+    return status;
+}
@@ -0,0 +1,134 @@
+/**
+ * This library selects the K smallest or largest integers of a stream, as library_sort --bottom and --top do, without
+ * reading or writing any text. The selected integers are kept in a binary heap, whose root is the one that is replaced
+ * first: the largest when the smallest are selected, and the smallest when the largest are selected. Once the heap is
+ * full, an integer that does not beat the root is rejected at once, so the time is close to linear for long streams.
+ */
+#include <stdlib.h>
+#include <string.h>
+
+#include "compare.h"
+#include "topk.h"
+
+/**
+ * Check whether an integer must be closer to the root of the heap than another one.
+ *
+ * @param selector Pointer to the selector data structure.
+ * @param x The first integer.
+ * @param y The second integer.
+ * @return true if x must be above y in the heap, false otherwise.
+ */
+static inline bool above(const PpTopK *selector, uint32_t x, uint32_t y) {
+    return selector->largest ? x < y : x > y;
+}
+
+/**
+ * Move the integer at an index of the heap up, until its parent is above it.
+ *
+ * @param selector Pointer to the selector data structure.
+ * @param index The index.
+ */
+static void sift_up(PpTopK *selector, size_t index) {
+    uint32_t value = selector->heap[index];
+    while (index > 0) {
+        size_t parent = (index - 1) / 2;
+        if (!above(selector, value, selector->heap[parent])) {
+            break;
+        }
+        selector->heap[index] = selector->heap[parent];
+        index = parent;
+    }
+    selector->heap[index] = value;
+}
+
+/**
+ * Move the integer at the root of the heap down, until neither of its children is above it.
+ *
+ * @param selector Pointer to the selector data structure.
+ */
+static void sift_down(PpTopK *selector) {
+    uint32_t *heap = selector->heap;
+    uint32_t value = heap[0];
+    size_t index = 0;
+    while (true) {
+        size_t child = 2 * index + 1;
+        if (child >= selector->count) {
+            break;
+        }
+        if (child + 1 < selector->count && above(selector, heap[child + 1], heap[child])) {
+            child++;
+        }
+        if (!above(selector, heap[child], value)) {
+            break;
+        }
+        heap[index] = heap[child];
+        index = child;
+    }
+    heap[index] = value;
+}
+
+/**
+ * Initialize a selector.
+ *
+ * @param selector Pointer to the selector data structure.
+ * @param k The number of integers to select, which must be positive.
+ * @param largest true to select the largest integers, false to select the smallest.
+ * @return PP_OK if the selector was initialized successfully, an error otherwise.
+ */
+PpStatus pp_topk_init(PpTopK *selector, size_t k, bool largest) {
+    memset(selector, 0, sizeof(PpTopK));
+    if (k == 0 || k > SIZE_MAX / sizeof(uint32_t)) {
+        return PP_ERROR_ARGUMENT;
+    }
+    selector->heap = malloc(k * sizeof(uint32_t));
+    if (!selector->heap) {
+        return PP_ERROR_MEMORY;
+    }
+    selector->k = k;
+    selector->largest = largest;
+
+    return PP_OK;
+}
+
+/**
+ * Add an integer to a selector. It is kept if it is one of the K smallest or largest integers that were added so far.
+ *
+ * @param selector Pointer to the selector data structure.
+ * @param value The integer.
+ */
+void pp_topk_add(PpTopK *selector, uint32_t value) {
+    selector->added++;
+    if (selector->count < selector->k) {
+        selector->heap[selector->count++] = value;
+        sift_up(selector, selector->count - 1);
+    } else if (above(selector, selector->heap[0], value)) {
+        // The integer beats the threshold, so it replaces the root
+        selector->heap[0] = value;
+        sift_down(selector);
+    }
+}
+
+/**
+ * Sort the selected integers in ascending order, and get them. The selector must not be added to afterwards.
+ *
+ * @param selector Pointer to the selector data structure.
+ * @param count Pointer to where the number of selected integers will be written to, which is less than K if fewer
+ * integers were added.
+ * @return The selected integers, which are owned by the selector.
+ */
+const uint32_t *pp_topk_sorted(PpTopK *selector, size_t *count) {
+    qsort(selector->heap, selector->count, sizeof(uint32_t), compare_u_int32_t);
+    *count = selector->count;
+
+    return selector->heap;
+}
+
+/**
+ * Free resources associated with a selector.
+ *
+ * @param selector Pointer to the selector data structure.
+ */
+void pp_topk_destroy(PpTopK *selector) {
+    free(selector->heap);
+    memset(selector, 0, sizeof(PpTopK));
+}
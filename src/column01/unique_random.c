@@ -10,18 +10,31 @@
 #include <stdlib.h>
 #include <time.h>
 
+#include <getopt.h>
+
+#include "stats.h"
+
 /**
  * The main entry point of the program. It takes 2 required command line arguments: The number of unique integers to
- * generate and the maximum value of the integer.
+ * generate and the maximum value of the integer. The optional --stats[=json] argument prints the time and the counters
+ * of each phase to the standard error.
  *
  * @param argc The number of command line arguments.
  * @param argv The command line arguments.
  * @return The program exit status.
  */
 int main(int argc, char *argv[]) {
+    // Parse the command line arguments
+    static struct option long_options[] = {STATS_LONG_OPTION, {0, 0, 0, 0}};
+    int c;
+    while ((c = getopt_long(argc, argv, "", long_options, NULL)) != -1) {
+        if (c != STATS_OPTION || !stats_enable(optarg)) {
+            return EXIT_FAILURE;
+        }
+    }
     // Validate the number of command line arguments
-    if (argc < 3) {
-        fprintf(stderr, "Usage: unique_random: [NUMBER] [MAX]\n"
+    if (argc - optind < 2) {
+        fprintf(stderr, "Usage: unique_random: [--stats[=json]] [NUMBER] [MAX]\n"
                         "Print [NUMBER] unique random integers between 0 and [MAX] - 1, each in a new line.\n");
         return EXIT_FAILURE;
     }
@@ -29,14 +42,14 @@ int main(int argc, char *argv[]) {
     // Parse input arguments
     char *end_ptr = NULL;
     errno = 0;
-    u_int32_t k = strtoul(argv[1], &end_ptr, 10);
-    if (end_ptr == argv[1] || errno != 0) {
+    u_int32_t k = strtoul(argv[optind], &end_ptr, 10);
+    if (end_ptr == argv[optind] || errno != 0) {
         fprintf(stderr, "Invalid value for number of integers to generate.\n");
         return EXIT_FAILURE;
     }
     errno = 0;
-    u_int32_t n = strtoul(argv[2], &end_ptr, 10);
-    if (end_ptr == argv[2] || errno != 0) {
+    u_int32_t n = strtoul(argv[optind + 1], &end_ptr, 10);
+    if (end_ptr == argv[optind + 1] || errno != 0) {
         fprintf(stderr, "Invalid value for the maximum value of the integers to generate.\n");
         return EXIT_FAILURE;
     }
@@ -48,11 +61,14 @@ int main(int argc, char *argv[]) {
     }
 
     // Create the array
+    stats_phase("init");
     u_int32_t *array = malloc(n * sizeof(u_int32_t));
     for (size_t i = 0; i < n; i++) {
         array[i] = i;
     }
     // Shuffle the array
+    stats_phase("shuffle");
+    stats_add_records(k);
     srand(time(NULL));
     for (size_t i = 0; i < k; i++) {
         // Get a random index between i and n - 1
@@ -63,6 +79,7 @@ int main(int argc, char *argv[]) {
         array[i] = temp;
         printf("%u\n", array[i]);
     }
+    stats_report();
 
     return EXIT_SUCCESS;
 }
@@ -1,65 +1,745 @@
 /**
  * This program checks if a word is an anagram of a word found in a dictionary. No preprocessing is performed.
  *
+ * A single word is searched in the memory mapped dictionary, without copying it. The newlines are found with vector
+ * compares of 64 bytes at a time, which give a bit mask of the newlines of the block, so the length of every line is
+ * known without looking at its characters. Only the lines of the same length as the word are candidates, and they are
+ * compared by their letter histograms instead of sorted signatures. Dictionaries that cannot be mapped, such as pipes,
+ * are read line by line.
+ *
+ * In batch mode, many query words are read from the standard input or from a file. The queries are stored in a hash
+ * table keyed by their signature, and the dictionary is read only once. Each dictionary word is looked up in the table,
+ * so the cost is proportional to the size of the dictionary plus the number of queries, instead of their product.
+ *
  * This is a solution for problem 1.
  */
+#include "reader.h"
+#include "stats.h"
 #include "stringsig.h"
 
+#include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
+#include <getopt.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+// The initial capacity of the dynamic arrays
+#define CHUNK_SIZE 16
+// The number of bytes whose newlines are found at once
+#define SCAN_BLOCK_SIZE 64
+
+// The help flag
+static bool help_flag = false;
+// The batch mode flag
+static bool batch_flag = false;
+// true if the dictionary is read line by line even if it can be memory mapped
+static bool stream_flag = false;
+// The file to read the batch queries from, or NULL for the standard input
+static char *batch_input = NULL;
+// The dictionary file
+static char *dictionary = NULL;
+// The word to search the anagrams for
+static char *word = NULL;
+
 /**
- * The main entry point of the program. It takes 2 required command line arguments: The dictionary file and the word we
- * want to search the anagram for.
+ * An anagram class of the batch mode. It holds the dictionary words that have the same signature.
+ */
+typedef struct {
+    /** The class signature */
+    char *signature;
+    /** The length of the signature */
+    size_t length;
+    /** The hash of the signature */
+    uint64_t hash;
+    /** The dictionary words with this signature */
+    char **words;
+    /** The number of dictionary words */
+    size_t word_count;
+    /** The capacity of the words array */
+    size_t capacity;
+} AnagramClass;
+
+/**
+ * The query of the single word search of a memory mapped dictionary.
+ */
+typedef struct {
+    /** The query word */
+    const char *word;
+    /** The length of the query word */
+    size_t length;
+    /** true if the candidates are compared by histogram, false if the word has other characters than 'a' to 'z' */
+    bool use_histogram;
+    /** The letter histogram of the query word */
+    SsHistogram histogram;
+    /** The signature of the query word, when the histogram is not used */
+    char *signature;
+    /** Buffer that holds the signature of a candidate, when the histogram is not used */
+    char *candidate_signature;
+} WordQuery;
+
+/**
+ * A query of the batch mode.
+ */
+typedef struct {
+    /** The query word */
+    char *word;
+    /** The index of the anagram class of the word */
+    size_t class_index;
+} Query;
+
+/**
+ * A hash table that maps signatures to anagram classes. It uses open addressing with linear probing.
+ */
+typedef struct {
+    /** The anagram classes */
+    AnagramClass *classes;
+    /** The number of anagram classes */
+    size_t class_count;
+    /** The capacity of the classes array */
+    size_t class_capacity;
+    /** The slots of the table. Each slot holds the index of a class plus one, or zero if it is empty. */
+    size_t *slots;
+    /** The number of slots. It is always a power of two. */
+    size_t slot_count;
+} ClassTable;
+
+/**
+ * Parse the command line arguments.
  *
  * @param argc The number of command line arguments.
  * @param argv The command line arguments.
+ * @return true if the parsing was successful, false otherwise.
+ */
+bool parse_arguments(int argc, char *argv[]) {
+    static struct option long_options[] = {
+        {"batch", optional_argument, 0, 'b'},
+        {"stream", no_argument, 0, 's'},
+        {"help", no_argument, 0, 'h'},
+        STATS_LONG_OPTION,
+        {0, 0, 0, 0}
+    };
+
+    // Parse options
+    int c;
+    int option_index = 0;
+    while (true) {
+        c = getopt_long(argc, argv, "hb::s", long_options, &option_index);
+        if (c == -1) {
+            break;
+        }
+        switch (c) {
+            case 'b':
+                batch_flag = true;
+                batch_input = optarg;
+                break;
+            case 's':
+                stream_flag = true;
+                break;
+            case STATS_OPTION:
+                if (!stats_enable(optarg)) {
+                    return false;
+                }
+                break;
+            case 'h':
+                help_flag = true;
+                return false;
+            default:
+                return false;
+        }
+    }
+
+    // Parse the remaining arguments
+    if (optind < argc) {
+        dictionary = argv[optind++];
+    }
+    if (optind < argc) {
+        word = argv[optind++];
+    }
+    // Validate the arguments
+    if (!dictionary) {
+        fprintf(stderr, "A dictionary file must be provided.\n");
+        return false;
+    }
+    if (!batch_flag && !word) {
+        fprintf(stderr, "A word must be provided when not in batch mode.\n");
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * Prints usage instructions for the program.
+ */
+void print_usage() {
+    printf("Usage: anagram [OPTION]... [DICTIONARY] [WORD]\n\n"
+           "Find all anagrams of [WORD] in the [DICTIONARY].\n\n"
+           "Mandatory arguments to long options are mandatory for short options too.\n"
+           "    -b, --batch[=FILE]      Read the query words from FILE, one per line, instead of [WORD]. If no FILE\n"
+           "                                is given, the standard input is used. For each query a line with the\n"
+           "                                word, a colon and its anagrams is printed, in the order of the queries.\n"
+           "    -s, --stream            Read the dictionary line by line, instead of mapping it into memory when a\n"
+           "                                single word is searched.\n"
+           STATS_USAGE
+           "    -h, --help              Display this help and exit.\n");
+}
+
+/**
+ * Strip the new line from the end of a line, if it exists.
+ *
+ * @param line The line.
+ * @param line_length The length of the line.
+ * @return The length of the line without the new line.
+ */
+static size_t strip_new_line(char *line, size_t line_length) {
+    if (line_length > 0 && line[line_length - 1] == '\n') {
+        line[--line_length] = '\0';
+    }
+
+    return line_length;
+}
+
+/**
+ * Find the slot of a signature in the class table.
+ *
+ * @param table The class table.
+ * @param signature The signature to find.
+ * @param length The length of the signature.
+ * @param hash The hash of the signature.
+ * @return The slot of the signature if it exists in the table, otherwise the empty slot where it should be inserted.
+ */
+static size_t ct_find_slot(const ClassTable *table, const char *signature, size_t length, uint64_t hash) {
+    size_t mask = table->slot_count - 1;
+    for (size_t slot = hash & mask; ; slot = (slot + 1) & mask) {
+        size_t index = table->slots[slot];
+        if (index == 0) {
+            return slot;
+        }
+        const AnagramClass *class = &table->classes[index - 1];
+        if (class->hash == hash && class->length == length && memcmp(class->signature, signature, length) == 0) {
+            return slot;
+        }
+    }
+}
+
+/**
+ * Find the anagram class of a word, if it exists in the class table. The signature of the word is only calculated if a
+ * class with the same signature hash exists.
+ *
+ * @param table The class table.
+ * @param word The word.
+ * @param length The length of the word.
+ * @param signature Buffer that can hold length + 1 characters, used to calculate the word signature.
+ * @return The anagram class, or NULL if it does not exist.
+ */
+static AnagramClass *ct_lookup(const ClassTable *table, const char *word, size_t length, char *signature) {
+    uint64_t hash = ss_hash(word, length);
+    size_t mask = table->slot_count - 1;
+    bool signature_calculated = false;
+    for (size_t slot = hash & mask; table->slots[slot] != 0; slot = (slot + 1) & mask) {
+        AnagramClass *class = &table->classes[table->slots[slot] - 1];
+        if (class->hash != hash || class->length != length) {
+            continue;
+        }
+        if (!signature_calculated) {
+            ss_calculate(word, length, signature);
+            signature_calculated = true;
+        }
+        if (memcmp(class->signature, signature, length) == 0) {
+            return class;
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * Grow the slots of the class table so that it is at most half full, and rehash the classes.
+ *
+ * @param table The class table.
+ * @return true if the table was grown successfully, false otherwise.
+ */
+static bool ct_grow(ClassTable *table) {
+    size_t slot_count = table->slot_count ? table->slot_count * 2 : CHUNK_SIZE;
+    size_t *slots = calloc(slot_count, sizeof(size_t));
+    if (!slots) {
+        return false;
+    }
+    free(table->slots);
+    table->slots = slots;
+    table->slot_count = slot_count;
+    for (size_t i = 0; i < table->class_count; i++) {
+        const AnagramClass *class = &table->classes[i];
+        table->slots[ct_find_slot(table, class->signature, class->length, class->hash)] = i + 1;
+    }
+
+    return true;
+}
+
+/**
+ * Add a signature to the class table, if it does not already exist.
+ *
+ * @param table The class table.
+ * @param signature The signature to add.
+ * @param length The length of the signature.
+ * @param class_index Pointer to where the index of the class of the signature will be written to.
+ * @return true if the signature was added successfully, false otherwise.
+ */
+static bool ct_add(ClassTable *table, const char *signature, size_t length, size_t *class_index) {
+    if (2 * (table->class_count + 1) > table->slot_count && !ct_grow(table)) {
+        return false;
+    }
+    uint64_t hash = ss_hash(signature, length);
+    size_t slot = ct_find_slot(table, signature, length, hash);
+    if (table->slots[slot] != 0) {
+        *class_index = table->slots[slot] - 1;
+        return true;
+    }
+
+    // Create a new class
+    if (table->class_count == table->class_capacity) {
+        size_t capacity = table->class_capacity + CHUNK_SIZE + table->class_capacity / 2;
+        AnagramClass *classes = realloc(table->classes, capacity * sizeof(AnagramClass));
+        if (!classes) {
+            return false;
+        }
+        table->classes = classes;
+        table->class_capacity = capacity;
+    }
+    char *class_signature = strndup(signature, length);
+    if (!class_signature) {
+        return false;
+    }
+    AnagramClass class = {.signature = class_signature, .length = length, .hash = hash};
+    table->classes[table->class_count] = class;
+    table->slots[slot] = ++table->class_count;
+    *class_index = table->class_count - 1;
+
+    return true;
+}
+
+/**
+ * Add a dictionary word to an anagram class.
+ *
+ * @param class The anagram class.
+ * @param word The word to add.
+ * @param length The length of the word.
+ * @return true if the word was added successfully, false otherwise.
+ */
+static bool class_add_word(AnagramClass *class, const char *word, size_t length) {
+    if (class->word_count == class->capacity) {
+        size_t capacity = class->capacity + CHUNK_SIZE;
+        char **words = realloc(class->words, capacity * sizeof(char *));
+        if (!words) {
+            return false;
+        }
+        class->words = words;
+        class->capacity = capacity;
+    }
+    char *copy = strndup(word, length);
+    if (!copy) {
+        return false;
+    }
+    class->words[class->word_count++] = copy;
+
+    return true;
+}
+
+/**
+ * Free resources associated with the class table.
+ *
+ * @param table The class table.
+ */
+static void ct_destroy(ClassTable *table) {
+    for (size_t i = 0; i < table->class_count; i++) {
+        for (size_t j = 0; j < table->classes[i].word_count; j++) {
+            free(table->classes[i].words[j]);
+        }
+        free(table->classes[i].words);
+        free(table->classes[i].signature);
+    }
+    free(table->classes);
+    free(table->slots);
+}
+
+/**
+ * Find the anagrams of all the query words in the dictionary, reading the dictionary only once.
+ *
+ * @param dictionary_reader The reader of the dictionary file.
+ * @param query_reader The reader of the file with the query words, one per line.
  * @return The program exit status.
  */
-int main(int argc, char *argv[]) {
-    // Validate the number of command line arguments
-    if (argc < 3) {
-        fprintf(stderr, "Usage: anagram: [DICTIONARY] [WORD]\n"
-                        "Find all anagrams of [WORD] in the [DICTIONARY].\n");
-        return EXIT_FAILURE;
+static int search_batch(PpReader *dictionary_reader, PpReader *query_reader) {
+    int exit_status = EXIT_SUCCESS;
+    ClassTable table = {0};
+    Query *queries = NULL;
+    size_t query_count = 0;
+    size_t query_capacity = 0;
+    char *line = NULL;
+    size_t n = 0;
+    ssize_t line_length;
+    char *signature = NULL;
+    size_t signature_capacity = 0;
+
+    // Read the queries and add their signatures to the class table
+    stats_phase("queries");
+    while ((line_length = pp_reader_getline(query_reader, &line, &n)) != -1) {
+        stats_add_bytes(line_length);
+        stats_add_records(1);
+        line_length = (ssize_t) strip_new_line(line, line_length);
+        if (signature_capacity < n) {
+            signature_capacity = n;
+            free(signature);
+            signature = malloc(signature_capacity);
+            if (!signature) {
+                goto out_of_memory;
+            }
+        }
+        if (query_count == query_capacity) {
+            query_capacity += CHUNK_SIZE + query_capacity / 2;
+            Query *extended = realloc(queries, query_capacity * sizeof(Query));
+            if (!extended) {
+                goto out_of_memory;
+            }
+            queries = extended;
+        }
+        ss_calculate(line, line_length, signature);
+        Query query = {.word = strndup(line, line_length)};
+        if (!query.word || !ct_add(&table, signature, line_length, &query.class_index)) {
+            free(query.word);
+            goto out_of_memory;
+        }
+        queries[query_count++] = query;
+    }
+    if (query_reader->status != PP_OK) {
+        fprintf(stderr, "Unable to read the queries: %s.\n", pp_status_message(query_reader->status));
+        exit_status = EXIT_FAILURE;
+        goto cleanup;
     }
 
-    // Open the input file
-    FILE *file = fopen(argv[1], "r");
-    if (file == NULL) {
-        fprintf(stderr, "Unable to open input file %s.\n", argv[1]);
-        return EXIT_FAILURE;
+    // Read the dictionary once, and add each word to its class if it is queried
+    stats_phase("dictionary");
+    if (table.class_count > 0) {
+        while ((line_length = pp_reader_getline(dictionary_reader, &line, &n)) != -1) {
+            stats_add_bytes(line_length);
+            stats_add_records(1);
+            line_length = (ssize_t) strip_new_line(line, line_length);
+            if (signature_capacity < n) {
+                signature_capacity = n;
+                free(signature);
+                signature = malloc(signature_capacity);
+                if (!signature) {
+                    goto out_of_memory;
+                }
+            }
+            AnagramClass *class = ct_lookup(&table, line, line_length, signature);
+            if (class && !class_add_word(class, line, line_length)) {
+                goto out_of_memory;
+            }
+        }
+        if (dictionary_reader->status != PP_OK) {
+            fprintf(stderr, "Unable to read the dictionary: %s.\n", pp_status_message(dictionary_reader->status));
+            exit_status = EXIT_FAILURE;
+            goto cleanup;
+        }
     }
 
+    // Print the anagrams grouped per query
+    stats_phase("write");
+    stats_add_records(query_count);
+    for (size_t i = 0; i < query_count; i++) {
+        const AnagramClass *class = &table.classes[queries[i].class_index];
+        fputs(queries[i].word, stdout);
+        putchar(':');
+        for (size_t j = 0; j < class->word_count; j++) {
+            if (strcmp(class->words[j], queries[i].word) != 0) {
+                putchar(' ');
+                fputs(class->words[j], stdout);
+            }
+        }
+        putchar('\n');
+    }
+    goto cleanup;
+
+out_of_memory:
+    fprintf(stderr, "Out of memory.\n");
+    exit_status = EXIT_FAILURE;
+cleanup:
+    for (size_t i = 0; i < query_count; i++) {
+        free(queries[i].word);
+    }
+    free(queries);
+    ct_destroy(&table);
+    free(signature);
+    free(line);
+
+    return exit_status;
+}
+
+/**
+ * Find the anagrams of a single word in the dictionary.
+ *
+ * @param reader The reader of the dictionary file.
+ * @param word The word to search the anagrams for.
+ * @return The program exit status.
+ */
+static int search_word(PpReader *reader, const char *word) {
     // Calculate the signature of the input
-    size_t signature_length = strlen(argv[2]);
+    size_t signature_length = strlen(word);
     char signature[signature_length + 1];
-    ss_calculate(argv[2], signature_length, signature);
+    ss_calculate(word, signature_length, signature);
     // Buffer to hold the target signature
     char target_signature[signature_length + 1];
     // Read the dictionary
     char *line = NULL;
     size_t n = 0;
     ssize_t line_length;
-    while ((line_length = getline(&line, &n, file)) != -1) {
-        // Strip new line if it exists
-        if (line[line_length - 1] == '\n') {
-            line[line_length - 1] = '\0';
-            line_length--;
-        }
+    stats_phase("dictionary");
+    while ((line_length = pp_reader_getline(reader, &line, &n)) != -1) {
+        stats_add_bytes(line_length);
+        stats_add_records(1);
+        line_length = (ssize_t) strip_new_line(line, line_length);
         // Check if signatures match
         if (signature_length == line_length) {
             ss_calculate(line, line_length, target_signature);
             if (strncmp(signature, target_signature, signature_length) == 0 &&
-                strncmp(argv[2], line, signature_length) != 0) {
+                strncmp(word, line, signature_length) != 0) {
                 puts(line);
             }
         }
     }
-
     free(line);
-    fclose(file);
+    if (reader->status != PP_OK) {
+        fprintf(stderr, "Unable to read the dictionary: %s.\n", pp_status_message(reader->status));
+        return EXIT_FAILURE;
+    }
 
     return EXIT_SUCCESS;
 }
+
+/**
+ * Find the newlines of a block with scalar compares.
+ *
+ * @param block The block of SCAN_BLOCK_SIZE bytes.
+ * @return The mask of the newlines of the block, with bit i set if byte i is a newline.
+ */
+static uint64_t newline_mask_scalar(const char *block) {
+    uint64_t mask = 0;
+    for (size_t i = 0; i < SCAN_BLOCK_SIZE; i++) {
+        mask |= (uint64_t) (block[i] == '\n') << i;
+    }
+
+    return mask;
+}
+
+#if defined(__SSE2__)
+/**
+ * Find the newlines of a block with four 16-byte SSE2 compares.
+ *
+ * @param block The block of SCAN_BLOCK_SIZE bytes.
+ * @return The mask of the newlines of the block, with bit i set if byte i is a newline.
+ */
+static uint64_t newline_mask_sse2(const char *block) {
+    __m128i newline = _mm_set1_epi8('\n');
+    uint64_t mask = 0;
+    for (size_t i = 0; i < SCAN_BLOCK_SIZE; i += 16) {
+        __m128i bytes = _mm_loadu_si128((const __m128i *) (block + i));
+        mask |= (uint64_t) (uint16_t) _mm_movemask_epi8(_mm_cmpeq_epi8(bytes, newline)) << i;
+    }
+
+    return mask;
+}
+
+/**
+ * Find the newlines of a block with two 32-byte AVX2 compares. It is only called if the processor supports AVX2.
+ *
+ * @param block The block of SCAN_BLOCK_SIZE bytes.
+ * @return The mask of the newlines of the block, with bit i set if byte i is a newline.
+ */
+__attribute__((target("avx2")))
+static uint64_t newline_mask_avx2(const char *block) {
+    __m256i newline = _mm256_set1_epi8('\n');
+    __m256i low = _mm256_loadu_si256((const __m256i *) block);
+    __m256i high = _mm256_loadu_si256((const __m256i *) (block + 32));
+    uint32_t low_mask = (uint32_t) _mm256_movemask_epi8(_mm256_cmpeq_epi8(low, newline));
+    uint32_t high_mask = (uint32_t) _mm256_movemask_epi8(_mm256_cmpeq_epi8(high, newline));
+
+    return (uint64_t) high_mask << 32 | low_mask;
+}
+#endif
+
+/**
+ * Check a dictionary line against the query word, and print it if it is an anagram of the word other than the word
+ * itself. Only the lines of the same length as the word are looked at. Their letters are taken from a copy of the
+ * histogram of the word, so most of them are rejected at the first letter that the word does not have left, and a line
+ * that takes all of its letters has the same histogram as the word, as both have the same length.
+ *
+ * @param query The query.
+ * @param line The line, without its newline.
+ * @param length The length of the line.
+ */
+static void check_line(const WordQuery *query, const char *line, size_t length) {
+    if (length != query->length) {
+        return;
+    }
+    bool anagram;
+    if (query->use_histogram) {
+        SsHistogram remaining = query->histogram;
+        anagram = true;
+        for (size_t i = 0; i < length && anagram; i++) {
+            unsigned letter = (unsigned char) line[i] - 'a';
+            anagram = letter < SS_HISTOGRAM_LETTERS && remaining.counts[letter]-- > 0;
+        }
+    } else {
+        ss_calculate(line, length, query->candidate_signature);
+        anagram = memcmp(query->signature, query->candidate_signature, length) == 0;
+    }
+    if (anagram && memcmp(query->word, line, length) != 0) {
+        fwrite(line, 1, length, stdout);
+        putchar('\n');
+    }
+}
+
+/**
+ * Find the anagrams of a single word in a memory mapped dictionary. The dictionary is scanned in blocks, whose
+ * newlines are found with the widest vector compares that the processor supports, and the lines are checked in place.
+ *
+ * @param file The dictionary file.
+ * @param word The word to search the anagrams for.
+ * @param exit_status Pointer to where the program exit status will be written to.
+ * @return true if the dictionary was searched, false if it cannot be mapped and must be read line by line.
+ */
+static bool search_word_mapped(FILE *file, const char *word, int *exit_status) {
+    struct stat st;
+    if (fstat(fileno(file), &st) != 0 || !S_ISREG(st.st_mode) || st.st_size == 0) {
+        return false;
+    }
+    size_t size = (size_t) st.st_size;
+    const char *map = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fileno(file), 0);
+    if (map == MAP_FAILED) {
+        return false;
+    }
+    madvise((void *) map, size, MADV_SEQUENTIAL);
+
+    // Prepare the query, which is compared by histogram unless it has other characters than the lowercase letters
+    size_t length = strlen(word);
+    char signature[length + 1];
+    char candidate_signature[length + 1];
+    WordQuery query = {.word = word, .length = length, .signature = signature,
+                       .candidate_signature = candidate_signature};
+    query.use_histogram = ss_histogram(word, length, &query.histogram);
+    ss_calculate(word, length, signature);
+
+    uint64_t (*newline_mask)(const char *block) = newline_mask_scalar;
+#if defined(__SSE2__)
+    newline_mask = __builtin_cpu_supports("avx2") ? newline_mask_avx2 : newline_mask_sse2;
+#endif
+
+    // Scan the whole blocks in place, and the last partial block from a padded copy
+    stats_phase("dictionary");
+    uint64_t line_count = 0;
+    size_t line_start = 0;
+    for (size_t block = 0; block < size; block += SCAN_BLOCK_SIZE) {
+        uint64_t mask;
+        if (size - block >= SCAN_BLOCK_SIZE) {
+            mask = newline_mask(map + block);
+        } else {
+            char tail[SCAN_BLOCK_SIZE] = {0};
+            memcpy(tail, map + block, size - block);
+            mask = newline_mask(tail);
+        }
+        line_count += __builtin_popcountll(mask);
+        for (; mask != 0; mask &= mask - 1) {
+            size_t line_end = block + __builtin_ctzll(mask);
+            check_line(&query, map + line_start, line_end - line_start);
+            line_start = line_end + 1;
+        }
+    }
+    // The last line may have no newline
+    if (line_start < size) {
+        line_count++;
+        check_line(&query, map + line_start, size - line_start);
+    }
+    stats_add_bytes(size);
+    stats_add_records(line_count);
+    munmap((void *) map, size);
+    *exit_status = EXIT_SUCCESS;
+
+    return true;
+}
+
+/**
+ * The main entry point of the program. It takes 2 required command line arguments: The dictionary file and the word we
+ * want to search the anagram for. In batch mode, the word is not needed.
+ *
+ * @param argc The number of command line arguments.
+ * @param argv The command line arguments.
+ * @return The program exit status.
+ */
+int main(int argc, char *argv[]) {
+    // Parse the command line arguments
+    if (!parse_arguments(argc, argv)) {
+        if (help_flag) {
+            print_usage();
+            return EXIT_SUCCESS;
+        } else {
+            return EXIT_FAILURE;
+        }
+    }
+
+    // Open the input file, whose reader starts reading it while the queries are read
+    FILE *file = fopen(dictionary, "r");
+    if (file == NULL) {
+        fprintf(stderr, "Unable to open input file %s.\n", dictionary);
+        return EXIT_FAILURE;
+    }
+    int exit_status;
+    if (!batch_flag && !stream_flag && search_word_mapped(file, word, &exit_status)) {
+        fclose(file);
+        stats_report();
+        return exit_status;
+    }
+    PpReader reader;
+    PpStatus status = pp_reader_open(&reader, fileno(file), PP_READER_AUTO);
+    if (status != PP_OK) {
+        fprintf(stderr, "Unable to read input file %s: %s.\n", dictionary, pp_status_message(status));
+        fclose(file);
+        return EXIT_FAILURE;
+    }
+
+    if (batch_flag) {
+        // Open the query file
+        FILE *query_file = batch_input ? fopen(batch_input, "r") : stdin;
+        PpReader query_reader;
+        status = query_file ? pp_reader_open(&query_reader, fileno(query_file), PP_READER_AUTO) : PP_ERROR_IO;
+        if (status != PP_OK) {
+            fprintf(stderr, "Unable to open query file %s.\n", batch_input ? batch_input : "(standard input)");
+            if (query_file && query_file != stdin) {
+                fclose(query_file);
+            }
+            pp_reader_close(&reader);
+            fclose(file);
+            return EXIT_FAILURE;
+        }
+        exit_status = search_batch(&reader, &query_reader);
+        pp_reader_close(&query_reader);
+        if (query_file != stdin) {
+            fclose(query_file);
+        }
+    } else {
+        exit_status = search_word(&reader, word);
+    }
+
+    pp_reader_close(&reader);
+    fclose(file);
+    stats_report();
+
+    return exit_status;
+}
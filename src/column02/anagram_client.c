@@ -0,0 +1,393 @@
+/**
+ * This program is a load generator for the anagram query server. It opens a number of connections to the server, each
+ * from its own thread, and sends queries taken from a file in turn. Each connection waits for the answer of a query
+ * before it sends the next one, and the latency of each query is recorded. At the end, the throughput in queries per
+ * second and the latency percentiles are reported.
+ *
+ * This is a solution for problem 1.
+ */
+#include <errno.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <getopt.h>
+#include <pthread.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "compare.h"
+#include "reader.h"
+#include "stats.h"
+
+// The maximum number of connections
+#define MAX_CONNECTIONS 1024
+// The size of the answer buffer
+#define ANSWER_BUFFER_SIZE 65536
+// The number of queries by which the query array will be extended, if there is no space left
+#define CHUNK_SIZE 1024
+
+/**
+ * The work of a connection thread.
+ */
+typedef struct {
+    /** The thread */
+    pthread_t thread;
+    /** The index of the first query to send */
+    size_t first_query;
+    /** The number of queries to send */
+    size_t query_count;
+    /** The latency of each query in nanoseconds */
+    uint64_t *latencies;
+    /** The number of answered queries */
+    size_t answered;
+    /** true if the connection failed */
+    bool failed;
+} ConnectionTask;
+
+// The help flag
+static bool help_flag = false;
+// The number of connections
+static size_t connection_count = 1;
+// The total number of queries to send
+static size_t total_queries = 0;
+// The socket path
+static char *socket_path = NULL;
+// The query file
+static char *query_path = NULL;
+// The query words, each followed by a new line
+static char **queries = NULL;
+// The length of each query, including the new line
+static size_t *query_lengths = NULL;
+// The number of query words
+static size_t query_word_count = 0;
+
+/**
+ * Parse the command line arguments.
+ *
+ * @param argc The number of command line arguments.
+ * @param argv The command line arguments.
+ * @return true if the parsing was successful, false otherwise.
+ */
+bool parse_arguments(int argc, char *argv[]) {
+    static struct option long_options[] = {
+        {"connections", required_argument, 0, 'c'},
+        {"requests", required_argument, 0, 'n'},
+        {"help", no_argument, 0, 'h'},
+        STATS_LONG_OPTION,
+        {0, 0, 0, 0}
+    };
+
+    // Parse options
+    int c;
+    char *end_ptr = NULL;
+    int option_index = 0;
+    while (true) {
+        c = getopt_long(argc, argv, "hc:n:", long_options, &option_index);
+        if (c == -1) {
+            break;
+        }
+        switch (c) {
+            case 'c':
+                errno = 0;
+                connection_count = strtoul(optarg, &end_ptr, 10);
+                if (end_ptr == optarg || errno != 0 || connection_count == 0 || connection_count > MAX_CONNECTIONS) {
+                    fprintf(stderr, "Invalid value for the connections argument: %s.\n", optarg);
+                    return false;
+                }
+                break;
+            case 'n':
+                errno = 0;
+                total_queries = strtoul(optarg, &end_ptr, 10);
+                if (end_ptr == optarg || errno != 0) {
+                    fprintf(stderr, "Invalid value for the requests argument: %s.\n", optarg);
+                    return false;
+                }
+                break;
+            case STATS_OPTION:
+                if (!stats_enable(optarg)) {
+                    return false;
+                }
+                break;
+            case 'h':
+                help_flag = true;
+                return false;
+            default:
+                return false;
+        }
+    }
+
+    // Parse the remaining arguments
+    if (optind + 2 > argc) {
+        fprintf(stderr, "A socket path and a query file must be provided.\n");
+        return false;
+    }
+    socket_path = argv[optind];
+    query_path = argv[optind + 1];
+
+    return true;
+}
+
+/**
+ * Prints usage instructions for the program.
+ */
+void print_usage() {
+    printf("Usage: anagram_client [OPTION]... [SOCKET] [QUERIES]\n\n"
+           "Send the words of the [QUERIES] file, one per line, to the anagram server listening on the Unix domain\n"
+           "socket [SOCKET], and report the throughput and the latency of the queries.\n\n"
+           "Mandatory arguments to long options are mandatory for short options too.\n"
+           "    -c, --connections=COUNT The number of concurrent connections, default is 1.\n"
+           "    -n, --requests=COUNT    The total number of queries to send, default is the number of words in the\n"
+           "                                query file. The words are sent again from the start if needed.\n"
+           STATS_USAGE
+           "    -h, --help              Display this help and exit.\n");
+}
+
+/**
+ * Read the query words.
+ *
+ * @return true if the queries were read successfully, false otherwise.
+ */
+static bool read_queries() {
+    FILE *file = fopen(query_path, "r");
+    if (!file) {
+        return false;
+    }
+    PpReader reader;
+    if (pp_reader_open(&reader, fileno(file), PP_READER_AUTO) != PP_OK) {
+        fclose(file);
+        return false;
+    }
+    char *line = NULL;
+    size_t n = 0;
+    ssize_t line_length;
+    size_t capacity = 0;
+    bool ok = true;
+    while (ok && (line_length = pp_reader_getline(&reader, &line, &n)) != -1) {
+        stats_add_bytes(line_length);
+        if (line[line_length - 1] != '\n') {
+            // Add the missing new line in place of the null character
+            line[line_length++] = '\n';
+        }
+        if (query_word_count == capacity) {
+            capacity += CHUNK_SIZE;
+            char **extended_queries = realloc(queries, capacity * sizeof(char *));
+            size_t *extended_lengths = realloc(query_lengths, capacity * sizeof(size_t));
+            if (extended_queries) {
+                queries = extended_queries;
+            }
+            if (extended_lengths) {
+                query_lengths = extended_lengths;
+            }
+            if (!extended_queries || !extended_lengths) {
+                ok = false;
+                break;
+            }
+        }
+        queries[query_word_count] = strndup(line, line_length);
+        query_lengths[query_word_count] = line_length;
+        ok = queries[query_word_count++] != NULL;
+    }
+    ok = ok && reader.status == PP_OK;
+    free(line);
+    pp_reader_close(&reader);
+    fclose(file);
+    stats_add_records(query_word_count);
+
+    return ok && query_word_count > 0;
+}
+
+/**
+ * Get the current time of the monotonic clock.
+ *
+ * @return The time in nanoseconds.
+ */
+static uint64_t now() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (uint64_t) ts.tv_sec * 1000000000u + ts.tv_nsec;
+}
+
+/**
+ * Connect to the server.
+ *
+ * @return The connection socket, or -1 if the connection failed.
+ */
+static int connect_to_server() {
+    struct sockaddr_un address = {.sun_family = AF_UNIX};
+    if (strlen(socket_path) >= sizeof(address.sun_path)) {
+        return -1;
+    }
+    strcpy(address.sun_path, socket_path);
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd == -1) {
+        return -1;
+    }
+    if (connect(fd, (struct sockaddr *) &address, sizeof(address)) == -1) {
+        close(fd);
+        return -1;
+    }
+
+    return fd;
+}
+
+/**
+ * Send the queries of a connection one after the other, and record their latencies.
+ *
+ * @param arg Pointer to the connection task.
+ * @return Always NULL.
+ */
+static void *connection_worker(void *arg) {
+    ConnectionTask *task = arg;
+    int fd = connect_to_server();
+    if (fd == -1) {
+        task->failed = true;
+        return NULL;
+    }
+    char buffer[ANSWER_BUFFER_SIZE];
+    for (size_t i = 0; i < task->query_count; i++) {
+        size_t query = (task->first_query + i) % query_word_count;
+        uint64_t start = now();
+        // Send the query
+        size_t sent = 0;
+        while (sent < query_lengths[query]) {
+            ssize_t result = send(fd, queries[query] + sent, query_lengths[query] - sent, MSG_NOSIGNAL);
+            if (result == -1) {
+                task->failed = true;
+                goto done;
+            }
+            sent += result;
+        }
+        // Read until the end of the answer line
+        while (true) {
+            ssize_t received = recv(fd, buffer, sizeof(buffer), 0);
+            if (received <= 0) {
+                task->failed = true;
+                goto done;
+            }
+            if (buffer[received - 1] == '\n') {
+                break;
+            }
+        }
+        task->latencies[task->answered++] = now() - start;
+    }
+
+done:
+    close(fd);
+
+    return NULL;
+}
+
+/**
+ * Get a percentile of sorted latencies.
+ *
+ * @param latencies The sorted latencies.
+ * @param count The number of latencies.
+ * @param percentile The percentile, between 0 and 100.
+ * @return The latency in microseconds.
+ */
+static double percentile_us(const uint64_t *latencies, size_t count, double percentile) {
+    size_t index = (size_t) (percentile / 100.0 * (double) (count - 1) + 0.5);
+
+    return (double) latencies[index] / 1000.0;
+}
+
+/**
+ * The main entry point of the program. It takes 2 required command line arguments: The path of the Unix domain socket
+ * of the server and the query file.
+ *
+ * @param argc The number of command line arguments.
+ * @param argv The command line arguments.
+ * @return The program exit status.
+ */
+int main(int argc, char *argv[]) {
+    // Parse the command line arguments
+    if (!parse_arguments(argc, argv)) {
+        if (help_flag) {
+            print_usage();
+            return EXIT_SUCCESS;
+        } else {
+            return EXIT_FAILURE;
+        }
+    }
+    stats_phase("read");
+    if (!read_queries()) {
+        fprintf(stderr, "Unable to read queries from the file %s.\n", query_path);
+        return EXIT_FAILURE;
+    }
+    if (total_queries == 0) {
+        total_queries = query_word_count;
+    }
+
+    // Split the queries among the connections
+    int exit_status = EXIT_SUCCESS;
+    ConnectionTask tasks[MAX_CONNECTIONS] = {0};
+    uint64_t *latencies = malloc(total_queries * sizeof(uint64_t));
+    if (!latencies) {
+        fprintf(stderr, "Out of memory.\n");
+        exit_status = EXIT_FAILURE;
+        goto cleanup;
+    }
+    for (size_t i = 0; i < connection_count; i++) {
+        tasks[i].first_query = total_queries * i / connection_count;
+        tasks[i].query_count = total_queries * (i + 1) / connection_count - tasks[i].first_query;
+        tasks[i].latencies = latencies + tasks[i].first_query;
+    }
+
+    // Run the connections
+    stats_phase("queries");
+    uint64_t start = now();
+    size_t started = 0;
+    for (; started < connection_count; started++) {
+        if (pthread_create(&tasks[started].thread, NULL, connection_worker, &tasks[started]) != 0) {
+            break;
+        }
+    }
+    size_t answered = 0;
+    bool failed = started < connection_count;
+    for (size_t i = 0; i < started; i++) {
+        pthread_join(tasks[i].thread, NULL);
+        failed = failed || tasks[i].failed;
+        // Gather the latencies at the start of the array
+        memmove(latencies + answered, tasks[i].latencies, tasks[i].answered * sizeof(uint64_t));
+        answered += tasks[i].answered;
+    }
+    stats_add_records(answered);
+    double elapsed = (double) (now() - start) / 1e9;
+    if (failed) {
+        fprintf(stderr, "Some connections to the server at %s failed.\n", socket_path);
+        exit_status = EXIT_FAILURE;
+    }
+
+    // Report the results
+    stats_phase("report");
+    if (answered > 0) {
+        qsort(latencies, answered, sizeof(uint64_t), compare_u_int64_t);
+        printf("connections: %zu\n"
+               "queries: %zu\n"
+               "seconds: %.3f\n"
+               "qps: %.0f\n"
+               "p50_us: %.1f\n"
+               "p99_us: %.1f\n"
+               "max_us: %.1f\n",
+               connection_count, answered, elapsed, (double) answered / elapsed,
+               percentile_us(latencies, answered, 50), percentile_us(latencies, answered, 99),
+               percentile_us(latencies, answered, 100));
+    }
+
+cleanup:
+    free(latencies);
+    for (size_t i = 0; i < query_word_count; i++) {
+        free(queries[i]);
+    }
+    free(queries);
+    free(query_lengths);
+    stats_report();
+
+    return exit_status;
+}
@@ -0,0 +1,778 @@
+/**
+ * This program is a long-running anagram query server. It loads an anagram database once, and answers queries over a
+ * Unix domain socket. A query is a line with a word, and the answer is a line with the anagrams of the word, separated
+ * by spaces. The answer line is empty if the word has no anagrams.
+ *
+ * The main thread accepts connections and hands them to a pool of worker threads in turn, through a pipe of each
+ * worker. Each worker runs its own epoll event loop over its connections, so the answers of a connection are always
+ * sent in the order of the queries.
+ *
+ * On SIGHUP, the database file and its delta segments are opened again and atomically replace the current ones, so that
+ * a database rebuilt by build_anagram_db, new delta segments or compacted segments can be served without a restart.
+ * Queries that are being answered keep using the previous database, which is closed when the last of them finishes. On
+ * SIGINT or SIGTERM the server stops.
+ *
+ * This is a solution for problem 1.
+ */
+#define _GNU_SOURCE
+
+#include <errno.h>
+#include <signal.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <fcntl.h>
+#include <getopt.h>
+#include <pthread.h>
+#include <sys/epoll.h>
+#include <sys/signalfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "anagramdb.h"
+#include "stats.h"
+#include "stringsig.h"
+
+// The maximum number of worker threads
+#define MAX_WORKERS 256
+// The maximum number of events that are handled in one iteration of an event loop
+#define MAX_EVENTS 64
+// The maximum length of a query line
+#define MAX_LINE_LENGTH 65536
+// The size of the blocks in which the connection buffers grow
+#define BUFFER_BLOCK_SIZE 4096
+// The size of the unsent answers above which the queries of a connection are not read until the client reads them
+#define MAX_OUTPUT_SIZE (1024 * 1024)
+// The number of pending connections of the listening socket
+#define LISTEN_BACKLOG 128
+
+/**
+ * A reference counted database, with its delta segments. It is closed when the last reference is released.
+ */
+typedef struct {
+    /** The database segments */
+    AdbSegmentSet set;
+    /** The number of references */
+    size_t references;
+} SharedDb;
+
+/**
+ * A growable byte buffer.
+ */
+typedef struct {
+    /** The data */
+    char *data;
+    /** The number of bytes in the buffer */
+    size_t size;
+    /** The capacity of the buffer */
+    size_t capacity;
+} Buffer;
+
+/**
+ * A client connection.
+ */
+typedef struct Connection {
+    /** The previous connection of the worker */
+    struct Connection *previous;
+    /** The next connection of the worker */
+    struct Connection *next;
+    /** The connection socket */
+    int fd;
+    /** The bytes that have been received but do not form a complete line yet */
+    Buffer input;
+    /** The answers that have not been sent yet */
+    Buffer output;
+    /** The number of bytes of the output buffer that have been sent */
+    size_t sent;
+    /** The events that the socket is registered for in the epoll instance of the worker */
+    uint32_t events;
+    /** true if the client has closed its side of the connection, so no more queries are read */
+    bool input_closed;
+} Connection;
+
+/**
+ * A worker thread.
+ */
+typedef struct {
+    /** The thread */
+    pthread_t thread;
+    /** The epoll instance of the worker */
+    int epoll_fd;
+    /** The pipe through which the worker receives new connections. Closing it stops the worker. */
+    int pipe_fds[2];
+    /** The connections of the worker */
+    Connection *connections;
+    /** Buffer for the query signatures */
+    char *signature;
+    /** The capacity of the signature buffer */
+    size_t signature_capacity;
+    /** The number of bytes received by the worker, which are added to the statistics when it stops */
+    uint64_t byte_count;
+    /** The number of queries answered by the worker */
+    uint64_t query_count;
+} Worker;
+
+// The help flag
+static bool help_flag = false;
+// The number of worker threads
+static size_t worker_count = 4;
+// The database file
+static char *db_path = NULL;
+// The socket path
+static char *socket_path = NULL;
+// The current database
+static SharedDb *current_db = NULL;
+// The lock that protects the current database and the reference counts
+static pthread_mutex_t db_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/**
+ * Parse the command line arguments.
+ *
+ * @param argc The number of command line arguments.
+ * @param argv The command line arguments.
+ * @return true if the parsing was successful, false otherwise.
+ */
+bool parse_arguments(int argc, char *argv[]) {
+    static struct option long_options[] = {
+        {"workers", required_argument, 0, 'w'},
+        {"help", no_argument, 0, 'h'},
+        STATS_LONG_OPTION,
+        {0, 0, 0, 0}
+    };
+
+    // Parse options
+    int c;
+    char *end_ptr = NULL;
+    int option_index = 0;
+    while (true) {
+        c = getopt_long(argc, argv, "hw:", long_options, &option_index);
+        if (c == -1) {
+            break;
+        }
+        switch (c) {
+            case 'w':
+                errno = 0;
+                worker_count = strtoul(optarg, &end_ptr, 10);
+                if (end_ptr == optarg || errno != 0 || worker_count == 0 || worker_count > MAX_WORKERS) {
+                    fprintf(stderr, "Invalid value for the workers argument: %s.\n", optarg);
+                    return false;
+                }
+                break;
+            case STATS_OPTION:
+                if (!stats_enable(optarg)) {
+                    return false;
+                }
+                break;
+            case 'h':
+                help_flag = true;
+                return false;
+            default:
+                return false;
+        }
+    }
+
+    // Parse the remaining arguments
+    if (optind + 2 > argc) {
+        fprintf(stderr, "An anagram database and a socket path must be provided.\n");
+        return false;
+    }
+    db_path = argv[optind];
+    socket_path = argv[optind + 1];
+
+    return true;
+}
+
+/**
+ * Prints usage instructions for the program.
+ */
+void print_usage() {
+    printf("Usage: anagram_server [OPTION]... [ANAGRAM_DB] [SOCKET]\n\n"
+           "Load the anagram database file [ANAGRAM_DB] and answer queries on the Unix domain socket [SOCKET]. Each\n"
+           "query is a line with a word, and it is answered with a line with its anagrams, separated by spaces.\n"
+           "Send SIGHUP to reload the database file.\n\n"
+           "Mandatory arguments to long options are mandatory for short options too.\n"
+           "    -w, --workers=WORKERS   The number of worker threads, default is 4.\n"
+           STATS_USAGE
+           "    -h, --help              Display this help and exit.\n");
+}
+
+/**
+ * Open the database file as a shared database.
+ *
+ * @return The shared database, with one reference, or NULL if it could not be opened.
+ */
+static SharedDb *open_shared_db() {
+    SharedDb *shared = malloc(sizeof(SharedDb));
+    if (!shared) {
+        return NULL;
+    }
+    if (!adb_set_open(&shared->set, db_path)) {
+        free(shared);
+        return NULL;
+    }
+    shared->references = 1;
+
+    return shared;
+}
+
+/**
+ * Get a reference to the current database.
+ *
+ * @return The current database.
+ */
+static SharedDb *acquire_db() {
+    pthread_mutex_lock(&db_lock);
+    SharedDb *shared = current_db;
+    shared->references++;
+    pthread_mutex_unlock(&db_lock);
+
+    return shared;
+}
+
+/**
+ * Release a reference to a database, and close it if it was the last one.
+ *
+ * @param shared The database.
+ */
+static void release_db(SharedDb *shared) {
+    pthread_mutex_lock(&db_lock);
+    bool last = --shared->references == 0;
+    pthread_mutex_unlock(&db_lock);
+    if (last) {
+        adb_set_close(&shared->set);
+        free(shared);
+    }
+}
+
+/**
+ * Open the database file again and make it the current database.
+ */
+static void reload_db() {
+    SharedDb *shared = open_shared_db();
+    if (!shared) {
+        fprintf(stderr, "Unable to reload database file %s, the current database is kept.\n", db_path);
+        return;
+    }
+    pthread_mutex_lock(&db_lock);
+    SharedDb *previous = current_db;
+    current_db = shared;
+    pthread_mutex_unlock(&db_lock);
+    release_db(previous);
+    fprintf(stderr, "Reloaded database file %s.\n", db_path);
+}
+
+/**
+ * Make sure that a buffer can hold more bytes.
+ *
+ * @param buffer The buffer.
+ * @param size The number of bytes that must fit in the buffer, in addition to its current contents.
+ * @return true if the buffer has enough capacity, false otherwise.
+ */
+static bool buffer_reserve(Buffer *buffer, size_t size) {
+    if (buffer->capacity - buffer->size >= size) {
+        return true;
+    }
+    size_t capacity = buffer->capacity * 2;
+    if (capacity < buffer->size + size) {
+        capacity = (buffer->size + size + BUFFER_BLOCK_SIZE - 1) / BUFFER_BLOCK_SIZE * BUFFER_BLOCK_SIZE;
+    }
+    char *data = realloc(buffer->data, capacity);
+    if (!data) {
+        return false;
+    }
+    buffer->data = data;
+    buffer->capacity = capacity;
+
+    return true;
+}
+
+/**
+ * Append bytes to a buffer.
+ *
+ * @param buffer The buffer.
+ * @param data The bytes to append.
+ * @param size The number of bytes.
+ * @return true if the bytes were appended successfully, false otherwise.
+ */
+static bool buffer_append(Buffer *buffer, const char *data, size_t size) {
+    if (!buffer_reserve(buffer, size)) {
+        return false;
+    }
+    memcpy(buffer->data + buffer->size, data, size);
+    buffer->size += size;
+
+    return true;
+}
+
+/**
+ * Start serving a new connection.
+ *
+ * @param worker The worker that serves the connection.
+ * @param fd The connection socket.
+ */
+static void open_connection(Worker *worker, int fd) {
+    Connection *connection = calloc(1, sizeof(Connection));
+    if (!connection) {
+        close(fd);
+        return;
+    }
+    connection->fd = fd;
+    connection->events = EPOLLIN | EPOLLRDHUP;
+    struct epoll_event event = {.events = connection->events, .data.ptr = connection};
+    if (epoll_ctl(worker->epoll_fd, EPOLL_CTL_ADD, fd, &event) == -1) {
+        close(fd);
+        free(connection);
+        return;
+    }
+    connection->next = worker->connections;
+    if (worker->connections) {
+        worker->connections->previous = connection;
+    }
+    worker->connections = connection;
+}
+
+/**
+ * Close a connection and free its resources.
+ *
+ * @param worker The worker that serves the connection.
+ * @param connection The connection.
+ */
+static void close_connection(Worker *worker, Connection *connection) {
+    if (connection->previous) {
+        connection->previous->next = connection->next;
+    } else {
+        worker->connections = connection->next;
+    }
+    if (connection->next) {
+        connection->next->previous = connection->previous;
+    }
+    epoll_ctl(worker->epoll_fd, EPOLL_CTL_DEL, connection->fd, NULL);
+    close(connection->fd);
+    free(connection->input.data);
+    free(connection->output.data);
+    free(connection);
+}
+
+/**
+ * The state of the answer to a query, while the anagrams are appended to it.
+ */
+typedef struct {
+    /** The connection */
+    Connection *connection;
+    /** The query word */
+    const char *word;
+    /** The length of the query word */
+    size_t length;
+    /** true if no anagram has been appended yet */
+    bool first;
+    /** false if an anagram could not be appended */
+    bool ok;
+} Answer;
+
+/**
+ * Append an anagram to the answer, unless it is the query word.
+ *
+ * @param anagram The anagram.
+ * @param length The length of the anagram.
+ * @param context Pointer to the answer.
+ * @return true if the anagram was appended successfully, false otherwise.
+ */
+static bool append_anagram(const char *anagram, size_t length, void *context) {
+    Answer *answer = context;
+    if (memcmp(anagram, answer->word, length) == 0) {
+        return true;
+    }
+    if ((!answer->first && !buffer_append(&answer->connection->output, " ", 1)) ||
+        !buffer_append(&answer->connection->output, anagram, length)) {
+        answer->ok = false;
+        return false;
+    }
+    answer->first = false;
+
+    return true;
+}
+
+/**
+ * Answer a query, and append the answer to the output buffer of the connection.
+ *
+ * @param worker The worker that answers the query.
+ * @param set The database segments.
+ * @param connection The connection.
+ * @param word The query word.
+ * @param length The length of the query word.
+ * @return true if the answer was appended successfully, false otherwise.
+ */
+static bool answer_query(Worker *worker, const AdbSegmentSet *set, Connection *connection, const char *word,
+                         size_t length) {
+    if (worker->signature_capacity < length + 1) {
+        char *signature = realloc(worker->signature, length + 1);
+        if (!signature) {
+            return false;
+        }
+        worker->signature = signature;
+        worker->signature_capacity = length + 1;
+    }
+    ss_calculate(word, length, worker->signature);
+
+    Answer answer = {.connection = connection, .word = word, .length = length, .first = true, .ok = true};
+    adb_set_lookup(set, worker->signature, length, append_anagram, &answer);
+
+    return answer.ok && buffer_append(&connection->output, "\n", 1);
+}
+
+/**
+ * Send as much of the output buffer of the connection as the socket accepts. Once the client has closed its side of
+ * the connection, the connection is kept until all the answers have been sent.
+ *
+ * @param worker The worker of the connection.
+ * @param connection The connection.
+ * @return true if the connection is still usable, false if it must be closed.
+ */
+static bool flush_output(Worker *worker, Connection *connection) {
+    while (connection->sent < connection->output.size) {
+        ssize_t sent = send(connection->fd, connection->output.data + connection->sent,
+                            connection->output.size - connection->sent, MSG_NOSIGNAL);
+        if (sent == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                return false;
+            }
+            break;
+        }
+        connection->sent += sent;
+    }
+    if (connection->sent == connection->output.size) {
+        connection->output.size = 0;
+        connection->sent = 0;
+    }
+
+    bool waiting_output = connection->output.size > 0;
+    if (connection->input_closed && !waiting_output) {
+        return false;
+    }
+
+    // Wait for the socket to become writable only while there is pending output, and for queries until the client
+    // closes its side, as the end of the input would be reported again and again. The queries are not read while the
+    // client does not read the answers, so the output buffer stays bounded.
+    bool reading = !connection->input_closed && connection->output.size <= MAX_OUTPUT_SIZE;
+    uint32_t events = (reading ? EPOLLIN | EPOLLRDHUP : 0) | (waiting_output ? EPOLLOUT : 0);
+    if (events != connection->events) {
+        struct epoll_event event = {.events = events, .data.ptr = connection};
+        if (epoll_ctl(worker->epoll_fd, EPOLL_CTL_MOD, connection->fd, &event) == -1) {
+            return false;
+        }
+        connection->events = events;
+    }
+
+    return true;
+}
+
+/**
+ * Answer all the complete query lines of the input buffer of a connection, with the same database, and keep the
+ * incomplete line for the next read.
+ *
+ * @param worker The worker of the connection.
+ * @param connection The connection.
+ * @return true if the connection is still usable, false if it must be closed.
+ */
+static bool answer_queries(Worker *worker, Connection *connection) {
+    SharedDb *shared = acquire_db();
+    char *start = connection->input.data;
+    char *end = connection->input.data + connection->input.size;
+    char *new_line;
+    bool ok = true;
+    while (ok && (new_line = memchr(start, '\n', end - start)) != NULL) {
+        size_t length = new_line - start;
+        if (length > 0 && start[length - 1] == '\r') {
+            length--;
+        }
+        ok = answer_query(worker, &shared->set, connection, start, length);
+        worker->query_count++;
+        start = new_line + 1;
+    }
+    release_db(shared);
+    connection->input.size = end - start;
+    memmove(connection->input.data, start, connection->input.size);
+
+    return ok && connection->input.size <= MAX_LINE_LENGTH;
+}
+
+/**
+ * Read the available data from a connection, and answer the complete query lines after each read. The reads stop once
+ * the unsent answers exceed MAX_OUTPUT_SIZE, until the client reads them.
+ *
+ * @param worker The worker of the connection.
+ * @param connection The connection.
+ * @return true if the connection is still usable, false if it must be closed.
+ */
+static bool handle_input(Worker *worker, Connection *connection) {
+    while (!connection->input_closed && connection->output.size <= MAX_OUTPUT_SIZE) {
+        if (!buffer_reserve(&connection->input, BUFFER_BLOCK_SIZE)) {
+            return false;
+        }
+        ssize_t received = recv(connection->fd, connection->input.data + connection->input.size,
+                                connection->input.capacity - connection->input.size, 0);
+        if (received == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                return false;
+            }
+            break;
+        }
+        if (received == 0) {
+            connection->input_closed = true;
+            break;
+        }
+        connection->input.size += received;
+        worker->byte_count += received;
+        if (!answer_queries(worker, connection)) {
+            return false;
+        }
+    }
+
+    return flush_output(worker, connection);
+}
+
+/**
+ * The event loop of a worker thread.
+ *
+ * @param arg Pointer to the worker.
+ * @return Always NULL.
+ */
+static void *worker_loop(void *arg) {
+    Worker *worker = arg;
+    struct epoll_event events[MAX_EVENTS];
+    bool running = true;
+    while (running) {
+        int event_count = epoll_wait(worker->epoll_fd, events, MAX_EVENTS, -1);
+        if (event_count == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            break;
+        }
+        for (int i = 0; i < event_count; i++) {
+            if (events[i].data.ptr == NULL) {
+                // New connections, or the end of the pipe if the server is stopping
+                int fd;
+                ssize_t received;
+                while ((received = read(worker->pipe_fds[0], &fd, sizeof(fd))) == sizeof(fd)) {
+                    open_connection(worker, fd);
+                }
+                if (received == 0) {
+                    running = false;
+                }
+                continue;
+            }
+            Connection *connection = events[i].data.ptr;
+            bool ok = !(events[i].events & EPOLLERR);
+            if (ok && (events[i].events & EPOLLOUT)) {
+                ok = flush_output(worker, connection);
+            }
+            if (ok && (events[i].events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP))) {
+                ok = handle_input(worker, connection);
+            }
+            if (!ok) {
+                close_connection(worker, connection);
+            }
+        }
+    }
+    while (worker->connections) {
+        close_connection(worker, worker->connections);
+    }
+
+    return NULL;
+}
+
+/**
+ * Create the listening socket.
+ *
+ * @return The listening socket, or -1 if it could not be created.
+ */
+static int create_listening_socket() {
+    struct sockaddr_un address = {.sun_family = AF_UNIX};
+    if (strlen(socket_path) >= sizeof(address.sun_path)) {
+        fprintf(stderr, "The socket path %s is too long.\n", socket_path);
+        return -1;
+    }
+    strcpy(address.sun_path, socket_path);
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd == -1) {
+        return -1;
+    }
+    unlink(socket_path);
+    if (bind(fd, (struct sockaddr *) &address, sizeof(address)) == -1 || listen(fd, LISTEN_BACKLOG) == -1) {
+        close(fd);
+        return -1;
+    }
+
+    return fd;
+}
+
+/**
+ * Accept the pending connections, and hand them to the workers in turn.
+ *
+ * @param listen_fd The listening socket.
+ * @param workers The workers.
+ * @param next_worker Pointer to the index of the worker that gets the next connection.
+ */
+static void accept_connections(int listen_fd, Worker *workers, size_t *next_worker) {
+    while (true) {
+        int fd = accept4(listen_fd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd == -1) {
+            if (errno == EINTR || errno == ECONNABORTED) {
+                continue;
+            }
+            return;
+        }
+        Worker *worker = &workers[*next_worker];
+        *next_worker = (*next_worker + 1) % worker_count;
+        if (write(worker->pipe_fds[1], &fd, sizeof(fd)) != sizeof(fd)) {
+            close(fd);
+        }
+    }
+}
+
+/**
+ * The main entry point of the program. It takes 2 required command line arguments: The anagram database file and the
+ * path of the Unix domain socket to listen to.
+ *
+ * @param argc The number of command line arguments.
+ * @param argv The command line arguments.
+ * @return The program exit status.
+ */
+int main(int argc, char *argv[]) {
+    // Parse the command line arguments
+    if (!parse_arguments(argc, argv)) {
+        if (help_flag) {
+            print_usage();
+            return EXIT_SUCCESS;
+        } else {
+            return EXIT_FAILURE;
+        }
+    }
+
+    // Open the database file
+    stats_phase("load");
+    current_db = open_shared_db();
+    if (!current_db) {
+        fprintf(stderr, "Unable to open database file %s.\n", db_path);
+        return EXIT_FAILURE;
+    }
+
+    // Handle the signals synchronously in the event loop of the main thread. They are blocked before the workers are
+    // created, so that the workers inherit the mask.
+    int exit_status = EXIT_SUCCESS;
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGHUP);
+    sigaddset(&signals, SIGINT);
+    sigaddset(&signals, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &signals, NULL);
+    int signal_fd = signalfd(-1, &signals, SFD_NONBLOCK | SFD_CLOEXEC);
+    int listen_fd = create_listening_socket();
+    int epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    if (signal_fd == -1 || listen_fd == -1 || epoll_fd == -1) {
+        fprintf(stderr, "Unable to listen on socket %s: %s.\n", socket_path, strerror(errno));
+        exit_status = EXIT_FAILURE;
+        goto cleanup;
+    }
+    struct epoll_event listen_event = {.events = EPOLLIN, .data.fd = listen_fd};
+    struct epoll_event signal_event = {.events = EPOLLIN, .data.fd = signal_fd};
+    epoll_ctl(epoll_fd, EPOLL_CTL_ADD, listen_fd, &listen_event);
+    epoll_ctl(epoll_fd, EPOLL_CTL_ADD, signal_fd, &signal_event);
+
+    // Start the workers
+    Worker workers[MAX_WORKERS] = {0};
+    size_t started = 0;
+    for (; started < worker_count; started++) {
+        Worker *worker = &workers[started];
+        worker->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+        struct epoll_event pipe_event = {.events = EPOLLIN, .data.ptr = NULL};
+        bool pipe_created = pipe2(worker->pipe_fds, O_NONBLOCK | O_CLOEXEC) == 0;
+        if (worker->epoll_fd == -1 || !pipe_created ||
+            epoll_ctl(worker->epoll_fd, EPOLL_CTL_ADD, worker->pipe_fds[0], &pipe_event) == -1 ||
+            pthread_create(&worker->thread, NULL, worker_loop, worker) != 0) {
+            if (worker->epoll_fd != -1) {
+                close(worker->epoll_fd);
+            }
+            if (pipe_created) {
+                close(worker->pipe_fds[0]);
+                close(worker->pipe_fds[1]);
+            }
+            fprintf(stderr, "Unable to start the worker threads.\n");
+            exit_status = EXIT_FAILURE;
+            goto stop_workers;
+        }
+    }
+
+    // Accept connections and handle signals until the server is stopped
+    stats_phase("serve");
+    size_t next_worker = 0;
+    bool running = true;
+    while (running) {
+        struct epoll_event events[MAX_EVENTS];
+        int event_count = epoll_wait(epoll_fd, events, MAX_EVENTS, -1);
+        if (event_count == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            exit_status = EXIT_FAILURE;
+            break;
+        }
+        for (int i = 0; i < event_count; i++) {
+            if (events[i].data.fd == listen_fd) {
+                accept_connections(listen_fd, workers, &next_worker);
+            } else {
+                struct signalfd_siginfo info;
+                while (read(signal_fd, &info, sizeof(info)) == sizeof(info)) {
+                    if (info.ssi_signo == SIGHUP) {
+                        stats_phase("reload");
+                        reload_db();
+                        stats_phase("serve");
+                    } else {
+                        running = false;
+                    }
+                }
+            }
+        }
+    }
+
+stop_workers:
+    // Closing the pipes stops the workers, which close their connections
+    for (size_t i = 0; i < started; i++) {
+        close(workers[i].pipe_fds[1]);
+    }
+    for (size_t i = 0; i < started; i++) {
+        pthread_join(workers[i].thread, NULL);
+        close(workers[i].pipe_fds[0]);
+        close(workers[i].epoll_fd);
+        free(workers[i].signature);
+        stats_add_bytes(workers[i].byte_count);
+        stats_add_records(workers[i].query_count);
+    }
+    unlink(socket_path);
+
+cleanup:
+    if (epoll_fd != -1) {
+        close(epoll_fd);
+    }
+    if (listen_fd != -1) {
+        close(listen_fd);
+    }
+    if (signal_fd != -1) {
+        close(signal_fd);
+    }
+    release_db(current_db);
+    stats_report();
+
+    return exit_status;
+}
@@ -0,0 +1,299 @@
+/**
+ * This program prints statistics about the anagram classes of an anagram database: the largest classes, the number of
+ * classes of each size and of each word length, and the full listing of the classes.
+ *
+ * The statistics are read from the summary section of the database, so they do not depend on the size of the database.
+ * If the database has no summary section, or more largest classes are requested than it holds, the statistics are
+ * calculated from all the entries instead. The class listing is written with large buffered writes, one line per class.
+ *
+ * This is a solution for problem 1.
+ */
+#include <errno.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <getopt.h>
+
+#include "anagramdb.h"
+#include "stats.h"
+
+// The size of the output buffer
+#define OUTPUT_BUFFER_SIZE (1024 * 1024)
+
+// The help flag
+static bool help_flag = false;
+// The number of largest classes to print
+static size_t top = 0;
+// The histogram flag
+static bool histogram_flag = false;
+// The lengths flag
+static bool lengths_flag = false;
+// The list flag
+static bool list_flag = false;
+// The word length of the listed classes, or 0 for all the classes
+static size_t list_length = 0;
+// The database file
+static char *db_path = NULL;
+
+/**
+ * Parse the command line arguments.
+ *
+ * @param argc The number of command line arguments.
+ * @param argv The command line arguments.
+ * @return true if the parsing was successful, false otherwise.
+ */
+bool parse_arguments(int argc, char *argv[]) {
+    static struct option long_options[] = {
+        {"top", required_argument, 0, 't'},
+        {"histogram", no_argument, 0, 'g'},
+        {"lengths", no_argument, 0, 'l'},
+        {"list", optional_argument, 0, 'L'},
+        {"help", no_argument, 0, 'h'},
+        STATS_LONG_OPTION,
+        {0, 0, 0, 0}
+    };
+
+    // Parse options
+    int c;
+    char *end_ptr = NULL;
+    int option_index = 0;
+    while (true) {
+        c = getopt_long(argc, argv, "hglL::t:", long_options, &option_index);
+        if (c == -1) {
+            break;
+        }
+        switch (c) {
+            case 't':
+                errno = 0;
+                top = strtoul(optarg, &end_ptr, 10);
+                if (end_ptr == optarg || errno != 0 || top == 0) {
+                    fprintf(stderr, "Invalid value for the top argument: %s.\n", optarg);
+                    return false;
+                }
+                break;
+            case 'g':
+                histogram_flag = true;
+                break;
+            case 'l':
+                lengths_flag = true;
+                break;
+            case 'L':
+                list_flag = true;
+                if (optarg) {
+                    errno = 0;
+                    list_length = strtoul(optarg, &end_ptr, 10);
+                    if (end_ptr == optarg || errno != 0 || list_length == 0) {
+                        fprintf(stderr, "Invalid value for the list argument: %s.\n", optarg);
+                        return false;
+                    }
+                }
+                break;
+            case STATS_OPTION:
+                if (!stats_enable(optarg)) {
+                    return false;
+                }
+                break;
+            case 'h':
+                help_flag = true;
+                return false;
+            default:
+                return false;
+        }
+    }
+
+    // Parse the remaining arguments
+    if (optind >= argc) {
+        fprintf(stderr, "An anagram database must be provided.\n");
+        return false;
+    }
+    db_path = argv[optind];
+
+    return true;
+}
+
+/**
+ * Prints usage instructions for the program.
+ */
+void print_usage() {
+    printf("Usage: anagram_stats [OPTION]... [ANAGRAM_DB]\n\n"
+           "Print statistics about the anagram classes of the anagram database file [ANAGRAM_DB]. Without options,\n"
+           "the totals are printed. The delta segments of the database are not included.\n\n"
+           "Mandatory arguments to long options are mandatory for short options too.\n"
+           "    -t, --top=K             Print the K largest classes, one per line, preceded by their size.\n"
+           "    -g, --histogram         Print the number of classes and words for each class size.\n"
+           "    -l, --lengths           Print the number of classes and words for each word length.\n"
+           "    -L, --list[=LENGTH]     Print all the classes, one per line, or only the classes of the words of\n"
+           "                                length LENGTH.\n"
+           STATS_USAGE
+           "    -h, --help              Display this help and exit.\n");
+}
+
+/**
+ * Print the words of an entry on a single line. The words are stored null terminated and length + 1 characters apart,
+ * so they are copied to the line buffer at once, and the null characters are replaced with separators.
+ *
+ * @param entry The entry.
+ * @param line Pointer to the line buffer.
+ * @param line_size Pointer to the size of the line buffer.
+ * @return true if the words were printed successfully, false otherwise.
+ */
+static bool print_class(const AdbEntry *entry, char **line, size_t *line_size) {
+    size_t size = (entry->length + 1) * entry->word_count;
+    if (size == 0) {
+        return true;
+    }
+    if (size > *line_size) {
+        char *extended_line = realloc(*line, size);
+        if (!extended_line) {
+            return false;
+        }
+        *line = extended_line;
+        *line_size = size;
+    }
+    memcpy(*line, entry->words, size);
+    for (size_t i = entry->length; i < size; i += entry->length + 1) {
+        (*line)[i] = ' ';
+    }
+    (*line)[size - 1] = '\n';
+    stats_add_bytes(size);
+    stats_add_records(1);
+
+    return fwrite(*line, 1, size, stdout) == size;
+}
+
+/**
+ * Print the largest classes.
+ *
+ * @param db The database.
+ * @param summary The summary of the database.
+ * @return true if the classes were printed successfully, false otherwise.
+ */
+static bool print_top(const AnagramDb *db, const AdbSummary *summary) {
+    size_t count = top < summary->header.top_count ? top : summary->header.top_count;
+    AdbEntry entry = {0};
+    char *line = NULL;
+    size_t line_size = 0;
+    bool ok = true;
+    for (size_t i = 0; i < count && ok; i++) {
+        printf("%llu: ", (unsigned long long) summary->classes[i].word_count);
+        ok = adb_entry(db, summary->classes[i].index, &entry) && print_class(&entry, &line, &line_size);
+    }
+    free(line);
+    adb_entry_free(&entry);
+
+    return ok;
+}
+
+/**
+ * Print buckets of the summary.
+ *
+ * @param title The title of the bucket key.
+ * @param buckets The buckets.
+ * @param count The number of buckets.
+ */
+static void print_buckets(const char *title, const AdbSummaryBucket *buckets, size_t count) {
+    printf("%s classes words\n", title);
+    for (size_t i = 0; i < count; i++) {
+        printf("%llu %llu %llu\n", (unsigned long long) buckets[i].key, (unsigned long long) buckets[i].class_count,
+               (unsigned long long) buckets[i].word_count);
+    }
+}
+
+/**
+ * Print all the classes, or the classes of the words of list_length characters.
+ *
+ * @param db The database.
+ * @return true if the classes were printed successfully, false otherwise.
+ */
+static bool print_list(const AnagramDb *db) {
+    AdbEntry entry = {0};
+    char *line = NULL;
+    size_t line_size = 0;
+    bool ok = true;
+    for (size_t i = 0; i < db->entry_count && ok; i++) {
+        ok = adb_entry(db, i, &entry) &&
+             ((list_length != 0 && entry.length != list_length) || print_class(&entry, &line, &line_size));
+    }
+    free(line);
+    adb_entry_free(&entry);
+
+    return ok;
+}
+
+/**
+ * The main entry point of the program. It takes 1 required command line argument: The anagram database file.
+ *
+ * @param argc The number of command line arguments.
+ * @param argv The command line arguments.
+ * @return The program exit status.
+ */
+int main(int argc, char *argv[]) {
+    // Parse the command line arguments
+    if (!parse_arguments(argc, argv)) {
+        if (help_flag) {
+            print_usage();
+            return EXIT_SUCCESS;
+        } else {
+            return EXIT_FAILURE;
+        }
+    }
+
+    // Open the database file, and read its summary
+    stats_phase("open");
+    AnagramDb db;
+    if (!adb_open(&db, db_path)) {
+        fprintf(stderr, "Unable to open database file %s.\n", db_path);
+        return EXIT_FAILURE;
+    }
+    stats_phase("summary");
+    AdbSummary summary;
+    if (!adb_summary(&db, top, &summary)) {
+        fprintf(stderr, "Unable to read the summary of the database file %s.\n", db_path);
+        adb_close(&db);
+        return EXIT_FAILURE;
+    }
+    setvbuf(stdout, NULL, _IOFBF, OUTPUT_BUFFER_SIZE);
+
+    // Print the statistics
+    stats_phase("print");
+    bool ok = true;
+    if (top == 0 && !histogram_flag && !lengths_flag && !list_flag) {
+        printf("classes: %llu\n"
+               "words: %llu\n"
+               "largest_class: %llu\n"
+               "longest_word: %llu\n",
+               (unsigned long long) summary.header.class_count, (unsigned long long) summary.header.word_count,
+               (unsigned long long) (summary.header.size_count > 0 ?
+                                     summary.sizes[summary.header.size_count - 1].key : 0),
+               (unsigned long long) (summary.header.length_count > 0 ?
+                                     summary.lengths[summary.header.length_count - 1].key : 0));
+    }
+    if (top > 0) {
+        ok = print_top(&db, &summary);
+    }
+    if (histogram_flag) {
+        print_buckets("size", summary.sizes, summary.header.size_count);
+    }
+    if (lengths_flag) {
+        print_buckets("length", summary.lengths, summary.header.length_count);
+    }
+    if (list_flag && ok) {
+        ok = print_list(&db);
+    }
+    if (fflush(stdout) != 0) {
+        ok = false;
+    }
+    if (!ok) {
+        fprintf(stderr, "Unable to print the classes of the database file %s.\n", db_path);
+    }
+
+    // Cleanup
+    adb_summary_free(&summary);
+    adb_close(&db);
+    stats_report();
+
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,2033 @@
+/**
+ * This library reads and writes anagram database files. A database maps signatures to the dictionary words that have
+ * that signature, sorted by signature.
+ *
+ * Databases of the current version are memory mapped, and a lookup is a binary search over the offset table. No part of
+ * the file is parsed or copied, so opening a database takes constant time, and a lookup only touches the pages of the
+ * offset table and of the records that the binary search visits. If the database has a hash table, a lookup usually
+ * touches a single slot and a single record instead. Legacy databases, which have no header or offset table, are loaded
+ * in memory.
+ *
+ * The rack index answers the sub-anagram queries, which find the words that can be built from a set of letters. Its
+ * groups are rejected with a single mask test, so most of the histograms are never compared.
+ *
+ * Compact databases are memory mapped as well, but their records are decoded when they are read. A lookup decodes the
+ * first signature of the blocks that the binary search visits, and then the records of a single block.
+ *
+ * The summary section holds the statistics of the anagram classes, so that they are read without reading every entry.
+ *
+ * A segment can have a Bloom filter of its signatures in a separate file, which is mapped next to it. Most lookups of
+ * signatures that are not in the segment test a single cache line of the filter and never search the segment, and the
+ * filter files of all the segments can be tested without opening the segments at all.
+ */
+#include <limits.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "anagramdb.h"
+#include "stringsig.h"
+
+// The alignment of the entry records
+#define ADB_ALIGNMENT 8
+// The size of the fixed part of an entry record
+#define ADB_RECORD_HEADER_SIZE (2 * sizeof(uint32_t))
+// The number of entries by which the entry arrays are extended, if there is no space left
+#define ADB_CHUNK_SIZE 1024
+// The size of the output buffer of the writer
+#define ADB_WRITE_BUFFER_SIZE (1024 * 1024)
+// The suffix of the temporary file of the writer
+#define ADB_TEMP_SUFFIX ".tmp"
+// The size of the header of the first files of the current version, which had no optional sections
+#define ADB_MIN_HEADER_SIZE offsetof(AdbHeader, hash_offset)
+// The number of distinct character values
+#define ADB_CHAR_VALUES (UCHAR_MAX + 1)
+// The length of the words whose signature is calculated on the stack by pp_anagram_db_lookup
+#define ADB_STACK_SIGNATURE_SIZE 256
+
+/**
+ * Read a legacy database entry from the file.
+ *
+ * @param file The file to read.
+ * @param arena The arena from which the entry memory is allocated.
+ * @param entry The entry to read.
+ * @return true if the entry was read successfully, false otherwise.
+ */
+static bool read_legacy_entry(FILE *file, Arena *arena, AdbEntry *entry) {
+    int length = fgetc(file);
+    if (length == EOF) {
+        return false;
+    }
+    entry->length = length;
+    char *signature = arena_alloc_chars(arena, entry->length + 1);
+    if (!signature) {
+        return false;
+    }
+    fgets(signature, (int) entry->length + 1, file);
+    entry->signature = signature;
+    int word_count = fgetc(file);
+    if (word_count == EOF) {
+        return false;
+    }
+    entry->word_count = word_count;
+    // The words are stored back to back in a single allocation, the same way as in the current format
+    char *words = arena_alloc_chars(arena, (entry->length + 1) * entry->word_count);
+    if (!words) {
+        return false;
+    }
+    for (size_t i = 0; i < entry->word_count; i++) {
+        fgets(words + i * (entry->length + 1), (int) entry->length + 1, file);
+    }
+    entry->words = words;
+
+    return true;
+}
+
+/**
+ * Load a legacy database in memory.
+ *
+ * @param db Pointer to the database data structure.
+ * @param path The path of the database file.
+ * @return true if the database was loaded successfully, false otherwise.
+ */
+static bool open_legacy(AnagramDb *db, const char *path) {
+    FILE *file = fopen(path, "rb");
+    if (!file) {
+        return false;
+    }
+    db->version = ADB_VERSION_LEGACY;
+    arena_init(&db->arena, 0);
+    AdbEntry entry = {0};
+    size_t capacity = 0;
+    while (read_legacy_entry(file, &db->arena, &entry)) {
+        if (db->entry_count == capacity) {
+            capacity += ADB_CHUNK_SIZE;
+            AdbEntry *entries = realloc(db->entries, capacity * sizeof(AdbEntry));
+            if (!entries) {
+                fclose(file);
+                return false;
+            }
+            db->entries = entries;
+        }
+        db->entries[db->entry_count++] = entry;
+    }
+    fclose(file);
+
+    return true;
+}
+
+/**
+ * Check if a summary section fits in the file.
+ *
+ * @param summary The header of the summary section.
+ * @param available The number of bytes from the start of the summary section to the end of the file.
+ * @return true if the summary section fits in the file, false otherwise.
+ */
+static bool summary_fits(const AdbSummaryHeader *summary, uint64_t available) {
+    if (available < sizeof(AdbSummaryHeader)) {
+        return false;
+    }
+    available -= sizeof(AdbSummaryHeader);
+    if (summary->top_count > summary->class_count || summary->top_count > available / sizeof(AdbSummaryClass)) {
+        return false;
+    }
+    available -= summary->top_count * sizeof(AdbSummaryClass);
+    if (summary->size_count > available / sizeof(AdbSummaryBucket)) {
+        return false;
+    }
+    available -= summary->size_count * sizeof(AdbSummaryBucket);
+
+    return summary->length_count <= available / sizeof(AdbSummaryBucket);
+}
+
+/**
+ * Get the identity of a file.
+ *
+ * @param st The status of the file.
+ * @param id Pointer to where the identity will be written to.
+ */
+static void file_id(const struct stat *st, AdbFileId *id) {
+    id->size = st->st_size;
+    id->inode = st->st_ino;
+    id->mtime = (int64_t) st->st_mtim.tv_sec * 1000000000 + st->st_mtim.tv_nsec;
+}
+
+/**
+ * Get the path of the Bloom filter file of a segment.
+ *
+ * @param path The path of the segment file.
+ * @return The path of the filter file, which the caller must free, or NULL if the memory could not be allocated.
+ */
+char *adb_bloom_path(const char *path) {
+    char *filter_path = malloc(strlen(path) + sizeof(ADB_BLOOM_SUFFIX));
+    if (filter_path) {
+        strcpy(filter_path, path);
+        strcat(filter_path, ADB_BLOOM_SUFFIX);
+    }
+
+    return filter_path;
+}
+
+/**
+ * Open the Bloom filter file of a segment, and validate its header.
+ *
+ * @param path The path of the segment file.
+ * @param id The identity of the segment file, which the filter must have been built for.
+ * @param header Pointer to where the header of the filter will be written to.
+ * @param size Pointer to where the size of the filter file will be written to.
+ * @return The file descriptor of the filter file, or -1 if it does not exist or it is invalid or stale.
+ */
+static int open_bloom_file(const char *path, const AdbFileId *id, AdbBloomHeader *header, size_t *size) {
+    char *filter_path = adb_bloom_path(path);
+    int fd = filter_path ? open(filter_path, O_RDONLY) : -1;
+    free(filter_path);
+    if (fd == -1) {
+        return -1;
+    }
+    struct stat st;
+    if (fstat(fd, &st) == -1 || (size_t) st.st_size < sizeof(AdbBloomHeader) ||
+        pread(fd, header, sizeof(AdbBloomHeader), 0) != sizeof(AdbBloomHeader) ||
+        memcmp(header->magic, ADB_BLOOM_MAGIC, ADB_MAGIC_SIZE) != 0 ||
+        header->header_size < sizeof(AdbBloomHeader) || header->header_size % BF_BLOCK_SIZE != 0 ||
+        header->header_size > (size_t) st.st_size || header->hash_count == 0 || header->hash_count > BF_MAX_HASHES ||
+        header->block_count == 0 || header->block_count > ((size_t) st.st_size - header->header_size) / BF_BLOCK_SIZE ||
+        memcmp(&header->segment, id, sizeof(AdbFileId)) != 0) {
+        close(fd);
+        return -1;
+    }
+    *size = st.st_size;
+
+    return fd;
+}
+
+/**
+ * Map the Bloom filter file of a database, if it has a valid one. A missing or invalid filter is not an error, as the
+ * database is searched without it.
+ *
+ * @param db Pointer to the database data structure.
+ * @param path The path of the database file.
+ */
+static void open_bloom(AnagramDb *db, const char *path) {
+    AdbBloomHeader header;
+    size_t size;
+    int fd = open_bloom_file(path, &db->file_id, &header, &size);
+    if (fd == -1) {
+        return;
+    }
+    void *map = mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        return;
+    }
+    madvise(map, size, MADV_RANDOM);
+    db->bloom_map = map;
+    db->bloom_map_size = size;
+    db->bloom_rate = header.false_positive_rate;
+    BloomFilter bloom = {
+        .bits = {(BS_UNIT *) (db->bloom_map + header.header_size), header.block_count * BF_BLOCK_BITS},
+        .block_count = header.block_count,
+        .hash_count = header.hash_count
+    };
+    db->bloom = bloom;
+}
+
+/**
+ * Open an anagram database. Its Bloom filter file is mapped as well if it exists and matches the database, so that the
+ * lookups of the signatures that are not in the database are rejected without searching it.
+ *
+ * @param db Pointer to the database data structure.
+ * @param path The path of the database file.
+ * @return true if the database was opened successfully, false otherwise.
+ */
+bool adb_open(AnagramDb *db, const char *path) {
+    memset(db, 0, sizeof(AnagramDb));
+    int fd = open(path, O_RDONLY);
+    if (fd == -1) {
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) == -1) {
+        close(fd);
+        return false;
+    }
+    file_id(&st, &db->file_id);
+
+    // Check the magic number, files without it are legacy databases
+    AdbHeader header = {0};
+    size_t header_read = (size_t) st.st_size < sizeof(AdbHeader) ? (size_t) st.st_size : sizeof(AdbHeader);
+    if (header_read < ADB_MIN_HEADER_SIZE || pread(fd, &header, header_read, 0) != (ssize_t) header_read ||
+        memcmp(header.magic, ADB_MAGIC, ADB_MAGIC_SIZE) != 0) {
+        close(fd);
+        if (!open_legacy(db, path)) {
+            adb_close(db);
+            return false;
+        }
+        open_bloom(db, path);
+        return true;
+    }
+
+    // Validate the header. The fields that were added after the header was written are absent.
+    size_t size = st.st_size;
+    if (header.header_size < sizeof(AdbHeader)) {
+        if (header.header_size < ADB_MIN_HEADER_SIZE) {
+            close(fd);
+            return false;
+        }
+        memset((char *) &header + header.header_size, 0, sizeof(AdbHeader) - header.header_size);
+    }
+    if ((header.version != ADB_VERSION && header.version != ADB_VERSION_COMPACT) || header.index_offset > size ||
+        header.index_offset % sizeof(uint64_t) != 0) {
+        close(fd);
+        return false;
+    }
+    uint64_t block_count = header.entry_count;
+    if (header.version == ADB_VERSION_COMPACT) {
+        if (header.restart_interval == 0 || header.hash_offset != 0 || header.rack_offset != 0) {
+            close(fd);
+            return false;
+        }
+        block_count = header.entry_count / header.restart_interval +
+                      (header.entry_count % header.restart_interval != 0);
+    }
+    if (block_count > (size - header.index_offset) / sizeof(uint64_t)) {
+        close(fd);
+        return false;
+    }
+    if (header.hash_offset != 0 && (header.hash_offset > size || header.hash_offset % sizeof(uint64_t) != 0 ||
+                                    header.hash_slot_count == 0 ||
+                                    (header.hash_slot_count & (header.hash_slot_count - 1)) != 0 ||
+                                    header.hash_slot_count > (size - header.hash_offset) / sizeof(AdbHashSlot))) {
+        close(fd);
+        return false;
+    }
+    if (header.rack_offset != 0 && (header.rack_offset > size || header.rack_offset % sizeof(uint64_t) != 0 ||
+                                    header.rack_group_count > (size - header.rack_offset) / sizeof(AdbRackGroup))) {
+        close(fd);
+        return false;
+    }
+
+    // Map the file
+    void *map = mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        return false;
+    }
+    madvise(map, size, MADV_RANDOM);
+    db->version = header.version;
+    db->entry_count = header.entry_count;
+    db->map = map;
+    db->map_size = size;
+    db->index = (const uint64_t *) (db->map + header.index_offset);
+    db->restart_interval = header.restart_interval;
+    db->block_count = block_count;
+    if (header.hash_offset != 0) {
+        db->hash_slots = (const AdbHashSlot *) (db->map + header.hash_offset);
+        db->hash_slot_count = header.hash_slot_count;
+    }
+    if (header.summary_offset != 0) {
+        if (header.summary_offset % sizeof(uint64_t) != 0 || header.summary_offset > size ||
+            !summary_fits((const AdbSummaryHeader *) (db->map + header.summary_offset), size - header.summary_offset)) {
+            adb_close(db);
+            return false;
+        }
+        db->summary = (const AdbSummaryHeader *) (db->map + header.summary_offset);
+    }
+    if (header.rack_offset != 0) {
+        uint64_t rack_entries_offset = header.rack_offset + header.rack_group_count * sizeof(AdbRackGroup);
+        db->rack_groups = (const AdbRackGroup *) (db->map + header.rack_offset);
+        db->rack_group_count = header.rack_group_count;
+        db->rack_entries = (const AdbRackEntry *) (db->map + rack_entries_offset);
+        db->rack_entry_count = (size - rack_entries_offset) / sizeof(AdbRackEntry);
+    }
+    open_bloom(db, path);
+
+    return true;
+}
+
+/**
+ * Close an anagram database, and free the resources associated with it.
+ *
+ * @param db Pointer to the database data structure.
+ */
+void adb_close(AnagramDb *db) {
+    if (db->map) {
+        munmap((void *) db->map, db->map_size);
+    }
+    if (db->bloom_map) {
+        munmap((void *) db->bloom_map, db->bloom_map_size);
+    }
+    free(db->entries);
+    arena_destroy(&db->arena);
+    memset(db, 0, sizeof(AnagramDb));
+}
+
+/**
+ * Read the entry record at a file offset of a memory mapped database.
+ *
+ * @param db Pointer to the database data structure.
+ * @param offset The file offset of the record.
+ * @param entry Pointer to where the entry will be written to.
+ * @return true if the entry was read successfully, false if the record is not inside the file.
+ */
+static bool entry_at_offset(const AnagramDb *db, uint64_t offset, AdbEntry *entry) {
+    if (offset > db->map_size || db->map_size - offset < ADB_RECORD_HEADER_SIZE || offset % ADB_ALIGNMENT != 0) {
+        return false;
+    }
+    const uint32_t *record = (const uint32_t *) (db->map + offset);
+    uint64_t strings_size = ((uint64_t) record[1] + 1) * ((uint64_t) record[0] + 1);
+    if (strings_size > db->map_size - offset - ADB_RECORD_HEADER_SIZE) {
+        return false;
+    }
+    entry->length = record[0];
+    entry->word_count = record[1];
+    entry->signature = db->map + offset + ADB_RECORD_HEADER_SIZE;
+    entry->words = entry->signature + entry->length + 1;
+
+    return true;
+}
+
+/**
+ * Get the distinct characters of a signature in the order in which they occur, and the number of occurrences of each.
+ * The words of compact databases are stored as indexes into the distinct characters.
+ *
+ * @param signature The signature. Equal characters are adjacent, as the signature is sorted.
+ * @param length The length of the signature.
+ * @param letters Pointer to where the distinct characters will be written to.
+ * @param counts Pointer to where the number of occurrences of each character will be written to.
+ * @return The number of distinct characters, or 0 if the signature is not sorted and has too many distinct characters.
+ */
+static size_t signature_letters(const char *signature, size_t length, unsigned char *letters, size_t *counts) {
+    size_t distinct = 0;
+    for (size_t i = 0; i < length; i++) {
+        if (distinct == 0 || letters[distinct - 1] != (unsigned char) signature[i]) {
+            if (distinct == ADB_CHAR_VALUES) {
+                return 0;
+            }
+            letters[distinct] = (unsigned char) signature[i];
+            counts[distinct++] = 0;
+        }
+        counts[distinct - 1]++;
+    }
+
+    return distinct;
+}
+
+/**
+ * Get the number of bits that an index into the distinct characters is stored in.
+ *
+ * @param distinct The number of distinct characters.
+ * @return The number of bits.
+ */
+static unsigned letter_index_width(size_t distinct) {
+    unsigned width = 0;
+    while (((size_t) 1 << width) < distinct) {
+        width++;
+    }
+
+    return width;
+}
+
+/**
+ * Use a character of the distinct characters of a signature. If all its occurrences are used, it is removed.
+ *
+ * @param letters The distinct characters.
+ * @param counts The number of unused occurrences of each character.
+ * @param distinct Pointer to the number of distinct characters.
+ * @param index The index of the character to use.
+ */
+static void use_letter(unsigned char *letters, size_t *counts, size_t *distinct, size_t index) {
+    if (--counts[index] == 0) {
+        (*distinct)--;
+        memmove(letters + index, letters + index + 1, (*distinct - index) * sizeof(unsigned char));
+        memmove(counts + index, counts + index + 1, (*distinct - index) * sizeof(size_t));
+    }
+}
+
+/**
+ * Read an unsigned LEB128 varint from a compact database.
+ *
+ * @param db Pointer to the database data structure.
+ * @param position Pointer to the file offset of the varint, which is advanced past it.
+ * @param value Pointer to where the value will be written to.
+ * @return true if the varint was read successfully, false if it is not inside the file or it is too long.
+ */
+static bool read_varint(const AnagramDb *db, uint64_t *position, uint64_t *value) {
+    uint64_t result = 0;
+    for (unsigned shift = 0; shift < 64 && *position < db->map_size; shift += 7) {
+        uint8_t byte = (uint8_t) db->map[(*position)++];
+        result |= (uint64_t) (byte & 0x7f) << shift;
+        if ((byte & 0x80) == 0) {
+            *value = result;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/**
+ * Make sure that the buffer of an entry can hold a number of characters. The contents of the buffer are kept.
+ *
+ * @param entry Pointer to the entry.
+ * @param size The number of characters.
+ * @return true if the buffer is large enough, false if the memory could not be allocated.
+ */
+static bool reserve_entry_buffer(AdbEntry *entry, size_t size) {
+    if (entry->buffer_size >= size) {
+        return true;
+    }
+    size_t buffer_size = 2 * entry->buffer_size > size ? 2 * entry->buffer_size : size;
+    char *buffer = realloc(entry->buffer, buffer_size);
+    if (!buffer) {
+        return false;
+    }
+    entry->buffer = buffer;
+    entry->buffer_size = buffer_size;
+
+    return true;
+}
+
+/**
+ * Read a compact record, and decode its signature to the buffer of the entry. The signature is front coded against the
+ * signature of the previous record, which must be in the buffer, unless the record starts a block. The words are
+ * skipped, and the entry has no words until they are decoded with decode_compact_words.
+ *
+ * @param db Pointer to the database data structure.
+ * @param position Pointer to the file offset of the record, which is advanced to the next record.
+ * @param entry Pointer to the entry. Its length must be zero if the record starts a block.
+ * @param words_position Pointer to where the file offset of the packed words will be written to.
+ * @param words_size Pointer to where the size of the packed words will be written to.
+ * @return true if the record was read successfully, false if it is corrupt.
+ */
+static bool read_compact_signature(const AnagramDb *db, uint64_t *position, AdbEntry *entry, uint64_t *words_position,
+                                   uint64_t *words_size) {
+    uint64_t prefix;
+    uint64_t suffix;
+    uint64_t word_count;
+    if (!read_varint(db, position, &prefix) || !read_varint(db, position, &suffix) || prefix > entry->length ||
+        suffix > db->map_size - *position || !reserve_entry_buffer(entry, prefix + suffix + 1)) {
+        return false;
+    }
+    memcpy(entry->buffer + prefix, db->map + *position, suffix);
+    entry->buffer[prefix + suffix] = '\0';
+    *position += suffix;
+    if (!read_varint(db, position, &word_count) || !read_varint(db, position, words_size) ||
+        *words_size > db->map_size - *position) {
+        return false;
+    }
+    // The words of a signature with more than one distinct letter take at least one bit each, so their number is
+    // bounded by the size of the packed words. The words of a single letter repeated have one arrangement, which takes
+    // no bits, so any number of copies of the word fits in no bytes.
+    size_t length = prefix + suffix;
+    if (length > 0 && entry->buffer[0] != entry->buffer[length - 1] && word_count / CHAR_BIT > *words_size) {
+        return false;
+    }
+    *words_position = *position;
+    *position += *words_size;
+    entry->length = length;
+    entry->signature = entry->buffer;
+    entry->word_count = word_count;
+    entry->words = NULL;
+
+    return true;
+}
+
+/**
+ * Decode the words of a compact record to the buffer of the entry, after its signature.
+ *
+ * @param entry Pointer to the entry, as read by read_compact_signature.
+ * @param bits The packed words.
+ * @param size The size of the packed words in bytes.
+ * @return true if the words were decoded successfully, false if they are corrupt or the memory could not be allocated.
+ */
+static bool decode_compact_words(AdbEntry *entry, const uint8_t *bits, uint64_t size) {
+    size_t stride = entry->length + 1;
+    if (entry->word_count > SIZE_MAX / stride - 1 || !reserve_entry_buffer(entry, stride * (entry->word_count + 1))) {
+        return false;
+    }
+    char *words = entry->buffer + stride;
+    unsigned char all_letters[ADB_CHAR_VALUES];
+    size_t all_counts[ADB_CHAR_VALUES];
+    size_t all_distinct = signature_letters(entry->buffer, entry->length, all_letters, all_counts);
+    uint64_t bit = 0;
+    for (size_t i = 0; i < entry->word_count; i++) {
+        unsigned char letters[ADB_CHAR_VALUES];
+        size_t counts[ADB_CHAR_VALUES];
+        size_t distinct = all_distinct;
+        memcpy(letters, all_letters, distinct * sizeof(unsigned char));
+        memcpy(counts, all_counts, distinct * sizeof(size_t));
+        char *word = words + i * stride;
+        for (size_t j = 0; j < entry->length; j++) {
+            unsigned width = letter_index_width(distinct);
+            if (width > size * CHAR_BIT - bit) {
+                return false;
+            }
+            size_t index = 0;
+            for (unsigned k = 0; k < width; k++, bit++) {
+                index |= (size_t) ((bits[bit / CHAR_BIT] >> (bit % CHAR_BIT)) & 1) << k;
+            }
+            if (index >= distinct) {
+                return false;
+            }
+            word[j] = (char) letters[index];
+            use_letter(letters, counts, &distinct, index);
+        }
+        word[entry->length] = '\0';
+    }
+    entry->signature = entry->buffer;
+    entry->words = words;
+
+    return true;
+}
+
+/**
+ * Get an entry of a compact database. The records of its block are decoded up to the entry.
+ *
+ * @param db Pointer to the database data structure.
+ * @param index The index of the entry.
+ * @param entry Pointer to where the entry will be written to.
+ * @return true if the entry was read successfully, false if the entry is corrupt.
+ */
+static bool compact_entry(const AnagramDb *db, size_t index, AdbEntry *entry) {
+    size_t block = index / db->restart_interval;
+    uint64_t position = db->index[block];
+    uint64_t words_position = 0;
+    uint64_t words_size = 0;
+    entry->length = 0;
+    for (size_t i = block * db->restart_interval; i <= index; i++) {
+        if (!read_compact_signature(db, &position, entry, &words_position, &words_size)) {
+            return false;
+        }
+    }
+
+    return decode_compact_words(entry, (const uint8_t *) db->map + words_position, words_size);
+}
+
+/**
+ * Get an entry of the database.
+ *
+ * @param db Pointer to the database data structure.
+ * @param index The index of the entry. The entries are sorted by signature.
+ * @param entry Pointer to where the entry will be written to.
+ * @return true if the entry was read successfully, false if the index is out of range or the entry is corrupt.
+ */
+bool adb_entry(const AnagramDb *db, size_t index, AdbEntry *entry) {
+    if (index >= db->entry_count) {
+        return false;
+    }
+    if (!db->map) {
+        // The buffer of the entry is kept, it may be reused for a compact database
+        const AdbEntry *legacy_entry = &db->entries[index];
+        entry->length = legacy_entry->length;
+        entry->signature = legacy_entry->signature;
+        entry->word_count = legacy_entry->word_count;
+        entry->words = legacy_entry->words;
+        return true;
+    }
+    if (db->version == ADB_VERSION_COMPACT) {
+        return compact_entry(db, index, entry);
+    }
+
+    return entry_at_offset(db, db->index[index], entry);
+}
+
+/**
+ * Free the buffer of an entry.
+ *
+ * @param entry Pointer to the entry.
+ */
+void adb_entry_free(AdbEntry *entry) {
+    free(entry->buffer);
+    entry->buffer = NULL;
+    entry->buffer_size = 0;
+}
+
+/**
+ * Compare a signature with the signature of a database entry, in the order in which the entries are sorted.
+ *
+ * @param signature The signature.
+ * @param length The length of the signature.
+ * @param entry The database entry.
+ * @return A negative value if the signature is less than the entry signature, a positive value if it is greater, or 0
+ * if the two signatures are equal.
+ */
+int adb_compare(const char *signature, size_t length, const AdbEntry *entry) {
+    int result = memcmp(signature, entry->signature, length < entry->length ? length : entry->length);
+    if (result != 0) {
+        return result;
+    }
+
+    return (length > entry->length) - (length < entry->length);
+}
+
+/**
+ * Search the hash table of the database for a signature.
+ *
+ * @param db Pointer to the database data structure.
+ * @param signature The signature to search for.
+ * @param length The length of the signature.
+ * @param entry Pointer to where the matching entry will be written to.
+ * @return true if the signature was found, false otherwise.
+ */
+static bool lookup_hash(const AnagramDb *db, const char *signature, size_t length, AdbEntry *entry) {
+    uint64_t hash = ss_hash(signature, length);
+    size_t mask = db->hash_slot_count - 1;
+    size_t slot = hash & mask;
+    for (size_t probes = 0; probes < db->hash_slot_count && db->hash_slots[slot].offset != 0; probes++) {
+        const AdbHashSlot *hash_slot = &db->hash_slots[slot];
+        if (hash_slot->hash == hash && entry_at_offset(db, hash_slot->offset, entry) &&
+            adb_compare(signature, length, entry) == 0) {
+            return true;
+        }
+        slot = (slot + 1) & mask;
+    }
+
+    return false;
+}
+
+/**
+ * Search a compact database for a signature. The blocks are binary searched by their first signature, and then the
+ * records of the block that can hold the signature are decoded one by one.
+ *
+ * @param db Pointer to the database data structure.
+ * @param signature The signature to search for.
+ * @param length The length of the signature.
+ * @param entry Pointer to where the matching entry will be written to.
+ * @return true if the signature was found, false otherwise.
+ */
+static bool lookup_compact(const AnagramDb *db, const char *signature, size_t length, AdbEntry *entry) {
+    // Find the first block that starts after the signature
+    uint64_t position;
+    uint64_t words_position;
+    uint64_t words_size;
+    size_t low = 0;
+    size_t high = db->block_count;
+    while (low < high) {
+        size_t middle = low + (high - low) / 2;
+        position = db->index[middle];
+        entry->length = 0;
+        if (!read_compact_signature(db, &position, entry, &words_position, &words_size)) {
+            return false;
+        }
+        if (adb_compare(signature, length, entry) < 0) {
+            high = middle;
+        } else {
+            low = middle + 1;
+        }
+    }
+    if (low == 0) {
+        return false;
+    }
+
+    // Search the block before it
+    size_t block = low - 1;
+    size_t end = (block + 1) * db->restart_interval < db->entry_count ? (block + 1) * db->restart_interval
+                                                                       : db->entry_count;
+    position = db->index[block];
+    entry->length = 0;
+    for (size_t i = block * db->restart_interval; i < end; i++) {
+        if (!read_compact_signature(db, &position, entry, &words_position, &words_size)) {
+            return false;
+        }
+        int result = adb_compare(signature, length, entry);
+        if (result == 0) {
+            return decode_compact_words(entry, (const uint8_t *) db->map + words_position, words_size);
+        } else if (result < 0) {
+            return false;
+        }
+    }
+
+    return false;
+}
+
+/**
+ * Search the database for a signature. The Bloom filter is tested first if the database has one, then the hash table
+ * is used if the database has one, otherwise the offset table is binary searched.
+ *
+ * @param db Pointer to the database data structure.
+ * @param signature The signature to search for.
+ * @param length The length of the signature.
+ * @param entry Pointer to where the matching entry will be written to.
+ * @return true if the signature was found, false otherwise.
+ */
+bool adb_lookup(const AnagramDb *db, const char *signature, size_t length, AdbEntry *entry) {
+    if (db->bloom_map && !bf_may_contain(&db->bloom, ss_hash(signature, length))) {
+        return false;
+    }
+    if (db->hash_slots) {
+        return lookup_hash(db, signature, length, entry);
+    }
+    if (db->version == ADB_VERSION_COMPACT) {
+        return lookup_compact(db, signature, length, entry);
+    }
+
+    size_t low = 0;
+    size_t high = db->entry_count;
+    while (low < high) {
+        size_t middle = low + (high - low) / 2;
+        if (!adb_entry(db, middle, entry)) {
+            return false;
+        }
+        int result = adb_compare(signature, length, entry);
+        if (result == 0) {
+            return true;
+        } else if (result < 0) {
+            high = middle;
+        } else {
+            low = middle + 1;
+        }
+    }
+
+    return false;
+}
+
+/**
+ * Search the rack index of the database for the entries whose words can be built from a set of letters.
+ *
+ * @param db Pointer to the database data structure.
+ * @param rack The letter histogram of the set of letters.
+ * @param length The number of letters.
+ * @param callback The callback that receives the entries.
+ * @param context The context that is passed to the callback.
+ * @return false if the callback stopped the search or the database is corrupt, true otherwise.
+ */
+static bool rack_search_index(const AnagramDb *db, const SsHistogram *rack, size_t length, AdbEntryCallback callback,
+                              void *context) {
+    uint32_t excluded = ~ss_histogram_mask(rack);
+    AdbEntry entry;
+    for (size_t i = 0; i < db->rack_group_count; i++) {
+        const AdbRackGroup *group = &db->rack_groups[i];
+        // The groups are sorted by length, so none of the remaining groups fit
+        if (group->length > length) {
+            break;
+        }
+        if ((group->mask & excluded) != 0) {
+            continue;
+        }
+        if (group->first > db->rack_entry_count || group->count > db->rack_entry_count - group->first) {
+            return false;
+        }
+        const AdbRackEntry *rack_entries = db->rack_entries + group->first;
+        for (size_t j = 0; j < group->count; j++) {
+            if (ss_histogram_contains(rack, &rack_entries[j].histogram) &&
+                (!entry_at_offset(db, rack_entries[j].offset, &entry) || !callback(&entry, context))) {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+/**
+ * Search the database for the entries whose words can be built from a set of letters, and pass them to a callback. The
+ * rack index is used if the database has one, otherwise the histogram of each entry is calculated and compared.
+ *
+ * @param db Pointer to the database data structure.
+ * @param rack The letter histogram of the set of letters.
+ * @param length The number of letters.
+ * @param callback The callback that receives the entries.
+ * @param context The context that is passed to the callback.
+ * @return false if the callback stopped the search or the database is corrupt, true otherwise.
+ */
+bool adb_rack_search(const AnagramDb *db, const SsHistogram *rack, size_t length, AdbEntryCallback callback,
+                     void *context) {
+    if (db->rack_groups) {
+        return rack_search_index(db, rack, length, callback, context);
+    }
+
+    AdbEntry entry = {0};
+    SsHistogram histogram;
+    bool ok = true;
+    for (size_t i = 0; i < db->entry_count && ok; i++) {
+        ok = adb_entry(db, i, &entry) &&
+             (entry.length > length || !ss_histogram(entry.signature, entry.length, &histogram) ||
+              !ss_histogram_contains(rack, &histogram) || callback(&entry, context));
+    }
+    adb_entry_free(&entry);
+
+    return ok;
+}
+
+/**
+ * Comparison function for sorting classes by size in descending order, then by length in descending order, and then by
+ * entry.
+ *
+ * @param p Pointer to the first array element to compare.
+ * @param q Pointer to the second array element to compare.
+ * @return -1 if the first element is less that the second, 1 if the first element is greater then the second or 0 if
+ * the two elements are equal.
+ */
+static int compare_classes_by_size(const void *p, const void *q) {
+    const AdbSummaryClass *x = p;
+    const AdbSummaryClass *y = q;
+    if (x->word_count != y->word_count) {
+        return x->word_count > y->word_count ? -1 : 1;
+    }
+    if (x->length != y->length) {
+        return x->length > y->length ? -1 : 1;
+    }
+
+    return (x->index > y->index) - (x->index < y->index);
+}
+
+/**
+ * Comparison function for sorting classes by length, and then by entry.
+ *
+ * @param p Pointer to the first array element to compare.
+ * @param q Pointer to the second array element to compare.
+ * @return -1 if the first element is less that the second, 1 if the first element is greater then the second or 0 if
+ * the two elements are equal.
+ */
+static int compare_classes_by_length(const void *p, const void *q) {
+    const AdbSummaryClass *x = p;
+    const AdbSummaryClass *y = q;
+    if (x->length != y->length) {
+        return x->length < y->length ? -1 : 1;
+    }
+
+    return (x->index > y->index) - (x->index < y->index);
+}
+
+/**
+ * Add a class to the last bucket, or to a new bucket if the key of the last bucket is different.
+ *
+ * @param buckets The buckets.
+ * @param bucket_count Pointer to the number of buckets.
+ * @param key The key of the class.
+ * @param word_count The number of words of the class.
+ */
+static void add_to_bucket(AdbSummaryBucket *buckets, uint64_t *bucket_count, uint64_t key, uint64_t word_count) {
+    if (*bucket_count == 0 || buckets[*bucket_count - 1].key != key) {
+        buckets[(*bucket_count)++] = (AdbSummaryBucket) {.key = key};
+    }
+    buckets[*bucket_count - 1].class_count++;
+    buckets[*bucket_count - 1].word_count += word_count;
+}
+
+/**
+ * Summarize the classes of a database. The classes are sorted by size in descending order, and they are counted by size
+ * and by length. All the classes are kept, the caller sets the number of the largest classes.
+ *
+ * @param classes The classes.
+ * @param count The number of classes.
+ * @param header Pointer to where the summary header will be written to.
+ * @param sizes Pointer to where the class size buckets will be written to. There must be room for count buckets.
+ * @param lengths Pointer to where the word length buckets will be written to. There must be room for count buckets.
+ */
+static void summarize_classes(AdbSummaryClass *classes, size_t count, AdbSummaryHeader *header,
+                              AdbSummaryBucket *sizes, AdbSummaryBucket *lengths) {
+    memset(header, 0, sizeof(AdbSummaryHeader));
+    header->class_count = count;
+    qsort(classes, count, sizeof(AdbSummaryClass), compare_classes_by_length);
+    for (size_t i = 0; i < count; i++) {
+        header->word_count += classes[i].word_count;
+        add_to_bucket(lengths, &header->length_count, classes[i].length, classes[i].word_count);
+    }
+    qsort(classes, count, sizeof(AdbSummaryClass), compare_classes_by_size);
+    for (size_t i = count; i > 0; i--) {
+        add_to_bucket(sizes, &header->size_count, classes[i - 1].word_count, classes[i - 1].word_count);
+    }
+}
+
+/**
+ * Get the summary of the database. It is read from the summary section if the database has one that holds at least
+ * the requested number of largest classes, otherwise it is calculated from all the entries.
+ *
+ * @param db Pointer to the database data structure.
+ * @param top The number of largest classes that are needed.
+ * @param summary Pointer to where the summary will be written to. It must be freed with adb_summary_free.
+ * @return true if the summary was read successfully, false otherwise.
+ */
+bool adb_summary(const AnagramDb *db, size_t top, AdbSummary *summary) {
+    memset(summary, 0, sizeof(AdbSummary));
+    if (db->summary && db->summary->top_count >= (top < db->summary->class_count ? top : db->summary->class_count)) {
+        summary->header = *db->summary;
+        summary->classes = (const AdbSummaryClass *) (db->summary + 1);
+        summary->sizes = (const AdbSummaryBucket *) (summary->classes + summary->header.top_count);
+        summary->lengths = summary->sizes + summary->header.size_count;
+        return true;
+    }
+
+    // Calculate the summary from the entries
+    size_t count = db->entry_count;
+    if (count > SIZE_MAX / (sizeof(AdbSummaryClass) + 2 * sizeof(AdbSummaryBucket)) - 1) {
+        return false;
+    }
+    AdbSummaryClass *classes = malloc((count + 1) * (sizeof(AdbSummaryClass) + 2 * sizeof(AdbSummaryBucket)));
+    if (!classes) {
+        return false;
+    }
+    AdbSummaryBucket *sizes = (AdbSummaryBucket *) (classes + count);
+    AdbSummaryBucket *lengths = sizes + count;
+    AdbEntry entry = {0};
+    for (size_t i = 0; i < count; i++) {
+        if (!adb_entry(db, i, &entry)) {
+            adb_entry_free(&entry);
+            free(classes);
+            return false;
+        }
+        classes[i] = (AdbSummaryClass) {.word_count = entry.word_count, .length = entry.length, .index = i};
+    }
+    adb_entry_free(&entry);
+    summarize_classes(classes, count, &summary->header, sizes, lengths);
+    summary->header.top_count = count;
+    summary->classes = classes;
+    summary->sizes = sizes;
+    summary->lengths = lengths;
+    summary->memory = classes;
+
+    return true;
+}
+
+/**
+ * Free the memory of a summary.
+ *
+ * @param summary Pointer to the summary.
+ */
+void adb_summary_free(AdbSummary *summary) {
+    free(summary->memory);
+    memset(summary, 0, sizeof(AdbSummary));
+}
+
+/**
+ * Get a word of a database entry.
+ *
+ * @param entry Pointer to the database entry.
+ * @param index The index of the word.
+ * @return The word.
+ */
+const char *adb_word(const AdbEntry *entry, size_t index) {
+    return entry->words + index * (entry->length + 1);
+}
+
+/**
+ * Write data to the database file.
+ *
+ * @param writer Pointer to the writer data structure.
+ * @param data The data to write.
+ * @param size The size of the data.
+ */
+static void writer_write(AdbWriter *writer, const void *data, size_t size) {
+    if (writer->ok && fwrite(data, 1, size, writer->file) != size) {
+        writer->ok = false;
+    }
+    writer->position += size;
+}
+
+/**
+ * Write zero bytes to the database file, until the position is aligned.
+ *
+ * @param writer Pointer to the writer data structure.
+ */
+static void writer_align(AdbWriter *writer) {
+    static const char padding[ADB_ALIGNMENT] = {0};
+    size_t remainder = writer->position % ADB_ALIGNMENT;
+    if (remainder != 0) {
+        writer_write(writer, padding, ADB_ALIGNMENT - remainder);
+    }
+}
+
+/**
+ * Write an unsigned LEB128 varint to the database file.
+ *
+ * @param writer Pointer to the writer data structure.
+ * @param value The value to write.
+ */
+static void writer_write_varint(AdbWriter *writer, uint64_t value) {
+    uint8_t bytes[10];
+    size_t size = 0;
+    do {
+        bytes[size] = value & 0x7f;
+        value >>= 7;
+        if (value != 0) {
+            bytes[size] |= 0x80;
+        }
+        size++;
+    } while (value != 0);
+    writer_write(writer, bytes, size);
+}
+
+/**
+ * Open a writer for an anagram database file.
+ *
+ * @param writer Pointer to the writer data structure.
+ * @param path The path of the database file.
+ * @param flags The optional sections to write, as a combination of the ADB_WRITER flags.
+ * @return true if the writer was opened successfully, false otherwise.
+ */
+bool adb_writer_open(AdbWriter *writer, const char *path, uint32_t flags) {
+    memset(writer, 0, sizeof(AdbWriter));
+    // The hash table and the rack index refer to the entry records by their file offset, which compact records do not
+    // have
+    writer->flags = (flags & ADB_WRITER_COMPACT) ? flags & (ADB_WRITER_COMPACT | ADB_WRITER_SUMMARY) : flags;
+    writer->path = strdup(path);
+    writer->temp_path = malloc(strlen(path) + sizeof(ADB_TEMP_SUFFIX));
+    if (!writer->path || !writer->temp_path) {
+        free(writer->path);
+        free(writer->temp_path);
+        return false;
+    }
+    strcpy(writer->temp_path, path);
+    strcat(writer->temp_path, ADB_TEMP_SUFFIX);
+    writer->file = fopen(writer->temp_path, "wb");
+    if (!writer->file) {
+        free(writer->path);
+        free(writer->temp_path);
+        return false;
+    }
+    setvbuf(writer->file, NULL, _IOFBF, ADB_WRITE_BUFFER_SIZE);
+    writer->ok = true;
+
+    // Reserve space for the header, it is written when the writer is closed
+    AdbHeader header = {0};
+    writer_write(writer, &header, sizeof(AdbHeader));
+
+    return writer->ok;
+}
+
+/**
+ * Add the rack entry of the next entry, if its signature consists of the letters 'a' to 'z'.
+ *
+ * @param writer Pointer to the writer data structure.
+ * @param signature The signature of the entry.
+ * @param length The length of the signature.
+ * @return true if the rack entry was added or the signature is not indexed, false if the memory could not be allocated.
+ */
+static bool writer_add_rack_item(AdbWriter *writer, const char *signature, size_t length) {
+    AdbRackItem item = {.length = (uint32_t) length, .entry.offset = writer->position};
+    if (!ss_histogram(signature, length, &item.entry.histogram)) {
+        return true;
+    }
+    item.mask = ss_histogram_mask(&item.entry.histogram);
+    if (writer->rack_item_count == writer->rack_capacity) {
+        size_t capacity = writer->rack_capacity + ADB_CHUNK_SIZE + writer->rack_capacity / 2;
+        AdbRackItem *rack_items = realloc(writer->rack_items, capacity * sizeof(AdbRackItem));
+        if (!rack_items) {
+            return false;
+        }
+        writer->rack_items = rack_items;
+        writer->rack_capacity = capacity;
+    }
+    writer->rack_items[writer->rack_item_count++] = item;
+
+    return true;
+}
+
+/**
+ * Start a new record of a compact database. Its signature is front coded against the signature of the previous record,
+ * unless the record starts a new block.
+ *
+ * @param writer Pointer to the writer data structure.
+ * @param signature The signature of the entry.
+ * @param length The length of the signature.
+ * @param word_count The number of words of the entry.
+ * @return true if the record was written successfully, false otherwise.
+ */
+static bool writer_add_compact_entry(AdbWriter *writer, const char *signature, size_t length, size_t word_count) {
+    size_t prefix = 0;
+    if (writer->entry_count % ADB_RESTART_INTERVAL == 0) {
+        writer->offsets[writer->entry_count / ADB_RESTART_INTERVAL] = writer->position;
+    } else {
+        while (prefix < length && prefix < writer->length && writer->signature[prefix] == signature[prefix]) {
+            prefix++;
+        }
+    }
+    if (length + 1 > writer->signature_capacity) {
+        char *extended_signature = realloc(writer->signature, length + 1);
+        if (!extended_signature) {
+            writer->ok = false;
+            return false;
+        }
+        writer->signature = extended_signature;
+        writer->signature_capacity = length + 1;
+    }
+    memcpy(writer->signature, signature, length);
+    writer->signature[length] = '\0';
+
+    writer_write_varint(writer, prefix);
+    writer_write_varint(writer, length - prefix);
+    writer_write(writer, signature + prefix, length - prefix);
+    writer_write_varint(writer, word_count);
+    if (word_count == 0) {
+        writer_write_varint(writer, 0);
+    }
+    writer->entry_count++;
+    writer->pending_words = word_count;
+    writer->length = length;
+    writer->word_bit_count = 0;
+
+    return writer->ok;
+}
+
+/**
+ * Add a word to the current record of a compact database. The word is packed as the indexes of its characters into the
+ * unused distinct characters of the signature, and the packed words are written after the last word of the record.
+ *
+ * @param writer Pointer to the writer data structure.
+ * @param word The word. It must be a permutation of the signature of the record.
+ * @return true if the word was added successfully, false otherwise.
+ */
+static bool writer_add_compact_word(AdbWriter *writer, const char *word) {
+    // Each character takes at most CHAR_BIT bits
+    size_t capacity = (writer->word_bit_count + CHAR_BIT - 1) / CHAR_BIT + writer->length;
+    if (capacity > writer->word_bits_capacity) {
+        capacity = capacity < 2 * writer->word_bits_capacity ? 2 * writer->word_bits_capacity : capacity;
+        uint8_t *word_bits = realloc(writer->word_bits, capacity);
+        if (!word_bits) {
+            return false;
+        }
+        writer->word_bits = word_bits;
+        writer->word_bits_capacity = capacity;
+    }
+    unsigned char letters[ADB_CHAR_VALUES];
+    size_t counts[ADB_CHAR_VALUES];
+    size_t distinct = signature_letters(writer->signature, writer->length, letters, counts);
+    for (size_t i = 0; i < writer->length; i++) {
+        size_t index = 0;
+        while (index < distinct && letters[index] != (unsigned char) word[i]) {
+            index++;
+        }
+        if (index == distinct) {
+            return false;
+        }
+        unsigned width = letter_index_width(distinct);
+        for (unsigned k = 0; k < width; k++, writer->word_bit_count++) {
+            size_t bit = writer->word_bit_count;
+            if (bit % CHAR_BIT == 0) {
+                writer->word_bits[bit / CHAR_BIT] = 0;
+            }
+            writer->word_bits[bit / CHAR_BIT] |= ((index >> k) & 1) << (bit % CHAR_BIT);
+        }
+        use_letter(letters, counts, &distinct, index);
+    }
+
+    // Write the packed words after the last word
+    if (writer->pending_words == 1) {
+        size_t size = (writer->word_bit_count + CHAR_BIT - 1) / CHAR_BIT;
+        writer_write_varint(writer, size);
+        writer_write(writer, writer->word_bits, size);
+    }
+
+    return true;
+}
+
+/**
+ * Start a new entry. The entries must be added in ascending signature order, as defined by adb_compare, and the words
+ * of the entry must be added with adb_writer_add_word before the next entry is added.
+ *
+ * @param writer Pointer to the writer data structure.
+ * @param signature The signature of the entry.
+ * @param length The length of the signature.
+ * @param word_count The number of words of the entry.
+ * @return true if the entry was written successfully, false otherwise.
+ */
+bool adb_writer_add_entry(AdbWriter *writer, const char *signature, size_t length, size_t word_count) {
+    if (writer->pending_words != 0 || length >= UINT32_MAX || word_count > UINT32_MAX) {
+        writer->ok = false;
+        return false;
+    }
+    if (writer->entry_count == writer->capacity) {
+        size_t capacity = writer->capacity + ADB_CHUNK_SIZE + writer->capacity / 2;
+        uint64_t *offsets = realloc(writer->offsets, capacity * sizeof(uint64_t));
+        if (!offsets) {
+            writer->ok = false;
+            return false;
+        }
+        writer->offsets = offsets;
+        if (writer->flags & ADB_WRITER_HASH) {
+            uint64_t *hashes = realloc(writer->hashes, capacity * sizeof(uint64_t));
+            if (!hashes) {
+                writer->ok = false;
+                return false;
+            }
+            writer->hashes = hashes;
+        }
+        if (writer->flags & ADB_WRITER_SUMMARY) {
+            AdbSummaryClass *classes = realloc(writer->classes, capacity * sizeof(AdbSummaryClass));
+            if (!classes) {
+                writer->ok = false;
+                return false;
+            }
+            writer->classes = classes;
+        }
+        writer->capacity = capacity;
+    }
+    if (writer->flags & ADB_WRITER_SUMMARY) {
+        writer->classes[writer->entry_count] = (AdbSummaryClass) {
+            .word_count = word_count,
+            .length = length,
+            .index = writer->entry_count
+        };
+    }
+    if (writer->flags & ADB_WRITER_COMPACT) {
+        return writer_add_compact_entry(writer, signature, length, word_count);
+    }
+    if (writer->flags & ADB_WRITER_HASH) {
+        writer->hashes[writer->entry_count] = ss_hash(signature, length);
+    }
+
+    writer_align(writer);
+    if ((writer->flags & ADB_WRITER_RACK) && !writer_add_rack_item(writer, signature, length)) {
+        writer->ok = false;
+        return false;
+    }
+    writer->offsets[writer->entry_count++] = writer->position;
+    uint32_t record[2] = {(uint32_t) length, (uint32_t) word_count};
+    writer_write(writer, record, sizeof(record));
+    writer_write(writer, signature, length);
+    writer_write(writer, "", 1);
+    writer->pending_words = word_count;
+    writer->length = length;
+
+    return writer->ok;
+}
+
+/**
+ * Add a word to the current entry.
+ *
+ * @param writer Pointer to the writer data structure.
+ * @param word The word. Its length must be the length of the entry signature.
+ * @return true if the word was written successfully, false otherwise.
+ */
+bool adb_writer_add_word(AdbWriter *writer, const char *word) {
+    if (writer->pending_words == 0) {
+        writer->ok = false;
+        return false;
+    }
+    if (writer->flags & ADB_WRITER_COMPACT) {
+        if (!writer_add_compact_word(writer, word)) {
+            writer->ok = false;
+            return false;
+        }
+        writer->pending_words--;
+        return writer->ok;
+    }
+    writer_write(writer, word, writer->length);
+    writer_write(writer, "", 1);
+    writer->pending_words--;
+
+    return writer->ok;
+}
+
+/**
+ * Write the hash table section. It has at least twice as many slots as entries, so that the probe sequences are short.
+ *
+ * @param writer Pointer to the writer data structure.
+ * @param header The file header, where the offset and size of the section are written to.
+ */
+static void write_hash_table(AdbWriter *writer, AdbHeader *header) {
+    size_t slot_count = 1;
+    while (slot_count < 2 * writer->entry_count) {
+        slot_count *= 2;
+    }
+    AdbHashSlot *slots = calloc(slot_count, sizeof(AdbHashSlot));
+    if (!slots) {
+        writer->ok = false;
+        return;
+    }
+    size_t mask = slot_count - 1;
+    for (size_t i = 0; i < writer->entry_count; i++) {
+        size_t slot = writer->hashes[i] & mask;
+        while (slots[slot].offset != 0) {
+            slot = (slot + 1) & mask;
+        }
+        slots[slot].hash = writer->hashes[i];
+        slots[slot].offset = writer->offsets[i];
+    }
+    header->hash_offset = writer->position;
+    header->hash_slot_count = slot_count;
+    writer_write(writer, slots, slot_count * sizeof(AdbHashSlot));
+    free(slots);
+}
+
+/**
+ * Comparison function for sorting rack entries by length and by mask. Entries in the same group are kept in signature
+ * order.
+ *
+ * @param p Pointer to the first array element to compare.
+ * @param q Pointer to the second array element to compare.
+ * @return -1 if the first element is less that the second, 1 if the first element is greater then the second or 0 if
+ * the two elements are equal.
+ */
+static int compare_rack_items(const void *p, const void *q) {
+    const AdbRackItem *x = p;
+    const AdbRackItem *y = q;
+    if (x->length != y->length) {
+        return x->length < y->length ? -1 : 1;
+    }
+    if (x->mask != y->mask) {
+        return x->mask < y->mask ? -1 : 1;
+    }
+
+    return (x->entry.offset > y->entry.offset) - (x->entry.offset < y->entry.offset);
+}
+
+/**
+ * Write the rack index section. The rack entries are grouped by length and mask, and the groups are written first,
+ * followed by the rack entries of all the groups.
+ *
+ * @param writer Pointer to the writer data structure.
+ * @param header The file header, where the offset and size of the section are written to.
+ */
+static void write_rack_index(AdbWriter *writer, AdbHeader *header) {
+    qsort(writer->rack_items, writer->rack_item_count, sizeof(AdbRackItem), compare_rack_items);
+    header->rack_offset = writer->position;
+    for (size_t first = 0; first < writer->rack_item_count;) {
+        size_t last = first + 1;
+        while (last < writer->rack_item_count && writer->rack_items[last].length == writer->rack_items[first].length &&
+               writer->rack_items[last].mask == writer->rack_items[first].mask) {
+            last++;
+        }
+        AdbRackGroup group = {
+            .length = writer->rack_items[first].length,
+            .mask = writer->rack_items[first].mask,
+            .first = first,
+            .count = last - first
+        };
+        writer_write(writer, &group, sizeof(AdbRackGroup));
+        header->rack_group_count++;
+        first = last;
+    }
+    for (size_t i = 0; i < writer->rack_item_count; i++) {
+        writer_write(writer, &writer->rack_items[i].entry, sizeof(AdbRackEntry));
+    }
+}
+
+/**
+ * Write the summary section.
+ *
+ * @param writer Pointer to the writer data structure.
+ * @param header The file header, where the offset of the section is written to.
+ */
+static void write_summary(AdbWriter *writer, AdbHeader *header) {
+    size_t count = writer->entry_count;
+    AdbSummaryBucket *buckets = malloc((2 * count + 1) * sizeof(AdbSummaryBucket));
+    if (!buckets) {
+        writer->ok = false;
+        return;
+    }
+    AdbSummaryHeader summary;
+    summarize_classes(writer->classes, count, &summary, buckets, buckets + count);
+    summary.top_count = count < ADB_SUMMARY_TOP ? count : ADB_SUMMARY_TOP;
+    writer_align(writer);
+    header->summary_offset = writer->position;
+    writer_write(writer, &summary, sizeof(AdbSummaryHeader));
+    writer_write(writer, writer->classes, summary.top_count * sizeof(AdbSummaryClass));
+    writer_write(writer, buckets, summary.size_count * sizeof(AdbSummaryBucket));
+    writer_write(writer, buckets + count, summary.length_count * sizeof(AdbSummaryBucket));
+    free(buckets);
+}
+
+/**
+ * Finish the database file and close the writer. The output file is only replaced if all the writes were successful.
+ *
+ * @param writer Pointer to the writer data structure.
+ * @return true if the database was written successfully, false otherwise.
+ */
+bool adb_writer_close(AdbWriter *writer) {
+    if (writer->pending_words != 0) {
+        writer->ok = false;
+    }
+
+    // Write the offset table. Compact databases only have the offsets of the blocks.
+    writer_align(writer);
+    AdbHeader header = {
+        .version = ADB_VERSION,
+        .header_size = sizeof(AdbHeader),
+        .entry_count = writer->entry_count,
+        .index_offset = writer->position
+    };
+    memcpy(header.magic, ADB_MAGIC, ADB_MAGIC_SIZE);
+    size_t offset_count = writer->entry_count;
+    if (writer->flags & ADB_WRITER_COMPACT) {
+        header.version = ADB_VERSION_COMPACT;
+        header.restart_interval = ADB_RESTART_INTERVAL;
+        offset_count = (writer->entry_count + ADB_RESTART_INTERVAL - 1) / ADB_RESTART_INTERVAL;
+    }
+    writer_write(writer, writer->offsets, offset_count * sizeof(uint64_t));
+
+    // Write the optional sections
+    if (writer->flags & ADB_WRITER_HASH) {
+        write_hash_table(writer, &header);
+    }
+    if (writer->flags & ADB_WRITER_RACK) {
+        write_rack_index(writer, &header);
+    }
+    if (writer->flags & ADB_WRITER_SUMMARY) {
+        write_summary(writer, &header);
+    }
+
+    // Write the header, and make sure that the file is on disk before it replaces the output file
+    if (writer->ok && (fseek(writer->file, 0, SEEK_SET) != 0 ||
+                       fwrite(&header, sizeof(AdbHeader), 1, writer->file) != 1 ||
+                       fflush(writer->file) != 0 || fsync(fileno(writer->file)) != 0)) {
+        writer->ok = false;
+    }
+    if (fclose(writer->file) != 0) {
+        writer->ok = false;
+    }
+    if (writer->ok && rename(writer->temp_path, writer->path) != 0) {
+        writer->ok = false;
+    }
+    if (!writer->ok) {
+        unlink(writer->temp_path);
+    }
+    bool ok = writer->ok;
+    free(writer->offsets);
+    free(writer->hashes);
+    free(writer->rack_items);
+    free(writer->signature);
+    free(writer->word_bits);
+    free(writer->classes);
+    free(writer->path);
+    free(writer->temp_path);
+    memset(writer, 0, sizeof(AdbWriter));
+
+    return ok;
+}
+
+/**
+ * Get the path of a database segment.
+ *
+ * @param path The path of the base database.
+ * @param delta The number of the delta segment, starting from 1, or 0 for the base database.
+ * @return The path of the segment, which the caller must free, or NULL if the memory could not be allocated.
+ */
+char *adb_segment_path(const char *path, size_t delta) {
+    if (delta == 0) {
+        return strdup(path);
+    }
+    size_t size = snprintf(NULL, 0, "%s" ADB_DELTA_INFIX "%zu", path, delta) + 1;
+    char *segment_path = malloc(size);
+    if (segment_path) {
+        snprintf(segment_path, size, "%s" ADB_DELTA_INFIX "%zu", path, delta);
+    }
+
+    return segment_path;
+}
+
+/**
+ * Check if a database segment exists.
+ *
+ * @param path The path of the base database.
+ * @param delta The number of the delta segment, or 0 for the base database.
+ * @return true if the segment exists, false otherwise.
+ */
+static bool segment_exists(const char *path, size_t delta) {
+    char *segment_path = adb_segment_path(path, delta);
+    bool exists = segment_path && access(segment_path, F_OK) == 0;
+    free(segment_path);
+
+    return exists;
+}
+
+/**
+ * Open a base database and all its delta segments. The base database does not need to exist if there are delta
+ * segments.
+ *
+ * @param set Pointer to the segment set data structure.
+ * @param path The path of the base database.
+ * @return true if the segments were opened successfully, false otherwise.
+ */
+bool adb_set_open(AdbSegmentSet *set, const char *path) {
+    memset(set, 0, sizeof(AdbSegmentSet));
+    set->has_base = segment_exists(path, 0);
+    while (set->delta_count < ADB_MAX_DELTAS && segment_exists(path, set->delta_count + 1)) {
+        set->delta_count++;
+    }
+    if (!set->has_base && set->delta_count == 0) {
+        return false;
+    }
+
+    set->segments = calloc(set->delta_count + 1, sizeof(AnagramDb));
+    if (!set->segments) {
+        return false;
+    }
+    for (size_t delta = set->has_base ? 0 : 1; delta <= set->delta_count; delta++) {
+        char *segment_path = adb_segment_path(path, delta);
+        if (!segment_path || !adb_open(&set->segments[set->segment_count], segment_path)) {
+            free(segment_path);
+            adb_set_close(set);
+            return false;
+        }
+        free(segment_path);
+        set->segment_count++;
+    }
+
+    return true;
+}
+
+/**
+ * Close all the segments of a segment set.
+ *
+ * @param set Pointer to the segment set data structure.
+ */
+void adb_set_close(AdbSegmentSet *set) {
+    for (size_t i = 0; i < set->segment_count; i++) {
+        adb_close(&set->segments[i]);
+    }
+    free(set->segments);
+    memset(set, 0, sizeof(AdbSegmentSet));
+}
+
+/**
+ * Write the Bloom filter file of a database segment, from the signatures of its entries. The filter file is replaced
+ * atomically, and it is matched with the current segment file, so it must be written after the segment.
+ *
+ * @param path The path of the segment file.
+ * @param false_positive_rate The false positive rate of the filter, between 0 and 1 exclusive.
+ * @return true if the filter file was written successfully, false otherwise.
+ */
+bool adb_write_bloom(const char *path, double false_positive_rate) {
+    // Add the signatures of all the entries to the filter
+    AnagramDb db;
+    if (!adb_open(&db, path)) {
+        return false;
+    }
+    BloomFilter bloom;
+    if (!bf_init(&bloom, db.entry_count, false_positive_rate)) {
+        adb_close(&db);
+        return false;
+    }
+    bool ok = true;
+    AdbEntry entry = {0};
+    for (size_t i = 0; i < db.entry_count && ok; i++) {
+        ok = adb_entry(&db, i, &entry);
+        if (ok) {
+            bf_add(&bloom, ss_hash(entry.signature, entry.length));
+        }
+    }
+    adb_entry_free(&entry);
+    AdbBloomHeader header = {
+        .header_size = BF_BLOCK_SIZE,
+        .hash_count = bloom.hash_count,
+        .block_count = bloom.block_count,
+        .false_positive_rate = false_positive_rate,
+        .segment = db.file_id
+    };
+    memcpy(header.magic, ADB_BLOOM_MAGIC, ADB_MAGIC_SIZE);
+    adb_close(&db);
+
+    // Write the filter to a temporary file, and make sure that it is on disk before it replaces the filter file
+    char *filter_path = adb_bloom_path(path);
+    char *temp_path = filter_path ? malloc(strlen(filter_path) + sizeof(ADB_TEMP_SUFFIX)) : NULL;
+    FILE *file = NULL;
+    if (temp_path) {
+        strcpy(temp_path, filter_path);
+        strcat(temp_path, ADB_TEMP_SUFFIX);
+        file = fopen(temp_path, "wb");
+    }
+    char padding[BF_BLOCK_SIZE] = {0};
+    ok = ok && file && fwrite(&header, sizeof(AdbBloomHeader), 1, file) == 1 &&
+         fwrite(padding, 1, header.header_size - sizeof(AdbBloomHeader), file) ==
+             header.header_size - sizeof(AdbBloomHeader) &&
+         fwrite(bloom.bits.bits, BF_BLOCK_SIZE, bloom.block_count, file) == bloom.block_count &&
+         fflush(file) == 0 && fsync(fileno(file)) == 0;
+    if (file && fclose(file) != 0) {
+        ok = false;
+    }
+    ok = ok && rename(temp_path, filter_path) == 0;
+    if (!ok && file) {
+        unlink(temp_path);
+    }
+    free(filter_path);
+    free(temp_path);
+    bf_destroy(&bloom);
+
+    return ok;
+}
+
+/**
+ * Check if the Bloom filter file of a segment rejects a signature, by reading the single block of the signature.
+ *
+ * @param path The path of the segment file.
+ * @param st The status of the segment file.
+ * @param hash The signature hash.
+ * @return true if the segment has a valid filter that rejects the signature, false otherwise.
+ */
+static bool bloom_rejects(const char *path, const struct stat *st, uint64_t hash) {
+    AdbFileId id;
+    file_id(st, &id);
+    AdbBloomHeader header;
+    size_t size;
+    int fd = open_bloom_file(path, &id, &header, &size);
+    if (fd == -1) {
+        return false;
+    }
+    BS_UNIT block[BF_BLOCK_SIZE / sizeof(BS_UNIT)];
+    off_t offset = header.header_size + (off_t) bf_block_index(header.block_count, hash) * BF_BLOCK_SIZE;
+    bool read = pread(fd, block, BF_BLOCK_SIZE, offset) == BF_BLOCK_SIZE;
+    close(fd);
+
+    // The bits of the signature in its block do not depend on the other blocks, so the block is a filter of its own
+    BloomFilter bloom = {.bits = {block, BF_BLOCK_BITS}, .block_count = 1, .hash_count = header.hash_count};
+    return read && !bf_may_contain(&bloom, hash);
+}
+
+/**
+ * Check the Bloom filter files of a base database and its delta segments for the signature of a word, without opening
+ * the segments. A single block of each filter is read.
+ *
+ * @param path The path of the base database.
+ * @param word The word, or its signature, as the signature hash does not depend on the order of the characters.
+ * @param length The length of the word.
+ * @return false if every segment has a filter that rejects the signature, so no segment has it, true otherwise.
+ */
+bool adb_bloom_may_contain(const char *path, const char *word, size_t length) {
+    uint64_t hash = ss_hash(word, length);
+    size_t segment_count = 0;
+    for (size_t delta = 0; delta <= ADB_MAX_DELTAS; delta++) {
+        char *segment_path = adb_segment_path(path, delta);
+        struct stat st;
+        if (!segment_path) {
+            return true;
+        }
+        if (stat(segment_path, &st) == -1) {
+            // The base database does not need to exist, but the delta segments are numbered consecutively
+            free(segment_path);
+            if (delta == 0) {
+                continue;
+            }
+            break;
+        }
+        bool rejected = bloom_rejects(segment_path, &st, hash);
+        free(segment_path);
+        if (!rejected) {
+            return true;
+        }
+        segment_count++;
+    }
+
+    // Without segments, the database cannot be opened, which is left to the caller to report
+    return segment_count == 0;
+}
+
+/**
+ * Merge entries with the same signature, and pass each distinct word to a callback in ascending order. The words of
+ * each entry must be sorted.
+ *
+ * @param entries The entries.
+ * @param entry_count The number of entries.
+ * @param callback The callback that receives the words.
+ * @param context The context that is passed to the callback.
+ * @return false if the callback stopped the merge, true otherwise.
+ */
+bool adb_merge_words(const AdbEntry *entries, size_t entry_count, AdbWordCallback callback, void *context) {
+    size_t positions[entry_count];
+    memset(positions, 0, sizeof(positions));
+    while (true) {
+        // Find the smallest current word
+        const char *smallest = NULL;
+        size_t length = 0;
+        for (size_t i = 0; i < entry_count; i++) {
+            if (positions[i] < entries[i].word_count) {
+                const char *word = adb_word(&entries[i], positions[i]);
+                if (!smallest || strcmp(word, smallest) < 0) {
+                    smallest = word;
+                    length = entries[i].length;
+                }
+            }
+        }
+        if (!smallest) {
+            return true;
+        }
+        if (!callback(smallest, length, context)) {
+            return false;
+        }
+        // Skip the word in all the entries that have it
+        for (size_t i = 0; i < entry_count; i++) {
+            if (positions[i] < entries[i].word_count && strcmp(adb_word(&entries[i], positions[i]), smallest) == 0) {
+                positions[i]++;
+            }
+        }
+    }
+}
+
+/**
+ * Search all the segments for a signature, and pass the words of the matching entries to a callback. The words are
+ * merged in ascending order and each distinct word is passed once.
+ *
+ * @param set Pointer to the segment set data structure.
+ * @param signature The signature to search for.
+ * @param length The length of the signature.
+ * @param callback The callback that receives the words.
+ * @param context The context that is passed to the callback.
+ * @return true if the signature was found in any segment, false otherwise.
+ */
+bool adb_set_lookup(const AdbSegmentSet *set, const char *signature, size_t length, AdbWordCallback callback,
+                    void *context) {
+    AdbEntry entries[set->segment_count];
+    memset(entries, 0, sizeof(entries));
+    size_t entry_count = 0;
+    for (size_t i = 0; i < set->segment_count; i++) {
+        if (adb_lookup(&set->segments[i], signature, length, &entries[entry_count])) {
+            entry_count++;
+        }
+    }
+    if (entry_count > 0) {
+        adb_merge_words(entries, entry_count, callback, context);
+    }
+    for (size_t i = 0; i < set->segment_count; i++) {
+        adb_entry_free(&entries[i]);
+    }
+
+    return entry_count > 0;
+}
+
+/**
+ * The entries that were found by a rack search.
+ */
+typedef struct {
+    /** The entries. */
+    AdbEntry *entries;
+    /** The number of entries. */
+    size_t count;
+    /** The capacity of the entries array. */
+    size_t capacity;
+    /** The arena that holds the copies of the decoded entries of compact databases. */
+    Arena arena;
+} RackMatches;
+
+/**
+ * Add an entry to the entries that were found by a rack search.
+ *
+ * @param entry The entry.
+ * @param context Pointer to the rack matches.
+ * @return true if the entry was added, false if the memory could not be allocated.
+ */
+static bool add_rack_match(const AdbEntry *entry, void *context) {
+    RackMatches *matches = context;
+    if (matches->count == matches->capacity) {
+        size_t capacity = matches->capacity + ADB_CHUNK_SIZE;
+        AdbEntry *entries = realloc(matches->entries, capacity * sizeof(AdbEntry));
+        if (!entries) {
+            return false;
+        }
+        matches->entries = entries;
+        matches->capacity = capacity;
+    }
+    AdbEntry *match = &matches->entries[matches->count++];
+    *match = *entry;
+    if (entry->buffer) {
+        // The buffer of the entry is reused for the next entry, so the decoded entry is copied
+        size_t size = (entry->length + 1) * (entry->word_count + 1);
+        char *buffer = arena_alloc_chars(&matches->arena, size);
+        if (!buffer) {
+            return false;
+        }
+        memcpy(buffer, entry->signature, entry->length + 1);
+        memcpy(buffer + entry->length + 1, entry->words, size - entry->length - 1);
+        match->signature = buffer;
+        match->words = buffer + entry->length + 1;
+        match->buffer = NULL;
+        match->buffer_size = 0;
+    }
+
+    return true;
+}
+
+/**
+ * Comparison function for sorting the entries that were found by a rack search, from the longest to the shortest
+ * signature, and then by signature.
+ *
+ * @param p Pointer to the first array element to compare.
+ * @param q Pointer to the second array element to compare.
+ * @return -1 if the first element is less that the second, 1 if the first element is greater then the second or 0 if
+ * the two elements are equal.
+ */
+static int compare_rack_matches(const void *p, const void *q) {
+    const AdbEntry *x = p;
+    const AdbEntry *y = q;
+    if (x->length != y->length) {
+        return x->length > y->length ? -1 : 1;
+    }
+
+    return memcmp(x->signature, y->signature, x->length);
+}
+
+/**
+ * Search all the segments for the words that can be built from a set of letters, and pass them to a callback. The
+ * words are passed from the longest to the shortest, the words with the same signature are merged in ascending order,
+ * and each distinct word is passed once.
+ *
+ * @param set Pointer to the segment set data structure.
+ * @param letters The set of letters. It must consist of the letters 'a' to 'z'.
+ * @param length The number of letters.
+ * @param callback The callback that receives the words.
+ * @param context The context that is passed to the callback.
+ * @return true if the search was successful, false if the letters are invalid or the memory could not be allocated.
+ */
+bool adb_set_rack_search(const AdbSegmentSet *set, const char *letters, size_t length, AdbWordCallback callback,
+                         void *context) {
+    SsHistogram rack;
+    if (!ss_histogram(letters, length, &rack)) {
+        return false;
+    }
+    RackMatches matches = {0};
+    arena_init(&matches.arena, 0);
+    bool ok = true;
+    for (size_t i = 0; i < set->segment_count && ok; i++) {
+        ok = adb_rack_search(&set->segments[i], &rack, length, add_rack_match, &matches);
+    }
+
+    // Merge the entries with the same signature from different segments
+    if (ok) {
+        qsort(matches.entries, matches.count, sizeof(AdbEntry), compare_rack_matches);
+        for (size_t first = 0, last = 0; first < matches.count; first = last) {
+            while (last < matches.count && compare_rack_matches(&matches.entries[first], &matches.entries[last]) == 0) {
+                last++;
+            }
+            if (!adb_merge_words(matches.entries + first, last - first, callback, context)) {
+                break;
+            }
+        }
+    }
+    free(matches.entries);
+    arena_destroy(&matches.arena);
+
+    return ok;
+}
+
+/**
+ * Take an exclusive lock on the segments of a database, so that delta segments are not appended while the segments are
+ * compacted. The lock is held on the file PATH.lock, and it is released when the process exits.
+ *
+ * @param path The path of the base database.
+ * @return The file descriptor of the lock file, or -1 if the lock could not be taken.
+ */
+int adb_lock_segments(const char *path) {
+    char *lock_path = malloc(strlen(path) + sizeof(ADB_LOCK_SUFFIX));
+    if (!lock_path) {
+        return -1;
+    }
+    strcpy(lock_path, path);
+    strcat(lock_path, ADB_LOCK_SUFFIX);
+    int fd = open(lock_path, O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    free(lock_path);
+    if (fd != -1 && flock(fd, LOCK_EX) == -1) {
+        close(fd);
+        return -1;
+    }
+
+    return fd;
+}
+
+/**
+ * Release the lock on the segments of a database.
+ *
+ * @param lock_fd The file descriptor of the lock file.
+ */
+void adb_unlock_segments(int lock_fd) {
+    if (lock_fd != -1) {
+        flock(lock_fd, LOCK_UN);
+        close(lock_fd);
+    }
+}
+
+/**
+ * Open an anagram database and its delta segments.
+ *
+ * @param db Pointer to the handle data structure.
+ * @param path The path of the database.
+ * @return PP_OK if the database was opened successfully, an error otherwise.
+ */
+PpStatus pp_anagram_db_open(PpAnagramDb *db, const char *path) {
+    return adb_set_open(&db->set, path) ? PP_OK : PP_ERROR_IO;
+}
+
+/**
+ * The output of a lookup of the embeddable API.
+ */
+typedef struct {
+    /** The query word */
+    const char *word;
+    /** The length of the query word */
+    size_t length;
+    /** The buffer */
+    char *buffer;
+    /** The size of the buffer */
+    size_t capacity;
+    /** The number of anagrams */
+    size_t count;
+    /** The size of the anagrams, which may exceed the capacity */
+    size_t size;
+} LookupOutput;
+
+/**
+ * Copy an anagram to the buffer of a lookup, if it fits. The size is counted in any case, so that the caller can learn
+ * the size that the buffer must have.
+ *
+ * @param word The anagram.
+ * @param length The length of the anagram.
+ * @param context Pointer to the lookup output.
+ * @return Always true.
+ */
+static bool copy_anagram(const char *word, size_t length, void *context) {
+    LookupOutput *output = context;
+    if (length == output->length && memcmp(word, output->word, length) == 0) {
+        return true;
+    }
+    if (output->size + length + 1 <= output->capacity) {
+        memcpy(output->buffer + output->size, word, length + 1);
+    }
+    output->size += length + 1;
+    output->count++;
+
+    return true;
+}
+
+/**
+ * Look up the anagrams of a word, other than the word itself. The anagrams are written to a caller provided buffer in
+ * ascending order, each one null terminated.
+ *
+ * @param db The handle.
+ * @param word The word.
+ * @param length The length of the word.
+ * @param buffer The buffer.
+ * @param capacity The size of the buffer.
+ * @param count Pointer to where the number of anagrams will be written to, or NULL.
+ * @param size Pointer to where the size of the anagrams will be written to, or NULL. If the buffer is too small, it is
+ * the size that the buffer must have.
+ * @return PP_OK if the anagrams were written to the buffer, PP_ERROR_BUFFER if the buffer is too small or
+ * PP_ERROR_MEMORY if the memory could not be allocated.
+ */
+PpStatus pp_anagram_db_lookup(const PpAnagramDb *db, const char *word, size_t length, char *buffer, size_t capacity,
+                              size_t *count, size_t *size) {
+    // The signature of a short word is calculated on the stack, so that the lookup does not allocate
+    char stack_signature[ADB_STACK_SIGNATURE_SIZE];
+    char *signature = length < ADB_STACK_SIGNATURE_SIZE ? stack_signature : malloc(length + 1);
+    if (!signature) {
+        return PP_ERROR_MEMORY;
+    }
+    ss_calculate(word, length, signature);
+
+    LookupOutput output = {.word = word, .length = length, .buffer = buffer, .capacity = capacity};
+    adb_set_lookup(&db->set, signature, length, copy_anagram, &output);
+    if (signature != stack_signature) {
+        free(signature);
+    }
+    if (count) {
+        *count = output.count;
+    }
+    if (size) {
+        *size = output.size;
+    }
+
+    return output.size <= capacity ? PP_OK : PP_ERROR_BUFFER;
+}
+
+/**
+ * Close an anagram database and its delta segments.
+ *
+ * @param db Pointer to the handle data structure.
+ */
+void pp_anagram_db_close(PpAnagramDb *db) {
+    adb_set_close(&db->set);
+}
@@ -2,14 +2,57 @@
  * This program builds a anagram database from a dictionary. The database maps the dictionary words to a signature,
  * which is the word with all its letters sorted. Words with the same signature are anagrams of each other.
  *
+ * With more than one thread, the dictionary is loaded with a single read, the signatures are calculated in parallel
+ * over chunks of the dictionary and the signature pairs are sorted with a parallel merge sort, on the work stealing
+ * pool of the library. The pairs are ordered by signature and then by word, so the database is the same regardless of
+ * the number of threads.
+ *
+ * With a memory limit, the dictionary is sorted in runs that fit in the limit, which are written to temporary files,
+ * and the runs are merged with a heap straight into the database, a group of anagrams at a time, so dictionaries that
+ * are larger than the memory can be built. If there are too many runs to merge at once, they are merged in several
+ * passes.
+ *
+ * In append mode, the dictionary holds only the new words, and it is written as a small delta segment next to the
+ * database. Delta segments keep the words that have no anagram in the segment itself, as they may be anagrams of words
+ * in other segments. The segments are merged when they are searched, and they are merged into the database by
+ * compact_anagram_db.
+ *
+ * The database has a summary section with the statistics of the anagram classes, which anagram_stats reads. With
+ * --bloom, a Bloom filter of the signatures is written to a file next to the database or the delta segment, which the
+ * searches test before they search the segment.
+ *
  * This is a solution for problem 1.
  */
+#include <errno.h>
+#include <limits.h>
+#include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
+#include <getopt.h>
+#include <unistd.h>
+
+#include "anagramdb.h"
+#include "arena.h"
+#include "pool.h"
+#include "reader.h"
+#include "stats.h"
 #include "stringsig.h"
 
+// The maximum number of threads
+#define MAX_THREADS PP_POOL_MAX_WORKERS
+// The number of words of the chunks whose signatures are calculated at once
+#define SIGNATURE_GRAIN 4096
+// The size of the blocks in which the dictionary is read in bulk
+#define READ_BLOCK_SIZE (1024 * 1024)
+// The largest number of runs that are merged at once, which bounds the open files and their buffers
+#define MERGE_FAN_IN 64
+// The initial number of words of the group of anagrams that is written from the merged runs
+#define GROUP_SIZE 16
+// The suffix of the temporary file of a legacy database, which replaces the output file once it is complete
+#define LEGACY_TEMP_SUFFIX ".tmp"
+
 /**
  * Structure that holds a word along with its signature
  */
@@ -23,7 +66,249 @@ typedef struct {
 } SignaturePair;
 
 /**
- * Comparison function for sorting an array of string signature elements.
+ * The loaded dictionary.
+ */
+typedef struct {
+    /** The signature pairs */
+    SignaturePair *pairs;
+    /** The number of signature pairs */
+    size_t word_count;
+    /** The arena that holds the words and signatures, when the dictionary is read line by line */
+    Arena arena;
+    /** The buffer that holds the words, when the dictionary is read in bulk */
+    char *buffer;
+    /** The buffer that holds the signatures, when the dictionary is read in bulk */
+    char *signatures;
+} Dictionary;
+
+/**
+ * A sorted run of signature pairs in a temporary file, which is read a pair at a time while it is merged.
+ */
+typedef struct {
+    /** The temporary file */
+    FILE *file;
+    /** The current signature pair of the run */
+    SignaturePair pair;
+    /** The buffer that holds the word and the signature of the current pair */
+    char *buffer;
+    /** The size of the buffer */
+    size_t capacity;
+} Run;
+
+/**
+ * A merge of sorted runs, which returns their signature pairs in order. The runs are kept in a heap ordered by their
+ * current pairs.
+ */
+typedef struct {
+    /** The runs */
+    Run *runs;
+    /** The number of runs */
+    size_t run_count;
+    /** The heap of the runs that are not exhausted */
+    Run **heap;
+    /** The number of runs in the heap */
+    size_t heap_count;
+    /** The run whose pair was returned last, which is advanced on the next call */
+    Run *current;
+    /** false if a run could not be read */
+    bool ok;
+} RunMerge;
+
+/**
+ * The temporary files of the sorted runs of the dictionary.
+ */
+typedef struct {
+    /** The run files */
+    FILE **files;
+    /** The number of run files */
+    size_t count;
+    /** The capacity of the run files array */
+    size_t capacity;
+    /** The number of words in all the runs */
+    size_t word_count;
+} RunFiles;
+
+// The help flag
+static bool help_flag = false;
+// The number of threads to use
+static size_t threads = 1;
+// The pool of the threads, when more than one is used
+static PpPool pool;
+// The version of the database format to write
+static uint32_t format = ADB_VERSION;
+// The optional sections of the database to write. The summary section is small, so it is always written.
+static uint32_t writer_flags = ADB_WRITER_SUMMARY;
+// true if the dictionary is written as a delta segment of the output database
+static bool append_flag = false;
+// true if the words without anagrams are written to the database as well
+static bool singletons_flag = false;
+// The false positive rate of the Bloom filter file of the database, or zero if no filter file is written
+static double bloom_rate = 0;
+// The memory of the words and signature pairs of a sorted run, in bytes, or zero to sort the whole dictionary in memory
+static size_t memory_limit = 0;
+// The dictionary file
+static char *input = NULL;
+// The output file
+static char *output = NULL;
+
+/**
+ * Parse the command line arguments.
+ *
+ * @param argc The number of command line arguments.
+ * @param argv The command line arguments.
+ * @return true if the parsing was successful, false otherwise.
+ */
+bool parse_arguments(int argc, char *argv[]) {
+    static struct option long_options[] = {
+        {"append", no_argument, 0, 'a'},
+        {"bloom", required_argument, 0, 'b'},
+        {"format", required_argument, 0, 'f'},
+        {"hash", no_argument, 0, 'H'},
+        {"memory-limit", required_argument, 0, 'l'},
+        {"rack-index", no_argument, 0, 'r'},
+        {"singletons", no_argument, 0, 's'},
+        {"threads", required_argument, 0, 't'},
+        {"help", no_argument, 0, 'h'},
+        STATS_LONG_OPTION,
+        {0, 0, 0, 0}
+    };
+
+    // Parse options
+    int c;
+    char *end_ptr = NULL;
+    int option_index = 0;
+    while (true) {
+        c = getopt_long(argc, argv, "ahHrsb:f:l:t:", long_options, &option_index);
+        if (c == -1) {
+            break;
+        }
+        switch (c) {
+            case 'a':
+                append_flag = true;
+                break;
+            case 'b':
+                errno = 0;
+                bloom_rate = strtod(optarg, &end_ptr);
+                if (end_ptr == optarg || *end_ptr != '\0' || errno != 0 || !(bloom_rate > 0 && bloom_rate < 1)) {
+                    fprintf(stderr, "Invalid value for the bloom argument: %s.\n", optarg);
+                    return false;
+                }
+                break;
+            case 'f':
+                errno = 0;
+                format = strtoul(optarg, &end_ptr, 10);
+                if (end_ptr == optarg || errno != 0 || (format != ADB_VERSION_LEGACY && format != ADB_VERSION &&
+                                                           format != ADB_VERSION_COMPACT)) {
+                    fprintf(stderr, "Invalid value for the format argument: %s.\n", optarg);
+                    return false;
+                }
+                break;
+            case 'H':
+                writer_flags |= ADB_WRITER_HASH;
+                break;
+            case 'l':
+                errno = 0;
+                memory_limit = strtoul(optarg, &end_ptr, 10);
+                if (end_ptr == optarg || *end_ptr != '\0' || errno != 0 || memory_limit == 0 ||
+                    memory_limit > SIZE_MAX >> 20) {
+                    fprintf(stderr, "Invalid value for the memory limit argument: %s.\n", optarg);
+                    return false;
+                }
+                memory_limit <<= 20;
+                break;
+            case 'r':
+                writer_flags |= ADB_WRITER_RACK;
+                break;
+            case 's':
+                singletons_flag = true;
+                break;
+            case 't':
+                errno = 0;
+                threads = strtoul(optarg, &end_ptr, 10);
+                if (end_ptr == optarg || errno != 0 || threads == 0 || threads > MAX_THREADS) {
+                    fprintf(stderr, "Invalid value for the threads argument: %s.\n", optarg);
+                    return false;
+                }
+                break;
+            case STATS_OPTION:
+                if (!stats_enable(optarg)) {
+                    return false;
+                }
+                break;
+            case 'h':
+                help_flag = true;
+                return false;
+            default:
+                return false;
+        }
+    }
+
+    // Parse the remaining arguments
+    if (optind + 2 > argc) {
+        fprintf(stderr, "A dictionary and an output file must be provided.\n");
+        return false;
+    }
+    input = argv[optind];
+    output = argv[optind + 1];
+    // Validate the arguments
+    if (format == ADB_VERSION_LEGACY && (append_flag || singletons_flag)) {
+        fprintf(stderr, "The legacy format does not support delta segments or words without anagrams.\n");
+        return false;
+    }
+    if (format != ADB_VERSION && (writer_flags & (ADB_WRITER_HASH | ADB_WRITER_RACK))) {
+        fprintf(stderr, "The %s format does not support hash tables or rack indexes.\n",
+                format == ADB_VERSION_LEGACY ? "legacy" : "compact");
+        return false;
+    }
+    if (format == ADB_VERSION_COMPACT) {
+        writer_flags |= ADB_WRITER_COMPACT;
+    }
+    // The rack searches must find the words without anagrams as well
+    if (writer_flags & ADB_WRITER_RACK) {
+        singletons_flag = true;
+    }
+
+    return true;
+}
+
+/**
+ * Prints usage instructions for the program.
+ */
+void print_usage() {
+    printf("Usage: build_anagram_db [OPTION]... [DICTIONARY] [OUTPUT]\n\n"
+           "Build an anagram database from the [DICTIONARY] file and write it to the [OUTPUT] file.\n\n"
+           "Mandatory arguments to long options are mandatory for short options too.\n"
+           "    -a, --append            Write the dictionary as a new delta segment of the [OUTPUT] database, instead\n"
+           "                                of replacing it. The words without anagrams are kept in the segment.\n"
+           "    -b, --bloom=RATE        Write a Bloom filter of the signatures next to the database, with the false\n"
+           "                                positive rate RATE, such as 0.01, so that most searches for words\n"
+           "                                without anagrams return without searching the database.\n"
+           "    -f, --format=VERSION    The version of the database format to write, default is %d. Version %d\n"
+           "                                is the legacy format, which can only hold words of up to 255 characters\n"
+           "                                and entries of up to 255 words. Version %d is the compact format, which\n"
+           "                                is front coded and has no size limits.\n"
+           "    -H, --hash              Add a hash table to the database, so that a lookup reads a single record\n"
+           "                                instead of binary searching the entries. Not supported by the legacy\n"
+           "                                and the compact formats.\n"
+           "    -l, --memory-limit=MIB  Sort the dictionary in runs of at most MIB MiB, which are written to\n"
+           "                                temporary files and merged into the database, so that dictionaries\n"
+           "                                larger than the memory can be built. By default the whole dictionary\n"
+           "                                is sorted in memory.\n"
+           "    -r, --rack-index        Add a rack index to the database, so that the words that can be built from a\n"
+           "                                set of letters are found without checking every entry. It implies\n"
+           "                                --singletons, as the words without anagrams can be built from a set of\n"
+           "                                letters too. Not supported by the legacy and the compact formats.\n"
+           "    -s, --singletons        Keep the words without anagrams in the database, so that the words of delta\n"
+           "                                segments that are appended later can be matched with them.\n"
+           "    -t, --threads=THREADS   The number of threads to use, default is 1.\n"
+           STATS_USAGE
+           "    -h, --help              Display this help and exit.\n", ADB_VERSION, ADB_VERSION_LEGACY,
+           ADB_VERSION_COMPACT);
+}
+
+/**
+ * Comparison function for sorting an array of string signature elements. Elements with the same signature are ordered
+ * by the original word, so that the order does not depend on the sort algorithm.
  *
  * @param p Pointer to the first array element to compare.
  * @param q Pointer to the second array element to compare.
@@ -31,64 +316,442 @@ typedef struct {
  * the two elements are equal.
  */
 int compare_signature_pairs(const void *p, const void *q) {
-    SignaturePair x = *(const SignaturePair*) p;
-    SignaturePair y = *(const SignaturePair*) q;
-    size_t max_length = (x.length < y.length) ? y.length : x.length;
+    const SignaturePair *x = (const SignaturePair*) p;
+    const SignaturePair *y = (const SignaturePair*) q;
+    int result = strcmp(x->signature, y->signature);
 
-    return strncmp(x.signature, y.signature, max_length);
+    return result != 0 ? result : strcmp(x->original, y->original);
 }
 
 /**
- * Write an anagram db entry to the output file.
+ * Write an anagram db entry to the output file. The length and the number of words are stored in a single byte each.
  *
  * @param file The output file.
  * @param pairs The signature pairs.
  * @param first_entry The index of the first signature pair to write.
  * @param last_entry The index of the last signature pair to write.
+ * @return true if the entry was written, false if the words are too long or too many for the legacy format.
  */
-void write_db_entry(FILE *file, const SignaturePair *pairs, size_t first_entry, size_t last_entry) {
+bool write_db_entry(FILE *file, const SignaturePair *pairs, size_t first_entry, size_t last_entry) {
+    if (pairs[first_entry].length > UCHAR_MAX || last_entry - first_entry + 1 > UCHAR_MAX) {
+        fprintf(stderr, "The anagrams of %s do not fit in the legacy format, use format version %d instead.\n",
+                pairs[first_entry].original, ADB_VERSION_COMPACT);
+        return false;
+    }
     fputc((char) pairs[first_entry].length, file);
     fputs(pairs[first_entry].signature, file);
     fputc((char) (last_entry - first_entry + 1), file);
     for (size_t j = first_entry; j <= last_entry; j++) {
         fputs(pairs[j].original, file);
     }
+
+    return true;
 }
 
-// The number of entries by which the database will be extended, if there is no space left
-#define CHUNK_SIZE 1000
+/**
+ * Write an anagram db entry to the legacy output file, or to the database writer.
+ *
+ * @param legacy_file The legacy output file, or NULL if the database writer is used.
+ * @param writer The database writer.
+ * @param pairs The signature pairs.
+ * @param first_entry The index of the first signature pair to write.
+ * @param last_entry The index of the last signature pair to write.
+ * @return true if the entry was written successfully, false otherwise.
+ */
+static bool write_entry(FILE *legacy_file, AdbWriter *writer, const SignaturePair *pairs, size_t first_entry,
+                        size_t last_entry) {
+    if (legacy_file) {
+        return write_db_entry(legacy_file, pairs, first_entry, last_entry) && !ferror(legacy_file);
+    }
+    if (!adb_writer_add_entry(writer, pairs[first_entry].signature, pairs[first_entry].length,
+                              last_entry - first_entry + 1)) {
+        return false;
+    }
+    for (size_t j = first_entry; j <= last_entry; j++) {
+        if (!adb_writer_add_word(writer, pairs[j].original)) {
+            return false;
+        }
+    }
+
+    return true;
+}
 
 /**
- * The main entry point of the program. It takes 2 required command line arguments: The dictionary file and the output
- * file where the anagram database will be written.
+ * Write a signature pair to a run file. The length is followed by the word and the signature, without terminators.
  *
- * @param argc The number of command line arguments.
- * @param argv The command line arguments.
- * @return The program exit status.
+ * @param file The run file.
+ * @param pair The signature pair.
+ * @return true if the pair was written successfully, false otherwise.
  */
-int main(int argc, char *argv[]) {
-    // Validate the number of command line arguments
-    if (argc < 3) {
-        fprintf(stderr, "Usage: build_anagram_db: [DICTIONARY] [OUTPUT]\n"
-                        "Build an anagram database from the [DICTIONARY] file and write it to the [OUTPUT] file.\n");
-        return EXIT_FAILURE;
+static bool write_run_pair(FILE *file, const SignaturePair *pair) {
+    return fwrite(&pair->length, sizeof(size_t), 1, file) == 1 &&
+           fwrite(pair->original, 1, pair->length, file) == pair->length &&
+           fwrite(pair->signature, 1, pair->length, file) == pair->length;
+}
+
+/**
+ * Read the next signature pair of a run.
+ *
+ * @param run The run.
+ * @param end Pointer to where true will be written to if the run is exhausted.
+ * @return true if the pair was read successfully or the run is exhausted, false otherwise.
+ */
+static bool read_run_pair(Run *run, bool *end) {
+    size_t length;
+    *end = fread(&length, sizeof(size_t), 1, run->file) != 1;
+    if (*end) {
+        return !ferror(run->file);
+    }
+    if (2 * (length + 1) > run->capacity) {
+        size_t capacity = 2 * (length + 1) > 2 * run->capacity ? 2 * (length + 1) : 2 * run->capacity;
+        char *buffer = realloc(run->buffer, capacity);
+        if (!buffer) {
+            return false;
+        }
+        run->buffer = buffer;
+        run->capacity = capacity;
     }
+    run->pair.original = run->buffer;
+    run->pair.signature = run->buffer + length + 1;
+    run->pair.length = length;
+    if (fread(run->pair.original, 1, length, run->file) != length ||
+        fread(run->pair.signature, 1, length, run->file) != length) {
+        return false;
+    }
+    run->pair.original[length] = '\0';
+    run->pair.signature[length] = '\0';
 
-    // Open the input input_file
-    FILE *input_file = fopen(argv[1], "r");
-    if (input_file == NULL) {
-        fprintf(stderr, "Unable to open the dictionary file %s.\n", argv[1]);
-        return EXIT_FAILURE;
+    return true;
+}
+
+/**
+ * Restore the heap order of a merge, by moving a run down the heap.
+ *
+ * @param merge The merge.
+ * @param index The index of the run in the heap.
+ */
+static void sift_down(RunMerge *merge, size_t index) {
+    while (true) {
+        size_t smallest = index;
+        size_t left = 2 * index + 1;
+        size_t right = left + 1;
+        if (left < merge->heap_count && compare_signature_pairs(&merge->heap[left]->pair,
+                                                                &merge->heap[smallest]->pair) < 0) {
+            smallest = left;
+        }
+        if (right < merge->heap_count && compare_signature_pairs(&merge->heap[right]->pair,
+                                                                 &merge->heap[smallest]->pair) < 0) {
+            smallest = right;
+        }
+        if (smallest == index) {
+            return;
+        }
+        Run *swap = merge->heap[index];
+        merge->heap[index] = merge->heap[smallest];
+        merge->heap[smallest] = swap;
+        index = smallest;
+    }
+}
+
+/**
+ * Free resources associated with a merge. The run files are not closed.
+ *
+ * @param merge The merge.
+ */
+static void run_merge_destroy(RunMerge *merge) {
+    for (size_t i = 0; i < merge->run_count; i++) {
+        free(merge->runs[i].buffer);
+    }
+    free(merge->runs);
+    free(merge->heap);
+}
+
+/**
+ * Start a merge of sorted runs, by reading the first pair of each one.
+ *
+ * @param merge The merge to start.
+ * @param files The run files, positioned at their first pair.
+ * @param count The number of run files.
+ * @return true if the merge was started successfully, false otherwise.
+ */
+static bool run_merge_init(RunMerge *merge, FILE *const *files, size_t count) {
+    RunMerge empty = {.runs = calloc(count, sizeof(Run)), .heap = malloc(count * sizeof(Run *)), .ok = true};
+    *merge = empty;
+    if (count > 0 && (!merge->runs || !merge->heap)) {
+        return false;
+    }
+    merge->run_count = count;
+    for (size_t i = 0; i < count; i++) {
+        merge->runs[i].file = files[i];
+        bool end;
+        if (!read_run_pair(&merge->runs[i], &end)) {
+            return false;
+        }
+        if (!end) {
+            merge->heap[merge->heap_count++] = &merge->runs[i];
+        }
     }
+    for (size_t i = merge->heap_count / 2; i-- > 0;) {
+        sift_down(merge, i);
+    }
+
+    return true;
+}
+
+/**
+ * Get the next signature pair of a merge.
+ *
+ * @param merge The merge.
+ * @return The next signature pair, which is valid until the next call, or NULL if the runs are exhausted or a run could
+ * not be read, in which case the ok flag of the merge is cleared.
+ */
+static const SignaturePair *run_merge_next(RunMerge *merge) {
+    if (merge->current) {
+        // Replace the pair that was returned last with the next one of its run
+        bool end;
+        if (!read_run_pair(merge->current, &end)) {
+            merge->ok = false;
+            return NULL;
+        }
+        if (end) {
+            merge->heap[0] = merge->heap[--merge->heap_count];
+        }
+        merge->current = NULL;
+        sift_down(merge, 0);
+    }
+    if (merge->heap_count == 0) {
+        return NULL;
+    }
+    merge->current = merge->heap[0];
 
-    // Read the dictionary
+    return &merge->current->pair;
+}
+
+/**
+ * Write the signature pairs of a merge to the database, grouped by signature as write_database does. Only the words of
+ * the current group are kept in memory, as the number of words of an entry is written before them.
+ *
+ * @param legacy_file The legacy output file, or NULL if the database writer is used.
+ * @param writer The database writer.
+ * @param merge The merge of the sorted runs.
+ * @param keep_singletons true if groups with a single word are written as well.
+ * @return true if the entries were written successfully, false otherwise.
+ */
+static bool write_merged_entries(FILE *legacy_file, AdbWriter *writer, RunMerge *merge, bool keep_singletons) {
+    // The signature of the group, followed by its words, which all have the same length
+    char *text = NULL;
+    size_t text_capacity = 0;
+    SignaturePair *group = NULL;
+    size_t group_capacity = 0;
+    size_t group_count = 0;
+    size_t length = 0;
+    bool ok = true;
+    while (ok) {
+        const SignaturePair *pair = run_merge_next(merge);
+        if (group_count > 0 && (pair == NULL || pair->length != length || strcmp(pair->signature, text) != 0)) {
+            // Different signature, write the group if its words are anagrams
+            if (group_count > 1 || keep_singletons) {
+                for (size_t i = 0; i < group_count; i++) {
+                    SignaturePair word = {.original = text + (i + 1) * (length + 1), .signature = text,
+                                          .length = length};
+                    group[i] = word;
+                }
+                ok = write_entry(legacy_file, writer, group, 0, group_count - 1);
+            }
+            group_count = 0;
+        }
+        if (pair == NULL || !ok) {
+            break;
+        }
+
+        // Add the word to the group, the pointers to the text are set when the group is written
+        length = group_count == 0 ? pair->length : length;
+        if (group_count == group_capacity) {
+            size_t capacity = group_capacity > 0 ? 2 * group_capacity : GROUP_SIZE;
+            SignaturePair *grown_group = realloc(group, capacity * sizeof(SignaturePair));
+            if (!grown_group) {
+                ok = false;
+                break;
+            }
+            group = grown_group;
+            group_capacity = capacity;
+        }
+        if ((group_count + 2) * (length + 1) > text_capacity) {
+            size_t capacity = (group_count + 2) * (length + 1);
+            capacity = capacity > 2 * text_capacity ? capacity : 2 * text_capacity;
+            char *grown_text = realloc(text, capacity);
+            if (!grown_text) {
+                ok = false;
+                break;
+            }
+            text = grown_text;
+            text_capacity = capacity;
+        }
+        if (group_count == 0) {
+            memcpy(text, pair->signature, length + 1);
+        }
+        memcpy(text + (group_count + 1) * (length + 1), pair->original, length + 1);
+        group_count++;
+    }
+    free(text);
+    free(group);
+
+    return ok && merge->ok;
+}
+
+/**
+ * Close the output file of the anagram database, and write its Bloom filter file if one was requested. Both formats
+ * are written to a temporary file, which replaces the database file once it is complete and on disk, and is removed
+ * otherwise.
+ *
+ * @param path The path of the database file.
+ * @param legacy_path The path of the temporary legacy output file, which is freed, or NULL if the database writer is
+ * used.
+ * @param legacy_file The legacy output file, or NULL if the database writer is used.
+ * @param writer The database writer.
+ * @param ok false if the entries were not written successfully, in which case the output file is not replaced.
+ * @return true if the database was written successfully, false otherwise.
+ */
+static bool close_database(const char *path, char *legacy_path, FILE *legacy_file, AdbWriter *writer, bool ok) {
+    bool written;
+    if (legacy_file) {
+        written = fflush(legacy_file) == 0 && fsync(fileno(legacy_file)) == 0 && ok;
+        written = fclose(legacy_file) == 0 && written && rename(legacy_path, path) == 0;
+        if (!written) {
+            unlink(legacy_path);
+        }
+        free(legacy_path);
+    } else {
+        written = adb_writer_close(writer) && ok;
+    }
+
+    return written && (bloom_rate == 0 || adb_write_bloom(path, bloom_rate));
+}
+
+/**
+ * Write the anagram database to a file. The signature pairs are grouped by signature, and each group with more than
+ * one word is written as a database entry. Groups with a single word are written as well if keep_singletons is set.
+ *
+ * @param path The path of the database file.
+ * @param pairs The signature pairs, sorted by signature, if they are in memory.
+ * @param merge The merge of the sorted runs of the signature pairs, or NULL if they are in memory.
+ * @param word_count The number of signature pairs.
+ * @param keep_singletons true if groups with a single word are written as well.
+ * @return true if the database was written successfully, false otherwise.
+ */
+static bool write_database(const char *path, const SignaturePair *pairs, RunMerge *merge, size_t word_count,
+                          bool keep_singletons) {
+    // Open the output file
+    char *legacy_path = NULL;
+    FILE *legacy_file = NULL;
+    AdbWriter writer;
+    if (format == ADB_VERSION_LEGACY) {
+        // Nothing is written for an empty dictionary
+        if (word_count == 0) {
+            return true;
+        }
+        legacy_path = malloc(strlen(path) + sizeof(LEGACY_TEMP_SUFFIX));
+        if (!legacy_path) {
+            return false;
+        }
+        strcpy(legacy_path, path);
+        strcat(legacy_path, LEGACY_TEMP_SUFFIX);
+        legacy_file = fopen(legacy_path, "wb");
+        if (legacy_file == NULL) {
+            free(legacy_path);
+            return false;
+        }
+    } else if (!adb_writer_open(&writer, path, writer_flags)) {
+        return false;
+    }
+
+    // Group entries with the same signature together
+    if (merge) {
+        bool ok = write_merged_entries(legacy_file, &writer, merge, keep_singletons);
+        return close_database(path, legacy_path, legacy_file, &writer, ok);
+    }
+    bool ok = true;
+    size_t first_entry = 0;
+    size_t last_entry = 0;
+    for (size_t i = 1; i < word_count && ok; i++) {
+        if (pairs[i].length == pairs[first_entry].length &&
+            strncmp(pairs[i].signature, pairs[first_entry].signature, pairs[first_entry].length) == 0) {
+            // The signature is the same, continue with the next entry
+            last_entry = i;
+        } else {
+            // Different signature. If there are more than one words with the same signature, write them to the
+            // output file, as they are anagrams
+            if (first_entry != last_entry || keep_singletons) {
+                ok = write_entry(legacy_file, &writer, pairs, first_entry, last_entry);
+            }
+            first_entry = i;
+            last_entry = i;
+        }
+    }
+    if (ok && word_count > 0 && (first_entry != last_entry || keep_singletons)) {
+        ok = write_entry(legacy_file, &writer, pairs, first_entry, last_entry);
+    }
+
+    return close_database(path, legacy_path, legacy_file, &writer, ok);
+}
+
+/**
+ * Write the dictionary as the next delta segment of the output database.
+ *
+ * @param pairs The signature pairs, sorted by signature, if they are in memory.
+ * @param merge The merge of the sorted runs of the signature pairs, or NULL if they are in memory.
+ * @param word_count The number of signature pairs.
+ * @return true if the delta segment was written successfully, false otherwise.
+ */
+static bool append_database(const SignaturePair *pairs, RunMerge *merge, size_t word_count) {
+    if (word_count == 0) {
+        return true;
+    }
+    // Hold the lock, so that the segments are not compacted while the segment number is chosen and written
+    int lock_fd = adb_lock_segments(output);
+    if (lock_fd == -1) {
+        return false;
+    }
+    size_t delta = 1;
+    char *segment_path;
+    while ((segment_path = adb_segment_path(output, delta)) != NULL && access(segment_path, F_OK) == 0) {
+        free(segment_path);
+        delta++;
+    }
+    bool ok = segment_path && delta <= ADB_MAX_DELTAS && write_database(segment_path, pairs, merge, word_count, true);
+    free(segment_path);
+    adb_unlock_segments(lock_fd);
+
+    return ok;
+}
+
+// The number of entries by which the database will be extended, if there is no space left
+#define CHUNK_SIZE 1000
+
+/**
+ * Read the dictionary line by line, and calculate the signature of each word. The reading stops early once the words
+ * and the signature pairs use the memory limit, so the rest of the dictionary can be loaded by the next call.
+ *
+ * @param reader The reader of the dictionary file.
+ * @param dictionary The dictionary to load.
+ * @param limit The memory that the words and the signature pairs can use, in bytes, or SIZE_MAX.
+ * @param end Pointer to where true will be written to if the end of the dictionary was reached.
+ * @return true if the dictionary was loaded successfully, false otherwise.
+ */
+static bool load_dictionary(PpReader *reader, Dictionary *dictionary, size_t limit, bool *end) {
+    // The words and signatures are allocated from the arena, and freed all at once
+    arena_init(&dictionary->arena, 0);
     char *line = NULL;
     size_t n = 0;
-    ssize_t line_length;
-    SignaturePair *pairs = malloc(CHUNK_SIZE * sizeof (SignaturePair));
-    size_t word_count = 0;
+    ssize_t line_length = 0;
+    size_t size = 0;
     size_t capacity = CHUNK_SIZE;
-    while ((line_length = getline(&line, &n, input_file)) != -1) {
+    dictionary->pairs = malloc(capacity * sizeof (SignaturePair));
+    if (!dictionary->pairs) {
+        return false;
+    }
+    while (size < limit && (line_length = pp_reader_getline(reader, &line, &n)) != -1) {
+        stats_add_bytes(line_length);
         // Strip new line if it exists
         if (line[line_length - 1] == '\n') {
             line[line_length - 1] = '\0';
@@ -96,69 +759,548 @@ int main(int argc, char *argv[]) {
         }
 
         // Crate the signature pair
-        char *original = strndup(line, line_length);
-        char *signature = malloc((line_length + 1) * sizeof (char));
+        char *original = arena_alloc_chars(&dictionary->arena, 2 * (line_length + 1));
+        if (original == NULL) {
+            free(line);
+            return false;
+        }
+        memcpy(original, line, line_length + 1);
+        char *signature = original + line_length + 1;
         ss_calculate(original, line_length, signature);
         SignaturePair pair = {.signature = signature, .original = original, .length = line_length};
-        pairs[word_count++] = pair;
+        dictionary->pairs[dictionary->word_count++] = pair;
+        size += 2 * (line_length + 1) + sizeof(SignaturePair);
 
         // Extend the capacity if needed
-        if (word_count == capacity) {
+        if (dictionary->word_count == capacity) {
             capacity += CHUNK_SIZE;
-            pairs = realloc(pairs, capacity * sizeof(SignaturePair));
+            SignaturePair *pairs = realloc(dictionary->pairs, capacity * sizeof(SignaturePair));
+            if (!pairs) {
+                free(line);
+                return false;
+            }
+            dictionary->pairs = pairs;
         }
     }
+    free(line);
+    stats_add_records(dictionary->word_count);
+    *end = line_length == -1;
 
-    // Sort the signature pairs
-    qsort(pairs, word_count, sizeof (SignaturePair), compare_signature_pairs);
+    return reader->status == PP_OK;
+}
 
-    // Build the database
-    int exit_status = EXIT_SUCCESS;
-    FILE *output_file = NULL;
-    if (word_count > 0) { // Check if not empty
-        // Open the output file
-        output_file = fopen(argv[2], "wb");
-        if (output_file == NULL) {
-            exit_status = EXIT_FAILURE;
-            fprintf(stderr, "Unable to open the output file %s for writing.\n", argv[1]);
-            goto cleanup;
+/**
+ * The words of the dictionary whose signatures are calculated in parallel.
+ */
+typedef struct {
+    /** The dictionary */
+    Dictionary *dictionary;
+    /** The offset of each word in the dictionary buffer */
+    const size_t *offsets;
+    /** The length of each word */
+    const size_t *lengths;
+} SignatureWords;
+
+/**
+ * Calculate the signatures of a chunk of the dictionary, and create its signature pairs.
+ *
+ * @param context Pointer to the words.
+ * @param first The index of the first word of the chunk.
+ * @param last The index after the last word of the chunk.
+ */
+static void calculate_signatures(void *context, size_t first, size_t last) {
+    SignatureWords *words = context;
+    Dictionary *dictionary = words->dictionary;
+    ss_calculate_many(dictionary->buffer, words->offsets + first, words->lengths + first, last - first,
+                      dictionary->signatures);
+    for (size_t i = first; i < last; i++) {
+        SignaturePair pair = {
+            .original = dictionary->buffer + words->offsets[i],
+            .signature = dictionary->signatures + words->offsets[i],
+            .length = words->lengths[i]
+        };
+        dictionary->pairs[i] = pair;
+    }
+}
+
+/**
+ * Read the whole dictionary with bulk reads, and calculate the signatures of the words with many threads.
+ *
+ * @param reader The reader of the dictionary file.
+ * @param dictionary The dictionary to load.
+ * @return true if the dictionary was loaded successfully, false otherwise.
+ */
+static bool load_dictionary_bulk(PpReader *reader, Dictionary *dictionary) {
+    // Read the file into a single buffer, with room for a terminating null character
+    size_t size = 0;
+    size_t capacity = READ_BLOCK_SIZE;
+    dictionary->buffer = malloc(capacity + 1);
+    if (!dictionary->buffer) {
+        return false;
+    }
+    size_t read;
+    while ((read = pp_reader_read(reader, dictionary->buffer + size, capacity - size)) > 0) {
+        size += read;
+        if (size == capacity) {
+            capacity *= 2;
+            char *buffer = realloc(dictionary->buffer, capacity + 1);
+            if (!buffer) {
+                return false;
+            }
+            dictionary->buffer = buffer;
         }
+    }
+    if (reader->status != PP_OK) {
+        return false;
+    }
+    stats_add_bytes(size);
+
+    // Split the buffer into words
+    size_t word_count = 0;
+    for (char *p = dictionary->buffer; (p = memchr(p, '\n', dictionary->buffer + size - p)) != NULL; p++) {
+        word_count++;
+    }
+    if (size > 0 && dictionary->buffer[size - 1] != '\n') {
+        word_count++;
+    }
+    dictionary->buffer[size] = '\0';
+    size_t *offsets = malloc(word_count * sizeof(size_t));
+    size_t *lengths = malloc(word_count * sizeof(size_t));
+    dictionary->signatures = malloc(size + 1);
+    dictionary->pairs = malloc(word_count * sizeof(SignaturePair));
+    if ((word_count > 0 && (!offsets || !lengths || !dictionary->pairs)) || !dictionary->signatures) {
+        free(offsets);
+        free(lengths);
+        return false;
+    }
+    size_t offset = 0;
+    for (size_t i = 0; i < word_count; i++) {
+        char *end = memchr(dictionary->buffer + offset, '\n', size - offset);
+        size_t length = end ? (size_t) (end - dictionary->buffer) - offset : size - offset;
+        dictionary->buffer[offset + length] = '\0';
+        offsets[i] = offset;
+        lengths[i] = length;
+        offset += length + 1;
+    }
+    dictionary->word_count = word_count;
+    stats_add_records(word_count);
+
+    // Calculate the signatures over chunks of the dictionary
+    stats_phase("signatures");
+    stats_add_records(word_count);
+    SignatureWords words = {.dictionary = dictionary, .offsets = offsets, .lengths = lengths};
+    pp_parallel_for(&pool, 0, word_count, SIGNATURE_GRAIN, calculate_signatures, &words);
+    free(offsets);
+    free(lengths);
 
-        // Group entries with the same signature together
-        size_t first_entry = 0;
-        size_t last_entry = 0;
-        for (size_t i = 1; i < word_count; i++) {
-            if (pairs[i].length == pairs[first_entry].length &&
-                strncmp(pairs[i].signature, pairs[first_entry].signature, pairs[first_entry].length) == 0) {
-                // The signature is the same, continue with the next entry
-                last_entry = i;
+    return true;
+}
+
+/**
+ * A task of the parallel merge sort, which sorts a run of the signature pairs, or merges two sorted runs.
+ */
+typedef struct {
+    /** The first sorted run to merge, or the run to sort */
+    const SignaturePair *a;
+    /** The number of elements of the first run */
+    size_t a_count;
+    /** The second sorted run to merge */
+    const SignaturePair *b;
+    /** The number of elements of the second run, or zero if the first run should be sorted */
+    size_t b_count;
+    /** Pointer to where the merged runs will be written to */
+    SignaturePair *output;
+} MergeTask;
+
+/**
+ * Sort runs of signature pairs, or merge pairs of sorted runs.
+ *
+ * @param context Pointer to the merge tasks.
+ * @param first The index of the first task to run.
+ * @param last The index after the last task to run.
+ */
+static void run_merge_tasks(void *context, size_t first, size_t last) {
+    for (MergeTask *task = (MergeTask *) context + first; task < (MergeTask *) context + last; task++) {
+        if (task->b == NULL) {
+            qsort(task->output, task->a_count, sizeof(SignaturePair), compare_signature_pairs);
+            continue;
+        }
+        size_t i = 0;
+        size_t j = 0;
+        size_t k = 0;
+        while (i < task->a_count && j < task->b_count) {
+            if (compare_signature_pairs(&task->b[j], &task->a[i]) < 0) {
+                task->output[k++] = task->b[j++];
             } else {
-                // Different signature. If there are more than one words with the same signature, write them to the
-                // output file, as they are anagrams
-                if (first_entry != last_entry) {
-                    write_db_entry(output_file, pairs, first_entry, last_entry);
-                }
-                first_entry = i;
-                last_entry = i;
+                task->output[k++] = task->a[i++];
             }
         }
-        if (first_entry != last_entry) {
-            write_db_entry(output_file, pairs, first_entry, last_entry);
+        memcpy(task->output + k, task->a + i, (task->a_count - i) * sizeof(SignaturePair));
+        k += task->a_count - i;
+        memcpy(task->output + k, task->b + j, (task->b_count - j) * sizeof(SignaturePair));
+    }
+}
+
+/**
+ * Find the number of elements of a sorted run that are less than a value.
+ *
+ * @param run The sorted run.
+ * @param count The number of elements of the run.
+ * @param value The value.
+ * @return The number of elements less than the value.
+ */
+static size_t lower_bound(const SignaturePair *run, size_t count, const SignaturePair *value) {
+    size_t low = 0;
+    size_t high = count;
+    while (low < high) {
+        size_t middle = low + (high - low) / 2;
+        if (compare_signature_pairs(&run[middle], value) < 0) {
+            low = middle + 1;
+        } else {
+            high = middle;
         }
     }
 
-    // Cleanup
-cleanup:
-    if (output_file != NULL) {
-        fclose(output_file);
+    return low;
+}
+
+/**
+ * Sort the signature pairs with a parallel merge sort. Each thread sorts a run of the pairs, and then the runs are
+ * merged in rounds. When a round has fewer merges than threads, each merge is split into independent parts by binary
+ * searching the second run for the split points of the first one, so that all threads are kept busy. The tasks of each
+ * step are run by the pool, which balances parts of uneven sizes between the threads.
+ *
+ * @param pairs The signature pairs.
+ * @param count The number of signature pairs.
+ * @return true if the pairs were sorted successfully, false otherwise.
+ */
+static bool parallel_sort(SignaturePair *pairs, size_t count) {
+    SignaturePair *buffer = malloc(count * sizeof(SignaturePair));
+    // Each step has at most one task per thread
+    MergeTask *tasks = calloc(threads, sizeof(MergeTask));
+    if (!buffer || !tasks) {
+        free(buffer);
+        free(tasks);
+        return false;
     }
-    for (size_t i = 0; i < word_count; i++) {
-        free(pairs[i].original);
-        free(pairs[i].signature);
+    size_t runs = threads;
+    size_t run_bounds[MAX_THREADS + 1];
+    for (size_t i = 0; i <= runs; i++) {
+        run_bounds[i] = count * i / runs;
     }
-    free(pairs);
-    free(line);
+
+    // Sort the runs
+    for (size_t i = 0; i < runs; i++) {
+        MergeTask task = {.a_count = run_bounds[i + 1] - run_bounds[i], .output = pairs + run_bounds[i]};
+        tasks[i] = task;
+    }
+    pp_parallel_for(&pool, 0, runs, 1, run_merge_tasks, tasks);
+
+    // Merge pairs of runs until a single run is left
+    SignaturePair *source = pairs;
+    SignaturePair *target = buffer;
+    while (runs > 1) {
+        size_t merges = runs / 2;
+        size_t parts = threads > merges ? threads / merges : 1;
+        size_t task_count = 0;
+        for (size_t m = 0; m < merges; m++) {
+            const SignaturePair *a = source + run_bounds[2 * m];
+            size_t a_count = run_bounds[2 * m + 1] - run_bounds[2 * m];
+            const SignaturePair *b = source + run_bounds[2 * m + 1];
+            size_t b_count = run_bounds[2 * m + 2] - run_bounds[2 * m + 1];
+            SignaturePair *output = target + run_bounds[2 * m];
+            size_t a_start = 0;
+            size_t b_start = 0;
+            for (size_t p = 1; p <= parts; p++) {
+                size_t a_end = p == parts ? a_count : a_count * p / parts;
+                size_t b_end = p == parts ? b_count : lower_bound(b, b_count, &a[a_end]);
+                MergeTask task = {
+                    .a = a + a_start, .a_count = a_end - a_start,
+                    .b = b + b_start, .b_count = b_end - b_start,
+                    .output = output + a_start + b_start
+                };
+                tasks[task_count++] = task;
+                a_start = a_end;
+                b_start = b_end;
+            }
+        }
+        // An odd run is copied as it is
+        if (runs % 2 == 1) {
+            memcpy(target + run_bounds[runs - 1], source + run_bounds[runs - 1],
+                   (run_bounds[runs] - run_bounds[runs - 1]) * sizeof(SignaturePair));
+        }
+        pp_parallel_for(&pool, 0, task_count, 1, run_merge_tasks, tasks);
+
+        // Compute the bounds of the merged runs
+        for (size_t i = 0; i <= merges; i++) {
+            run_bounds[i] = run_bounds[2 * i];
+        }
+        run_bounds[(runs + 1) / 2] = count;
+        runs = (runs + 1) / 2;
+        SignaturePair *swap = source;
+        source = target;
+        target = swap;
+    }
+    if (source != pairs) {
+        memcpy(pairs, source, count * sizeof(SignaturePair));
+    }
+    free(buffer);
+    free(tasks);
+
+    return true;
+}
+
+/**
+ * Free resources associated with the dictionary.
+ *
+ * @param dictionary The dictionary.
+ */
+static void destroy_dictionary(Dictionary *dictionary) {
+    arena_destroy(&dictionary->arena);
+    free(dictionary->buffer);
+    free(dictionary->signatures);
+    free(dictionary->pairs);
+}
+
+/**
+ * Add a run file to the run files.
+ *
+ * @param runs The run files.
+ * @param file The run file, positioned at its first pair. It is closed if it cannot be added.
+ * @return true if the run file was added successfully, false otherwise.
+ */
+static bool add_run_file(RunFiles *runs, FILE *file) {
+    if (runs->count == runs->capacity) {
+        size_t capacity = runs->capacity > 0 ? 2 * runs->capacity : MERGE_FAN_IN;
+        FILE **files = realloc(runs->files, capacity * sizeof(FILE *));
+        if (!files) {
+            fclose(file);
+            return false;
+        }
+        runs->files = files;
+        runs->capacity = capacity;
+    }
+    runs->files[runs->count++] = file;
+
+    return true;
+}
+
+/**
+ * Write sorted signature pairs to a new run file.
+ *
+ * @param runs The run files.
+ * @param pairs The signature pairs, sorted by signature.
+ * @param count The number of signature pairs.
+ * @return true if the run was written successfully, false otherwise.
+ */
+static bool write_run(RunFiles *runs, const SignaturePair *pairs, size_t count) {
+    FILE *file = tmpfile();
+    if (file == NULL) {
+        return false;
+    }
+    bool ok = true;
+    for (size_t i = 0; i < count && ok; i++) {
+        ok = write_run_pair(file, &pairs[i]);
+    }
+    if (!ok || fflush(file) != 0 || fseek(file, 0, SEEK_SET) != 0) {
+        fclose(file);
+        return false;
+    }
+
+    return add_run_file(runs, file);
+}
+
+/**
+ * Read the dictionary in parts that fit in the memory limit, and sort each part. The parts are written as sorted runs
+ * to temporary files, unless the whole dictionary fits in the first one, which is then kept in memory.
+ *
+ * @param reader The reader of the dictionary file.
+ * @param dictionary The dictionary, which holds the sorted signature pairs if no run was written.
+ * @param runs The run files.
+ * @return true if the dictionary was sorted successfully, false otherwise.
+ */
+static bool sort_runs(PpReader *reader, Dictionary *dictionary, RunFiles *runs) {
+    bool end = false;
+    while (!end) {
+        Dictionary part = {0};
+        bool loaded = load_dictionary(reader, &part, memory_limit, &end);
+        bool sorted = loaded && (threads == 1 || part.word_count == 0 || parallel_sort(part.pairs, part.word_count));
+        if (sorted && threads == 1) {
+            qsort(part.pairs, part.word_count, sizeof(SignaturePair), compare_signature_pairs);
+        }
+        if (sorted && end && runs->count == 0) {
+            *dictionary = part;
+            return true;
+        }
+        bool written = sorted && (part.word_count == 0 || write_run(runs, part.pairs, part.word_count));
+        runs->word_count += part.word_count;
+        destroy_dictionary(&part);
+        if (!written) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * Merge the run files in passes, MERGE_FAN_IN at a time, until at most MERGE_FAN_IN are left, so that the final merge
+ * keeps a bounded number of files open.
+ *
+ * @param runs The run files.
+ * @return true if the runs were merged successfully, false otherwise.
+ */
+static bool merge_run_files(RunFiles *runs) {
+    while (runs->count > MERGE_FAN_IN) {
+        RunFiles merged = {.word_count = runs->word_count};
+        bool ok = true;
+        for (size_t first = 0; first < runs->count && ok; first += MERGE_FAN_IN) {
+            size_t count = runs->count - first < MERGE_FAN_IN ? runs->count - first : MERGE_FAN_IN;
+            FILE *file = tmpfile();
+            RunMerge merge;
+            ok = file != NULL && run_merge_init(&merge, runs->files + first, count);
+            const SignaturePair *pair;
+            while (ok && (pair = run_merge_next(&merge)) != NULL) {
+                ok = write_run_pair(file, pair);
+            }
+            ok = ok && merge.ok && fflush(file) == 0 && fseek(file, 0, SEEK_SET) == 0;
+            if (file != NULL) {
+                run_merge_destroy(&merge);
+            }
+            if (ok) {
+                ok = add_run_file(&merged, file);
+            } else if (file != NULL) {
+                fclose(file);
+            }
+        }
+
+        // The merged runs replace the runs
+        for (size_t i = 0; i < runs->count; i++) {
+            fclose(runs->files[i]);
+        }
+        free(runs->files);
+        *runs = merged;
+        if (!ok) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * Close the run files, and free their resources.
+ *
+ * @param runs The run files.
+ */
+static void destroy_run_files(RunFiles *runs) {
+    for (size_t i = 0; i < runs->count; i++) {
+        fclose(runs->files[i]);
+    }
+    free(runs->files);
+}
+
+/**
+ * The main entry point of the program. It takes 2 required command line arguments: The dictionary file and the output
+ * file where the anagram database will be written.
+ *
+ * @param argc The number of command line arguments.
+ * @param argv The command line arguments.
+ * @return The program exit status.
+ */
+int main(int argc, char *argv[]) {
+    // Parse the command line arguments
+    if (!parse_arguments(argc, argv)) {
+        if (help_flag) {
+            print_usage();
+            return EXIT_SUCCESS;
+        } else {
+            return EXIT_FAILURE;
+        }
+    }
+
+    // Open the input input_file
+    FILE *input_file = fopen(input, "r");
+    if (input_file == NULL) {
+        fprintf(stderr, "Unable to open the dictionary file %s.\n", input);
+        return EXIT_FAILURE;
+    }
+    PpReader reader;
+    PpStatus status = pp_reader_open(&reader, fileno(input_file), PP_READER_AUTO);
+    if (status != PP_OK) {
+        fprintf(stderr, "Unable to read the dictionary file %s: %s.\n", input, pp_status_message(status));
+        fclose(input_file);
+        return EXIT_FAILURE;
+    }
+
+    // Read the dictionary and sort the signature pairs
+    int exit_status = EXIT_SUCCESS;
+    Dictionary dictionary = {0};
+    RunFiles runs = {0};
+    RunMerge merge = {0};
+    stats_phase("read");
+    if (threads > 1) {
+        status = pp_pool_init(&pool, threads);
+        if (status != PP_OK) {
+            exit_status = EXIT_FAILURE;
+            fprintf(stderr, "Unable to start %zu threads: %s.\n", threads, pp_status_message(status));
+            goto cleanup;
+        }
+    }
+    if (memory_limit > 0) {
+        // The runs are sorted while the dictionary is read
+        if (!sort_runs(&reader, &dictionary, &runs)) {
+            exit_status = EXIT_FAILURE;
+            fprintf(stderr, "Unable to sort the dictionary file %s in runs.\n", input);
+            goto cleanup;
+        }
+        stats_phase("merge");
+        if (!merge_run_files(&runs) || (runs.count > 0 && !run_merge_init(&merge, runs.files, runs.count))) {
+            exit_status = EXIT_FAILURE;
+            fprintf(stderr, "Unable to merge the runs of the dictionary file %s.\n", input);
+            goto cleanup;
+        }
+        dictionary.word_count = runs.count > 0 ? runs.word_count : dictionary.word_count;
+    } else if (threads == 1) {
+        bool end;
+        if (!load_dictionary(&reader, &dictionary, SIZE_MAX, &end)) {
+            exit_status = EXIT_FAILURE;
+            fprintf(stderr, "Unable to load the dictionary file %s.\n", input);
+            goto cleanup;
+        }
+        stats_phase("sort");
+        stats_add_records(dictionary.word_count);
+        qsort(dictionary.pairs, dictionary.word_count, sizeof (SignaturePair), compare_signature_pairs);
+    } else {
+        bool loaded = load_dictionary_bulk(&reader, &dictionary);
+        stats_phase("sort");
+        stats_add_records(dictionary.word_count);
+        if (!loaded || !parallel_sort(dictionary.pairs, dictionary.word_count)) {
+            exit_status = EXIT_FAILURE;
+            fprintf(stderr, "Unable to load the dictionary file %s.\n", input);
+            goto cleanup;
+        }
+    }
+    // Build the database
+    stats_phase("write");
+    stats_add_records(dictionary.word_count);
+    RunMerge *source = runs.count > 0 ? &merge : NULL;
+    bool written = append_flag ? append_database(dictionary.pairs, source, dictionary.word_count) :
+                   write_database(output, dictionary.pairs, source, dictionary.word_count, singletons_flag);
+    if (!written) {
+        exit_status = EXIT_FAILURE;
+        fprintf(stderr, "Unable to write the database to the output file %s.\n", output);
+    }
+
+    // Cleanup
+cleanup:
+    pp_pool_destroy(&pool);
+    run_merge_destroy(&merge);
+    destroy_run_files(&runs);
+    destroy_dictionary(&dictionary);
+    pp_reader_close(&reader);
     fclose(input_file);
+    stats_report();
 
     return exit_status;
 }
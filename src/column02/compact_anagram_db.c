@@ -0,0 +1,291 @@
+/**
+ * This program compacts an anagram database: It merges the delta segments that were appended to the database by
+ * build_anagram_db --append into the base database, and then removes them.
+ *
+ * All the segments are sorted by signature, so they are merged with a single sequential k-way merge, and nothing is
+ * sorted again. The merged database replaces the base database atomically, so the segments can be compacted in the
+ * background while they are searched. The merged database has the format of the base database, except that a legacy
+ * base database is upgraded to the current version, as the merged entries may not fit in the legacy format. If any
+ * segment has a Bloom filter file, one is written for the merged database with the same false positive rate, and the
+ * filter files of the delta segments are removed with them.
+ *
+ * This is a solution for problem 1.
+ */
+#include <errno.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <getopt.h>
+#include <unistd.h>
+
+#include "anagramdb.h"
+#include "stats.h"
+
+// The help flag
+static bool help_flag = false;
+// The optional sections of the compacted database. The summary section is always written.
+static uint32_t writer_flags = ADB_WRITER_SUMMARY;
+// The database file
+static char *db_path = NULL;
+
+/**
+ * Parse the command line arguments.
+ *
+ * @param argc The number of command line arguments.
+ * @param argv The command line arguments.
+ * @return true if the parsing was successful, false otherwise.
+ */
+bool parse_arguments(int argc, char *argv[]) {
+    static struct option long_options[] = {
+        {"hash", no_argument, 0, 'H'},
+        {"rack-index", no_argument, 0, 'r'},
+        {"help", no_argument, 0, 'h'},
+        STATS_LONG_OPTION,
+        {0, 0, 0, 0}
+    };
+
+    // Parse options
+    int c;
+    int option_index = 0;
+    while (true) {
+        c = getopt_long(argc, argv, "hHr", long_options, &option_index);
+        if (c == -1) {
+            break;
+        }
+        switch (c) {
+            case 'H':
+                writer_flags |= ADB_WRITER_HASH;
+                break;
+            case 'r':
+                writer_flags |= ADB_WRITER_RACK;
+                break;
+            case STATS_OPTION:
+                if (!stats_enable(optarg)) {
+                    return false;
+                }
+                break;
+            case 'h':
+                help_flag = true;
+                return false;
+            default:
+                return false;
+        }
+    }
+
+    // Parse the remaining arguments
+    if (optind >= argc) {
+        fprintf(stderr, "An anagram database must be provided.\n");
+        return false;
+    }
+    db_path = argv[optind];
+
+    return true;
+}
+
+/**
+ * Prints usage instructions for the program.
+ */
+void print_usage() {
+    printf("Usage: compact_anagram_db [OPTION]... [ANAGRAM_DB]\n\n"
+           "Merge the delta segments of the anagram database file [ANAGRAM_DB] into it, and remove them. The\n"
+           "compacted database has the format of the base database, except that a legacy base database is\n"
+           "upgraded to version %d, as the legacy format limits the sizes of the merged entries.\n\n"
+           "Mandatory arguments to long options are mandatory for short options too.\n"
+           "    -H, --hash              Add a hash table to the compacted database. It is added anyway if the base\n"
+           "                                database has one.\n"
+           "    -r, --rack-index        Add a rack index to the compacted database. It is added anyway if the base\n"
+           "                                database has one.\n"
+           STATS_USAGE
+           "    -h, --help              Display this help and exit.\n", ADB_VERSION);
+}
+
+/**
+ * Count a word.
+ *
+ * @param word The word.
+ * @param length The length of the word.
+ * @param context Pointer to the word count.
+ * @return Always true.
+ */
+static bool count_word(const char *word, size_t length, void *context) {
+    (void) word;
+    (void) length;
+    (*(size_t *) context)++;
+
+    return true;
+}
+
+/**
+ * Write a word to the database writer.
+ *
+ * @param word The word.
+ * @param length The length of the word.
+ * @param context Pointer to the database writer.
+ * @return true if the word was written successfully, false otherwise.
+ */
+static bool write_word(const char *word, size_t length, void *context) {
+    (void) length;
+    return adb_writer_add_word(context, word);
+}
+
+/**
+ * Merge the entries of all the segments into the writer. At each step, the entries with the smallest signature among
+ * the current entries of the segments are merged into a single entry.
+ *
+ * @param set The database segments.
+ * @param writer The database writer.
+ * @return true if the segments were merged successfully, false otherwise.
+ */
+static bool merge_segments(const AdbSegmentSet *set, AdbWriter *writer) {
+    size_t positions[set->segment_count];
+    AdbEntry current[set->segment_count];
+    AdbEntry merged[set->segment_count];
+    size_t merged_segments[set->segment_count];
+    memset(current, 0, sizeof(current));
+    bool ok = true;
+    for (size_t i = 0; i < set->segment_count && ok; i++) {
+        positions[i] = 0;
+        ok = set->segments[i].entry_count == 0 || adb_entry(&set->segments[i], 0, &current[i]);
+    }
+
+    while (ok) {
+        // Find the smallest signature
+        const AdbEntry *smallest = NULL;
+        for (size_t i = 0; i < set->segment_count; i++) {
+            if (positions[i] < set->segments[i].entry_count &&
+                (!smallest || adb_compare(current[i].signature, current[i].length, smallest) < 0)) {
+                smallest = &current[i];
+            }
+        }
+        if (!smallest) {
+            break;
+        }
+
+        // Collect the entries with that signature
+        size_t merged_count = 0;
+        for (size_t i = 0; i < set->segment_count; i++) {
+            if (positions[i] < set->segments[i].entry_count &&
+                adb_compare(current[i].signature, current[i].length, smallest) == 0) {
+                merged_segments[merged_count] = i;
+                merged[merged_count++] = current[i];
+            }
+        }
+
+        // Write the merged entry
+        size_t word_count = 0;
+        adb_merge_words(merged, merged_count, count_word, &word_count);
+        ok = adb_writer_add_entry(writer, smallest->signature, smallest->length, word_count) &&
+             adb_merge_words(merged, merged_count, write_word, writer);
+        stats_add_records(1);
+
+        // Advance the segments of the merged entries. This is done last, as the entries of compact segments are
+        // decoded to the buffers of the current entries.
+        for (size_t j = 0; j < merged_count && ok; j++) {
+            size_t i = merged_segments[j];
+            ok = ++positions[i] == set->segments[i].entry_count ||
+                 adb_entry(&set->segments[i], positions[i], &current[i]);
+        }
+    }
+    for (size_t i = 0; i < set->segment_count; i++) {
+        adb_entry_free(&current[i]);
+    }
+
+    return ok;
+}
+
+/**
+ * The main entry point of the program. It takes 1 required command line argument: The anagram database file.
+ *
+ * @param argc The number of command line arguments.
+ * @param argv The command line arguments.
+ * @return The program exit status.
+ */
+int main(int argc, char *argv[]) {
+    // Parse the command line arguments
+    if (!parse_arguments(argc, argv)) {
+        if (help_flag) {
+            print_usage();
+            return EXIT_SUCCESS;
+        } else {
+            return EXIT_FAILURE;
+        }
+    }
+
+    // Hold the lock, so that no delta segments are appended while they are merged and removed
+    stats_phase("open");
+    int lock_fd = adb_lock_segments(db_path);
+    if (lock_fd == -1) {
+        fprintf(stderr, "Unable to lock database file %s: %s.\n", db_path, strerror(errno));
+        return EXIT_FAILURE;
+    }
+    AdbSegmentSet set;
+    if (!adb_set_open(&set, db_path)) {
+        fprintf(stderr, "Unable to open database file %s.\n", db_path);
+        adb_unlock_segments(lock_fd);
+        return EXIT_FAILURE;
+    }
+    int exit_status = EXIT_SUCCESS;
+    if (set.delta_count == 0) {
+        goto cleanup;
+    }
+
+    // Merge the segments into a new base database
+    if (set.has_base && set.segments[0].hash_slots) {
+        writer_flags |= ADB_WRITER_HASH;
+    }
+    if (set.has_base && set.segments[0].rack_groups) {
+        writer_flags |= ADB_WRITER_RACK;
+    }
+    if (set.has_base && set.segments[0].version == ADB_VERSION_COMPACT) {
+        writer_flags |= ADB_WRITER_COMPACT;
+    }
+    AdbWriter writer;
+    if (!adb_writer_open(&writer, db_path, writer_flags)) {
+        fprintf(stderr, "Unable to open the output file %s for writing.\n", db_path);
+        exit_status = EXIT_FAILURE;
+        goto cleanup;
+    }
+    stats_phase("merge");
+    bool merged = merge_segments(&set, &writer);
+    stats_phase("write");
+    if (!adb_writer_close(&writer) || !merged) {
+        fprintf(stderr, "Unable to write the compacted database to the output file %s.\n", db_path);
+        exit_status = EXIT_FAILURE;
+        goto cleanup;
+    }
+    for (size_t i = 0; i < set.segment_count; i++) {
+        if (set.segments[i].bloom_map) {
+            if (!adb_write_bloom(db_path, set.segments[i].bloom_rate)) {
+                fprintf(stderr, "Unable to write the Bloom filter of the compacted database %s.\n", db_path);
+                exit_status = EXIT_FAILURE;
+            }
+            break;
+        }
+    }
+
+    // Remove the delta segments, starting from the last one, so that the remaining ones are numbered consecutively
+    stats_phase("remove");
+    for (size_t delta = set.delta_count; delta > 0; delta--) {
+        char *segment_path = adb_segment_path(db_path, delta);
+        if (!segment_path || unlink(segment_path) == -1) {
+            fprintf(stderr, "Unable to remove the delta segment %s.\n", segment_path ? segment_path : "");
+            exit_status = EXIT_FAILURE;
+        }
+        // The filter file is stale without its segment, so a failure to remove it is harmless
+        char *filter_path = segment_path ? adb_bloom_path(segment_path) : NULL;
+        if (filter_path) {
+            unlink(filter_path);
+        }
+        free(filter_path);
+        free(segment_path);
+    }
+
+cleanup:
+    adb_set_close(&set);
+    adb_unlock_segments(lock_fd);
+    stats_report();
+
+    return exit_status;
+}
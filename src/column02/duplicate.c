@@ -0,0 +1,390 @@
+/**
+ * This library finds a duplicate 32-bit integer of a file, as find_duplicate does, without printing anything. All the
+ * methods only read the file sequentially, once per pass, and parse it as missing_number_file does.
+ *
+ * The histogram method splits the range into 2^16 buckets by the high 16 bits of the integers. If a bucket has more
+ * integers than values, which is always the case for a file of more than 2^32 integers, one more pass that counts the
+ * integers of the bucket by their low 16 bits finds a duplicate, so two passes are enough. Otherwise only the buckets
+ * with at least two integers can have a duplicate, and they are checked with a bit set of 2^16 bits each, as many at
+ * once as the memory limit allows.
+ */
+#include <limits.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bitset.h"
+#include "duplicate.h"
+#include "missing.h"
+
+// The number of bits of the bucket of an integer
+#define BUCKET_BITS 16
+// The number of buckets of the range
+#define BUCKET_COUNT ((size_t) 1 << (32 - BUCKET_BITS))
+// The number of values of a bucket
+#define BUCKET_SIZE ((size_t) 1 << BUCKET_BITS)
+// The number of bits of a bit set unit
+#define UNIT_BITS (sizeof(BS_UNIT) * CHAR_BIT)
+// The slot of a bucket that is not checked
+#define NO_SLOT UINT32_MAX
+
+/**
+ * The input file of a search, which is read once per pass.
+ */
+typedef struct {
+    /** The reader of the file. */
+    PpReader reader;
+    /** The line buffer. */
+    char *line;
+    /** The size of the line buffer. */
+    size_t line_size;
+    /** The number of passes that were started, and the bytes and integers that they read. */
+    PpDuplicateCounts counts;
+    /** Pointer to where the number of an invalid line will be written to, or NULL. */
+    size_t *error_line;
+} Input;
+
+/**
+ * The counters of the integers per bucket, or of the integers of a bucket per value.
+ */
+typedef struct {
+    /** The counters. */
+    uint64_t *counts;
+    /** The bucket whose integers are counted by value. */
+    uint32_t bucket;
+} Histogram;
+
+/**
+ * The bit sets of the buckets that are checked in a pass.
+ */
+typedef struct {
+    /** The slot of the bit set of each bucket, or NO_SLOT if the bucket is not checked. */
+    uint32_t *slots;
+    /** The bit sets of the slots, one after the other. */
+    BS_UNIT *bits;
+    /** true if a duplicate integer was found. */
+    bool found;
+    /** The duplicate integer. */
+    uint32_t duplicate;
+} BucketSets;
+
+/**
+ * The range of a counting binary search.
+ */
+typedef struct {
+    /** The first integer of the range. */
+    uint32_t low;
+    /** The last integer of the lower half of the range. */
+    uint32_t middle;
+    /** The last integer of the range. */
+    uint32_t high;
+    /** The number of integers in the lower half. */
+    uint64_t low_count;
+    /** The number of integers in the upper half. */
+    uint64_t high_count;
+} Search;
+
+/**
+ * Read all the integers of the input in a new pass.
+ *
+ * @param input Pointer to the input data structure.
+ * @param visit The function that is called for each integer. The pass stops early if it returns false.
+ * @param context The context that is passed to the function.
+ * @return PP_OK if the pass was completed, an error otherwise.
+ */
+static PpStatus scan(Input *input, bool (*visit)(void *context, uint32_t number), void *context) {
+    if (input->counts.passes++ > 0 && pp_reader_rewind(&input->reader) != PP_OK) {
+        return PP_ERROR_IO;
+    }
+    size_t count = 0;
+    while (true) {
+        uint32_t number;
+        bool end;
+        PpStatus status = pp_read_number(&input->reader, true, &input->line, &input->line_size, &number, &end);
+        if (status != PP_OK) {
+            if (input->error_line) {
+                *input->error_line = count + 1;
+            }
+            return status;
+        } else if (end) {
+            return PP_OK;
+        }
+        input->counts.bytes += strlen(input->line);
+        input->counts.records++;
+        if (!visit(context, number)) {
+            return PP_OK;
+        }
+        count++;
+    }
+}
+
+/**
+ * Count an integer in its bucket.
+ *
+ * @param context Pointer to the histogram.
+ * @param number The integer.
+ * @return Always true.
+ */
+static bool count_bucket(void *context, uint32_t number) {
+    Histogram *histogram = context;
+    histogram->counts[number >> BUCKET_BITS]++;
+    return true;
+}
+
+/**
+ * Count an integer by its value, if it is in the bucket of the histogram.
+ *
+ * @param context Pointer to the histogram.
+ * @param number The integer.
+ * @return Always true.
+ */
+static bool count_value(void *context, uint32_t number) {
+    Histogram *histogram = context;
+    if (number >> BUCKET_BITS == histogram->bucket) {
+        histogram->counts[number & (BUCKET_SIZE - 1)]++;
+    }
+    return true;
+}
+
+/**
+ * Mark an integer in the bit set of its bucket, if the bucket is checked.
+ *
+ * @param context Pointer to the bucket sets.
+ * @param number The integer.
+ * @return false if the integer was already marked, true otherwise.
+ */
+static bool mark_value(void *context, uint32_t number) {
+    BucketSets *sets = context;
+    uint32_t slot = sets->slots[number >> BUCKET_BITS];
+    if (slot == NO_SLOT) {
+        return true;
+    }
+    size_t bit = (size_t) slot * BUCKET_SIZE + (number & (BUCKET_SIZE - 1));
+    BS_UNIT mask = (BS_UNIT) 1 << (bit % UNIT_BITS);
+    BS_UNIT *unit = &sets->bits[bit / UNIT_BITS];
+    if (*unit & mask) {
+        sets->found = true;
+        sets->duplicate = number;
+        return false;
+    }
+    *unit |= mask;
+    return true;
+}
+
+/**
+ * Count an integer in its half of the search range, if it is in the range.
+ *
+ * @param context Pointer to the search.
+ * @param number The integer.
+ * @return Always true.
+ */
+static bool count_halves(void *context, uint32_t number) {
+    Search *search = context;
+    if (number >= search->low && number <= search->high) {
+        if (number <= search->middle) {
+            search->low_count++;
+        } else {
+            search->high_count++;
+        }
+    }
+    return true;
+}
+
+/**
+ * Check the buckets that have at least two integers with bit sets, as many buckets per pass as the memory limit allows.
+ *
+ * @param input Pointer to the input data structure.
+ * @param counts The number of integers of each bucket.
+ * @param memory_limit The memory that the bit sets can use, in bytes.
+ * @param duplicate Pointer to where the duplicate integer will be written to.
+ * @return PP_OK if a duplicate integer was found, PP_ERROR_NO_DUPLICATE if there is none, or another error.
+ */
+static PpStatus check_buckets(Input *input, const uint64_t *counts, size_t memory_limit, uint32_t *duplicate) {
+    size_t bucket_bytes = BUCKET_SIZE / CHAR_BIT;
+    size_t slot_count = memory_limit / bucket_bytes > 0 ? memory_limit / bucket_bytes : 1;
+    slot_count = slot_count < BUCKET_COUNT ? slot_count : BUCKET_COUNT;
+    BucketSets sets = {.slots = malloc(BUCKET_COUNT * sizeof(uint32_t)), .bits = malloc(slot_count * bucket_bytes)};
+    PpStatus status = sets.slots && sets.bits ? PP_ERROR_NO_DUPLICATE : PP_ERROR_MEMORY;
+
+    size_t next_bucket = 0;
+    while (status == PP_ERROR_NO_DUPLICATE && next_bucket < BUCKET_COUNT) {
+        // Assign the slots to the next candidate buckets
+        size_t used = 0;
+        for (size_t i = 0; i < BUCKET_COUNT; i++) {
+            sets.slots[i] = NO_SLOT;
+        }
+        for (; next_bucket < BUCKET_COUNT && used < slot_count; next_bucket++) {
+            if (counts[next_bucket] >= 2) {
+                sets.slots[next_bucket] = (uint32_t) used++;
+            }
+        }
+        if (used == 0) {
+            break;
+        }
+
+        memset(sets.bits, 0, used * bucket_bytes);
+        PpStatus scan_status = scan(input, mark_value, &sets);
+        if (scan_status != PP_OK) {
+            status = scan_status;
+        } else if (sets.found) {
+            *duplicate = sets.duplicate;
+            status = PP_OK;
+        }
+    }
+    free(sets.slots);
+    free(sets.bits);
+
+    return status;
+}
+
+/**
+ * Find a duplicate integer with the histogram method.
+ *
+ * @param input Pointer to the input data structure.
+ * @param memory_limit The memory that the bit sets can use, in bytes.
+ * @param duplicate Pointer to where the duplicate integer will be written to.
+ * @return PP_OK if a duplicate integer was found, PP_ERROR_NO_DUPLICATE if there is none, or another error.
+ */
+static PpStatus find_histogram(Input *input, size_t memory_limit, uint32_t *duplicate) {
+    Histogram histogram = {.counts = calloc(BUCKET_COUNT, sizeof(uint64_t))};
+    if (!histogram.counts) {
+        return PP_ERROR_MEMORY;
+    }
+    PpStatus status = scan(input, count_bucket, &histogram);
+    if (status != PP_OK) {
+        free(histogram.counts);
+        return status;
+    }
+
+    // A bucket with more integers than values must have a duplicate, which the counts of its values find
+    bool overflow = false;
+    for (size_t i = 0; i < BUCKET_COUNT && !overflow; i++) {
+        if (histogram.counts[i] > BUCKET_SIZE) {
+            overflow = true;
+            histogram.bucket = (uint32_t) i;
+        }
+    }
+    if (!overflow) {
+        status = check_buckets(input, histogram.counts, memory_limit, duplicate);
+        free(histogram.counts);
+        return status;
+    }
+    memset(histogram.counts, 0, BUCKET_SIZE * sizeof(uint64_t));
+    status = scan(input, count_value, &histogram);
+    for (size_t i = 0; i < BUCKET_SIZE && status == PP_OK; i++) {
+        if (histogram.counts[i] > 1) {
+            *duplicate = histogram.bucket << BUCKET_BITS | (uint32_t) i;
+            free(histogram.counts);
+            return PP_OK;
+        }
+    }
+    free(histogram.counts);
+
+    // The input changed between the passes
+    return status == PP_OK ? PP_ERROR_IO : status;
+}
+
+/**
+ * Find a duplicate integer with the counting binary search method.
+ *
+ * @param input Pointer to the input data structure.
+ * @param memory_limit The memory that the bit sets of the fallback method can use, in bytes.
+ * @param duplicate Pointer to where the duplicate integer will be written to.
+ * @return PP_OK if a duplicate integer was found, PP_ERROR_NO_DUPLICATE if there is none, or another error.
+ */
+static PpStatus find_search(Input *input, size_t memory_limit, uint32_t *duplicate) {
+    Search search = {.low = 0, .high = UINT32_MAX};
+    while (search.low < search.high) {
+        search.middle = search.low + (search.high - search.low) / 2;
+        search.low_count = 0;
+        search.high_count = 0;
+        PpStatus status = scan(input, count_halves, &search);
+        if (status != PP_OK) {
+            return status;
+        }
+        if (search.low_count > (uint64_t) search.middle - search.low + 1) {
+            search.high = search.middle;
+        } else if (search.high_count > (uint64_t) search.high - search.middle) {
+            search.low = search.middle + 1;
+        } else {
+            // Neither half must have a duplicate, which only happens in the first pass
+            return find_histogram(input, memory_limit, duplicate);
+        }
+    }
+    *duplicate = search.low;
+
+    return PP_OK;
+}
+
+/**
+ * Find a duplicate integer with a bit set of the whole range.
+ *
+ * @param input Pointer to the input data structure.
+ * @param memory_limit The memory that the bit sets of the fallback method can use, in bytes.
+ * @param duplicate Pointer to where the duplicate integer will be written to.
+ * @return PP_OK if a duplicate integer was found, PP_ERROR_NO_DUPLICATE if there is none, or another error.
+ */
+static PpStatus find_bitset(Input *input, size_t memory_limit, uint32_t *duplicate) {
+    BucketSets sets = {
+        .slots = malloc(BUCKET_COUNT * sizeof(uint32_t)),
+        .bits = calloc(BUCKET_COUNT * BUCKET_SIZE / UNIT_BITS, sizeof(BS_UNIT))
+    };
+    if (!sets.slots || !sets.bits) {
+        free(sets.slots);
+        free(sets.bits);
+        return find_histogram(input, memory_limit, duplicate);
+    }
+    for (size_t i = 0; i < BUCKET_COUNT; i++) {
+        sets.slots[i] = (uint32_t) i;
+    }
+    PpStatus status = scan(input, mark_value, &sets);
+    if (status == PP_OK) {
+        status = sets.found ? PP_OK : PP_ERROR_NO_DUPLICATE;
+        *duplicate = sets.duplicate;
+    }
+    free(sets.slots);
+    free(sets.bits);
+
+    return status;
+}
+
+/**
+ * Find a duplicate 32-bit integer of a file of integers, one per line. The file is read sequentially, once per pass, so
+ * it must be a regular file if more than one pass is needed. If the file has more integers than the 32-bit range has
+ * values, a duplicate always exists.
+ *
+ * @param input The input file, which is read through its file descriptor, so nothing must have been read from it.
+ * @param method The method to use.
+ * @param memory_limit The memory that the bit sets of the histogram method can use, in bytes.
+ * @param duplicate Pointer to where the duplicate integer will be written to.
+ * @param line Pointer to where the number of the invalid line will be written to on a parse or range error, or NULL.
+ * @param counts Pointer to where the number of passes and the bytes and integers that they read will be written to, or
+ * NULL.
+ * @return PP_OK if a duplicate integer was found, PP_ERROR_NO_DUPLICATE if there is none, or another error.
+ */
+PpStatus pp_duplicate_file(FILE *input, PpDuplicateMethod method, size_t memory_limit, uint32_t *duplicate,
+                           size_t *line, PpDuplicateCounts *counts) {
+    Input in = {.error_line = line};
+    PpStatus status = pp_reader_open(&in.reader, fileno(input), PP_READER_AUTO);
+    if (status != PP_OK) {
+        return status;
+    }
+    switch (method) {
+        case PP_DUPLICATE_SEARCH:
+            status = find_search(&in, memory_limit, duplicate);
+            break;
+        case PP_DUPLICATE_BITSET:
+            status = find_bitset(&in, memory_limit, duplicate);
+            break;
+        default:
+            status = find_histogram(&in, memory_limit, duplicate);
+            break;
+    }
+    if (counts) {
+        *counts = in.counts;
+    }
+    free(in.line);
+    pp_reader_close(&in.reader);
+
+    return status;
+}
@@ -0,0 +1,168 @@
+/**
+ * This program finds a duplicate number in an input file of 32-bit unsigned integers, one per line. A file of more than
+ * 2^32 integers always has one, and it can be found with little memory by counting, as the numbers cannot all fit in
+ * their range. The file is only read sequentially, once per pass.
+ *
+ * By default, the numbers are counted by their high 16 bits, and then the numbers of a bucket that has more numbers
+ * than values are counted by their low 16 bits, so two passes are enough. The counting binary search of the range uses
+ * constant memory instead, and the bit set of the whole range needs a single pass, if 512 MiB can be allocated.
+ *
+ * The search is done by pp_duplicate_file of the library, and this program only reports its result.
+ *
+ * This is a solution for problem B.
+ */
+#include <errno.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <getopt.h>
+
+#include "duplicate.h"
+#include "stats.h"
+
+// The help flag
+static bool help_flag = false;
+// The method to use
+static PpDuplicateMethod method = PP_DUPLICATE_HISTOGRAM;
+// The memory that the bit sets of the histogram method can use, in bytes
+static size_t memory_limit = PP_DUPLICATE_MEMORY_LIMIT;
+// The file to open
+static char *input = NULL;
+
+/**
+ * Parse the command line arguments.
+ *
+ * @param argc The number of command line arguments.
+ * @param argv The command line arguments.
+ * @return true if the parsing was successful, false otherwise.
+ */
+bool parse_arguments(int argc, char *argv[]) {
+    static struct option long_options[] = {
+        {"method", required_argument, 0, 'm'},
+        {"memory-limit", required_argument, 0, 'l'},
+        {"help", no_argument, 0, 'h'},
+        STATS_LONG_OPTION,
+        {0, 0, 0, 0}
+    };
+
+    // Parse options
+    int c;
+    char *end_ptr = NULL;
+    int option_index = 0;
+    while ((c = getopt_long(argc, argv, "hm:l:", long_options, &option_index)) != -1) {
+        switch (c) {
+            case 'm':
+                if (strcmp(optarg, "histogram") == 0) {
+                    method = PP_DUPLICATE_HISTOGRAM;
+                } else if (strcmp(optarg, "search") == 0) {
+                    method = PP_DUPLICATE_SEARCH;
+                } else if (strcmp(optarg, "bitset") == 0) {
+                    method = PP_DUPLICATE_BITSET;
+                } else {
+                    fprintf(stderr, "Invalid value for the method argument: %s.\n", optarg);
+                    return false;
+                }
+                break;
+            case 'l':
+                errno = 0;
+                memory_limit = strtoul(optarg, &end_ptr, 10);
+                if (end_ptr == optarg || *end_ptr != '\0' || errno != 0 || memory_limit == 0 ||
+                    memory_limit > SIZE_MAX >> 20) {
+                    fprintf(stderr, "Invalid value for the memory limit argument: %s.\n", optarg);
+                    return false;
+                }
+                memory_limit <<= 20;
+                break;
+            case STATS_OPTION:
+                if (!stats_enable(optarg)) {
+                    return false;
+                }
+                break;
+            case 'h':
+                help_flag = true;
+                return false;
+            default:
+                return false;
+        }
+    }
+
+    // Parse the remaining arguments
+    if (optind >= argc) {
+        fprintf(stderr, "The input file must be provided.\n");
+        return false;
+    }
+    input = argv[optind];
+
+    return true;
+}
+
+/**
+ * Prints usage instructions for the program.
+ */
+void print_usage() {
+    printf("Usage: find_duplicate [OPTION]... [FILE]\n\n"
+           "Find a duplicate number in the input file [FILE] of 32-bit unsigned integers, one per line, and print it.\n"
+           "A file of more than 2^32 integers always has one.\n\n"
+           "Mandatory arguments to long options are mandatory for short options too.\n"
+           "    -m, --method=METHOD     The method to use, default is histogram. The histogram method counts the\n"
+           "                                numbers by their high bits and then by their low bits, in two passes with\n"
+           "                                512 KiB of counters, or checks the buckets that may have a duplicate\n"
+           "                                with bit sets. The search method halves the range in each of up to 32\n"
+           "                                passes with constant memory. The bitset method uses a single pass and\n"
+           "                                512 MiB, or the histogram method if the memory is not available.\n"
+           "    -l, --memory-limit=MIB  The memory of the bit sets of the histogram method, default is %u MiB.\n"
+           STATS_USAGE
+           "    -h, --help              Display this help and exit.\n", PP_DUPLICATE_MEMORY_LIMIT >> 20);
+}
+
+/**
+ * The main entry point of the program. It takes 1 required command line argument, which is the input file that contains
+ * the integers.
+ *
+ * @param argc The number of command line arguments.
+ * @param argv The command line arguments.
+ * @return The program exit status.
+ */
+int main(int argc, char *argv[]) {
+    // Parse the command line arguments
+    if (!parse_arguments(argc, argv)) {
+        if (help_flag) {
+            print_usage();
+            return EXIT_SUCCESS;
+        } else {
+            return EXIT_FAILURE;
+        }
+    }
+    // Open the input file
+    FILE *input_file = fopen(input, "r");
+    if (input_file == NULL) {
+        fprintf(stderr, "Unable to open the input file %s.\n", input);
+        return EXIT_FAILURE;
+    }
+
+    // Search the duplicate number
+    int exit_status = EXIT_SUCCESS;
+    stats_phase("search");
+    uint32_t duplicate;
+    size_t line = 0;
+    PpDuplicateCounts counts = {0};
+    PpStatus status = pp_duplicate_file(input_file, method, memory_limit, &duplicate, &line, &counts);
+    stats_add_bytes(counts.bytes);
+    stats_add_records(counts.records);
+    if (status == PP_OK) {
+        printf("%u\n", duplicate);
+    } else if (status == PP_ERROR_PARSE || status == PP_ERROR_RANGE) {
+        fprintf(stderr, "%s at line %zu\n", pp_status_message(status), line);
+        exit_status = EXIT_FAILURE;
+    } else {
+        fprintf(stderr, "%s\n", pp_status_message(status));
+        exit_status = EXIT_FAILURE;
+    }
+
+    fclose(input_file);
+    stats_report();
+    return exit_status;
+}
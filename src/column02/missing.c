@@ -0,0 +1,440 @@
+/**
+ * This library finds a missing 32-bit integer, as missing_number_bitset and missing_number_file do, without printing
+ * anything. The bit set finder scans the set a whole unit at a time for the first unit that is not full. The partition
+ * finders split the integers by each bit in turn, and keep the smaller part, which must miss an integer, so they only
+ * need memory for the integers themselves, or for the temporary files. The file finder can keep its files in a
+ * checkpoint directory, so that an interrupted search resumes at the split that it was doing.
+ */
+#include <errno.h>
+#include <limits.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <unistd.h>
+
+#include "missing.h"
+#include "reader.h"
+
+// The number of bits of the integers
+#define N 32
+// The number of bits of a bit set unit
+#define UNIT_BITS (sizeof(BS_UNIT) * CHAR_BIT)
+// The size of the names of the files of the splits in a checkpoint directory
+#define CHECKPOINT_NAME_SIZE 32
+// The indexes of the bits of the missing integer that were found and of the numbers of integers of the files of the
+// split in the values of a checkpoint
+#define VALUE_RESULT 0
+#define VALUE_COUNT_SET 1
+#define VALUE_COUNT_UNSET 2
+
+/**
+ * Initialize a finder.
+ *
+ * @param finder Pointer to the finder data structure.
+ * @param max_value The largest integer of the range, which starts at zero.
+ * @return PP_OK if the finder was initialized successfully, an error otherwise.
+ */
+PpStatus pp_missing_init(PpMissing *finder, uint32_t max_value) {
+    memset(finder, 0, sizeof(PpMissing));
+    if (!bs_init(&finder->bs, (size_t) max_value + 1)) {
+        return PP_ERROR_MEMORY;
+    }
+    finder->max_value = max_value;
+
+    return PP_OK;
+}
+
+/**
+ * Add an integer to a finder. An integer may be added more than once.
+ *
+ * @param finder Pointer to the finder data structure.
+ * @param value The integer.
+ * @return PP_OK if the integer was added, PP_ERROR_RANGE if it is larger than the largest integer of the range.
+ */
+PpStatus pp_missing_add(PpMissing *finder, uint32_t value) {
+    if (value > finder->max_value) {
+        return PP_ERROR_RANGE;
+    }
+    finder->bs.bits[value / UNIT_BITS] |= (BS_UNIT) 1 << (value % UNIT_BITS);
+    finder->count++;
+
+    return PP_OK;
+}
+
+/**
+ * Add integers to a finder. Adding stops at the first integer that is out of the range.
+ *
+ * @param finder Pointer to the finder data structure.
+ * @param values The integers.
+ * @param count The number of integers.
+ * @return PP_OK if all the integers were added, PP_ERROR_RANGE otherwise.
+ */
+PpStatus pp_missing_add_many(PpMissing *finder, const uint32_t *values, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        if (pp_missing_add(finder, values[i]) != PP_OK) {
+            return PP_ERROR_RANGE;
+        }
+    }
+
+    return PP_OK;
+}
+
+/**
+ * Find the smallest integer of the range that was not added to a finder.
+ *
+ * @param finder Pointer to the finder data structure.
+ * @param missing Pointer to where the missing integer will be written to.
+ * @return PP_OK if a missing integer was found, PP_ERROR_NOT_FOUND if all the integers of the range were added.
+ */
+PpStatus pp_missing_find(const PpMissing *finder, uint32_t *missing) {
+    uint64_t bit_count = (uint64_t) finder->max_value + 1;
+    uint64_t unit_count = (bit_count + UNIT_BITS - 1) / UNIT_BITS;
+    for (uint64_t i = 0; i < unit_count; i++) {
+        BS_UNIT unit = finder->bs.bits[i];
+        if (unit == (BS_UNIT) ~(BS_UNIT) 0) {
+            continue;
+        }
+        // The first unset bit may be past the end of the range in the last unit
+        uint64_t bit = i * UNIT_BITS + __builtin_ctz(~unit);
+        if (bit >= bit_count) {
+            break;
+        }
+        *missing = (uint32_t) bit;
+        return PP_OK;
+    }
+
+    return PP_ERROR_NOT_FOUND;
+}
+
+/**
+ * Free resources associated with a finder.
+ *
+ * @param finder Pointer to the finder data structure.
+ */
+void pp_missing_destroy(PpMissing *finder) {
+    bs_destroy(&finder->bs);
+    memset(finder, 0, sizeof(PpMissing));
+}
+
+/**
+ * Find a missing 32-bit integer of an array without extra memory. The array is split by each bit in turn, from the
+ * least significant one, and the search continues in the smaller part, which must miss an integer. The array is
+ * reordered.
+ *
+ * @param values The integers.
+ * @param count The number of integers.
+ * @param missing Pointer to where the missing integer will be written to.
+ * @return PP_OK if a missing integer was found, PP_ERROR_NOT_FOUND if there is none because of duplicate integers.
+ */
+PpStatus pp_missing_partition(uint32_t *values, size_t count, uint32_t *missing) {
+    if (count > UINT32_MAX) {
+        return PP_ERROR_TOO_MANY;
+    }
+    size_t first = 0;
+    size_t last = count;
+    uint32_t result = 0;
+    for (size_t bit = 0; bit < N; bit++) {
+        // Move the integers with the bit unset before the ones with the bit set
+        size_t i = first;
+        size_t j = last;
+        while (i < j) {
+            if ((values[i] >> bit) & 1) {
+                uint32_t value = values[i];
+                values[i] = values[--j];
+                values[j] = value;
+            } else {
+                i++;
+            }
+        }
+        size_t count_bit_unset = i - first;
+        size_t count_bit_set = last - i;
+
+        // Continue with the smaller part, or stop if one of them is empty
+        if (count_bit_set == 0) {
+            *missing = result | (uint32_t) 1 << bit;
+            return PP_OK;
+        } else if (count_bit_unset == 0) {
+            *missing = result;
+            return PP_OK;
+        } else if (count_bit_set < count_bit_unset) {
+            result |= (uint32_t) 1 << bit;
+            first = i;
+        } else {
+            last = i;
+        }
+    }
+
+    return PP_ERROR_NOT_FOUND;
+}
+
+/**
+ * Read the next integer of a file, for the finders that read files. The input files have an integer in each line, and
+ * the temporary files hold the integers in binary.
+ *
+ * @param reader The reader of the file.
+ * @param text true if the file is an input file.
+ * @param line Pointer to the line buffer.
+ * @param line_size Pointer to the size of the line buffer.
+ * @param number Pointer to where the integer will be written to.
+ * @param end Pointer to where true will be written to at the end of the file.
+ * @return PP_OK if an integer was read or the end of the file was reached, PP_ERROR_PARSE if a binary file ends with a
+ * partial integer, an error otherwise.
+ */
+PpStatus pp_read_number(PpReader *reader, bool text, char **line, size_t *line_size, uint32_t *number, bool *end) {
+    if (!text) {
+        size_t length = pp_reader_read(reader, number, sizeof(uint32_t));
+        *end = length == 0;
+        if (length == sizeof(uint32_t)) {
+            return PP_OK;
+        }
+        return length == 0 || reader->status != PP_OK ? reader->status : PP_ERROR_PARSE;
+    }
+    *end = pp_reader_getline(reader, line, line_size) == -1;
+    if (*end) {
+        return reader->status;
+    }
+    errno = 0;
+    char *end_ptr = NULL;
+    long long value = strtoll(*line, &end_ptr, 10);
+    if (errno != 0 || end_ptr == *line) {
+        return PP_ERROR_PARSE;
+    } else if (value < 0 || value > UINT32_MAX) {
+        return PP_ERROR_RANGE;
+    }
+    *number = (uint32_t) value;
+
+    return PP_OK;
+}
+
+/**
+ * Get the path of a file of the integers with a bit set or unset in a checkpoint directory.
+ *
+ * @param checkpoint Pointer to the checkpoint data structure.
+ * @param set true for the file of the integers with the bit set.
+ * @param bit The bit.
+ * @return The path, which must be freed, or NULL if memory could not be allocated.
+ */
+static char *split_path(const PpCheckpoint *checkpoint, bool set, size_t bit) {
+    char name[CHECKPOINT_NAME_SIZE];
+    snprintf(name, sizeof(name), "%s.%zu", set ? "set" : "unset", bit);
+
+    return pp_checkpoint_path(checkpoint, name);
+}
+
+/**
+ * Open a file of the integers with a bit set or unset. Without a checkpoint it is a temporary file, and with one it is
+ * a file of the checkpoint directory, which is created, or truncated to the integers of the checkpoint of a split that
+ * is resumed.
+ *
+ * @param checkpoint Pointer to the checkpoint data structure, or NULL.
+ * @param set true for the file of the integers with the bit set.
+ * @param bit The bit.
+ * @param count The number of integers of the file at the checkpoint of a resumed split, or zero for a new split.
+ * @return The file, or NULL if it could not be opened.
+ */
+static FILE *open_split(const PpCheckpoint *checkpoint, bool set, size_t bit, uint64_t count) {
+    if (!checkpoint) {
+        return tmpfile();
+    }
+    char *path = split_path(checkpoint, set, bit);
+    FILE *file = path ? fopen(path, count > 0 ? "r+b" : "w+b") : NULL;
+    free(path);
+    if (file && count > 0 && (ftruncate(fileno(file), (off_t) (count * sizeof(uint32_t))) != 0 ||
+                              fseek(file, 0, SEEK_END) != 0)) {
+        fclose(file);
+        file = NULL;
+    }
+
+    return file;
+}
+
+/**
+ * Save a checkpoint of a split, once the integers of its files are on the disk.
+ *
+ * @param checkpoint Pointer to the checkpoint data structure.
+ * @param bit The bit of the split.
+ * @param result The bits of the missing integer that were found.
+ * @param offset The number of bytes of the file that is split that were read.
+ * @param bit_set The file of the integers with the bit set, or NULL at the start of a split.
+ * @param count_bit_set The number of integers with the bit set.
+ * @param bit_unset The file of the integers with the bit unset, or NULL at the start of a split.
+ * @param count_bit_unset The number of integers with the bit unset.
+ * @return PP_OK if the checkpoint was saved successfully, PP_ERROR_IO otherwise.
+ */
+static PpStatus save_split(PpCheckpoint *checkpoint, size_t bit, uint32_t result, uint64_t offset, FILE *bit_set,
+                           uint64_t count_bit_set, FILE *bit_unset, uint64_t count_bit_unset) {
+    if ((bit_set && pp_checkpoint_sync(bit_set) != PP_OK) || (bit_unset && pp_checkpoint_sync(bit_unset) != PP_OK)) {
+        return PP_ERROR_IO;
+    }
+    checkpoint->state.pass = bit;
+    checkpoint->state.input_offset = offset;
+    checkpoint->state.values[VALUE_RESULT] = result;
+    checkpoint->state.values[VALUE_COUNT_SET] = count_bit_set;
+    checkpoint->state.values[VALUE_COUNT_UNSET] = count_bit_unset;
+
+    return pp_checkpoint_save(checkpoint);
+}
+
+/**
+ * Remove a file of the integers with a bit set or unset from a checkpoint directory.
+ *
+ * @param checkpoint Pointer to the checkpoint data structure.
+ * @param set true for the file of the integers with the bit set.
+ * @param bit The bit.
+ */
+static void remove_split(const PpCheckpoint *checkpoint, bool set, size_t bit) {
+    char *path = split_path(checkpoint, set, bit);
+    if (path) {
+        unlink(path);
+    }
+    free(path);
+}
+
+/**
+ * Find a missing 32-bit integer of a file of integers, one per line, with little memory. The integers are split by
+ * each bit in turn into temporary files, as pp_missing_partition does in memory. The files are read with asynchronous
+ * readers, so the next part of a file is read while the current one is split.
+ *
+ * With a checkpoint, the files of the splits are kept in its directory instead, and a checkpoint is saved at the end of
+ * each split and every PP_CHECKPOINT_INTERVAL bytes of the file that is split. A resumed search continues with the
+ * split of its checkpoint, from the offset that it had read, and the files that were written since are truncated.
+ *
+ * @param input The input file, which is read through its file descriptor, so nothing must have been read from it.
+ * @param checkpoint Pointer to the checkpoint data structure, or NULL.
+ * @param missing Pointer to where the missing integer will be written to.
+ * @param line Pointer to where the number of the invalid line will be written to on a parse or range error, or NULL.
+ * @return PP_OK if a missing integer was found, an error otherwise.
+ */
+PpStatus pp_missing_file(FILE *input, PpCheckpoint *checkpoint, uint32_t *missing, size_t *line) {
+    PpStatus status = PP_ERROR_NOT_FOUND;
+    char *text = NULL;
+    size_t text_size = 0;
+    FILE *current = input;
+    uint32_t result = 0;
+    size_t first_bit = 0;
+    uint64_t offset = 0;
+    if (checkpoint && checkpoint->resumed) {
+        // Continue with the file of the smaller part of the previous split, from the offset that was read
+        first_bit = checkpoint->state.pass;
+        offset = checkpoint->state.input_offset;
+        result = (uint32_t) checkpoint->state.values[VALUE_RESULT];
+        if (first_bit > 0) {
+            char *path = split_path(checkpoint, (result >> (first_bit - 1)) & 1, first_bit - 1);
+            current = path ? fopen(path, "rb") : NULL;
+            free(path);
+        }
+        if (!current || lseek(fileno(current), (off_t) offset, SEEK_SET) < 0) {
+            status = PP_ERROR_IO;
+        }
+    }
+    for (size_t bit = first_bit; bit < N && status == PP_ERROR_NOT_FOUND; bit++) {
+        // The files of the integers with the bit set and unset
+        bool resumed = checkpoint && checkpoint->resumed && bit == first_bit && offset > 0;
+        uint64_t count_bit_set = resumed ? checkpoint->state.values[VALUE_COUNT_SET] : 0;
+        uint64_t count_bit_unset = resumed ? checkpoint->state.values[VALUE_COUNT_UNSET] : 0;
+        FILE *bit_set = open_split(checkpoint, true, bit, count_bit_set);
+        FILE *bit_unset = open_split(checkpoint, false, bit, count_bit_unset);
+        PpReader reader;
+        if (!bit_set || !bit_unset) {
+            status = PP_ERROR_IO;
+        } else {
+            PpStatus open_status = pp_reader_open(&reader, fileno(current), PP_READER_AUTO);
+            status = open_status == PP_OK ? status : open_status;
+        }
+        bool reader_open = status == PP_ERROR_NOT_FOUND;
+        uint64_t checkpoint_offset = offset;
+
+        // Split the current file
+        bool end = false;
+        while (status == PP_ERROR_NOT_FOUND) {
+            uint32_t number;
+            PpStatus read_status = pp_read_number(&reader, current == input, &text, &text_size, &number, &end);
+            if (read_status != PP_OK) {
+                status = read_status;
+                if (line) {
+                    *line = count_bit_set + count_bit_unset + 1;
+                }
+            } else if (end) {
+                break;
+            } else if (count_bit_set + count_bit_unset == UINT32_MAX) {
+                status = PP_ERROR_TOO_MANY;
+            } else if ((number >> bit) & 1) {
+                count_bit_set++;
+                status = fwrite(&number, sizeof(uint32_t), 1, bit_set) == 1 ? status : PP_ERROR_IO;
+            } else {
+                count_bit_unset++;
+                status = fwrite(&number, sizeof(uint32_t), 1, bit_unset) == 1 ? status : PP_ERROR_IO;
+            }
+
+            // Save a checkpoint inside long splits, with the offset after the line or the integer that was read
+            offset += current == input ? strlen(text) : sizeof(uint32_t);
+            if (checkpoint && status == PP_ERROR_NOT_FOUND && offset - checkpoint_offset >= PP_CHECKPOINT_INTERVAL) {
+                PpStatus save_status = save_split(checkpoint, bit, result, offset, bit_set, count_bit_set, bit_unset,
+                                                  count_bit_unset);
+                status = save_status == PP_OK ? status : save_status;
+                checkpoint_offset = offset;
+            }
+        }
+
+        if (reader_open) {
+            pp_reader_close(&reader);
+        }
+
+        // Continue with the smaller part, or stop if one of them is empty
+        FILE *next = NULL;
+        if (status != PP_ERROR_NOT_FOUND) {
+            // An error occurred
+        } else if (count_bit_set == 0) {
+            result |= (uint32_t) 1 << bit;
+            status = PP_OK;
+        } else if (count_bit_unset == 0) {
+            status = PP_OK;
+        } else if (count_bit_set < count_bit_unset) {
+            result |= (uint32_t) 1 << bit;
+            next = bit_set;
+        } else {
+            next = bit_unset;
+        }
+        if (bit_set && bit_set != next) {
+            fclose(bit_set);
+        }
+        if (bit_unset && bit_unset != next) {
+            fclose(bit_unset);
+        }
+        if (current != input) {
+            fclose(current);
+        }
+        current = next;
+        offset = 0;
+        if (current && (fflush(current) != 0 || fseek(current, 0, SEEK_SET) != 0)) {
+            status = PP_ERROR_IO;
+        }
+
+        // Record the end of the split, and remove the files that the next split does not read
+        if (checkpoint && current && status == PP_ERROR_NOT_FOUND) {
+            status = save_split(checkpoint, bit + 1, result, 0, current, 0, NULL, 0);
+            status = status == PP_OK ? PP_ERROR_NOT_FOUND : status;
+            remove_split(checkpoint, !((result >> bit) & 1), bit);
+            if (bit > 0) {
+                remove_split(checkpoint, (result >> (bit - 1)) & 1, bit - 1);
+            }
+        }
+    }
+    if (current && current != input) {
+        fclose(current);
+    }
+    free(text);
+    if (status == PP_OK) {
+        *missing = result;
+    }
+    if (status == PP_OK && checkpoint) {
+        for (size_t bit = 0; bit < N; bit++) {
+            remove_split(checkpoint, true, bit);
+            remove_split(checkpoint, false, bit);
+        }
+    }
+
+    return status;
+}
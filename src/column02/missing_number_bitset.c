@@ -3,6 +3,8 @@
  * random order. N is defined in compile time and should be either 8, 16, 32 or 64. The solution uses a bitset, so it
  * should only be used if there is ample amount of memory.
  *
+ * The search is done by the pp_missing functions of the library, and this program only parses and prints the text.
+ *
  * This is a solution for problem A.
  */
 #include <errno.h>
@@ -10,43 +12,72 @@
 #include <stdlib.h>
 #include <stdint.h>
 
-#include "bitset.h"
+#include <getopt.h>
+
+#include "missing.h"
+#include "reader.h"
+#include "stats.h"
 
 #define N 32
 #define MAX_VALUE UINT32_MAX
 
 /**
  * The main entry point of the program. It takes 1 required command line argument, which is the input file that contains
- * the integers.
+ * the integers. The optional --stats[=json] argument prints the time and the counters of each phase to the standard
+ * error.
  *
  * @param argc The number of command line arguments.
  * @param argv The command line arguments.
  * @return The program exit status.
  */
 int main(int argc, char *argv[]) {
+    // Parse the command line arguments
+    static struct option long_options[] = {STATS_LONG_OPTION, {0, 0, 0, 0}};
+    int c;
+    while ((c = getopt_long(argc, argv, "", long_options, NULL)) != -1) {
+        if (c != STATS_OPTION || !stats_enable(optarg)) {
+            return EXIT_FAILURE;
+        }
+    }
     // Validate the number of command line arguments
-    if (argc < 2) {
-        fprintf(stderr, "Usage: missing_number_bitset: [INPUT]\n"
+    if (optind >= argc) {
+        fprintf(stderr, "Usage: missing_number_bitset: [--stats[=json]] [INPUT]\n"
                         "Search the input file [INPUT] of at most %d %d-bit unsigned integers for a missing "
                         "integer, and prints it.\n", MAX_VALUE - 1, N);
         return EXIT_FAILURE;
     }
     // Open the input file
-    FILE *input_file = fopen(argv[1], "r");
+    FILE *input_file = fopen(argv[optind], "r");
     if (input_file == NULL) {
-        fprintf(stderr, "Unable to open the input file %s.\n", argv[1]);
+        fprintf(stderr, "Unable to open the input file %s.\n", argv[optind]);
         return EXIT_FAILURE;
     }
 
     int exit_status = EXIT_SUCCESS;
-    BitSet bs;
-    bs_init(&bs, MAX_VALUE);
+    PpMissing finder;
+    stats_phase("init");
+    PpStatus status = pp_missing_init(&finder, MAX_VALUE);
+    if (status != PP_OK) {
+        fprintf(stderr, "Unable to initialize the bit set: %s.\n", pp_status_message(status));
+        fclose(input_file);
+        return EXIT_FAILURE;
+    }
+    PpReader reader;
+    status = pp_reader_open(&reader, fileno(input_file), PP_READER_AUTO);
+    if (status != PP_OK) {
+        fprintf(stderr, "Unable to read the input file: %s.\n", pp_status_message(status));
+        pp_missing_destroy(&finder);
+        fclose(input_file);
+        return EXIT_FAILURE;
+    }
     // Read the input file
     char *line = NULL;
     size_t n = 0;
     ssize_t line_length;
     size_t line_count = 0;
-    while ((line_length = getline(&line, &n, input_file)) != -1) {
+    stats_phase("read");
+    while ((line_length = pp_reader_getline(&reader, &line, &n)) != -1) {
+        stats_add_bytes(line_length);
         if (line_count++ == MAX_VALUE) {
             fprintf(stderr, "Too many input lines\n");
             exit_status = EXIT_FAILURE;
@@ -70,20 +101,28 @@ int main(int argc, char *argv[]) {
             goto cleanup;
         }
         // Valid number - add it to the bitset
-        bs_set(&bs, value);
+        pp_missing_add(&finder, value);
+    }
+    if (reader.status != PP_OK) {
+        fprintf(stderr, "Unable to read the input file: %s.\n", pp_status_message(reader.status));
+        exit_status = EXIT_FAILURE;
+        goto cleanup;
     }
 
+    stats_add_records(line_count);
+
     // Print the first missing number
-    for (size_t i = 0; i <= MAX_VALUE; i++) {
-        if (!bs_is_set(&bs, i)) {
-            printf("%zu\n", i);
-            break;
-        }
+    stats_phase("search");
+    uint32_t missing;
+    if (pp_missing_find(&finder, &missing) == PP_OK) {
+        printf("%u\n", missing);
     }
 
 cleanup:
-    bs_destroy(&bs);
+    pp_missing_destroy(&finder);
     free(line);
+    pp_reader_close(&reader);
     fclose(input_file);
+    stats_report();
     return exit_status;
 }
\ No newline at end of file
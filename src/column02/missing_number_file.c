@@ -8,143 +8,99 @@
  * search stops. If both of them are not empty, we use the smaller one to count the numbers with the 2nd bit set or
  * unset and so on. Eventually we will find an empty file, as the input numbers are less that the search set.
  *
+ * The search is done by pp_missing_file of the library, and this program only reports its result. With --checkpoint,
+ * the files of the splits are kept in a directory with the progress of the search, and an interrupted search that is
+ * started again with the same directory resumes at the split that it was doing, instead of reading the input again.
+ *
  * This is a solution for problem A.
  */
-#include <errno.h>
 #include <stdbool.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 
-#define N 32
-#define NUMBER uint32_t
-#define MAX_VALUE UINT32_MAX
+#include <getopt.h>
 
-/**
- * Read a number from a null terminated character array.
- *
- * @param line Null terminated string from which the number will be read.
- * @param number Pointer to the memory where the number will be stored. This memory will not be changed if the number is
- * not valid.
- * @return true if the number was read successfully, false otherwise.
- */
-bool read_number(char *line, NUMBER *number) {
-    errno = 0;
-    char *end = NULL;
-    long long value = strtoll(line, &end, 10);
-    if (errno != 0 || line == end) {
-        fprintf(stderr, "Invalid input: %s\n", line);
-        return false;
-    } else if (value < 0 || value > MAX_VALUE) {
-        fprintf(stderr, "Input %s is out of range\n", line);
-        return false;
-    }
-
-    *number = (NUMBER) value;
+#include "missing.h"
+#include "stats.h"
 
-    return true;
-}
+#define N 32
+#define MAX_VALUE UINT32_MAX
 
 /**
  * The main entry point of the program. It takes 1 required command line argument, which is the input file that contains
- * the integers.
+ * the integers. The optional --stats[=json] argument prints the time and the counters of each phase to the standard
+ * error, and the optional --checkpoint=DIR argument records the progress of the search in the directory DIR.
  *
  * @param argc The number of command line arguments.
  * @param argv The command line arguments.
  * @return The program exit status.
  */
 int main(int argc, char *argv[]) {
+    // Parse the command line arguments
+    static struct option long_options[] = {
+        {"checkpoint", required_argument, 0, 'k'},
+        STATS_LONG_OPTION,
+        {0, 0, 0, 0}
+    };
+    int c;
+    char *checkpoint_directory = NULL;
+    while ((c = getopt_long(argc, argv, "k:", long_options, NULL)) != -1) {
+        if (c == 'k') {
+            checkpoint_directory = optarg;
+        } else if (c != STATS_OPTION || !stats_enable(optarg)) {
+            return EXIT_FAILURE;
+        }
+    }
     // Validate the number of command line arguments
-    if (argc < 2) {
-        fprintf(stderr, "Usage: missing_number_file: [INPUT]\n"
-                        "Search the input file [INPUT] of at most %d %d-bit unsigned integers for a missing "
-                        "integer, and prints it.\n", MAX_VALUE - 1, N);
+    if (optind >= argc) {
+        fprintf(stderr, "Usage: missing_number_file: [--stats[=json]] [-k, --checkpoint=DIR] [INPUT]\n"
+                        "Search the input file [INPUT] of at most %u %d-bit unsigned integers for a missing "
+                        "integer, and prints it. With a checkpoint directory [DIR], the progress is recorded there, "
+                        "and an interrupted search with the same directory is resumed.\n", MAX_VALUE - 1, N);
         return EXIT_FAILURE;
     }
     // Open the input file
-    FILE *input_file = fopen(argv[1], "r");
+    FILE *input_file = fopen(argv[optind], "r");
     if (input_file == NULL) {
-        fprintf(stderr, "Unable to open the input file %s.\n", argv[1]);
+        fprintf(stderr, "Unable to open the input file %s.\n", argv[optind]);
         return EXIT_FAILURE;
     }
 
-    int exit_status = EXIT_SUCCESS; // The exit status for the program
-    char *line = NULL; // Will hold the current line from the file
-    size_t n = 0; // Needed for the getline invocation
-    size_t current_bit = 0; // The current bit to check. 0 is the least significant bit
-    FILE *current_file = input_file; // The current file to check
-    NUMBER missing_number = 0; // The value of the missing number
-
-    while (current_bit < N) {
-        ssize_t line_length; // The current line length
-        size_t line_count = 0; // The total line count
-        size_t count_bit_set = 0; // The count of numbers with the current bit set
-        size_t count_bit_unset = 0; // The count of numbers with the current bit unset
-
-        // Temporary file in which we will store the numbers with the current bit set
-        FILE *bit_set = tmpfile();
-        if (!bit_set) {
-            fprintf(stderr, "Could not create temporary file\n");
-            exit_status = EXIT_FAILURE;
-            goto cleanup;
-        }
-        // Temporary file in which we will store the numbers with the current bit unset
-        FILE *bit_unset = tmpfile();
-        if (!bit_unset) {
-            fprintf(stderr, "Could not create temporary file\n");
-            exit_status = EXIT_FAILURE;
-            goto cleanup;
-        }
-
-        // Read the current input file line by line
-        while ((line_length = getline(&line, &n, current_file)) != -1) {
-            // Check if we got to many lines (=numbers)
-            if (line_count++ == MAX_VALUE) {
-                fprintf(stderr, "Too many input lines\n");
-                exit_status = EXIT_FAILURE;
-                goto cleanup;
-            }
-            // Strip new line if it exists
-            if (line[line_length - 1] == '\n') {
-                line[line_length - 1] = '\0';
-            }
-            // Read the number
-            NUMBER number;
-            read_number(line, &number);
-            // Check if the bit is set or not
-            if ((number >> current_bit) & 1) {
-                fprintf(bit_set, "%d\n", number);
-                count_bit_set++;
-            } else {
-                fprintf(bit_unset, "%d\n", number);
-                count_bit_unset++;
-            }
+    // Open the checkpoint, which resumes an interrupted search
+    PpCheckpoint checkpoint = {0};
+    if (checkpoint_directory) {
+        uint64_t options[] = {N};
+        PpStatus status = pp_checkpoint_open(&checkpoint, checkpoint_directory, "missing_number_file",
+                                             fileno(input_file), options, sizeof(options) / sizeof(options[0]));
+        if (status != PP_OK) {
+            fprintf(stderr, "Unable to open the checkpoint %s: %s.\n", checkpoint_directory, pp_status_message(status));
+            fclose(input_file);
+            return EXIT_FAILURE;
         }
+    }
 
-        // Check the counts
-        if (count_bit_set == 0) {
-            // No numbers with the current bit set, so the missing number must have the current bit set
-            missing_number = (1 << current_bit) | missing_number;
-            break;
-        } else if (count_bit_unset == 0) {
-            // No numbers with the current bit unset, so the missing number must have the current bit unset
-            break;
-        } else if (count_bit_set < count_bit_unset) {
-            // Search the missing numbers in the range of numbers that have the current bit set
-            missing_number = (1 << current_bit) | missing_number;
-            current_file = bit_set;
-        } else {
-            // Search the missing numbers in the range of numbers that have the current bit unset
-            current_file = bit_unset;
-        }
-        rewind(current_file); // Rewind the current file in order to read it again
-        current_bit++; // Check the next bit
+    // Search the missing number
+    int exit_status = EXIT_SUCCESS;
+    stats_phase("search");
+    uint32_t missing_number;
+    size_t line = 0;
+    PpStatus status = pp_missing_file(input_file, checkpoint_directory ? &checkpoint : NULL, &missing_number, &line);
+    if (status == PP_OK && checkpoint_directory) {
+        pp_checkpoint_finish(&checkpoint);
+    }
+    pp_checkpoint_close(&checkpoint);
+    if (status == PP_OK) {
+        printf("%u\n", missing_number);
+    } else if (status == PP_ERROR_PARSE || status == PP_ERROR_RANGE) {
+        fprintf(stderr, "%s at line %zu\n", pp_status_message(status), line);
+        exit_status = EXIT_FAILURE;
+    } else {
+        fprintf(stderr, "%s\n", pp_status_message(status));
+        exit_status = EXIT_FAILURE;
     }
-    printf("%d\n", missing_number);
 
-cleanup:
-    free(line);
     fclose(input_file);
+    stats_report();
     return exit_status;
 }
-
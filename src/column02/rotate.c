@@ -0,0 +1,425 @@
+/**
+ * This library rotates arrays in place, which is the second problem of column 2: rotating a vector of n elements left
+ * by i positions. It implements the three algorithms of the column, juggling, block swapping and reversing, and a
+ * fourth one that copies the shorter side to a small buffer and moves the rest with memmove.
+ *
+ * The elements can have any size. The juggling method moves single elements, with typed copies for the sizes of the
+ * integer types, while the other methods only move byte ranges whose lengths are multiples of the element size, as a
+ * rotation by shift elements is a rotation of the bytes by shift * size bytes. The reversals of elements of 1, 2, 4, 8
+ * and 16 bytes swap vectors from both ends, whose elements are reversed with a byte shuffle.
+ */
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+#include "rotate.h"
+
+// The size of the chunks that the byte ranges are swapped in
+#define SWAP_CHUNK_SIZE 256
+// The largest element that is reversed with vector shuffles
+#define VECTOR_ELEMENT_MAX 16
+
+#if defined(__SSE2__)
+/**
+ * The byte shuffles that reverse the elements of a 16-byte vector, for elements of 1, 2, 4, 8 and 16 bytes, indexed
+ * by the base 2 logarithm of the element size.
+ */
+static const unsigned char reverse_shuffles[][16] = {
+    {15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0},
+    {14, 15, 12, 13, 10, 11, 8, 9, 6, 7, 4, 5, 2, 3, 0, 1},
+    {12, 13, 14, 15, 8, 9, 10, 11, 4, 5, 6, 7, 0, 1, 2, 3},
+    {8, 9, 10, 11, 12, 13, 14, 15, 0, 1, 2, 3, 4, 5, 6, 7},
+    {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15}
+};
+#endif
+
+/**
+ * Swap two byte ranges that do not overlap. Long ranges are swapped through a chunk buffer with memcpy, and short ones
+ * a 64-bit word at a time, as the variable length copies of a few bytes cost more than the words and stall the loads
+ * that follow them.
+ *
+ * @param a The first range.
+ * @param b The second range.
+ * @param length The length of each range.
+ */
+static void swap_bytes(unsigned char *a, unsigned char *b, size_t length) {
+    if (length < SWAP_CHUNK_SIZE) {
+        for (; length >= sizeof(uint64_t); a += sizeof(uint64_t), b += sizeof(uint64_t), length -= sizeof(uint64_t)) {
+            uint64_t t, u;
+            memcpy(&t, a, sizeof(uint64_t));
+            memcpy(&u, b, sizeof(uint64_t));
+            memcpy(a, &u, sizeof(uint64_t));
+            memcpy(b, &t, sizeof(uint64_t));
+        }
+        for (size_t i = 0; i < length; i++) {
+            unsigned char t = a[i];
+            a[i] = b[i];
+            b[i] = t;
+        }
+        return;
+    }
+    unsigned char chunk[SWAP_CHUNK_SIZE];
+    while (length > 0) {
+        size_t chunk_length = length < sizeof(chunk) ? length : sizeof(chunk);
+        memcpy(chunk, a, chunk_length);
+        memcpy(a, b, chunk_length);
+        memcpy(b, chunk, chunk_length);
+        a += chunk_length;
+        b += chunk_length;
+        length -= chunk_length;
+    }
+}
+
+/**
+ * Swap two elements. The elements of the sizes of the integer types are swapped with fixed size copies, which the
+ * compiler turns into single loads and stores.
+ *
+ * @param a The first element.
+ * @param b The second element.
+ * @param size The size of each element.
+ */
+static void swap_elements(unsigned char *a, unsigned char *b, size_t size) {
+    switch (size) {
+        case 1: {
+            unsigned char t = *a;
+            *a = *b;
+            *b = t;
+            break;
+        }
+        case 2: {
+            uint16_t t, u;
+            memcpy(&t, a, 2);
+            memcpy(&u, b, 2);
+            memcpy(a, &u, 2);
+            memcpy(b, &t, 2);
+            break;
+        }
+        case 4: {
+            uint32_t t, u;
+            memcpy(&t, a, 4);
+            memcpy(&u, b, 4);
+            memcpy(a, &u, 4);
+            memcpy(b, &t, 4);
+            break;
+        }
+        case 8: {
+            uint64_t t, u;
+            memcpy(&t, a, 8);
+            memcpy(&u, b, 8);
+            memcpy(a, &u, 8);
+            memcpy(b, &t, 8);
+            break;
+        }
+        default:
+            swap_bytes(a, b, size);
+    }
+}
+
+/**
+ * Copy an element. The elements of the sizes of the integer types are copied with fixed size copies.
+ *
+ * @param destination The element to copy to.
+ * @param source The element to copy from.
+ * @param size The size of each element.
+ */
+static void copy_element(unsigned char *destination, const unsigned char *source, size_t size) {
+    switch (size) {
+        case 1:
+            *destination = *source;
+            break;
+        case 2:
+            memcpy(destination, source, 2);
+            break;
+        case 4:
+            memcpy(destination, source, 4);
+            break;
+        case 8:
+            memcpy(destination, source, 8);
+            break;
+        default:
+            memcpy(destination, source, size);
+    }
+}
+
+/**
+ * Check if the elements of a size are reversed with vector shuffles, which needs a size that divides the vectors and a
+ * processor that supports at least SSSE3.
+ *
+ * @param size The size of each element.
+ * @return true if the elements are reversed with vector shuffles, false otherwise.
+ */
+static bool vector_reversal(size_t size) {
+#if defined(__SSE2__)
+    return size > 0 && size <= VECTOR_ELEMENT_MAX && (size & (size - 1)) == 0 && __builtin_cpu_supports("ssse3");
+#else
+    return false;
+#endif
+}
+
+#if defined(__SSE2__)
+/**
+ * Reverse the outer 16-byte blocks of a byte range with SSSE3 shuffles: each pair of blocks from both ends is swapped,
+ * and the elements of each block are reversed. It is only called if the processor supports SSSE3.
+ *
+ * @param base The range.
+ * @param length The length of the range.
+ * @param shuffle The byte shuffle that reverses the elements of a block.
+ * @return The number of bytes that were reversed at each end, which leaves fewer than 32 bytes in the middle.
+ */
+__attribute__((target("ssse3")))
+static size_t reverse_blocks_ssse3(unsigned char *base, size_t length, const unsigned char *shuffle) {
+    __m128i mask = _mm_loadu_si128((const __m128i *) shuffle);
+    size_t done = 0;
+    for (; length - 2 * done >= 32; done += 16) {
+        unsigned char *low = base + done;
+        unsigned char *high = base + length - done - 16;
+        __m128i low_block = _mm_loadu_si128((const __m128i *) low);
+        __m128i high_block = _mm_loadu_si128((const __m128i *) high);
+        _mm_storeu_si128((__m128i *) low, _mm_shuffle_epi8(high_block, mask));
+        _mm_storeu_si128((__m128i *) high, _mm_shuffle_epi8(low_block, mask));
+    }
+
+    return done;
+}
+
+/**
+ * Reverse the outer 32-byte blocks of a byte range with AVX2 shuffles. The elements are reversed within each 16-byte
+ * lane, and then the lanes are swapped. It is only called if the processor supports AVX2.
+ *
+ * @param base The range.
+ * @param length The length of the range.
+ * @param shuffle The byte shuffle that reverses the elements of a 16-byte lane.
+ * @return The number of bytes that were reversed at each end, which leaves fewer than 64 bytes in the middle.
+ */
+__attribute__((target("avx2")))
+static size_t reverse_blocks_avx2(unsigned char *base, size_t length, const unsigned char *shuffle) {
+    __m256i mask = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *) shuffle));
+    size_t done = 0;
+    for (; length - 2 * done >= 64; done += 32) {
+        unsigned char *low = base + done;
+        unsigned char *high = base + length - done - 32;
+        __m256i low_block = _mm256_shuffle_epi8(_mm256_loadu_si256((const __m256i *) low), mask);
+        __m256i high_block = _mm256_shuffle_epi8(_mm256_loadu_si256((const __m256i *) high), mask);
+        _mm256_storeu_si256((__m256i *) low, _mm256_permute2x128_si256(high_block, high_block, 1));
+        _mm256_storeu_si256((__m256i *) high, _mm256_permute2x128_si256(low_block, low_block, 1));
+    }
+
+    return done;
+}
+#endif
+
+/**
+ * Reverse the order of the elements of an array.
+ *
+ * @param base The array.
+ * @param count The number of elements.
+ * @param size The size of each element, in bytes.
+ */
+void pp_reverse(void *base, size_t count, size_t size) {
+    unsigned char *bytes = base;
+    size_t length = count * size;
+
+    // Reverse the outer blocks with vector shuffles, if the elements divide the blocks
+#if defined(__SSE2__)
+    if (vector_reversal(size)) {
+        const unsigned char *shuffle = reverse_shuffles[__builtin_ctzll(size)];
+        size_t done = __builtin_cpu_supports("avx2") ? reverse_blocks_avx2(bytes, length, shuffle)
+                                                     : reverse_blocks_ssse3(bytes, length, shuffle);
+        bytes += done;
+        length -= 2 * done;
+    }
+#endif
+
+    // Swap the remaining elements from both ends
+    if (length == 0) {
+        return;
+    }
+    for (unsigned char *low = bytes, *high = bytes + length - size; low < high; low += size, high -= size) {
+        swap_elements(low, high, size);
+    }
+}
+
+/**
+ * Get the greatest common divisor of two numbers.
+ *
+ * @param a The first number.
+ * @param b The second number.
+ * @return The greatest common divisor.
+ */
+static size_t gcd(size_t a, size_t b) {
+    while (b != 0) {
+        size_t remainder = a % b;
+        a = b;
+        b = remainder;
+    }
+
+    return a;
+}
+
+/**
+ * Rotate a byte range left by swapping the shorter side with the end of the longer one, until both sides have the
+ * same length and are swapped with each other.
+ *
+ * @param base The range.
+ * @param length The length of the range.
+ * @param left The length of the left side, between 1 and length - 1.
+ */
+static void rotate_block_swap(unsigned char *base, size_t length, size_t left) {
+    // The left side that is not in place yet is [left - i, left), and the right side [left, left + j)
+    size_t i = left;
+    size_t j = length - left;
+    while (i != j) {
+        if (i > j) {
+            swap_bytes(base + left - i, base + left, j);
+            i -= j;
+        } else {
+            swap_bytes(base + left - i, base + left + j - i, i);
+            j -= i;
+        }
+    }
+    swap_bytes(base + left - i, base + left, i);
+}
+
+/**
+ * Rotate an array left by moving each element to its final position, one cycle of the rotation at a time. The
+ * elements that are larger than PP_ROTATE_SCRATCH_SIZE are rotated with the block-swap method instead.
+ *
+ * @param base The array.
+ * @param count The number of elements.
+ * @param size The size of each element.
+ * @param shift The number of positions, between 1 and count - 1.
+ */
+static void rotate_juggling(unsigned char *base, size_t count, size_t size, size_t shift) {
+    if (size > PP_ROTATE_SCRATCH_SIZE) {
+        rotate_block_swap(base, count * size, shift * size);
+        return;
+    }
+    unsigned char temp[size];
+    size_t cycles = gcd(count, shift);
+    for (size_t start = 0; start < cycles; start++) {
+        copy_element(temp, base + start * size, size);
+        size_t current = start;
+        for (;;) {
+            size_t next = current + shift;
+            if (next >= count) {
+                next -= count;
+            }
+            if (next == start) {
+                break;
+            }
+            copy_element(base + current * size, base + next * size, size);
+            current = next;
+        }
+        copy_element(base + current * size, temp, size);
+    }
+}
+
+/**
+ * Rotate an array left by reversing both sides and then the whole array.
+ *
+ * @param base The array.
+ * @param count The number of elements.
+ * @param size The size of each element.
+ * @param shift The number of positions, between 1 and count - 1.
+ */
+static void rotate_reversal(unsigned char *base, size_t count, size_t size, size_t shift) {
+    pp_reverse(base, shift, size);
+    pp_reverse(base + shift * size, count - shift, size);
+    pp_reverse(base, count, size);
+}
+
+/**
+ * Rotate a byte range left by copying the shorter side to a stack buffer, and moving the longer side with memmove.
+ * If the shorter side does not fit in the buffer, it is rotated with the block-swap method instead.
+ *
+ * @param base The range.
+ * @param length The length of the range.
+ * @param left The length of the left side, between 1 and length - 1.
+ */
+static void rotate_scratch(unsigned char *base, size_t length, size_t left) {
+    size_t right = length - left;
+    if (left > PP_ROTATE_SCRATCH_SIZE && right > PP_ROTATE_SCRATCH_SIZE) {
+        rotate_block_swap(base, length, left);
+        return;
+    }
+    unsigned char scratch[PP_ROTATE_SCRATCH_SIZE];
+    if (left <= right) {
+        memcpy(scratch, base, left);
+        memmove(base, base + left, right);
+        memcpy(base + right, scratch, left);
+    } else {
+        memcpy(scratch, base + left, right);
+        memmove(base + right, base, left);
+        memcpy(base, scratch, right);
+    }
+}
+
+/**
+ * Choose the method that rotates an array the fastest, which is the one that pp_rotate uses for PP_ROTATE_AUTO. The
+ * choice follows the rotation benchmarks, from the L1 cache to the main memory: the scratch method moves each element
+ * once, so it is the fastest whenever the shorter side fits in its buffer. Otherwise the vector reversals are the
+ * fastest, except for sides of the same length, which the block-swap method swaps in a single pass. The elements
+ * without vector reversals are rotated with the block-swap method, whose long swaps are copied with memcpy, as the
+ * juggling method misses the caches.
+ *
+ * @param count The number of elements.
+ * @param size The size of each element, in bytes.
+ * @param shift The number of positions that the elements are rotated left by.
+ * @return The method, which is never PP_ROTATE_AUTO.
+ */
+PpRotateMethod pp_rotate_method(size_t count, size_t size, size_t shift) {
+    size_t shorter = shift < count - shift ? shift : count - shift;
+    if (shorter * size <= PP_ROTATE_SCRATCH_SIZE) {
+        return PP_ROTATE_SCRATCH;
+    }
+    if (vector_reversal(size) && shift != count - shift) {
+        return PP_ROTATE_REVERSAL;
+    }
+
+    return PP_ROTATE_BLOCK_SWAP;
+}
+
+/**
+ * Rotate an array left by a number of positions, so that the element at index shift becomes the first one and the
+ * first shift elements are moved to the end, in their order.
+ *
+ * @param base The array.
+ * @param count The number of elements.
+ * @param size The size of each element, in bytes.
+ * @param shift The number of positions that the elements are rotated left by, up to count.
+ * @param method The way to rotate the array.
+ * @return PP_OK if the array was rotated, PP_ERROR_RANGE if the shift is larger than the number of elements,
+ * PP_ERROR_ARGUMENT if the element size is zero or the method is unknown.
+ */
+PpStatus pp_rotate(void *base, size_t count, size_t size, size_t shift, PpRotateMethod method) {
+    if (size == 0 || (unsigned) method > PP_ROTATE_SCRATCH) {
+        return PP_ERROR_ARGUMENT;
+    }
+    if (shift > count) {
+        return PP_ERROR_RANGE;
+    }
+    if (shift == 0 || shift == count) {
+        return PP_OK;
+    }
+
+    unsigned char *bytes = base;
+    switch (method == PP_ROTATE_AUTO ? pp_rotate_method(count, size, shift) : method) {
+        case PP_ROTATE_JUGGLING:
+            rotate_juggling(bytes, count, size, shift);
+            break;
+        case PP_ROTATE_REVERSAL:
+            rotate_reversal(bytes, count, size, shift);
+            break;
+        case PP_ROTATE_SCRATCH:
+            rotate_scratch(bytes, count * size, shift * size);
+            break;
+        default:
+            rotate_block_swap(bytes, count * size, shift * size);
+    }
+
+    return PP_OK;
+}
@@ -1,6 +1,20 @@
 /**
  * This program searches for anagrams for the input word, using the preprocessed anagram database.
  *
+ * The database is memory mapped and searched in place, so only the parts of the file that the binary search visits are
+ * read. Legacy databases are loaded in memory before they are searched. The delta segments that were appended to the
+ * database are searched as well, and the anagrams found in all the segments are merged. The lookup is done by the
+ * pp_anagram_db functions of the library, so this program only prints their result.
+ *
+ * If the database and its delta segments have Bloom filter files, the filters are tested first, and a word whose
+ * signature they all reject has no anagrams, so the program returns without opening the database, after reading a
+ * single block of each filter.
+ *
+ * With the --rack option, all the words that can be built from the letters of the input word are printed instead,
+ * like the words that can be played from a Scrabble rack. The rack index of the database rejects whole groups of
+ * signatures with a single mask test, so only a small part of the entries is compared letter by letter. The words
+ * without anagrams are only found if the database keeps them, which a database with a rack index always does.
+ *
  * This is a solution for problem 1.
  */
 #include <stdbool.h>
@@ -9,63 +23,102 @@
 #include <stdlib.h>
 #include <string.h>
 
-#include "stringsig.h"
+#include <getopt.h>
 
-// The number of entries by which the database will be extended, if there is no space left
-#define CHUNK_SIZE 1000
+#include "anagramdb.h"
+#include "stats.h"
 
-/**
- * The anagram database entry.
- */
-typedef struct {
-    /** The length of the words of the entry */
-    uint8_t length;
-    /** The entry signature */
-    char *signature;
-    /** The number of anagrams */
-    uint8_t word_count;
-    /** The anagrams */
-    char **words;
-} Entry;
+// The help flag
+static bool help_flag = false;
+// The rack flag
+static bool rack_flag = false;
+// The database file
+static char *db_path = NULL;
+// The word to search for
+static char *query = NULL;
 
 /**
- * Read a database entry from the file.
+ * Parse the command line arguments.
  *
- * @param file The file to read.
- * @param entry The entry to read.
- * @return true if the entry was read successfully, false otherwise.
+ * @param argc The number of command line arguments.
+ * @param argv The command line arguments.
+ * @return true if the parsing was successful, false otherwise.
  */
-bool read_db_entry(FILE *file, Entry *entry) {
-    int length = fgetc(file);
-    if (length == EOF) {
-        return false;
+bool parse_arguments(int argc, char *argv[]) {
+    static struct option long_options[] = {
+        {"rack", no_argument, 0, 'r'},
+        {"help", no_argument, 0, 'h'},
+        STATS_LONG_OPTION,
+        {0, 0, 0, 0}
+    };
+
+    // Parse options
+    int c;
+    int option_index = 0;
+    while (true) {
+        c = getopt_long(argc, argv, "hr", long_options, &option_index);
+        if (c == -1) {
+            break;
+        }
+        switch (c) {
+            case 'r':
+                rack_flag = true;
+                break;
+            case STATS_OPTION:
+                if (!stats_enable(optarg)) {
+                    return false;
+                }
+                break;
+            case 'h':
+                help_flag = true;
+                return false;
+            default:
+                return false;
+        }
     }
-    entry->length = length;
-    entry->signature = malloc((entry->length + 1) * sizeof (char));
-    fgets(entry->signature, entry->length + 1, file);
-    entry->word_count = fgetc(file);
-    entry->words = malloc(sizeof (char *) * entry->word_count);
-    for (size_t i = 0; i < entry->word_count; i++) {
-        entry->words[i] = malloc((entry->length + 1) * sizeof (char));
-        fgets(entry->words[i], entry->length + 1, file);
+
+    // Parse the remaining arguments
+    if (optind + 2 > argc) {
+        fprintf(stderr, "An anagram database and a word must be provided.\n");
+        return false;
     }
+    db_path = argv[optind];
+    query = argv[optind + 1];
 
     return true;
 }
 
 /**
- * Search a sorted array of entries for the signature.
+ * Prints usage instructions for the program.
+ */
+void print_usage() {
+    printf("Usage: search_anagram_db [OPTION]... [ANAGRAM_DB] [WORD]\n\n"
+           "Search the anagram database file [ANAGRAM_DB] for anagrams of [WORD], and print them to the standard\n"
+           "output.\n\n"
+           "    -r, --rack              Print all the words that can be built from the letters of [WORD] instead,\n"
+           "                                from the longest to the shortest. [WORD] must consist of the letters\n"
+           "                                'a' to 'z'. The words without anagrams are only found if the database\n"
+           "                                keeps them, which build_anagram_db does with --rack-index or\n"
+           "                                --singletons.\n"
+           STATS_USAGE
+           "    -h, --help              Display this help and exit.\n");
+}
+
+/**
+ * Print a word.
  *
- * @param p The signature to find.
- * @param q The database entry to compare.
- * @return -1 if the signature is less that the entry, 1 if the signature is greater then entry or 0 if the two elements
- * are equal.
+ * @param word The word.
+ * @param length The length of the word.
+ * @param context Not used.
+ * @return Always true.
  */
-int compare_entries(const void *p, const void *q) {
-    char *ep = (char *) p;
-    Entry *eq = (Entry *) q;
+static bool print_word(const char *word, size_t length, void *context) {
+    (void) length;
+    (void) context;
+    puts(word);
+    stats_add_records(1);
 
-    return strcmp(ep, eq->signature);
+    return true;
 }
 
 /**
@@ -77,60 +130,74 @@ int compare_entries(const void *p, const void *q) {
  * @return The program exit status.
  */
 int main(int argc, char *argv[]) {
-    // Validate the number of command line arguments
-    if (argc < 3) {
-        fprintf(stderr, "Usage: search_anagram_db: [ANAGRAM_DB] [WORD]\n"
-                        "Search the anagram database file [ANAGRAM_DB] for anagrams of [WORD], and print them to the "
-                        "standard output.\n");
-        return EXIT_FAILURE;
+    // Parse the command line arguments
+    if (!parse_arguments(argc, argv)) {
+        if (help_flag) {
+            print_usage();
+            return EXIT_SUCCESS;
+        } else {
+            return EXIT_FAILURE;
+        }
     }
 
-    // Open the database file
-    FILE *input_file = fopen(argv[1], "rb");
-    if (input_file == NULL) {
-        fprintf(stderr, "Unable to open database file %s.\n", argv[1]);
+    // Return early if the Bloom filters rule the word out. The racks match many signatures, so they are not tested.
+    size_t length = strlen(query);
+    stats_phase("filter");
+    if (!rack_flag && !adb_bloom_may_contain(db_path, query, length)) {
+        stats_report();
+        return EXIT_SUCCESS;
+    }
+
+    // Open the database file and its delta segments
+    stats_phase("open");
+    PpAnagramDb db;
+    if (pp_anagram_db_open(&db, db_path) != PP_OK) {
+        fprintf(stderr, "Unable to open database file %s.\n", db_path);
         return EXIT_FAILURE;
     }
 
-    // Read the database
-    Entry entry;
-    size_t entry_count = 0;
-    size_t current_size = CHUNK_SIZE;
-    Entry *entries = malloc(current_size * sizeof(Entry));
-    while (read_db_entry(input_file, &entry)) {
-        entries[entry_count++] = entry;
-        if (entry_count == current_size) {
-            current_size += CHUNK_SIZE;
-            entries = realloc(entries, current_size * sizeof(Entry));
+    // Search the database for the words that can be built from the letters of the input word
+    int exit_status = EXIT_SUCCESS;
+    stats_phase("search");
+    if (rack_flag) {
+        if (!adb_set_rack_search(&db.set, query, length, print_word, NULL)) {
+            fprintf(stderr, "Unable to search for the words that can be built from %s.\n", query);
+            exit_status = EXIT_FAILURE;
         }
+        pp_anagram_db_close(&db);
+        stats_report();
+        return exit_status;
     }
 
-    // Calculate the signature of the input word
-    size_t signature_length = strlen(argv[2]);
-    char *signature = malloc((signature_length + 1) * sizeof(char));
-    ss_calculate(argv[2], signature_length, signature);
-
-    // Search the database for signature
-    Entry *matched_entry = bsearch(signature, entries, entry_count, sizeof (Entry), compare_entries);
-    if (matched_entry != NULL) {
-        for (size_t i = 0; i < matched_entry->word_count; i++) {
-            if (strncmp(matched_entry->words[i], argv[2], matched_entry->length) != 0) {
-                puts(matched_entry->words[i]);
-            }
+    // Search the database for the anagrams, and grow the buffer if they do not fit
+    char *buffer = NULL;
+    size_t capacity = 0;
+    size_t count;
+    size_t size;
+    PpStatus status;
+    while ((status = pp_anagram_db_lookup(&db, query, length, buffer, capacity, &count, &size)) == PP_ERROR_BUFFER) {
+        free(buffer);
+        capacity = size;
+        buffer = malloc(capacity);
+        if (!buffer) {
+            status = PP_ERROR_MEMORY;
+            break;
         }
     }
-
-    // Cleanup
-    for (size_t i = 0; i < entry_count; i++) {
-        free(entries[i].signature);
-        for (size_t j = 0; j < entries[i].word_count; j++) {
-            free(entries[i].words[j]);
+    if (status == PP_OK) {
+        for (size_t offset = 0; offset < size; offset += strlen(buffer + offset) + 1) {
+            puts(buffer + offset);
         }
-        free(entries[i].words);
+        stats_add_records(count);
+    } else {
+        fprintf(stderr, "Unable to search for the anagrams of %s: %s.\n", query, pp_status_message(status));
+        exit_status = EXIT_FAILURE;
     }
-    free(entries);
-    free(signature);
-    fclose(input_file);
 
-    return EXIT_SUCCESS;
-}
\ No newline at end of file
+    // Cleanup
+    free(buffer);
+    pp_anagram_db_close(&db);
+    stats_report();
+
+    return exit_status;
+}
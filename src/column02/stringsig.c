@@ -1,9 +1,104 @@
-#include <stdlib.h>
+/**
+ * This library calculates string signatures. The signature of a string is the string with all its characters sorted,
+ * so two strings are anagrams of each other if and only if they have the same signature. The characters are ordered the
+ * same way as compare_char orders them.
+ *
+ * Short strings are sorted with a sorting network, medium strings with insertion sort and long strings with a counting
+ * sort over all the possible character values. For equality checks only, a letter histogram or an order independent
+ * hash can be used instead, which avoid sorting altogether.
+ */
+#include <limits.h>
 #include <string.h>
 
-#include "compare.h"
 #include "stringsig.h"
 
+// The maximum length of a string that is sorted with a sorting network
+#define SS_NETWORK_MAX 8
+// The maximum length of a string that is sorted with insertion sort. Longer strings are sorted with counting sort.
+#define SS_INSERTION_MAX 32
+// The number of distinct character values
+#define SS_CHAR_VALUES (UCHAR_MAX + 1)
+
+/**
+ * The comparators of the optimal sorting networks for 2 up to SS_NETWORK_MAX elements. Each comparator is a pair of
+ * positions.
+ */
+static const unsigned char ss_network[] = {
+    // 2 elements, 1 comparator
+    0, 1,
+    // 3 elements, 3 comparators
+    1, 2, 0, 2, 0, 1,
+    // 4 elements, 5 comparators
+    0, 1, 2, 3, 0, 2, 1, 3, 1, 2,
+    // 5 elements, 9 comparators
+    0, 1, 3, 4, 2, 4, 2, 3, 1, 4, 0, 3, 0, 2, 1, 3, 1, 2,
+    // 6 elements, 12 comparators
+    1, 2, 4, 5, 0, 2, 3, 5, 0, 1, 3, 4, 2, 5, 0, 3, 1, 4, 2, 4, 1, 3, 2, 3,
+    // 7 elements, 16 comparators
+    1, 2, 3, 4, 5, 6, 0, 2, 3, 5, 4, 6, 0, 1, 4, 5, 2, 6, 0, 4, 1, 5, 0, 3, 2, 5, 1, 3, 2, 4, 2, 3,
+    // 8 elements, 19 comparators
+    0, 2, 1, 3, 4, 6, 5, 7, 0, 4, 1, 5, 2, 6, 3, 7, 0, 1, 2, 3, 4, 5, 6, 7, 2, 4, 3, 5, 1, 4, 3, 6, 1, 2, 3, 4, 5, 6
+};
+
+// The index of the first comparator for each network size in ss_network, and the number of comparators
+static const unsigned char ss_network_start[SS_NETWORK_MAX + 1] = {0, 0, 0, 1, 4, 9, 18, 30, 46};
+static const unsigned char ss_network_size[SS_NETWORK_MAX + 1] = {0, 0, 1, 3, 5, 9, 12, 16, 19};
+
+/**
+ * Sort a short string in place with a sorting network.
+ *
+ * @param s The string to sort.
+ * @param length The length of the string. Must be at most SS_NETWORK_MAX.
+ */
+static void ss_sort_network(char *s, size_t length) {
+    const unsigned char *comparator = ss_network + 2 * ss_network_start[length];
+    for (size_t i = 0; i < ss_network_size[length]; i++, comparator += 2) {
+        char x = s[comparator[0]];
+        char y = s[comparator[1]];
+        // Branch free compare and exchange
+        s[comparator[0]] = x < y ? x : y;
+        s[comparator[1]] = x < y ? y : x;
+    }
+}
+
+/**
+ * Sort a string in place with insertion sort.
+ *
+ * @param s The string to sort.
+ * @param length The length of the string.
+ */
+static void ss_sort_insertion(char *s, size_t length) {
+    for (size_t i = 1; i < length; i++) {
+        char c = s[i];
+        size_t j = i;
+        while (j > 0 && s[j - 1] > c) {
+            s[j] = s[j - 1];
+            j--;
+        }
+        s[j] = c;
+    }
+}
+
+/**
+ * Sort a string with counting sort.
+ *
+ * @param string The string to sort.
+ * @param length The length of the string.
+ * @param sorted Pointer to where the sorted string will be written to.
+ */
+static void ss_sort_counting(const char *string, size_t length, char *sorted) {
+    size_t counts[SS_CHAR_VALUES] = {0};
+    for (size_t i = 0; i < length; i++) {
+        counts[(unsigned char) string[i]]++;
+    }
+    // Emit the characters in the order of their char value, which puts the negative values first when char is signed
+    for (int c = CHAR_MIN; c <= CHAR_MAX; c++) {
+        size_t count = counts[(unsigned char) c];
+        memset(sorted, c, count);
+        sorted += count;
+    }
+}
+
 /**
  * Calculate the signature for a string.
  *
@@ -13,7 +108,135 @@
  * characters for the string.
  */
 void ss_calculate(const char *string, size_t length, char *signature) {
-    strncpy(signature, string , length);
+    if (length <= SS_NETWORK_MAX) {
+        memcpy(signature, string, length);
+        ss_sort_network(signature, length);
+    } else if (length <= SS_INSERTION_MAX) {
+        memcpy(signature, string, length);
+        ss_sort_insertion(signature, length);
+    } else {
+        ss_sort_counting(string, length, signature);
+    }
     signature[length] = '\0';
-    qsort(signature, length, sizeof(char), compare_char);
+}
+
+/**
+ * Calculate the signatures for many strings that are stored in the same buffer.
+ *
+ * @param buffer The buffer that holds the strings.
+ * @param offsets The offset of each string in the buffer.
+ * @param lengths The length of each string.
+ * @param count The number of strings.
+ * @param signatures Pointer to where the signatures will be written to. The signature of each string is written at the
+ * same offset as the string itself in the input buffer, and it is null terminated. The caller is responsible to
+ * allocate a buffer that can hold offsets[i] + lengths[i] + 1 characters for every string i, so when the strings are
+ * separated by a single character, a buffer of the same size as the input buffer is sufficient.
+ */
+void ss_calculate_many(const char *buffer, const size_t *offsets, const size_t *lengths, size_t count,
+                       char *signatures) {
+    for (size_t i = 0; i < count; i++) {
+        ss_calculate(buffer + offsets[i], lengths[i], signatures + offsets[i]);
+    }
+}
+
+/**
+ * Calculate the letter histogram for a string.
+ *
+ * @param string The string to calculate the histogram for.
+ * @param length The length of the input string.
+ * @param histogram Pointer to where the histogram will be written to.
+ * @return true if the histogram was calculated, false if the string contains characters other than 'a' to 'z' or a
+ * letter occurs more than 255 times. In that case the signature must be used instead.
+ */
+bool ss_histogram(const char *string, size_t length, SsHistogram *histogram) {
+    memset(histogram, 0, sizeof(SsHistogram));
+    for (size_t i = 0; i < length; i++) {
+        unsigned letter = (unsigned char) string[i] - 'a';
+        if (letter >= SS_HISTOGRAM_LETTERS || histogram->counts[letter] == UINT8_MAX) {
+            return false;
+        }
+        histogram->counts[letter]++;
+    }
+
+    return true;
+}
+
+/**
+ * Check if two letter histograms are equal.
+ *
+ * @param p The first histogram.
+ * @param q The second histogram.
+ * @return true if the histograms are equal, false otherwise.
+ */
+bool ss_histogram_equal(const SsHistogram *p, const SsHistogram *q) {
+    return memcmp(p->counts, q->counts, SS_HISTOGRAM_SIZE) == 0;
+}
+
+/**
+ * Check if a string can be built from the letters of another string, that is if each letter occurs in the second
+ * histogram at most as many times as in the first one.
+ *
+ * @param p The histogram of the available letters.
+ * @param q The histogram of the string to build.
+ * @return true if the letters of q are contained in the letters of p, false otherwise.
+ */
+bool ss_histogram_contains(const SsHistogram *p, const SsHistogram *q) {
+    // No early exit, so that the loop is compiled to a few vector instructions
+    uint8_t excess = 0;
+    for (size_t i = 0; i < SS_HISTOGRAM_SIZE; i++) {
+        excess |= q->counts[i] > p->counts[i];
+    }
+
+    return excess == 0;
+}
+
+/**
+ * Calculate the letter presence mask of a letter histogram. Bit i of the mask is set if the letter 'a' + i occurs in
+ * the string. A string can only be built from the letters of another string if its mask is a subset of the other mask.
+ *
+ * @param histogram The letter histogram.
+ * @return The letter presence mask.
+ */
+uint32_t ss_histogram_mask(const SsHistogram *histogram) {
+    uint32_t mask = 0;
+    for (size_t i = 0; i < SS_HISTOGRAM_LETTERS; i++) {
+        mask |= (uint32_t) (histogram->counts[i] != 0) << i;
+    }
+
+    return mask;
+}
+
+/**
+ * Mix the bits of a 64-bit value. This is the finalizer of the SplitMix64 generator.
+ *
+ * @param x The value to mix.
+ * @return The mixed value.
+ */
+static inline uint64_t ss_mix(uint64_t x) {
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ULL;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebULL;
+    x ^= x >> 31;
+
+    return x;
+}
+
+/**
+ * Calculate a 64-bit hash of the signature of a string. The hash does not depend on the order of the characters, so it
+ * is the same for a word, its signature and all of its anagrams. Different signatures can have the same hash, so it can
+ * only be used to rule out that two strings are anagrams.
+ *
+ * @param string The string to calculate the hash for.
+ * @param length The length of the input string.
+ * @return The signature hash.
+ */
+uint64_t ss_hash(const char *string, size_t length) {
+    // The sum of the hashes of the characters is independent of their order
+    uint64_t sum = 0;
+    for (size_t i = 0; i < length; i++) {
+        sum += ss_mix((unsigned char) string[i] + 0x9e3779b97f4a7c15ULL);
+    }
+
+    return ss_mix(sum ^ length);
 }
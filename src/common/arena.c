@@ -0,0 +1,144 @@
+/**
+ * This library implements an arena (or bump) allocator. Memory is allocated from large chunks by advancing an offset,
+ * so an allocation costs a few instructions and has no per allocation header. All the memory is freed at once when the
+ * arena is destroyed, which replaces one free call per allocation with one per chunk.
+ */
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "arena.h"
+
+// The default size of the first chunk
+#define ARENA_DEFAULT_CHUNK_SIZE (64 * 1024)
+// The size after which the chunks stop growing
+#define ARENA_MAX_CHUNK_SIZE (64 * 1024 * 1024)
+// The alignment of the memory returned by arena_alloc
+#define ARENA_ALIGNMENT (sizeof(max_align_t))
+
+/**
+ * Initialize the arena.
+ *
+ * @param arena Pointer to the arena data structure.
+ * @param chunk_size The size of the first chunk. Each subsequent chunk is double the size of the previous one, up to a
+ * limit. If it is zero, a default size is used.
+ */
+void arena_init(Arena *arena, size_t chunk_size) {
+    arena->head = NULL;
+    arena->chunk_size = chunk_size ? chunk_size : ARENA_DEFAULT_CHUNK_SIZE;
+    arena->chunk_count = 0;
+    arena->allocated = 0;
+}
+
+/**
+ * Free all the memory allocated from the arena.
+ *
+ * @param arena Pointer to the arena data structure.
+ */
+void arena_destroy(Arena *arena) {
+    ArenaChunk *chunk = arena->head;
+    while (chunk) {
+        ArenaChunk *next = chunk->next;
+        free(chunk);
+        chunk = next;
+    }
+    arena->head = NULL;
+    arena->chunk_count = 0;
+    arena->allocated = 0;
+}
+
+/**
+ * Allocate a new chunk that can hold at least size bytes, and make it the current chunk.
+ *
+ * @param arena Pointer to the arena data structure.
+ * @param size The minimum number of bytes that the chunk must hold.
+ * @return true if the chunk was allocated successfully, false otherwise.
+ */
+static bool arena_grow(Arena *arena, size_t size) {
+    size_t chunk_size = arena->chunk_size;
+    if (chunk_size < size) {
+        chunk_size = size;
+    }
+    if (chunk_size > SIZE_MAX - sizeof(ArenaChunk)) {
+        return false;
+    }
+    ArenaChunk *chunk = malloc(sizeof(ArenaChunk) + chunk_size);
+    if (!chunk) {
+        return false;
+    }
+    chunk->next = arena->head;
+    chunk->size = chunk_size;
+    chunk->used = 0;
+    arena->head = chunk;
+    arena->chunk_count++;
+    if (arena->chunk_size < ARENA_MAX_CHUNK_SIZE) {
+        arena->chunk_size *= 2;
+    }
+
+    return true;
+}
+
+/**
+ * Allocate memory from the current chunk, starting at an offset that is a multiple of the alignment.
+ *
+ * @param arena Pointer to the arena data structure.
+ * @param size The number of bytes to allocate.
+ * @param alignment The alignment of the memory. Must be a power of two.
+ * @return Pointer to the allocated memory, or NULL if the memory could not be allocated.
+ */
+static void *arena_alloc_aligned(Arena *arena, size_t size, size_t alignment) {
+    ArenaChunk *chunk = arena->head;
+    size_t offset = chunk ? (chunk->used + alignment - 1) & ~(alignment - 1) : 0;
+    if (!chunk || offset > chunk->size || size > chunk->size - offset) {
+        if (!arena_grow(arena, size)) {
+            return NULL;
+        }
+        chunk = arena->head;
+        offset = 0;
+    }
+    chunk->used = offset + size;
+    arena->allocated += size;
+
+    return (char *) chunk->data + offset;
+}
+
+/**
+ * Allocate memory from the arena. The memory is suitably aligned for any type.
+ *
+ * @param arena Pointer to the arena data structure.
+ * @param size The number of bytes to allocate.
+ * @return Pointer to the allocated memory, or NULL if the memory could not be allocated.
+ */
+void *arena_alloc(Arena *arena, size_t size) {
+    return arena_alloc_aligned(arena, size, ARENA_ALIGNMENT);
+}
+
+/**
+ * Allocate memory from the arena without any alignment. It is meant for character data.
+ *
+ * @param arena Pointer to the arena data structure.
+ * @param size The number of bytes to allocate.
+ * @return Pointer to the allocated memory, or NULL if the memory could not be allocated.
+ */
+char *arena_alloc_chars(Arena *arena, size_t size) {
+    return arena_alloc_aligned(arena, size, 1);
+}
+
+/**
+ * Copy at most length characters of a string to memory allocated from the arena. The copy is always null terminated.
+ *
+ * @param arena Pointer to the arena data structure.
+ * @param string The string to copy.
+ * @param length The maximum number of characters to copy.
+ * @return Pointer to the copy, or NULL if the memory could not be allocated.
+ */
+char *arena_strndup(Arena *arena, const char *string, size_t length) {
+    length = strnlen(string, length);
+    char *copy = arena_alloc_chars(arena, length + 1);
+    if (copy) {
+        memcpy(copy, string, length);
+        copy[length] = '\0';
+    }
+
+    return copy;
+}
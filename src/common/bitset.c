@@ -1,17 +1,27 @@
 /**
  * This library implements a bit set data structure, which is used to compactly store bits. It provides functions to
- * set, unset, toggle and clear all bits in the data structure.
+ * set, unset, toggle and clear all bits in the data structure, and to combine two bit sets and count their bits a whole
+ * unit at a time. A bit set can be saved to a snapshot file and loaded back, through memory mappings of the file.
  */
 #include <stdbool.h>
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <limits.h>
 
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
 #include "bitset.h"
 
 #define BS_NUM_BYTES(n) (((n - 1) / (sizeof(BS_UNIT) * CHAR_BIT) + 1) * sizeof(BS_UNIT))
 #define BS_UNIT_POS(n) ((n) / (sizeof(BS_UNIT) * CHAR_BIT))
 #define BS_BIT_POS(n) ((n) % (sizeof(BS_UNIT) * CHAR_BIT))
+#define BS_NUM_UNITS(n) (BS_NUM_BYTES(n) / sizeof(BS_UNIT))
+// The suffix of the temporary file of a snapshot
+#define BS_TEMP_SUFFIX ".tmp"
 
 /**
 * Initialize the bit set.
@@ -26,13 +36,11 @@ bool bs_init(BitSet *bs, size_t n) {
         return false;
     }
 
-    // Initialize the storage
-    size_t num_bytes = BS_NUM_BYTES(n);
-    bs->bits = malloc(num_bytes);
+    // Initialize the storage, which is only touched when its bits are, as large blocks are mapped zeroed
+    bs->bits = calloc(BS_NUM_BYTES(n), 1);
     if (!bs->bits) {
         return false;
     }
-    memset(bs->bits, 0, num_bytes);
     bs->n = n;
 
     return true;
@@ -122,3 +130,143 @@ bool bs_toggle(BitSet *bs, size_t n) {
 bool bs_reset(BitSet *bs) {
     return memset(bs->bits, 0, BS_NUM_BYTES(bs->n));
 }
+
+/**
+* Keep only the bits that are also set in another bit set, a whole unit at a time.
+*
+* @param bs Pointer to the bit set data structure.
+* @param other Pointer to the other bit set, which must hold the same number of bits.
+* @return true if the bit sets were combined successfully, false otherwise.
+*/
+bool bs_and(BitSet *bs, const BitSet *other) {
+    if (bs->n != other->n) {
+        return false;
+    }
+
+    size_t num_units = BS_NUM_UNITS(bs->n);
+    for (size_t i = 0; i < num_units; i++) {
+        bs->bits[i] &= other->bits[i];
+    }
+
+    return true;
+}
+
+/**
+* Set the bits that are set in another bit set, a whole unit at a time.
+*
+* @param bs Pointer to the bit set data structure.
+* @param other Pointer to the other bit set, which must hold the same number of bits.
+* @return true if the bit sets were combined successfully, false otherwise.
+*/
+bool bs_or(BitSet *bs, const BitSet *other) {
+    if (bs->n != other->n) {
+        return false;
+    }
+
+    size_t num_units = BS_NUM_UNITS(bs->n);
+    for (size_t i = 0; i < num_units; i++) {
+        bs->bits[i] |= other->bits[i];
+    }
+
+    return true;
+}
+
+/**
+* Clear the bits that are set in another bit set, a whole unit at a time.
+*
+* @param bs Pointer to the bit set data structure.
+* @param other Pointer to the other bit set, which must hold the same number of bits.
+* @return true if the bit sets were combined successfully, false otherwise.
+*/
+bool bs_andnot(BitSet *bs, const BitSet *other) {
+    if (bs->n != other->n) {
+        return false;
+    }
+
+    size_t num_units = BS_NUM_UNITS(bs->n);
+    for (size_t i = 0; i < num_units; i++) {
+        bs->bits[i] &= ~other->bits[i];
+    }
+
+    return true;
+}
+
+/**
+* Count the bits that are set.
+*
+* @param bs Pointer to the bit set data structure.
+* @return The number of bits that are set.
+*/
+size_t bs_count(const BitSet *bs) {
+    size_t num_units = BS_NUM_UNITS(bs->n);
+    size_t count = 0;
+    for (size_t i = 0; i < num_units; i++) {
+        count += __builtin_popcount(bs->bits[i]);
+    }
+
+    return count;
+}
+
+/**
+* Write a snapshot of the bit set to a file. The snapshot is copied to a shared memory mapping of a temporary file,
+* which is synced to the disk before it replaces the file, so the file always holds a complete snapshot.
+*
+* @param bs Pointer to the bit set data structure.
+* @param path The path of the snapshot file.
+* @return true if the snapshot was written successfully, false otherwise.
+*/
+bool bs_save(const BitSet *bs, const char *path) {
+    size_t size = BS_NUM_BYTES(bs->n);
+    char *temp_path = malloc(strlen(path) + sizeof(BS_TEMP_SUFFIX));
+    if (!temp_path) {
+        return false;
+    }
+    strcpy(temp_path, path);
+    strcat(temp_path, BS_TEMP_SUFFIX);
+    int fd = open(temp_path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    bool ok = fd >= 0 && ftruncate(fd, (off_t) size) == 0;
+    void *map = ok ? mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0) : MAP_FAILED;
+    ok = map != MAP_FAILED;
+    if (ok) {
+        memcpy(map, bs->bits, size);
+        ok = msync(map, size, MS_SYNC) == 0;
+        munmap(map, size);
+    }
+    if (fd >= 0 && close(fd) != 0) {
+        ok = false;
+    }
+    ok = ok && rename(temp_path, path) == 0;
+    if (!ok && fd >= 0) {
+        unlink(temp_path);
+    }
+    free(temp_path);
+
+    return ok;
+}
+
+/**
+* Read a snapshot of a bit set, which must hold the same number of bits, from a memory mapping of its file.
+*
+* @param bs Pointer to the bit set data structure.
+* @param path The path of the snapshot file.
+* @return true if the snapshot was read successfully, false if it cannot be read or holds a different number of bits.
+*/
+bool bs_load(BitSet *bs, const char *path) {
+    size_t size = BS_NUM_BYTES(bs->n);
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat st;
+    bool ok = fstat(fd, &st) == 0 && (size_t) st.st_size == size;
+    const void *map = ok ? mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0) : MAP_FAILED;
+    close(fd);
+    if (map == MAP_FAILED) {
+        return false;
+    }
+    madvise((void *) map, size, MADV_SEQUENTIAL);
+    memcpy(bs->bits, map, size);
+    munmap((void *) map, size);
+
+    return true;
+}
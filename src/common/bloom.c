@@ -0,0 +1,148 @@
+/**
+ * This library implements a blocked Bloom filter on top of the bit set. Each key sets hash_count bits of a single
+ * block, which is the size of a cache line, so a test reads a single cache line. The block of a key is chosen by the
+ * high half of the key, and its bits in the block by multiplicative hashing of the low half.
+ */
+#include <math.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "bloom.h"
+
+// The number of bits of the position of a bit in a block
+#define POSITION_BITS 9
+
+/**
+ * Estimate the false positive rate of a blocked Bloom filter. The number of keys of a block follows a Poisson
+ * distribution, and the rate is the average of the rates of a classic Bloom filter of a block with each number of keys,
+ * weighted by its probability. The overloaded blocks make it higher than the rate of a classic filter of the same size.
+ *
+ * @param bits_per_key The number of bits of the filter per key.
+ * @param hash_count The number of bits that are set for each key.
+ * @return The estimated false positive rate.
+ */
+static double blocked_rate(double bits_per_key, uint32_t hash_count) {
+    double mean = BF_BLOCK_BITS / bits_per_key;
+    double probability = exp(-mean);
+    double rate = 0;
+    for (size_t keys = 0; keys < 2 * mean + 64; keys++) {
+        rate += probability * pow(1 - exp(-(double) hash_count * keys / BF_BLOCK_BITS), hash_count);
+        probability *= mean / (keys + 1);
+    }
+
+    return rate;
+}
+
+/**
+ * Get the number of bits per key that minimizes the false positives of a Bloom filter.
+ *
+ * @param bits_per_key The number of bits of the filter per key.
+ * @return The number of bits that are set for each key.
+ */
+static uint32_t optimal_hash_count(double bits_per_key) {
+    double hash_count = round(bits_per_key * log(2));
+
+    return hash_count < 1 ? 1 : hash_count > BF_MAX_HASHES ? BF_MAX_HASHES : (uint32_t) hash_count;
+}
+
+/**
+ * Initialize a Bloom filter that is sized for a number of keys and a false positive rate.
+ *
+ * @param bf Pointer to the Bloom filter data structure.
+ * @param key_count The number of keys that will be added.
+ * @param false_positive_rate The rate of the tests of absent keys that find them, between 0 and 1 exclusive.
+ * @return true if the filter was initialized successfully, false if the rate is invalid or the memory could not be
+ * allocated.
+ */
+bool bf_init(BloomFilter *bf, size_t key_count, double false_positive_rate) {
+    if (!(false_positive_rate > 0 && false_positive_rate < 1)) {
+        return false;
+    }
+
+    // Start from the optimal size of a classic Bloom filter, and grow it until the blocks reach the rate as well
+    double bits_per_key = -log(false_positive_rate) / (log(2) * log(2));
+    bf->hash_count = optimal_hash_count(bits_per_key);
+    while (blocked_rate(bits_per_key, bf->hash_count) > false_positive_rate && bits_per_key < BF_BLOCK_BITS) {
+        bits_per_key *= 1.05;
+        bf->hash_count = optimal_hash_count(bits_per_key);
+    }
+    double block_count = ceil(bits_per_key * key_count / BF_BLOCK_BITS);
+    if (block_count > (double) (SIZE_MAX / BF_BLOCK_BITS)) {
+        return false;
+    }
+    bf->block_count = block_count < 1 ? 1 : (size_t) block_count;
+
+    return bs_init(&bf->bits, bf->block_count * BF_BLOCK_BITS);
+}
+
+/**
+ * Free resources associated with a Bloom filter. Filters whose bits are owned by someone else, like the views of
+ * memory mapped files, must not be destroyed.
+ *
+ * @param bf Pointer to the Bloom filter data structure.
+ */
+void bf_destroy(BloomFilter *bf) {
+    bs_destroy(&bf->bits);
+}
+
+/**
+ * Get the block of a Bloom filter that holds the bits of a key. The bits inside the block only depend on the key, so a
+ * single block can be tested as a filter of one block.
+ *
+ * @param block_count The number of blocks of the filter.
+ * @param hash The key.
+ * @return The index of the block.
+ */
+size_t bf_block_index(size_t block_count, uint64_t hash) {
+    // Multiply and shift instead of a modulo, which maps the high half of the key to the blocks evenly
+    return (size_t) (((hash >> 32) * (uint64_t) block_count) >> 32);
+}
+
+/**
+ * Get the position of the next bit of a key in its block. The state is multiplied by an odd constant, which is a
+ * bijection, and the position is taken from the high bits of the product, so the keys whose low halves differ have
+ * different sequences of bits.
+ *
+ * @param state Pointer to the state, which starts as the low half of the key.
+ * @return The position of the bit in the block.
+ */
+static size_t next_position(uint32_t *state) {
+    *state *= 0x9e3779b1u;
+
+    return *state >> (32 - POSITION_BITS);
+}
+
+/**
+ * Add a key to a Bloom filter.
+ *
+ * @param bf Pointer to the Bloom filter data structure.
+ * @param hash The key.
+ */
+void bf_add(BloomFilter *bf, uint64_t hash) {
+    size_t first = bf_block_index(bf->block_count, hash) * BF_BLOCK_BITS;
+    uint32_t state = (uint32_t) hash;
+    for (uint32_t i = 0; i < bf->hash_count; i++) {
+        bs_set(&bf->bits, first + next_position(&state));
+    }
+}
+
+/**
+ * Test if a key may have been added to a Bloom filter.
+ *
+ * @param bf Pointer to the Bloom filter data structure.
+ * @param hash The key.
+ * @return false if the key was definitely not added, true if it may have been.
+ */
+bool bf_may_contain(const BloomFilter *bf, uint64_t hash) {
+    BitSet bits = bf->bits;
+    size_t first = bf_block_index(bf->block_count, hash) * BF_BLOCK_BITS;
+    uint32_t state = (uint32_t) hash;
+    for (uint32_t i = 0; i < bf->hash_count; i++) {
+        if (!bs_is_set(&bits, first + next_position(&state))) {
+            return false;
+        }
+    }
+
+    return true;
+}
@@ -0,0 +1,190 @@
+/**
+ * This library keeps the checkpoints of the multi-pass programs, so that an interrupted run is resumed at its first
+ * unfinished pass instead of reading the passes that were finished again. A checkpoint is a directory with a state
+ * file, which records the pass, the input and output offsets and the values of the program, and the files that the
+ * program keeps there, like the snapshots of its bit sets. Every file is written to a temporary file first, which is
+ * synced and renamed, so a crash leaves either the old or the new state.
+ */
+#include <errno.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "checkpoint.h"
+
+// The name of the state file
+#define STATE_NAME "state"
+// The name of the temporary file of the state
+#define STATE_TEMP_NAME "state.tmp"
+
+/**
+ * Get the path of a file of a checkpoint directory.
+ *
+ * @param checkpoint Pointer to the checkpoint data structure.
+ * @param name The name of the file.
+ * @return The path, which must be freed, or NULL if memory could not be allocated.
+ */
+char *pp_checkpoint_path(const PpCheckpoint *checkpoint, const char *name) {
+    char *path = malloc(strlen(checkpoint->directory) + strlen(name) + 2);
+    if (path) {
+        sprintf(path, "%s/%s", checkpoint->directory, name);
+    }
+
+    return path;
+}
+
+/**
+ * Load the state of an earlier run from the state file of a checkpoint directory.
+ *
+ * @param checkpoint Pointer to the checkpoint data structure, whose state is the one of the new run.
+ * @return PP_OK if the state was loaded or there is no state file, PP_ERROR_CHECKPOINT if the state belongs to another
+ * program, input or options, an error otherwise.
+ */
+static PpStatus load_state(PpCheckpoint *checkpoint) {
+    char *path = pp_checkpoint_path(checkpoint, STATE_NAME);
+    if (!path) {
+        return PP_ERROR_MEMORY;
+    }
+    FILE *file = fopen(path, "rb");
+    free(path);
+    if (!file) {
+        return errno == ENOENT ? PP_OK : PP_ERROR_IO;
+    }
+    PpCheckpointState state;
+    bool read = fread(&state, sizeof(PpCheckpointState), 1, file) == 1;
+    fclose(file);
+    if (!read || memcmp(state.magic, checkpoint->state.magic, PP_CHECKPOINT_MAGIC_SIZE) != 0 ||
+        memcmp(state.program, checkpoint->state.program, PP_CHECKPOINT_PROGRAM_SIZE) != 0 ||
+        memcmp(&state.input, &checkpoint->state.input, sizeof(PpFileId)) != 0 ||
+        memcmp(state.options, checkpoint->state.options, sizeof(state.options)) != 0) {
+        return PP_ERROR_CHECKPOINT;
+    }
+    checkpoint->state = state;
+    checkpoint->resumed = true;
+
+    return PP_OK;
+}
+
+/**
+ * Open a checkpoint directory, which is created if it does not exist. If it holds the state of an earlier run, the
+ * state is loaded, so the run can be resumed. Otherwise the state is that of a run that has not started.
+ *
+ * @param checkpoint Pointer to the checkpoint data structure.
+ * @param directory The path of the directory.
+ * @param program The name of the program.
+ * @param input_fd The file descriptor of the input file.
+ * @param options The options of the run that decide its passes.
+ * @param option_count The number of options, up to PP_CHECKPOINT_OPTIONS.
+ * @return PP_OK if the directory was opened successfully, PP_ERROR_CHECKPOINT if its state belongs to another program,
+ * input or options, an error otherwise.
+ */
+PpStatus pp_checkpoint_open(PpCheckpoint *checkpoint, const char *directory, const char *program, int input_fd,
+                            const uint64_t *options, size_t option_count) {
+    memset(checkpoint, 0, sizeof(PpCheckpoint));
+    if (strlen(program) >= PP_CHECKPOINT_PROGRAM_SIZE || option_count > PP_CHECKPOINT_OPTIONS) {
+        return PP_ERROR_ARGUMENT;
+    }
+    struct stat st;
+    if (fstat(input_fd, &st) != 0 || (mkdir(directory, 0755) != 0 && errno != EEXIST)) {
+        return PP_ERROR_IO;
+    }
+    checkpoint->directory = strdup(directory);
+    if (!checkpoint->directory) {
+        return PP_ERROR_MEMORY;
+    }
+
+    // The state of a run that has not started, which an earlier run must match to be resumed
+    PpCheckpointState *state = &checkpoint->state;
+    memcpy(state->magic, PP_CHECKPOINT_MAGIC, PP_CHECKPOINT_MAGIC_SIZE);
+    strcpy(state->program, program);
+    state->input.size = st.st_size;
+    state->input.inode = st.st_ino;
+    state->input.mtime = (int64_t) st.st_mtim.tv_sec * 1000000000 + st.st_mtim.tv_nsec;
+    memcpy(state->options, options, option_count * sizeof(uint64_t));
+    PpStatus status = load_state(checkpoint);
+    if (status != PP_OK) {
+        pp_checkpoint_close(checkpoint);
+    }
+
+    return status;
+}
+
+/**
+ * Flush a file and make sure that its data is on the disk, before a state that refers to it is saved. Files that
+ * cannot be synced, like pipes and terminals, are only flushed.
+ *
+ * @param file The file.
+ * @return PP_OK if the file was synced successfully, PP_ERROR_IO otherwise.
+ */
+PpStatus pp_checkpoint_sync(FILE *file) {
+    if (fflush(file) != 0 || (fsync(fileno(file)) != 0 && errno != EINVAL)) {
+        return PP_ERROR_IO;
+    }
+
+    return PP_OK;
+}
+
+/**
+ * Save the state of a checkpoint. It is written to a temporary file, which replaces the state file once it is on the
+ * disk, and the directory is synced, so the state and the files that were renamed into the directory before it survive
+ * a crash together.
+ *
+ * @param checkpoint Pointer to the checkpoint data structure.
+ * @return PP_OK if the state was saved successfully, PP_ERROR_IO otherwise.
+ */
+PpStatus pp_checkpoint_save(PpCheckpoint *checkpoint) {
+    char *path = pp_checkpoint_path(checkpoint, STATE_NAME);
+    char *temp_path = pp_checkpoint_path(checkpoint, STATE_TEMP_NAME);
+    FILE *file = path && temp_path ? fopen(temp_path, "wb") : NULL;
+    bool ok = file && fwrite(&checkpoint->state, sizeof(PpCheckpointState), 1, file) == 1 &&
+              pp_checkpoint_sync(file) == PP_OK;
+    if (file && fclose(file) != 0) {
+        ok = false;
+    }
+    ok = ok && rename(temp_path, path) == 0;
+    if (!ok && file) {
+        unlink(temp_path);
+    }
+    free(path);
+    free(temp_path);
+
+    // Sync the directory, which holds the renames
+    int fd = ok ? open(checkpoint->directory, O_RDONLY | O_DIRECTORY) : -1;
+    ok = fd >= 0 && fsync(fd) == 0;
+    if (fd >= 0) {
+        close(fd);
+    }
+
+    return ok ? PP_OK : PP_ERROR_IO;
+}
+
+/**
+ * Remove the state of a finished run and the directory, if it is empty, and free the resources of a checkpoint. The
+ * files of the program must have been removed.
+ *
+ * @param checkpoint Pointer to the checkpoint data structure.
+ */
+void pp_checkpoint_finish(PpCheckpoint *checkpoint) {
+    char *path = pp_checkpoint_path(checkpoint, STATE_NAME);
+    if (path) {
+        unlink(path);
+        rmdir(checkpoint->directory);
+    }
+    free(path);
+    pp_checkpoint_close(checkpoint);
+}
+
+/**
+ * Free the resources of a checkpoint, keeping its directory for a later run.
+ *
+ * @param checkpoint Pointer to the checkpoint data structure.
+ */
+void pp_checkpoint_close(PpCheckpoint *checkpoint) {
+    free(checkpoint->directory);
+    checkpoint->directory = NULL;
+}
@@ -0,0 +1,469 @@
+/**
+ * This library runs fork-join tasks on a pool of worker threads with work stealing, so that the programs can process
+ * chunks of their input in parallel without starting their own threads for each step.
+ *
+ * Each worker has a queue of the tasks that it spawned. The worker takes its own tasks from the bottom of its queue,
+ * most recent first, and an idle worker steals from the top of the queue of another worker, where the oldest tasks
+ * are. As parallel loops spawn the larger half of their range first, a steal takes a large piece of work, and steals
+ * are rare. The queues are small and each one has its own lock, so workers only contend when they steal from the same
+ * queue. Workers that find no task sleep on a condition until a task is spawned, and a thread that waits for a join
+ * runs the queued tasks in the meantime, so nested joins cannot deadlock.
+ */
+#include <limits.h>
+#include <sched.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "pool.h"
+
+// The number of tasks that a queue initially holds
+#define DEQUE_INITIAL_CAPACITY 64
+// The number of calls of a parallel invoke that are spawned without allocating memory
+#define INVOKE_LOCAL_COUNT 8
+
+// The worker of the current thread, or NULL if the current thread is not a worker thread
+static _Thread_local PpWorker *current_worker = NULL;
+
+/**
+ * A range of a parallel loop.
+ */
+typedef struct {
+    /** The task. */
+    PpTask task;
+    /** The pool. */
+    PpPool *pool;
+    /** The first index of the range. */
+    size_t first;
+    /** The index after the last one of the range. */
+    size_t last;
+    /** The largest number of indexes of a single call. */
+    size_t grain;
+    /** The function. */
+    PpRangeFunction function;
+    /** The context that is passed to the function. */
+    void *context;
+} RangeTask;
+
+/**
+ * A function call of a parallel invoke.
+ */
+typedef struct {
+    /** The task. */
+    PpTask task;
+    /** The function call. */
+    PpInvoke call;
+} InvokeTask;
+
+/**
+ * Initialize a queue.
+ *
+ * @param deque Pointer to the queue data structure.
+ * @return true if the queue was initialized successfully, false otherwise.
+ */
+static bool deque_init(PpDeque *deque) {
+    memset(deque, 0, sizeof(PpDeque));
+    deque->tasks = malloc(DEQUE_INITIAL_CAPACITY * sizeof(PpTask *));
+    if (!deque->tasks) {
+        return false;
+    }
+    deque->capacity = DEQUE_INITIAL_CAPACITY;
+    pthread_mutex_init(&deque->lock, NULL);
+
+    return true;
+}
+
+/**
+ * Push a task at the bottom of a queue, growing the queue if it is full.
+ *
+ * @param deque Pointer to the queue data structure.
+ * @param task The task.
+ * @return true if the task was pushed, false if the queue could not grow.
+ */
+static bool deque_push(PpDeque *deque, PpTask *task) {
+    pthread_mutex_lock(&deque->lock);
+    if (deque->count == deque->capacity) {
+        PpTask **tasks = malloc(2 * deque->capacity * sizeof(PpTask *));
+        if (!tasks) {
+            pthread_mutex_unlock(&deque->lock);
+            return false;
+        }
+        for (size_t i = 0; i < deque->count; i++) {
+            tasks[i] = deque->tasks[(deque->top + i) % deque->capacity];
+        }
+        free(deque->tasks);
+        deque->tasks = tasks;
+        deque->capacity *= 2;
+        deque->top = 0;
+    }
+    deque->tasks[(deque->top + deque->count) % deque->capacity] = task;
+    deque->count++;
+    pthread_mutex_unlock(&deque->lock);
+
+    return true;
+}
+
+/**
+ * Take the bottom task of a queue, which is the most recently pushed one.
+ *
+ * @param deque Pointer to the queue data structure.
+ * @return The task, or NULL if the queue is empty.
+ */
+static PpTask *deque_pop(PpDeque *deque) {
+    PpTask *task = NULL;
+    pthread_mutex_lock(&deque->lock);
+    if (deque->count > 0) {
+        deque->count--;
+        task = deque->tasks[(deque->top + deque->count) % deque->capacity];
+    }
+    pthread_mutex_unlock(&deque->lock);
+
+    return task;
+}
+
+/**
+ * Take the top task of a queue, which is the oldest one.
+ *
+ * @param deque Pointer to the queue data structure.
+ * @return The task, or NULL if the queue is empty.
+ */
+static PpTask *deque_steal(PpDeque *deque) {
+    PpTask *task = NULL;
+    pthread_mutex_lock(&deque->lock);
+    if (deque->count > 0) {
+        task = deque->tasks[deque->top];
+        deque->top = (deque->top + 1) % deque->capacity;
+        deque->count--;
+    }
+    pthread_mutex_unlock(&deque->lock);
+
+    return task;
+}
+
+/**
+ * Free resources associated with a queue.
+ *
+ * @param deque Pointer to the queue data structure.
+ */
+static void deque_destroy(PpDeque *deque) {
+    if (deque->tasks) {
+        pthread_mutex_destroy(&deque->lock);
+    }
+    free(deque->tasks);
+    memset(deque, 0, sizeof(PpDeque));
+}
+
+/**
+ * Get the worker of the current thread in a pool. The threads that are not workers of the pool share worker 0.
+ *
+ * @param pool Pointer to the pool data structure.
+ * @return The worker.
+ */
+static PpWorker *get_worker(PpPool *pool) {
+    return current_worker && current_worker->pool == pool ? current_worker : &pool->workers[0];
+}
+
+/**
+ * Find a task for a worker, in its own queue first, and then in the queues of the other workers, starting from a
+ * random one.
+ *
+ * @param worker Pointer to the worker.
+ * @return The task, or NULL if no task was found.
+ */
+static PpTask *find_task(PpWorker *worker) {
+    PpPool *pool = worker->pool;
+    PpTask *task = deque_pop(&worker->deque);
+    if (!task && atomic_load(&pool->queued) > 0) {
+        // A xorshift generator, which is only used to spread the steals
+        size_t state = worker->victim_state;
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        worker->victim_state = state;
+        size_t start = state % pool->worker_count;
+        for (size_t i = 0; i < pool->worker_count && !task; i++) {
+            size_t victim = (start + i) % pool->worker_count;
+            if (victim != worker->index) {
+                task = deque_steal(&pool->workers[victim].deque);
+            }
+        }
+    }
+    if (task) {
+        atomic_fetch_sub(&pool->queued, 1);
+    }
+
+    return task;
+}
+
+/**
+ * Run a task, and mark it as done in its join.
+ *
+ * @param task The task.
+ */
+static void run_task(PpTask *task) {
+    // The task may be freed as soon as its join is complete, so its join is read first
+    atomic_size_t *pending = task->pending;
+    task->run(task);
+    atomic_fetch_sub_explicit(pending, 1, memory_order_release);
+}
+
+/**
+ * The loop of a worker thread, which runs tasks, and sleeps while there are none.
+ *
+ * @param arg Pointer to the worker.
+ * @return Always NULL.
+ */
+static void *worker_thread(void *arg) {
+    PpWorker *worker = arg;
+    PpPool *pool = worker->pool;
+    current_worker = worker;
+    while (!atomic_load(&pool->stop)) {
+        PpTask *task = find_task(worker);
+        if (task) {
+            run_task(task);
+            continue;
+        }
+        // The sleeping count is raised before the queued count is checked, and the spawners do the opposite, so
+        // either this worker sees the new task or the spawner sees this worker and wakes it
+        pthread_mutex_lock(&pool->lock);
+        atomic_fetch_add(&pool->sleeping, 1);
+        while (atomic_load(&pool->queued) == 0 && !atomic_load(&pool->stop)) {
+            pthread_cond_wait(&pool->wake, &pool->lock);
+        }
+        atomic_fetch_sub(&pool->sleeping, 1);
+        pthread_mutex_unlock(&pool->lock);
+    }
+
+    return NULL;
+}
+
+/**
+ * Initialize a pool.
+ *
+ * @param pool Pointer to the pool data structure.
+ * @param workers The number of workers, including the calling thread, so workers - 1 threads are started. It must be
+ * between 1 and PP_POOL_MAX_WORKERS.
+ * @return PP_OK if the pool was initialized successfully, an error otherwise.
+ */
+PpStatus pp_pool_init(PpPool *pool, size_t workers) {
+    memset(pool, 0, sizeof(PpPool));
+    if (workers == 0 || workers > PP_POOL_MAX_WORKERS) {
+        return PP_ERROR_ARGUMENT;
+    }
+    pool->workers = calloc(workers, sizeof(PpWorker));
+    if (!pool->workers) {
+        return PP_ERROR_MEMORY;
+    }
+    pool->worker_count = workers;
+    atomic_init(&pool->queued, 0);
+    atomic_init(&pool->sleeping, 0);
+    atomic_init(&pool->stop, false);
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->wake, NULL);
+    for (size_t i = 0; i < workers; i++) {
+        PpWorker *worker = &pool->workers[i];
+        worker->pool = pool;
+        worker->index = i;
+        worker->victim_state = 2 * i + 1;
+        if (!deque_init(&worker->deque)) {
+            pp_pool_destroy(pool);
+            return PP_ERROR_MEMORY;
+        }
+    }
+
+    // A worker whose thread cannot be started never has tasks of its own, so the others only run with less help
+    for (pool->started = 0; pool->started + 1 < workers; pool->started++) {
+        PpWorker *worker = &pool->workers[pool->started + 1];
+        if (pthread_create(&worker->thread, NULL, worker_thread, worker) != 0) {
+            break;
+        }
+    }
+
+    return PP_OK;
+}
+
+/**
+ * Spawn a task, which may be run by any worker. The number of pending tasks of its join must have been incremented.
+ *
+ * @param pool Pointer to the pool data structure.
+ * @param task The task.
+ */
+void pp_pool_spawn(PpPool *pool, PpTask *task) {
+    // The queued count is raised first, so that it is never lower than the number of queued tasks
+    atomic_fetch_add(&pool->queued, 1);
+    if (!deque_push(&get_worker(pool)->deque, task)) {
+        // The task is run at once if it cannot be queued
+        atomic_fetch_sub(&pool->queued, 1);
+        run_task(task);
+        return;
+    }
+    if (atomic_load(&pool->sleeping) > 0) {
+        pthread_mutex_lock(&pool->lock);
+        pthread_cond_signal(&pool->wake);
+        pthread_mutex_unlock(&pool->lock);
+    }
+}
+
+/**
+ * Wait until the pending tasks of a join are done, running tasks in the meantime.
+ *
+ * @param pool Pointer to the pool data structure.
+ * @param pending Pointer to the number of pending tasks of the join.
+ */
+void pp_pool_join(PpPool *pool, atomic_size_t *pending) {
+    PpWorker *worker = get_worker(pool);
+    while (atomic_load_explicit(pending, memory_order_acquire) > 0) {
+        PpTask *task = find_task(worker);
+        if (task) {
+            run_task(task);
+        } else {
+            // The last tasks of the join are running in other workers
+            sched_yield();
+        }
+    }
+}
+
+static void run_range(PpTask *task);
+
+/**
+ * Process a range of a parallel loop. The upper half of the range is spawned until the range is small enough, and the
+ * rest is processed in the current thread.
+ *
+ * @param pool Pointer to the pool data structure.
+ * @param first The first index of the range.
+ * @param last The index after the last one of the range.
+ * @param grain The largest number of indexes of a single call.
+ * @param function The function.
+ * @param context The context that is passed to the function.
+ */
+static void split_range(PpPool *pool, size_t first, size_t last, size_t grain, PpRangeFunction function,
+                        void *context) {
+    // The range is at least halved for each task, so there are fewer tasks than bits of the range
+    RangeTask tasks[sizeof(size_t) * CHAR_BIT];
+    atomic_size_t pending;
+    atomic_init(&pending, 0);
+    size_t spawned = 0;
+    while (last - first > grain) {
+        size_t middle = first + (last - first) / 2;
+        RangeTask task = {
+            .task = {.run = run_range, .pending = &pending},
+            .pool = pool,
+            .first = middle,
+            .last = last,
+            .grain = grain,
+            .function = function,
+            .context = context
+        };
+        tasks[spawned] = task;
+        atomic_fetch_add(&pending, 1);
+        pp_pool_spawn(pool, &tasks[spawned++].task);
+        last = middle;
+    }
+    function(context, first, last);
+    pp_pool_join(pool, &pending);
+}
+
+/**
+ * Run a range task of a parallel loop.
+ *
+ * @param task The task.
+ */
+static void run_range(PpTask *task) {
+    RangeTask *range = (RangeTask *) task;
+    split_range(range->pool, range->first, range->last, range->grain, range->function, range->context);
+}
+
+/**
+ * Run a function over the range of indexes [first, last) in parallel. The range is halved recursively, and one half is
+ * spawned while the other is processed, until the ranges have at most grain indexes, so idle workers steal the largest
+ * ranges first. The function returns when the whole range has been processed.
+ *
+ * @param pool Pointer to the pool data structure.
+ * @param first The first index of the range.
+ * @param last The index after the last one of the range.
+ * @param grain The largest number of indexes that a single call of the function processes, or zero for 1.
+ * @param function The function.
+ * @param context The context that is passed to the function.
+ */
+void pp_parallel_for(PpPool *pool, size_t first, size_t last, size_t grain, PpRangeFunction function, void *context) {
+    grain = grain > 0 ? grain : 1;
+    if (first >= last) {
+        return;
+    }
+    if (pool->started == 0) {
+        // Without worker threads, the chunks are processed in order
+        for (size_t chunk = first; chunk < last; chunk += last - chunk < grain ? last - chunk : grain) {
+            function(context, chunk, last - chunk < grain ? last : chunk + grain);
+        }
+        return;
+    }
+    split_range(pool, first, last, grain, function, context);
+}
+
+/**
+ * Run a function call task of a parallel invoke.
+ *
+ * @param task The task.
+ */
+static void run_invoke(PpTask *task) {
+    InvokeTask *invoke = (InvokeTask *) task;
+    invoke->call.function(invoke->call.context);
+}
+
+/**
+ * Call functions in parallel, and wait for all of them to return. The first function is called in the calling thread.
+ *
+ * @param pool Pointer to the pool data structure.
+ * @param calls The function calls.
+ * @param count The number of function calls, which may be zero.
+ */
+void pp_parallel_invoke(PpPool *pool, const PpInvoke *calls, size_t count) {
+    if (count == 0) {
+        return;
+    }
+    InvokeTask local_tasks[INVOKE_LOCAL_COUNT];
+    InvokeTask *tasks = count <= INVOKE_LOCAL_COUNT + 1 ? local_tasks : malloc((count - 1) * sizeof(InvokeTask));
+    if (pool->started == 0 || !tasks) {
+        for (size_t i = 0; i < count; i++) {
+            calls[i].function(calls[i].context);
+        }
+        return;
+    }
+
+    // The calls are spawned in reverse, so that the calling thread pops them in order after the first one
+    atomic_size_t pending;
+    atomic_init(&pending, count - 1);
+    for (size_t i = count - 1; i > 0; i--) {
+        InvokeTask task = {.task = {.run = run_invoke, .pending = &pending}, .call = calls[i]};
+        tasks[i - 1] = task;
+        pp_pool_spawn(pool, &tasks[i - 1].task);
+    }
+    calls[0].function(calls[0].context);
+    pp_pool_join(pool, &pending);
+    if (tasks != local_tasks) {
+        free(tasks);
+    }
+}
+
+/**
+ * Stop the worker threads of a pool, and free its resources. No task may be pending.
+ *
+ * @param pool Pointer to the pool data structure.
+ */
+void pp_pool_destroy(PpPool *pool) {
+    if (pool->workers) {
+        pthread_mutex_lock(&pool->lock);
+        atomic_store(&pool->stop, true);
+        pthread_cond_broadcast(&pool->wake);
+        pthread_mutex_unlock(&pool->lock);
+        for (size_t i = 1; i <= pool->started; i++) {
+            pthread_join(pool->workers[i].thread, NULL);
+        }
+        for (size_t i = 0; i < pool->worker_count; i++) {
+            deque_destroy(&pool->workers[i].deque);
+        }
+        pthread_mutex_destroy(&pool->lock);
+        pthread_cond_destroy(&pool->wake);
+    }
+    free(pool->workers);
+    memset(pool, 0, sizeof(PpPool));
+}
@@ -0,0 +1,42 @@
+/**
+ * This library describes the status codes of the pp_* functions, so that the programs that call them can report their
+ * errors.
+ */
+#include "ppstatus.h"
+
+/**
+ * Get a description of a status code.
+ *
+ * @param status The status code.
+ * @return The description, which must not be freed.
+ */
+const char *pp_status_message(PpStatus status) {
+    switch (status) {
+        case PP_OK:
+            return "Success";
+        case PP_ERROR_MEMORY:
+            return "Out of memory";
+        case PP_ERROR_IO:
+            return "Input or output error";
+        case PP_ERROR_PARSE:
+            return "Invalid number";
+        case PP_ERROR_RANGE:
+            return "Number out of range";
+        case PP_ERROR_DUPLICATE:
+            return "Duplicate number";
+        case PP_ERROR_TOO_MANY:
+            return "Too many numbers";
+        case PP_ERROR_NOT_FOUND:
+            return "No missing number";
+        case PP_ERROR_NO_DUPLICATE:
+            return "No duplicate number";
+        case PP_ERROR_BUFFER:
+            return "Buffer too small";
+        case PP_ERROR_ARGUMENT:
+            return "Invalid argument";
+        case PP_ERROR_CHECKPOINT:
+            return "Checkpoint of another program, input file or options";
+    }
+
+    return "Unknown error";
+}
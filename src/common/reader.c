@@ -0,0 +1,581 @@
+/**
+ * This library reads files asynchronously, so that the programs parse the input while the next parts of it are read,
+ * instead of alternating between waiting for the disk and parsing.
+ *
+ * A reader has a ring of large aligned buffers. With io_uring, the reads of all the free buffers are submitted at once,
+ * at increasing file offsets, and each buffer is submitted again as soon as it has been consumed. The io_uring instance
+ * is set up with raw system calls, so no extra library is needed, and the readers fall back to a background read thread
+ * if the kernel does not support it or does not allow it. The read thread fills the buffers in order, and waits while
+ * all of them are full. Pipes and terminals always use the read thread, as they cannot be read at an offset.
+ */
+#define _GNU_SOURCE
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "reader.h"
+
+// The smallest size of a line buffer
+#define MIN_LINE_SIZE 128
+
+/**
+ * Fill a buffer with blocking reads. The buffer of a regular file is filled completely, unless the end of the file is
+ * reached, and the buffer of another file is handed over after the first read that returns data.
+ *
+ * @param fd The file descriptor.
+ * @param buffer The buffer.
+ * @param regular true if the file is a regular file.
+ */
+static void fill_buffer(int fd, PpReaderBuffer *buffer, bool regular) {
+    while (buffer->length < PP_READER_BUFFER_SIZE) {
+        ssize_t count = read(fd, buffer->data + buffer->length, PP_READER_BUFFER_SIZE - buffer->length);
+        if (count < 0 && errno == EINTR) {
+            continue;
+        } else if (count < 0) {
+            buffer->error = errno;
+            break;
+        } else if (count == 0) {
+            buffer->end = true;
+            break;
+        }
+        buffer->length += count;
+        if (!regular) {
+            break;
+        }
+    }
+}
+
+/**
+ * Set up an io_uring instance with a queue entry for each buffer.
+ *
+ * @param ring Pointer to the ring data structure.
+ * @return true if the instance was set up successfully, false otherwise.
+ */
+static bool ring_setup(PpReaderRing *ring) {
+    struct io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    memset(ring, 0, sizeof(PpReaderRing));
+    ring->fd = (int) syscall(__NR_io_uring_setup, PP_READER_BUFFER_COUNT, &params);
+    if (ring->fd < 0) {
+        return false;
+    }
+
+    // Map the rings, which share a single mapping on the kernels that support it
+    ring->sq_ring_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    ring->cq_ring_size = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    bool single_mmap = params.features & IORING_FEAT_SINGLE_MMAP;
+    if (single_mmap && ring->cq_ring_size > ring->sq_ring_size) {
+        ring->sq_ring_size = ring->cq_ring_size;
+    }
+    ring->sq_ring = mmap(NULL, ring->sq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->fd,
+                         IORING_OFF_SQ_RING);
+    ring->cq_ring = single_mmap ? ring->sq_ring : mmap(NULL, ring->cq_ring_size, PROT_READ | PROT_WRITE,
+                                                       MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_CQ_RING);
+    ring->sqes_size = params.sq_entries * sizeof(struct io_uring_sqe);
+    ring->sqes = mmap(NULL, ring->sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->fd,
+                      IORING_OFF_SQES);
+    if (ring->sq_ring == MAP_FAILED || ring->cq_ring == MAP_FAILED || ring->sqes == MAP_FAILED) {
+        return false;
+    }
+
+    ring->sq_tail = (unsigned *) ((char *) ring->sq_ring + params.sq_off.tail);
+    ring->sq_mask = (unsigned *) ((char *) ring->sq_ring + params.sq_off.ring_mask);
+    ring->sq_array = (unsigned *) ((char *) ring->sq_ring + params.sq_off.array);
+    ring->cq_head = (unsigned *) ((char *) ring->cq_ring + params.cq_off.head);
+    ring->cq_tail = (unsigned *) ((char *) ring->cq_ring + params.cq_off.tail);
+    ring->cq_mask = (unsigned *) ((char *) ring->cq_ring + params.cq_off.ring_mask);
+    ring->cqes = (char *) ring->cq_ring + params.cq_off.cqes;
+
+    return true;
+}
+
+/**
+ * Unmap the rings of an io_uring instance, and close it. The instance may be partially set up.
+ *
+ * @param ring Pointer to the ring data structure.
+ */
+static void ring_destroy(PpReaderRing *ring) {
+    if (ring->sqes && ring->sqes != MAP_FAILED) {
+        munmap(ring->sqes, ring->sqes_size);
+    }
+    if (ring->cq_ring && ring->cq_ring != MAP_FAILED && ring->cq_ring != ring->sq_ring) {
+        munmap(ring->cq_ring, ring->cq_ring_size);
+    }
+    if (ring->sq_ring && ring->sq_ring != MAP_FAILED) {
+        munmap(ring->sq_ring, ring->sq_ring_size);
+    }
+    if (ring->fd >= 0) {
+        close(ring->fd);
+    }
+    memset(ring, 0, sizeof(PpReaderRing));
+    ring->fd = -1;
+}
+
+/**
+ * Submit the read of the free part of a buffer to the io_uring instance. If the submission fails, the buffer is marked
+ * with the error.
+ *
+ * @param reader Pointer to the reader data structure.
+ * @param index The index of the buffer.
+ */
+static void ring_submit(PpReader *reader, size_t index) {
+    PpReaderRing *ring = &reader->ring;
+    PpReaderBuffer *buffer = &reader->buffers[index];
+    buffer->iov.iov_base = buffer->data + buffer->length;
+    buffer->iov.iov_len = PP_READER_BUFFER_SIZE - buffer->length;
+
+    // Only this thread adds entries, and there is an entry for each buffer, so the queue is never full
+    unsigned tail = *ring->sq_tail;
+    unsigned slot = tail & *ring->sq_mask;
+    struct io_uring_sqe *sqe = (struct io_uring_sqe *) ring->sqes + slot;
+    memset(sqe, 0, sizeof(struct io_uring_sqe));
+    sqe->opcode = IORING_OP_READV;
+    sqe->fd = reader->fd;
+    sqe->addr = (uint64_t) (uintptr_t) &buffer->iov;
+    sqe->len = 1;
+    sqe->off = buffer->offset + buffer->length;
+    sqe->user_data = index;
+    ring->sq_array[slot] = slot;
+    __atomic_store_n(ring->sq_tail, tail + 1, __ATOMIC_RELEASE);
+
+    if (syscall(__NR_io_uring_enter, ring->fd, 1, 0, 0, NULL, 0) < 0) {
+        buffer->error = errno;
+        buffer->full = true;
+        return;
+    }
+    buffer->pending = true;
+}
+
+/**
+ * Handle the completion of a read of a buffer. A short read is submitted again for the rest of the buffer, and the
+ * buffer is full when it is filled completely, or when a read reaches the end of the file.
+ *
+ * @param reader Pointer to the reader data structure.
+ * @param index The index of the buffer.
+ * @param result The result of the read: the number of bytes read, or a negative error number.
+ */
+static void ring_complete(PpReader *reader, size_t index, int result) {
+    PpReaderBuffer *buffer = &reader->buffers[index];
+    buffer->pending = false;
+    if (result == -EINTR || result == -EAGAIN) {
+        // The read was interrupted, so it is submitted again
+    } else if (result < 0) {
+        buffer->error = -result;
+        buffer->full = true;
+        return;
+    } else if (result == 0) {
+        buffer->end = true;
+        buffer->full = true;
+        reader->end = true;
+        return;
+    } else {
+        buffer->length += result;
+        if (buffer->length == PP_READER_BUFFER_SIZE) {
+            buffer->full = true;
+            return;
+        }
+    }
+    if (reader->stop) {
+        buffer->full = true;
+    } else {
+        ring_submit(reader, index);
+    }
+}
+
+/**
+ * Wait for at least one read of the io_uring instance to complete, and handle all the completed reads.
+ *
+ * @param reader Pointer to the reader data structure.
+ * @return true if the wait was successful, false otherwise.
+ */
+static bool ring_wait(PpReader *reader) {
+    PpReaderRing *ring = &reader->ring;
+    unsigned head = *ring->cq_head;
+    unsigned tail = __atomic_load_n(ring->cq_tail, __ATOMIC_ACQUIRE);
+    if (head == tail) {
+        return syscall(__NR_io_uring_enter, ring->fd, 0, 1, IORING_ENTER_GETEVENTS, NULL, 0) >= 0 || errno == EINTR;
+    }
+    for (; head != tail; head++) {
+        struct io_uring_cqe *cqe = (struct io_uring_cqe *) ring->cqes + (head & *ring->cq_mask);
+        size_t index = (size_t) cqe->user_data;
+        int result = cqe->res;
+        __atomic_store_n(ring->cq_head, head + 1, __ATOMIC_RELEASE);
+        ring_complete(reader, index, result);
+    }
+
+    return true;
+}
+
+/**
+ * The read thread, which fills the buffers in order, and waits while the next buffer is full. Cancellation is only
+ * enabled while it reads, so that a read of a pipe that blocks forever can be stopped.
+ *
+ * @param arg Pointer to the reader data structure.
+ * @return Always NULL.
+ */
+static void *read_thread(void *arg) {
+    PpReader *reader = arg;
+    pthread_setcancelstate(PTHREAD_CANCEL_DISABLE, NULL);
+    for (size_t i = 0; ; i = (i + 1) % PP_READER_BUFFER_COUNT) {
+        PpReaderBuffer *buffer = &reader->buffers[i];
+        pthread_mutex_lock(&reader->mutex);
+        while (buffer->full && !reader->stop) {
+            pthread_cond_wait(&reader->cond, &reader->mutex);
+        }
+        bool stop = reader->stop;
+        pthread_mutex_unlock(&reader->mutex);
+        if (stop) {
+            break;
+        }
+
+        // The buffer is not full, so the consumer does not access it
+        pthread_setcancelstate(PTHREAD_CANCEL_ENABLE, NULL);
+        fill_buffer(reader->fd, buffer, reader->regular);
+        pthread_setcancelstate(PTHREAD_CANCEL_DISABLE, NULL);
+
+        pthread_mutex_lock(&reader->mutex);
+        buffer->full = true;
+        pthread_cond_broadcast(&reader->cond);
+        pthread_mutex_unlock(&reader->mutex);
+        if (buffer->end || buffer->error) {
+            break;
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * Empty the buffers, and start filling them from the offset of the reader.
+ *
+ * @param reader Pointer to the reader data structure.
+ * @return PP_OK if the reads were started successfully, an error otherwise.
+ */
+static PpStatus start(PpReader *reader) {
+    for (size_t i = 0; i < PP_READER_BUFFER_COUNT; i++) {
+        PpReaderBuffer *buffer = &reader->buffers[i];
+        buffer->length = 0;
+        buffer->pending = false;
+        buffer->full = false;
+        buffer->end = false;
+        buffer->error = 0;
+    }
+    reader->current = 0;
+    reader->position = 0;
+    reader->end = false;
+    reader->stop = false;
+    reader->status = PP_OK;
+
+    if (reader->backend == PP_READER_IO_URING) {
+        for (size_t i = 0; i < PP_READER_BUFFER_COUNT; i++) {
+            reader->buffers[i].offset = reader->offset;
+            reader->offset += PP_READER_BUFFER_SIZE;
+            ring_submit(reader, i);
+        }
+    } else if (reader->backend == PP_READER_THREAD) {
+        if (pthread_create(&reader->thread, NULL, read_thread, reader) != 0) {
+            // The buffers are filled when they are needed instead
+            reader->backend = PP_READER_SYNC;
+        }
+    }
+
+    return PP_OK;
+}
+
+/**
+ * Stop the reads in flight. The io_uring reads are waited for, and the read thread is stopped.
+ *
+ * @param reader Pointer to the reader data structure.
+ */
+static void stop(PpReader *reader) {
+    reader->stop = true;
+    if (reader->backend == PP_READER_IO_URING) {
+        for (size_t i = 0; i < PP_READER_BUFFER_COUNT; i++) {
+            while (reader->buffers[i].pending && ring_wait(reader)) {
+            }
+        }
+    } else if (reader->backend == PP_READER_THREAD) {
+        pthread_mutex_lock(&reader->mutex);
+        pthread_cond_broadcast(&reader->cond);
+        pthread_mutex_unlock(&reader->mutex);
+        pthread_cancel(reader->thread);
+        pthread_join(reader->thread, NULL);
+    }
+}
+
+/**
+ * Wait until the current buffer is full.
+ *
+ * @param reader Pointer to the reader data structure.
+ * @return true if the buffer is full, false if it will not be filled.
+ */
+static bool wait_buffer(PpReader *reader) {
+    PpReaderBuffer *buffer = &reader->buffers[reader->current];
+    switch (reader->backend) {
+        case PP_READER_IO_URING:
+            while (!buffer->full) {
+                // A buffer that is not pending was not submitted, as it is past the end of the file
+                if (!buffer->pending || !ring_wait(reader)) {
+                    return false;
+                }
+            }
+            break;
+        case PP_READER_THREAD:
+            pthread_mutex_lock(&reader->mutex);
+            while (!buffer->full) {
+                pthread_cond_wait(&reader->cond, &reader->mutex);
+            }
+            pthread_mutex_unlock(&reader->mutex);
+            break;
+        default:
+            if (!buffer->full) {
+                fill_buffer(reader->fd, buffer, reader->regular);
+                buffer->full = true;
+            }
+            break;
+    }
+
+    return true;
+}
+
+/**
+ * Hand the current buffer back to the backend, which fills it again, and move to the next buffer.
+ *
+ * @param reader Pointer to the reader data structure.
+ */
+static void release_buffer(PpReader *reader) {
+    PpReaderBuffer *buffer = &reader->buffers[reader->current];
+    if (reader->backend == PP_READER_THREAD) {
+        pthread_mutex_lock(&reader->mutex);
+    }
+    buffer->length = 0;
+    buffer->full = false;
+    if (reader->backend == PP_READER_THREAD) {
+        pthread_cond_broadcast(&reader->cond);
+        pthread_mutex_unlock(&reader->mutex);
+    } else if (reader->backend == PP_READER_IO_URING && !reader->end) {
+        buffer->offset = reader->offset;
+        reader->offset += PP_READER_BUFFER_SIZE;
+        ring_submit(reader, reader->current);
+    }
+    reader->current = (reader->current + 1) % PP_READER_BUFFER_COUNT;
+    reader->position = 0;
+}
+
+/**
+ * Get the current buffer, if it still has data to consume, or the next one.
+ *
+ * @param reader Pointer to the reader data structure.
+ * @return The buffer, or NULL at the end of the file or on error.
+ */
+static PpReaderBuffer *next_data(PpReader *reader) {
+    while (reader->status == PP_OK) {
+        PpReaderBuffer *buffer = &reader->buffers[reader->current];
+        if (!wait_buffer(reader)) {
+            return NULL;
+        } else if (buffer->error) {
+            reader->status = PP_ERROR_IO;
+        } else if (reader->position < buffer->length) {
+            return buffer;
+        } else if (buffer->end) {
+            return NULL;
+        } else {
+            release_buffer(reader);
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * Open a reader of a file descriptor. Reading starts at the current offset of the file descriptor, so the file must not
+ * have been read through a stdio stream.
+ *
+ * @param reader Pointer to the reader data structure.
+ * @param fd The file descriptor.
+ * @param backend The backend that fills the buffers. PP_READER_AUTO picks io_uring if it is available and the read
+ * thread otherwise, unless the PP_READER_BACKEND environment variable is set to thread or sync.
+ * @return PP_OK if the reader was opened successfully, an error otherwise, in which case it must not be closed.
+ */
+PpStatus pp_reader_open(PpReader *reader, int fd, PpReaderBackend backend) {
+    memset(reader, 0, sizeof(PpReader));
+    reader->fd = fd;
+    reader->ring.fd = -1;
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        return PP_ERROR_IO;
+    }
+    reader->regular = S_ISREG(st.st_mode);
+    off_t offset = reader->regular ? lseek(fd, 0, SEEK_CUR) : 0;
+    reader->offset = offset > 0 ? (uint64_t) offset : 0;
+
+    // Pick the backend, the environment variable only selects io_uring if it is available
+    const char *name = getenv(PP_READER_BACKEND_ENV);
+    if (backend == PP_READER_AUTO && name) {
+        for (PpReaderBackend i = PP_READER_THREAD; i <= PP_READER_SYNC; i++) {
+            if (strcmp(name, pp_reader_backend_name(i)) == 0) {
+                backend = i;
+            }
+        }
+    }
+    if (backend == PP_READER_IO_URING && !reader->regular) {
+        return PP_ERROR_ARGUMENT;
+    }
+    if (backend == PP_READER_AUTO || backend == PP_READER_IO_URING) {
+        bool ring_available = reader->regular && ring_setup(&reader->ring);
+        if (!ring_available) {
+            ring_destroy(&reader->ring);
+            if (backend == PP_READER_IO_URING) {
+                return PP_ERROR_IO;
+            }
+        }
+        backend = ring_available ? PP_READER_IO_URING : PP_READER_THREAD;
+    }
+    pthread_mutex_init(&reader->mutex, NULL);
+    pthread_cond_init(&reader->cond, NULL);
+
+    // Allocate the buffers, nothing is read yet, so the reader is closed as a synchronous one on failure
+    reader->backend = PP_READER_SYNC;
+    for (size_t i = 0; i < PP_READER_BUFFER_COUNT; i++) {
+        if (posix_memalign((void **) &reader->buffers[i].data, PP_READER_BUFFER_ALIGNMENT,
+                           PP_READER_BUFFER_SIZE) != 0) {
+            reader->buffers[i].data = NULL;
+            pp_reader_close(reader);
+            return PP_ERROR_MEMORY;
+        }
+    }
+    reader->backend = backend;
+
+    return start(reader);
+}
+
+/**
+ * Read a line, as getline does. The line contains the new line character, if there is one, and it is terminated by a
+ * null character, so a missing new line character can be added in place of it.
+ *
+ * @param reader Pointer to the reader data structure.
+ * @param line Pointer to the line buffer, which is allocated or extended as needed, and must be freed by the caller.
+ * @param size Pointer to the size of the line buffer.
+ * @return The length of the line, or -1 at the end of the file, on error, or if memory could not be allocated. The
+ * status of the reader tells them apart.
+ */
+ssize_t pp_reader_getline(PpReader *reader, char **line, size_t *size) {
+    size_t length = 0;
+    PpReaderBuffer *buffer;
+    while ((buffer = next_data(reader)) != NULL) {
+        // Copy the data up to the new line, or the rest of the buffer if the line continues in the next one
+        const char *start = buffer->data + reader->position;
+        size_t available = buffer->length - reader->position;
+        const char *new_line = memchr(start, '\n', available);
+        size_t count = new_line ? (size_t) (new_line - start) + 1 : available;
+        if (!*line || *size < length + count + 1) {
+            size_t new_size = *line && *size * 2 > MIN_LINE_SIZE ? *size * 2 : MIN_LINE_SIZE;
+            while (new_size < length + count + 1) {
+                new_size *= 2;
+            }
+            char *extended = realloc(*line, new_size);
+            if (!extended) {
+                reader->status = PP_ERROR_MEMORY;
+                return -1;
+            }
+            *line = extended;
+            *size = new_size;
+        }
+        memcpy(*line + length, start, count);
+        length += count;
+        reader->position += count;
+        if (new_line) {
+            break;
+        }
+    }
+    if (length == 0 || reader->status != PP_OK) {
+        return -1;
+    }
+    (*line)[length] = '\0';
+
+    return (ssize_t) length;
+}
+
+/**
+ * Read bytes, as fread does.
+ *
+ * @param reader Pointer to the reader data structure.
+ * @param data Pointer to where the bytes will be written to.
+ * @param size The number of bytes to read.
+ * @return The number of bytes that were read, which is less than the size only at the end of the file or on error.
+ */
+size_t pp_reader_read(PpReader *reader, void *data, size_t size) {
+    size_t length = 0;
+    PpReaderBuffer *buffer;
+    while (length < size && (buffer = next_data(reader)) != NULL) {
+        size_t available = buffer->length - reader->position;
+        size_t count = size - length < available ? size - length : available;
+        memcpy((char *) data + length, buffer->data + reader->position, count);
+        length += count;
+        reader->position += count;
+    }
+
+    return length;
+}
+
+/**
+ * Start reading again from the start of the file. The file must be seekable.
+ *
+ * @param reader Pointer to the reader data structure.
+ * @return PP_OK if the reader was rewound successfully, an error otherwise.
+ */
+PpStatus pp_reader_rewind(PpReader *reader) {
+    stop(reader);
+    if (!reader->regular || lseek(reader->fd, 0, SEEK_SET) != 0) {
+        reader->status = PP_ERROR_IO;
+        return PP_ERROR_IO;
+    }
+    reader->offset = 0;
+
+    return start(reader);
+}
+
+/**
+ * Stop the reads in flight, and free the resources associated with a reader. The file descriptor is not closed.
+ *
+ * @param reader Pointer to the reader data structure.
+ */
+void pp_reader_close(PpReader *reader) {
+    stop(reader);
+    ring_destroy(&reader->ring);
+    for (size_t i = 0; i < PP_READER_BUFFER_COUNT; i++) {
+        free(reader->buffers[i].data);
+    }
+    pthread_mutex_destroy(&reader->mutex);
+    pthread_cond_destroy(&reader->cond);
+    memset(reader, 0, sizeof(PpReader));
+    reader->fd = -1;
+}
+
+/**
+ * Get the name of a backend, for the reports of the programs.
+ *
+ * @param backend The backend.
+ * @return The name, which must not be freed.
+ */
+const char *pp_reader_backend_name(PpReaderBackend backend) {
+    switch (backend) {
+        case PP_READER_AUTO:
+            return "auto";
+        case PP_READER_IO_URING:
+            return "io_uring";
+        case PP_READER_THREAD:
+            return "thread";
+        case PP_READER_SYNC:
+            return "sync";
+    }
+
+    return "unknown";
+}
@@ -0,0 +1,219 @@
+/**
+ * This library records where a program spends its time. The program is split into named phases, and for each phase the
+ * elapsed time of the monotonic clock, the bytes and records processed, and optionally the hardware counters are
+ * recorded. The report also contains the peak resident set size of the process.
+ *
+ * The hardware counters are read with the perf_event_open system call, which is not available in every environment, so
+ * each counter that cannot be opened is left out of the report. The counters are inherited by the threads that are
+ * created afterwards, and the counts of a thread are added when it exits.
+ */
+#define _GNU_SOURCE
+
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include <linux/perf_event.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "stats.h"
+
+// The names of the hardware counters
+static const char *hw_counter_names[STATS_HW_COUNTER_COUNT] = {"cycles", "instructions", "cache_misses", "tlb_misses"};
+
+Stats stats = {.hw_fds = {-1, -1, -1, -1}};
+
+/**
+ * Get the current time of the monotonic clock.
+ *
+ * @return The time in nanoseconds.
+ */
+static uint64_t now() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (uint64_t) ts.tv_sec * 1000000000u + ts.tv_nsec;
+}
+
+/**
+ * Open a hardware counter of the calling process and the threads it creates.
+ *
+ * @param type The type of the counter.
+ * @param config The counter of the type.
+ * @return The file descriptor of the counter, or -1 if it is not available.
+ */
+static int open_hw_counter(uint32_t type, uint64_t config) {
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = type;
+    attr.config = config;
+    attr.inherit = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+
+    return (int) syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+}
+
+/**
+ * Read the hardware counters. The counters that are not available are read as zero.
+ *
+ * @param values Pointer to where the counter values will be written to.
+ */
+static void read_hw_counters(uint64_t values[STATS_HW_COUNTER_COUNT]) {
+    for (size_t i = 0; i < STATS_HW_COUNTER_COUNT; i++) {
+        values[i] = 0;
+        if (stats.hw_fds[i] != -1 && read(stats.hw_fds[i], &values[i], sizeof(uint64_t)) != sizeof(uint64_t)) {
+            values[i] = 0;
+        }
+    }
+}
+
+/**
+ * Enable the statistics from the value of the --stats option, and open the hardware counters.
+ *
+ * @param format The format of the report: NULL for a table, or "json".
+ * @return true if the format is valid, false otherwise.
+ */
+bool stats_enable(const char *format) {
+    if (format && strcmp(format, "json") != 0) {
+        fprintf(stderr, "Invalid value for the stats argument: %s.\n", format);
+        return false;
+    }
+    if (stats.enabled) {
+        stats.json = format != NULL;
+        return true;
+    }
+    stats.enabled = true;
+    stats.json = format != NULL;
+    // The counters are optional, so the errors of the system call are not reported
+    int saved_errno = errno;
+    stats.hw_fds[STATS_CYCLES] = open_hw_counter(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES);
+    stats.hw_fds[STATS_INSTRUCTIONS] = open_hw_counter(PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS);
+    stats.hw_fds[STATS_CACHE_MISSES] = open_hw_counter(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES);
+    stats.hw_fds[STATS_TLB_MISSES] = open_hw_counter(PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_DTLB |
+                                                     (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                                                     (PERF_COUNT_HW_CACHE_RESULT_MISS << 16));
+    errno = saved_errno;
+    stats.start = now();
+
+    return true;
+}
+
+/**
+ * Add the measurements since the current phase was entered to it, and leave it.
+ */
+static void leave_phase() {
+    if (!stats.current) {
+        return;
+    }
+    uint64_t hw[STATS_HW_COUNTER_COUNT];
+    read_hw_counters(hw);
+    stats.current->elapsed += now() - stats.phase_start;
+    stats.current->bytes += stats.bytes;
+    stats.current->records += stats.records;
+    for (size_t i = 0; i < STATS_HW_COUNTER_COUNT; i++) {
+        stats.current->hw[i] += hw[i] - stats.hw_start[i];
+    }
+    stats.current = NULL;
+}
+
+/**
+ * Enter a phase, and leave the current one. The name must be a string constant, as it is not copied. Nothing is
+ * recorded if the statistics are disabled.
+ *
+ * @param name The name of the phase.
+ */
+void stats_phase(const char *name) {
+    if (!stats.enabled) {
+        return;
+    }
+    leave_phase();
+
+    // Find the phase, or add it
+    StatsPhase *phase = NULL;
+    for (size_t i = 0; i < stats.phase_count && !phase; i++) {
+        if (strcmp(stats.phases[i].name, name) == 0) {
+            phase = &stats.phases[i];
+        }
+    }
+    if (!phase) {
+        if (stats.phase_count == STATS_MAX_PHASES) {
+            return;
+        }
+        phase = &stats.phases[stats.phase_count++];
+        phase->name = name;
+    }
+
+    stats.current = phase;
+    stats.bytes = 0;
+    stats.records = 0;
+    read_hw_counters(stats.hw_start);
+    stats.phase_start = now();
+}
+
+/**
+ * Write the report of the phases, the total time and the peak resident set size to the standard error, and close the
+ * hardware counters. Nothing is written if the statistics are disabled.
+ */
+void stats_report() {
+    if (!stats.enabled) {
+        return;
+    }
+    leave_phase();
+    uint64_t total = now() - stats.start;
+    struct rusage usage;
+    long peak_rss = getrusage(RUSAGE_SELF, &usage) == 0 ? usage.ru_maxrss : 0;
+
+    if (stats.json) {
+        fprintf(stderr, "{\"phases\": [");
+        for (size_t i = 0; i < stats.phase_count; i++) {
+            const StatsPhase *phase = &stats.phases[i];
+            fprintf(stderr, "%s{\"name\": \"%s\", \"ns\": %llu, \"bytes\": %llu, \"records\": %llu", i > 0 ? ", " : "",
+                    phase->name, (unsigned long long) phase->elapsed, (unsigned long long) phase->bytes,
+                    (unsigned long long) phase->records);
+            for (size_t j = 0; j < STATS_HW_COUNTER_COUNT; j++) {
+                if (stats.hw_fds[j] != -1) {
+                    fprintf(stderr, ", \"%s\": %llu", hw_counter_names[j], (unsigned long long) phase->hw[j]);
+                }
+            }
+            fprintf(stderr, "}");
+        }
+        fprintf(stderr, "], \"total_ns\": %llu, \"peak_rss_kb\": %ld}\n", (unsigned long long) total, peak_rss);
+    } else {
+        fprintf(stderr, "%-16s %12s %14s %12s", "phase", "time_ms", "bytes", "records");
+        for (size_t j = 0; j < STATS_HW_COUNTER_COUNT; j++) {
+            if (stats.hw_fds[j] != -1) {
+                fprintf(stderr, " %14s", hw_counter_names[j]);
+            }
+        }
+        fprintf(stderr, "\n");
+        for (size_t i = 0; i < stats.phase_count; i++) {
+            const StatsPhase *phase = &stats.phases[i];
+            fprintf(stderr, "%-16s %12.3f %14llu %12llu", phase->name, (double) phase->elapsed / 1e6,
+                    (unsigned long long) phase->bytes, (unsigned long long) phase->records);
+            for (size_t j = 0; j < STATS_HW_COUNTER_COUNT; j++) {
+                if (stats.hw_fds[j] != -1) {
+                    fprintf(stderr, " %14llu", (unsigned long long) phase->hw[j]);
+                }
+            }
+            fprintf(stderr, "\n");
+        }
+        fprintf(stderr, "%-16s %12.3f\npeak_rss_kb: %ld\n", "total", (double) total / 1e6, peak_rss);
+        if (stats.hw_fds[STATS_CYCLES] == -1) {
+            fprintf(stderr, "The hardware counters are not available.\n");
+        }
+    }
+
+    // Close the hardware counters
+    for (size_t i = 0; i < STATS_HW_COUNTER_COUNT; i++) {
+        if (stats.hw_fds[i] != -1) {
+            close(stats.hw_fds[i]);
+            stats.hw_fds[i] = -1;
+        }
+    }
+    stats.enabled = false;
+}